@@ -151,6 +151,23 @@ collectLeafNodes(const Crag& crag, Crag::Node n) {
 	return leafNodes;
 }
 
+/**
+ * Downsample the CRAG of a single section of a stack.
+ */
+void
+downSampleSection(std::unique_ptr<Crag>& crag, std::unique_ptr<CragVolumes>& volumes) {
+
+	std::unique_ptr<Crag>        downSampled(new Crag());
+	std::unique_ptr<CragVolumes> downSampledVolumes(new CragVolumes(*downSampled));
+
+	DownSampler downSampler(optionMinCandidateSize.as<int>());
+	downSampler.process(*crag, *volumes, *downSampled, *downSampledVolumes);
+
+	// the volumes refer to the CRAG, delete them first
+	volumes = std::move(downSampledVolumes);
+	crag    = std::move(downSampled);
+}
+
 int main(int argc, char** argv) {
 
 	UTIL_TIME_SCOPE("main");
@@ -176,6 +193,9 @@ int main(int argc, char** argv) {
 
 		CragImport import;
 
+		// set if the leaf adjacencies were found during the import
+		std::shared_ptr<AdjacencyAnnotator> leafAdjacencies;
+
 		bool alreadyDownsampled = false;
 
 		if (optionMergeTree) {
@@ -189,51 +209,31 @@ int main(int argc, char** argv) {
 
 				std::vector<std::string> files = getImageFiles(mergeTreePath);
 
-				// process one image after another
-				std::vector<std::unique_ptr<Crag>> crags(files.size());
-				std::vector<std::unique_ptr<CragVolumes>> cragsVolumes;
-				for (auto& c : crags) {
-					c = std::unique_ptr<Crag>(new Crag);
-					cragsVolumes.push_back(std::unique_ptr<CragVolumes>(new CragVolumes(*c)));
-				}
-
-				int i = 0;
-				for (std::string file : files) {
-					
-					LOG_USER(logger::out) << "reading crag from " << file << std::endl;
-
-					import.readCrag(file, *crags[i], *cragsVolumes[i], resolution, offset + util::point<float, 3>(0, 0, resolution.z()*i));
-					i++;
-				}
-
-				if (optionDownsampleCrag) {
-
-					UTIL_TIME_SCOPE("downsample CRAG");
-
-					DownSampler downSampler(optionMinCandidateSize.as<int>());
-
-					std::vector<std::unique_ptr<Crag>> downSampledCrags(crags.size());
-					std::vector<std::unique_ptr<CragVolumes>> downSampledVolumes(crags.size());
+				// read (and downsample) the images in parallel while 
+				// combining them
+				CragStackCombiner combiner;
+				combiner.combine(
+						files.size(),
+						[&](unsigned int z, std::unique_ptr<Crag>& sectionCrag, std::unique_ptr<CragVolumes>& sectionVolumes) {
 
-					for (int i = 0; i < crags.size(); i++) {
+							LOG_USER(logger::out) << "reading crag from " << files[z] << std::endl;
 
-						downSampledCrags[i]   = std::unique_ptr<Crag>(new Crag());
-						downSampledVolumes[i] = std::unique_ptr<CragVolumes>(new CragVolumes(*downSampledCrags[i]));
+							sectionCrag    = std::unique_ptr<Crag>(new Crag);
+							sectionVolumes = std::unique_ptr<CragVolumes>(new CragVolumes(*sectionCrag));
 
-						downSampler.process(*crags[i], *cragsVolumes[i], *downSampledCrags[i], *downSampledVolumes[i]);
-					}
+							CragImport sectionImport;
+							sectionImport.readCrag(files[z], *sectionCrag, *sectionVolumes, resolution, offset + util::point<float, 3>(0, 0, resolution.z()*z));
 
-					std::swap(cragsVolumes, downSampledVolumes);
-					std::swap(crags, downSampledCrags);
+							if (optionDownsampleCrag)
+								downSampleSection(sectionCrag, sectionVolumes);
+						},
+						*crag,
+						*volumes);
 
-					// prevent another downsampling on the candidates added by 
-					// the combiner
+				// prevent another downsampling on the candidates added by the 
+				// combiner
+				if (optionDownsampleCrag)
 					alreadyDownsampled = true;
-				}
-
-				// combine crags
-				CragStackCombiner combiner;
-				combiner.combine(crags, cragsVolumes, *crag, *volumes);
 
 			} else {
 
@@ -263,55 +263,40 @@ int main(int argc, char** argv) {
 					// get all supervoxel files
 					std::vector<std::string> svFiles = getImageFiles(optionSupervoxels);
 
-					// process one image after another
-					std::vector<std::unique_ptr<Crag>> crags(mhFiles.size());
-					std::vector<std::unique_ptr<CragVolumes>> cragsVolumes;
-					for (auto& c : crags) {
-						c = std::unique_ptr<Crag>(new Crag);
-						cragsVolumes.push_back(std::unique_ptr<CragVolumes>(new CragVolumes(*c)));
-					}
-
-					for (int i = 0; i < mhFiles.size(); i++) {
-						
-						LOG_USER(logger::out) << "reading crag from supervoxel file " << svFiles[i] << " and merge history " << mhFiles[i] << std::endl;
-
-						Costs mergeCosts(*crags[i]);
-						import.readCragFromMergeHistory(svFiles[i], mhFiles[i], *crags[i], *cragsVolumes[i], resolution, offset + util::point<float, 3>(0, 0, resolution.z()*i), mergeCosts, nodeToId);
-					}
-
-					if (optionDownsampleCrag) {
-
-						UTIL_TIME_SCOPE("downsample CRAG");
-
-						DownSampler downSampler(optionMinCandidateSize.as<int>());
+					// read (and downsample) the sections in parallel while 
+					// combining them
+					CragStackCombiner combiner;
+					combiner.combine(
+							mhFiles.size(),
+							[&](unsigned int z, std::unique_ptr<Crag>& sectionCrag, std::unique_ptr<CragVolumes>& sectionVolumes) {
 
-						std::vector<std::unique_ptr<Crag>> downSampledCrags(crags.size());
-						std::vector<std::unique_ptr<CragVolumes>> downSampledVolumes(crags.size());
+								LOG_USER(logger::out) << "reading crag from supervoxel file " << svFiles[z] << " and merge history " << mhFiles[z] << std::endl;
 
-						for (int i = 0; i < crags.size(); i++) {
+								sectionCrag    = std::unique_ptr<Crag>(new Crag);
+								sectionVolumes = std::unique_ptr<CragVolumes>(new CragVolumes(*sectionCrag));
 
-							downSampledCrags[i]   = std::unique_ptr<Crag>(new Crag());
-							downSampledVolumes[i] = std::unique_ptr<CragVolumes>(new CragVolumes(*downSampledCrags[i]));
+								Costs              sectionMergeCosts(*sectionCrag);
+								Crag::NodeMap<int> sectionNodeToId(*sectionCrag);
 
-							downSampler.process(*crags[i], *cragsVolumes[i], *downSampledCrags[i], *downSampledVolumes[i]);
-						}
+								CragImport sectionImport;
+								sectionImport.readCragFromMergeHistory(svFiles[z], mhFiles[z], *sectionCrag, *sectionVolumes, resolution, offset + util::point<float, 3>(0, 0, resolution.z()*z), sectionMergeCosts, sectionNodeToId);
 
-						std::swap(cragsVolumes, downSampledVolumes);
-						std::swap(crags, downSampledCrags);
+								if (optionDownsampleCrag)
+									downSampleSection(sectionCrag, sectionVolumes);
+							},
+							*crag,
+							*volumes);
 
-						// prevent another downsampling on the candidates added by 
-						// the combiner
+					// prevent another downsampling on the candidates added by 
+					// the combiner
+					if (optionDownsampleCrag)
 						alreadyDownsampled = true;
-					}
-
-					// combine crags
-					CragStackCombiner combiner;
-					combiner.combine(crags, cragsVolumes, *crag, *volumes);
 
 				} else {
 
 					mergeCosts = new Costs(*crag);
 					import.readCragFromMergeHistory(optionSupervoxels, optionMergeHistory, *crag, *volumes, resolution, offset, *mergeCosts, nodeToId);
+					leafAdjacencies = import.getAdjacencyAnnotator();
 
 				}
 
@@ -352,13 +337,23 @@ int main(int argc, char** argv) {
 			}
 			crag = downSampled;
 			volumes = downSampledVolumes;
+
+			// the found adjacencies refer to the old CRAG
+			leafAdjacencies.reset();
 		}
 
 		{
 			UTIL_TIME_SCOPE("find CRAG adjacencies");
 
-			PlanarAdjacencyAnnotator annotator(PlanarAdjacencyAnnotator::Direct);
-			annotator.annotate(*crag, *volumes);
+			if (leafAdjacencies) {
+
+				leafAdjacencies->annotate(*crag, *volumes);
+
+			} else {
+
+				PlanarAdjacencyAnnotator annotator(PlanarAdjacencyAnnotator::Direct);
+				annotator.annotate(*crag, *volumes);
+			}
 		}
 
 		// Statistics
@@ -13,6 +13,7 @@
 #include <util/helpers.hpp>
 #include <util/timing.h>
 #include <util/assert.h>
+#include <crag/ParallelFor.h>
 #include <io/Hdf5CragStore.h>
 #include <io/Hdf5VolumeStore.h>
 #include <io/SolutionImageWriter.h>
@@ -65,24 +66,12 @@ util::ProgramOption optionDryRun(
 		util::_long_name        = "dryRun",
 		util::_description_text = "Compute the costs and store them, but do not run the solver.");
 
-inline double dot(const std::vector<double>& a, const std::vector<double>& b) {
-
-	UTIL_ASSERT_REL(a.size(), ==, b.size());
-
-	double sum = 0;
-	auto ba = a.begin();
-	auto ea = a.end();
-	auto bb = b.begin();
-
-	while (ba != ea) {
-
-		sum += (*ba)*(*bb);
-		ba++;
-		bb++;
-	}
-
-	return sum;
-}
+util::ProgramOption optionNumCostThreads(
+		util::_module           = "costs",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to compute the costs from the features and weights with. "
+		                          "Set to 0 to use one thread per hardware thread. The costs do not depend on this value.",
+		util::_default_value    = 0);
 
 int main(int argc, char** argv) {
 
@@ -93,17 +82,19 @@ int main(int argc, char** argv) {
 		util::ProgramOptions::init(argc, argv);
 		logger::LogManager::init();
 
+		// the store has to outlive the volumes, which read from it on demand
+		Hdf5CragStore cragStore(optionProjectFile.as<std::string>());
+
 		Crag        crag;
 		CragVolumes volumes(crag);
 
 		NodeFeatures nodeFeatures(crag);
 		EdgeFeatures edgeFeatures(crag);
 
-		LOG_USER(logger::out) << "reading CRAG and volumes" << std::endl;
+		LOG_USER(logger::out) << "reading CRAG" << std::endl;
 
-		Hdf5CragStore cragStore(optionProjectFile.as<std::string>());
 		cragStore.retrieveCrag(crag);
-		cragStore.retrieveVolumes(volumes);
+		cragStore.retrieveVolumesOnDemand(volumes);
 
 		LOG_USER(logger::out) << "reading features" << std::endl;
 
@@ -120,17 +111,14 @@ int main(int argc, char** argv) {
 		float edgeBias = optionMergeBias;
 		float nodeBias = optionForegroundBias;
 
-		for (Crag::CragNode n : crag.nodes()) {
+		nodeFeatures.computeCosts(weights, costs.node, getNumThreads(optionNumCostThreads.as<int>()));
+		edgeFeatures.computeCosts(weights, costs.edge, getNumThreads(optionNumCostThreads.as<int>()));
 
-			costs.node[n] = nodeBias;
-			costs.node[n] += dot(weights[crag.type(n)], nodeFeatures[n]);
-		}
-
-		for (Crag::CragEdge e : crag.edges()) {
+		for (Crag::CragNode n : crag.nodes())
+			costs.node[n] += nodeBias;
 
-			costs.edge[e] = edgeBias;
-			costs.edge[e] += dot(weights[crag.type(e)], edgeFeatures[e]);
-		}
+		for (Crag::CragEdge e : crag.edges())
+			costs.edge[e] += edgeBias;
 
 		if (optionLevelAmplification) {
 
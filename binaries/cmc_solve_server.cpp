@@ -0,0 +1,413 @@
+/**
+ * Keeps a candidate mc project, its features, and a multi-cut solver in 
+ * memory and re-solves the segmentation problem after incremental edits, such 
+ * that interactive proofreading does not have to reload the project and solve 
+ * from scratch for each request.
+ *
+ * Requests are read line by line from stdin, each request is answered with 
+ * one line on stdout, starting with "ok", "error", or "solution". Log messages 
+ * are written to stderr. Node ids are the ids of the CRAG:
+ *
+ *   weights <w_1> ... <w_n>   set the feature weights (in the order of the
+ *                             weights stored in the project file)
+ *   bias <node|edge> <b>      set the bias added to each node or edge cost
+ *   merge <u> <v>             force adjacent nodes u and v to be merged
+ *   separate <u> <v>          force adjacent nodes u and v to be separated
+ *   select <n>                force node n to be selected
+ *   reject <n>                force node n to not be selected
+ *   release <n> [<v>]         undo any of the above for a node or an edge
+ *   solve                     re-solve, answer with "solution <value>
+ *                             <optimal|suboptimal>" followed by pairs
+ *                             "<leaf node id>:<label>" for all leaf nodes
+ *   save                      store the current solution in the project file
+ *   export <filename>         create a volume export of the current solution
+ *   quit                      stop the server
+ *
+ * The solver keeps the constraints found so far and starts from the previous 
+ * solution for each solve.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include <util/helpers.hpp>
+#include <util/timing.h>
+#include <crag/ParallelFor.h>
+#include <io/Hdf5CragStore.h>
+#include <io/Hdf5VolumeStore.h>
+#include <io/SolutionImageWriter.h>
+#include <features/NodeFeatures.h>
+#include <features/EdgeFeatures.h>
+#include <features/FeatureWeights.h>
+#include <inference/MultiCutSolver.h>
+
+util::ProgramOption optionProjectFile(
+		util::_long_name        = "projectFile",
+		util::_short_name       = "p",
+		util::_description_text = "The candidate mc project file.");
+
+util::ProgramOption optionForegroundBias(
+		util::_long_name        = "foregroundBias",
+		util::_short_name       = "f",
+		util::_description_text = "The initial bias to be added to each node weight.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionMergeBias(
+		util::_long_name        = "mergeBias",
+		util::_short_name       = "b",
+		util::_description_text = "The initial bias to be added to each edge weight.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionNumIterations(
+		util::_long_name        = "numIterations",
+		util::_description_text = "The maximal number of iterations to spend on finding a solution per request.");
+
+util::ProgramOption optionReadOnly(
+		util::_long_name        = "readOnly",
+		util::_description_text = "Don't write the solution to the project file on 'save' requests.");
+
+util::ProgramOption optionNumCostThreads(
+		util::_module           = "costs",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to compute the costs from the features and weights with. "
+		                          "Set to 0 to use one thread per hardware thread. The costs do not depend on this value.",
+		util::_default_value    = 0);
+
+class SolveServer {
+
+public:
+
+	SolveServer() :
+		_cragStore(optionProjectFile.as<std::string>()),
+		_volumes(_crag),
+		_nodeFeatures(_crag),
+		_edgeFeatures(_crag),
+		_costs(_crag),
+		_nodeBias(optionForegroundBias),
+		_edgeBias(optionMergeBias),
+		_numCostThreads(getNumThreads(optionNumCostThreads.as<int>())) {
+
+		LOG_USER(logger::out) << "reading CRAG" << std::endl;
+
+		_cragStore.retrieveCrag(_crag);
+		_cragStore.retrieveVolumesOnDemand(_volumes);
+
+		LOG_USER(logger::out) << "reading features" << std::endl;
+
+		_cragStore.retrieveNodeFeatures(_crag, _nodeFeatures);
+		_cragStore.retrieveEdgeFeatures(_crag, _edgeFeatures);
+		_cragStore.retrieveFeatureWeights(_weights);
+
+		_solution = std::unique_ptr<CragSolution>(new CragSolution(_crag));
+
+		MultiCutSolver::Parameters parameters;
+		if (optionNumIterations)
+			parameters.numIterations = optionNumIterations;
+		_solver = std::unique_ptr<MultiCutSolver>(new MultiCutSolver(_crag, parameters));
+
+		_costsDirty = true;
+		_solved     = false;
+	}
+
+	/**
+	 * Process requests from in until "quit" or the end of in.
+	 */
+	void run(std::istream& in, std::ostream& out) {
+
+		std::string line;
+		while (std::getline(in, line)) {
+
+			std::istringstream request(line);
+			std::string command;
+			request >> command;
+
+			if (command.empty())
+				continue;
+
+			if (command == "quit") {
+
+				out << "ok" << std::endl;
+				return;
+			}
+
+			try {
+
+				process(command, request, out);
+
+			} catch (Exception& e) {
+
+				replyError(e.what(), out);
+
+			} catch (std::exception& e) {
+
+				// errors from vigra, HDF5, or allocations should not end the 
+				// session and lose the solver state either
+				replyError(e.what(), out);
+			}
+		}
+	}
+
+private:
+
+	void replyError(std::string message, std::ostream& out) {
+
+		// keep the reply on one line, vigra messages span several
+		std::replace(message.begin(), message.end(), '\n', ' ');
+
+		out << "error " << message << std::endl;
+	}
+
+	void process(const std::string& command, std::istringstream& request, std::ostream& out) {
+
+		if (command == "weights") {
+
+			std::vector<double> weights;
+			double w;
+			while (request >> w)
+				weights.push_back(w);
+
+			if (weights.size() != _weights.exportToVector().size())
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"expected " << _weights.exportToVector().size() << " weights, got " << weights.size());
+
+			_weights.importFromVector(weights);
+			_costsDirty = true;
+
+		} else if (command == "bias") {
+
+			std::string type;
+			double bias;
+			if (!(request >> type >> bias) || (type != "node" && type != "edge"))
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"usage: bias <node|edge> <value>");
+
+			(type == "node" ? _nodeBias : _edgeBias) = bias;
+			_costsDirty = true;
+
+		} else if (command == "merge" || command == "separate") {
+
+			Crag::CragNode u = readNode(request);
+			Crag::CragNode v = readNode(request);
+
+			_solver->fix(findEdge(u, v), command == "merge");
+
+		} else if (command == "select" || command == "reject") {
+
+			_solver->fix(readNode(request), command == "select");
+
+		} else if (command == "release") {
+
+			Crag::CragNode u = readNode(request);
+
+			int id;
+			if (request >> id)
+				_solver->release(findEdge(u, nodeFromId(id)));
+			else
+				_solver->release(u);
+
+		} else if (command == "solve") {
+
+			solve();
+			writeSolution(out);
+			return;
+
+		} else if (command == "save") {
+
+			if (!_solved)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"no solution to save");
+
+			if (optionReadOnly)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"server is read-only");
+
+			_cragStore.saveSolution(_crag, *_solution, "solution");
+
+		} else if (command == "export") {
+
+			std::string filename;
+			if (!(request >> filename))
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"usage: export <filename>");
+
+			if (!_solved)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"no solution to export");
+
+			Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
+			ExplicitVolume<float> intensities;
+			volumeStore.retrieveIntensities(intensities);
+
+			SolutionImageWriter imageWriter;
+			imageWriter.setExportArea(intensities.getBoundingBox());
+			imageWriter.write(_crag, _volumes, *_solution, filename);
+
+		} else {
+
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"unknown request " << command);
+		}
+
+		out << "ok" << std::endl;
+	}
+
+	void solve() {
+
+		UTIL_TIME_SCOPE("solve server request");
+
+		// only new weights or biases change the costs, edits are constraints 
+		// of the solver
+		if (_costsDirty) {
+
+			_nodeFeatures.computeCosts(_weights, _costs.node, _numCostThreads);
+			_edgeFeatures.computeCosts(_weights, _costs.edge, _numCostThreads);
+
+			for (Crag::CragNode n : _crag.nodes())
+				_costs.node[n] += _nodeBias;
+			for (Crag::CragEdge e : _crag.edges())
+				_costs.edge[e] += _edgeBias;
+
+			_solver->setCosts(_costs);
+			_costsDirty = false;
+		}
+
+		_status = _solver->solve(*_solution);
+		_solved = true;
+	}
+
+	void writeSolution(std::ostream& out) {
+
+		out
+				<< "solution " << _solver->getValue() << " "
+				<< (_status == CragSolver::SolutionFound ? "optimal" : "suboptimal");
+
+		for (Crag::CragNode n : _crag.nodes())
+			if (_crag.isLeafNode(n))
+				out << " " << _crag.id(n) << ":" << leafLabel(n);
+
+		out << std::endl;
+	}
+
+	/**
+	 * The label of a leaf node is the label of the selected node among the 
+	 * leaf and its ancestors, if any. In stacked CRAGs, nodes have several 
+	 * parents, so all paths to the roots are searched.
+	 */
+	int leafLabel(Crag::CragNode leaf) {
+
+		std::vector<Crag::CragNode> ancestors(1, leaf);
+		std::set<Crag::CragNode>    visited;
+		visited.insert(leaf);
+
+		for (std::size_t i = 0; i < ancestors.size(); i++) {
+
+			Crag::CragNode ancestor = ancestors[i];
+
+			if (_solution->selected(ancestor))
+				return _solution->label(ancestor);
+
+			for (Crag::CragArc a : _crag.outArcs(ancestor))
+				if (visited.insert(a.target()).second)
+					ancestors.push_back(a.target());
+		}
+
+		return 0;
+	}
+
+	Crag::CragNode readNode(std::istringstream& request) {
+
+		int id;
+		if (!(request >> id))
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"expected a node id");
+
+		return nodeFromId(id);
+	}
+
+	Crag::CragNode nodeFromId(int id) {
+
+		const Crag::RagType& rag = _crag.getAdjacencyGraph();
+
+		if (id < 0 || id > rag.maxNodeId() || !rag.valid(rag.nodeFromId(id)))
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"there is no node with id " << id);
+
+		return _crag.nodeFromId(id);
+	}
+
+	Crag::CragEdge findEdge(Crag::CragNode u, Crag::CragNode v) {
+
+		for (Crag::CragEdge e : _crag.adjEdges(u))
+			if (e.opposite(u) == v)
+				return e;
+
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"nodes " << _crag.id(u) << " and " << _crag.id(v) << " are not adjacent");
+	}
+
+	Crag _crag;
+
+	// the store has to outlive the volumes, which read from it on demand
+	Hdf5CragStore _cragStore;
+
+	CragVolumes  _volumes;
+	NodeFeatures _nodeFeatures;
+	EdgeFeatures _edgeFeatures;
+	Costs        _costs;
+
+	FeatureWeights _weights;
+
+	double _nodeBias;
+	double _edgeBias;
+	int    _numCostThreads;
+
+	std::unique_ptr<MultiCutSolver> _solver;
+	std::unique_ptr<CragSolution>   _solution;
+	CragSolver::Status              _status;
+
+	bool _costsDirty;
+	bool _solved;
+};
+
+int main(int argc, char** argv) {
+
+	UTIL_TIME_SCOPE("main");
+
+	try {
+
+		util::ProgramOptions::init(argc, argv);
+		logger::LogManager::init();
+
+		// keep stdout for the replies, and send everything else written to 
+		// std::cout (like log messages) to stderr
+		std::ostream replies(std::cout.rdbuf());
+		std::cout.rdbuf(std::cerr.rdbuf());
+
+		SolveServer server;
+
+		LOG_USER(logger::out) << "waiting for requests" << std::endl;
+
+		server.run(std::cin, replies);
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
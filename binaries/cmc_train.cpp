@@ -1,6 +1,6 @@
 /**
- * Reads a treemc project file containing features and a ground-truth labelling 
- * and trains node and edge feature weights.
+ * Reads one or more treemc project files containing features and a ground-truth 
+ * labelling and trains node and edge feature weights on all of them.
  */
 
 #include <iostream>
@@ -10,6 +10,7 @@
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/exceptions.h>
+#include <util/string.h>
 #include <util/timing.h>
 #include <io/CragImport.h>
 #include <io/Hdf5CragStore.h>
@@ -21,10 +22,12 @@
 #include <learning/AssignmentLoss.h>
 #include <learning/ContourDistanceLoss.h>
 #include <learning/GradientOptimizer.h>
+#include <learning/GroundTruthOverlaps.h>
 #include <learning/HammingLoss.h>
 #include <learning/HausdorffLoss.h>
 #include <learning/CragSolverOracle.h>
 #include <learning/RandLoss.h>
+#include <learning/SumOracle.h>
 #include <learning/OverlapLoss.h>
 #include <learning/TopologicalLoss.h>
 
@@ -34,6 +37,12 @@ util::ProgramOption optionProjectFile(
 		util::_description_text = "The treemc project file.",
 		util::_default_value    = "project.hdf");
 
+util::ProgramOption optionAdditionalProjectFiles(
+		util::_long_name        = "additionalProjectFiles",
+		util::_description_text = "A comma separated list of further treemc project files to train on. The training "
+		                          "objective is the sum over all projects. Weights are read from and stored in the "
+		                          "project file given by --projectFile only.");
+
 util::ProgramOption optionBestEffortLoss(
 		util::_long_name        = "bestEffortLoss",
 		util::_description_text = "Use a loss to find the best-effort solution: rand (RAND index approximation "
@@ -125,212 +134,321 @@ util::ProgramOption optionExportBestEffortWithBoundary(
 		util::_long_name        = "exportBestEffortWithBoundary",
 		util::_description_text = "Create a volume export for the best-effort solution, showing the boundaries as well.");
 
-int main(int argc, char** argv) {
+util::ProgramOption optionNumCostThreads(
+		util::_module           = "costs",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to compute the costs and gradients from the features and weights "
+		                          "with. Set to 0 to use one thread per hardware thread. The results do not depend on this value.",
+		util::_default_value    = 0);
 
-	UTIL_TIME_SCOPE("main");
+util::ProgramOption optionNumDatasetThreads(
+		util::_module           = "training",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of projects to solve concurrently in each training iteration. Set to 0 "
+		                          "to use one thread per hardware thread. The results do not depend on this value.",
+		util::_default_value    = 0);
 
-	try {
+util::ProgramOption optionBatchSize(
+		util::_module           = "training",
+		util::_long_name        = "batchSize",
+		util::_description_text = "Solve only a random subset of this many projects in each training iteration, and "
+		                          "scale their sum to the number of projects. Best used with --gradientOptimizer. "
+		                          "Defaults to 0, which means all projects are used in each iteration.",
+		util::_default_value    = 0);
 
-		util::ProgramOptions::init(argc, argv);
-		logger::LogManager::init();
+util::ProgramOption optionBatchSeed(
+		util::_module           = "training",
+		util::_long_name        = "seed",
+		util::_description_text = "The seed for drawing the random subsets of projects for training.batchSize.",
+		util::_default_value    = 0);
 
-		std::shared_ptr<CragStore> cragStore = std::make_shared<Hdf5CragStore>(optionProjectFile.as<std::string>());
-		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
+/**
+ * A training dataset: one project with its CRAG, features, best-effort, and 
+ * training loss.
+ */
+struct Dataset {
 
-		LOG_USER(logger::out) << "reading ground-truth" << std::endl;
+	Dataset(std::string projectFile_) :
+		projectFile(projectFile_),
+		cragStore(std::make_shared<Hdf5CragStore>(projectFile)),
+		volumeStore(projectFile),
+		volumes(crag),
+		nodeFeatures(crag),
+		edgeFeatures(crag) {}
 
-		ExplicitVolume<int> groundTruth;
-		volumeStore.retrieveGroundTruth(groundTruth);
+	std::string projectFile;
 
-		LOG_USER(logger::out) << "reading CRAG and volumes" << std::endl;
+	std::shared_ptr<CragStore> cragStore;
+	Hdf5VolumeStore            volumeStore;
 
-		Crag crag;
-		CragVolumes volumes(crag);
-		cragStore->retrieveCrag(crag);
-		cragStore->retrieveVolumes(volumes);
+	ExplicitVolume<int> groundTruth;
 
-		NodeFeatures nodeFeatures(crag);
-		EdgeFeatures edgeFeatures(crag);
+	Crag         crag;
+	CragVolumes  volumes;
+	NodeFeatures nodeFeatures;
+	EdgeFeatures edgeFeatures;
 
-		if (!optionDryRun) {
+	std::unique_ptr<BestEffort> bestEffort;
+	std::unique_ptr<Loss>       bestEffortLoss;
+	std::unique_ptr<Loss>       trainingLoss;
 
-			LOG_USER(logger::out) << "reading features" << std::endl;
-			cragStore->retrieveNodeFeatures(crag, nodeFeatures);
-			cragStore->retrieveEdgeFeatures(crag, edgeFeatures);
-		}
+	// the overlaps of the candidates with the ground truth, shared by the 
+	// best-effort and the losses that need them
+	std::unique_ptr<GroundTruthOverlaps> gtOverlaps;
 
-		std::unique_ptr<BestEffort> bestEffort;
-		std::unique_ptr<Loss>       bestEffortLoss;
-		std::unique_ptr<Loss>       trainingLoss;
+	std::unique_ptr<CragSolverOracle> oracle;
+};
 
-		CragSolver::Parameters solverParameters;
-		if (optionNumIterations)
-			solverParameters.numIterations = optionNumIterations;
-		if (optionPretrain)
-			solverParameters.noConstraints = true;
+/**
+ * Read the CRAG, ground truth, and features of a dataset, and find its 
+ * best-effort and training loss.
+ */
+void
+prepareDataset(Dataset& dataset, const CragSolver::Parameters& solverParameters, bool exportBestEffort) {
 
-		if (optionBestEffortFromProjectFile) {
+	LOG_USER(logger::out) << "preparing project " << dataset.projectFile << std::endl;
 
-			LOG_USER(logger::out) << "reading best-effort" << std::endl;
+	Crag&                crag        = dataset.crag;
+	CragVolumes&         volumes     = dataset.volumes;
+	ExplicitVolume<int>& groundTruth = dataset.groundTruth;
+	CragStore&           cragStore   = *dataset.cragStore;
 
-			bestEffort = std::unique_ptr<BestEffort>(new BestEffort(crag));
+	LOG_USER(logger::out) << "reading ground-truth" << std::endl;
 
-			cragStore->retrieveSolution(crag, *bestEffort, "best-effort");
+	dataset.volumeStore.retrieveGroundTruth(groundTruth);
 
-		} else {
+	LOG_USER(logger::out) << "reading CRAG" << std::endl;
 
-			if (!optionBestEffortLoss) {
+	cragStore.retrieveCrag(crag);
+	cragStore.retrieveVolumesOnDemand(volumes);
 
-				LOG_USER(logger::out) << "using assignment heuristic for best-effort" << std::endl;
+	if (!optionDryRun) {
 
-				bestEffort = std::unique_ptr<BestEffort>(new BestEffort(crag, volumes, groundTruth));
+		LOG_USER(logger::out) << "reading features" << std::endl;
+		cragStore.retrieveNodeFeatures(crag, dataset.nodeFeatures);
+		cragStore.retrieveEdgeFeatures(crag, dataset.edgeFeatures);
+	}
 
-			} else {
+	std::unique_ptr<BestEffort>& bestEffort     = dataset.bestEffort;
+	std::unique_ptr<Loss>&       bestEffortLoss = dataset.bestEffortLoss;
+	std::unique_ptr<Loss>&       trainingLoss   = dataset.trainingLoss;
+
+	auto getGroundTruthOverlaps = [&]() -> const GroundTruthOverlaps& {
+
+		if (!dataset.gtOverlaps) {
 
-				if (optionBestEffortLoss.as<std::string>() == "rand") {
+			LOG_USER(logger::out) << "computing ground-truth overlaps" << std::endl;
+			dataset.gtOverlaps = std::unique_ptr<GroundTruthOverlaps>(new GroundTruthOverlaps(crag, volumes, groundTruth));
+		}
 
-					LOG_USER(logger::out) << "using RAND loss for best-effort" << std::endl;
+		return *dataset.gtOverlaps;
+	};
 
-					bestEffortLoss = std::unique_ptr<RandLoss>(new RandLoss(crag, volumes, groundTruth));
+	if (optionBestEffortFromProjectFile) {
 
-				} else if (optionBestEffortLoss.as<std::string>() == "overlap") {
+		LOG_USER(logger::out) << "reading best-effort" << std::endl;
 
-					LOG_USER(logger::out) << "using overlap loss for best-effort" << std::endl;
+		bestEffort = std::unique_ptr<BestEffort>(new BestEffort(crag));
 
-					bestEffortLoss = std::unique_ptr<OverlapLoss>(new OverlapLoss(crag, volumes, groundTruth));
+		cragStore.retrieveSolution(crag, *bestEffort, "best-effort");
 
-				} else if (optionBestEffortLoss.as<std::string>() == "hausdorff") {
+	} else {
 
-					LOG_USER(logger::out) << "using hausdorff loss for best-effort" << std::endl;
+		if (!optionBestEffortLoss) {
 
-					// get ground truth volumes
-					Crag        gtCrag;
-					CragVolumes gtVolumes(gtCrag);
-					CragImport  import;
-					import.readSupervoxels(groundTruth, gtCrag, gtVolumes, groundTruth.getResolution(), groundTruth.getOffset());
+			LOG_USER(logger::out) << "using assignment heuristic for best-effort" << std::endl;
 
-					bestEffortLoss = std::unique_ptr<HausdorffLoss>(new HausdorffLoss(crag, volumes, gtCrag, gtVolumes, optionMaxHausdorffDistance));
+			bestEffort = std::unique_ptr<BestEffort>(new BestEffort(crag, volumes, getGroundTruthOverlaps()));
 
-				} else if (optionBestEffortLoss.as<std::string>() == "contour") {
+		} else {
 
-					LOG_USER(logger::out) << "using contour loss for best-effort" << std::endl;
+			if (optionBestEffortLoss.as<std::string>() == "rand") {
 
-					// get ground truth volumes
-					Crag        gtCrag;
-					CragVolumes gtVolumes(gtCrag);
-					CragImport  import;
-					import.readSupervoxels(groundTruth, gtCrag, gtVolumes, groundTruth.getResolution(), groundTruth.getOffset());
+				LOG_USER(logger::out) << "using RAND loss for best-effort" << std::endl;
 
-					bestEffortLoss = std::unique_ptr<ContourDistanceLoss>(new ContourDistanceLoss(crag, volumes, gtCrag, gtVolumes, optionMaxHausdorffDistance));
+				bestEffortLoss = std::unique_ptr<RandLoss>(new RandLoss(crag, getGroundTruthOverlaps()));
 
-				} else if (optionBestEffortLoss.as<std::string>() == "assignment") {
+			} else if (optionBestEffortLoss.as<std::string>() == "overlap") {
 
-					LOG_USER(logger::out) << "using assignment loss for best-effort" << std::endl;
+				LOG_USER(logger::out) << "using overlap loss for best-effort" << std::endl;
 
-					bestEffortLoss = std::unique_ptr<AssignmentLoss>(new AssignmentLoss(crag, volumes, groundTruth));
+				bestEffortLoss = std::unique_ptr<OverlapLoss>(new OverlapLoss(crag, getGroundTruthOverlaps(), groundTruth));
 
-				} else {
+			} else if (optionBestEffortLoss.as<std::string>() == "hausdorff") {
 
-					UTIL_THROW_EXCEPTION(
-							UsageError,
-							"unknown best-effort loss " + optionBestEffortLoss.as<std::string>());
-				}
+				LOG_USER(logger::out) << "using hausdorff loss for best-effort" << std::endl;
+
+				// get ground truth volumes
+				Crag        gtCrag;
+				CragVolumes gtVolumes(gtCrag);
+				CragImport  import;
+				import.readSupervoxels(groundTruth, gtCrag, gtVolumes, groundTruth.getResolution(), groundTruth.getOffset());
 
-				LOG_USER(logger::out) << "storing best-effort loss" << std::endl;
+				bestEffortLoss = std::unique_ptr<HausdorffLoss>(new HausdorffLoss(crag, volumes, gtCrag, gtVolumes, optionMaxHausdorffDistance));
 
-				cragStore->saveCosts(crag, *bestEffortLoss, "best-effort_loss");
+			} else if (optionBestEffortLoss.as<std::string>() == "contour") {
 
-				LOG_USER(logger::out) << "finding best-effort solution" << std::endl;
+				LOG_USER(logger::out) << "using contour loss for best-effort" << std::endl;
 
-				bestEffort = std::unique_ptr<BestEffort>(new BestEffort(crag, volumes, *bestEffortLoss, solverParameters));
+				// get ground truth volumes
+				Crag        gtCrag;
+				CragVolumes gtVolumes(gtCrag);
+				CragImport  import;
+				import.readSupervoxels(groundTruth, gtCrag, gtVolumes, groundTruth.getResolution(), groundTruth.getOffset());
+
+				bestEffortLoss = std::unique_ptr<ContourDistanceLoss>(new ContourDistanceLoss(crag, volumes, gtCrag, gtVolumes, optionMaxHausdorffDistance));
+
+			} else if (optionBestEffortLoss.as<std::string>() == "assignment") {
+
+				LOG_USER(logger::out) << "using assignment loss for best-effort" << std::endl;
+
+				bestEffortLoss = std::unique_ptr<AssignmentLoss>(new AssignmentLoss(crag, getGroundTruthOverlaps()));
+
+			} else {
+
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"unknown best-effort loss " + optionBestEffortLoss.as<std::string>());
 			}
 
-			LOG_USER(logger::out) << "storing best-effort solution" << std::endl;
+			LOG_USER(logger::out) << "storing best-effort loss" << std::endl;
 
-			cragStore->saveSolution(crag, *bestEffort, "best-effort");
-		}
+			cragStore.saveCosts(crag, *bestEffortLoss, "best-effort_loss");
 
-		if (optionExportBestEffort) {
+			LOG_USER(logger::out) << "finding best-effort solution" << std::endl;
 
-			SolutionImageWriter imageWriter;
-			imageWriter.setExportArea(groundTruth.getBoundingBox());
-			imageWriter.write(crag, volumes, *bestEffort, optionExportBestEffort);
+			bestEffort = std::unique_ptr<BestEffort>(new BestEffort(crag, volumes, *bestEffortLoss, solverParameters));
 		}
 
-		if (optionExportBestEffortWithBoundary) {
+		LOG_USER(logger::out) << "storing best-effort solution" << std::endl;
 
-			SolutionImageWriter imageWriter;
-			imageWriter.setExportArea(groundTruth.getBoundingBox());
-			imageWriter.write(crag, volumes, *bestEffort, optionExportBestEffortWithBoundary, true);
-		}
+		cragStore.saveSolution(crag, *bestEffort, "best-effort");
+	}
 
-		if (optionLoss.as<std::string>() == "hamming") {
+	if (exportBestEffort && optionExportBestEffort) {
 
-			LOG_USER(logger::out) << "using Hamming loss" << std::endl;
+		SolutionImageWriter imageWriter;
+		imageWriter.setExportArea(groundTruth.getBoundingBox());
+		imageWriter.write(crag, volumes, *bestEffort, optionExportBestEffort);
+	}
 
-			trainingLoss = std::unique_ptr<HammingLoss>(new HammingLoss(crag, *bestEffort));
+	if (exportBestEffort && optionExportBestEffortWithBoundary) {
 
-		} else if (optionLoss.as<std::string>() == "rand") {
+		SolutionImageWriter imageWriter;
+		imageWriter.setExportArea(groundTruth.getBoundingBox());
+		imageWriter.write(crag, volumes, *bestEffort, optionExportBestEffortWithBoundary, true);
+	}
 
-			LOG_USER(logger::out) << "using RAND loss" << std::endl;
+	if (optionLoss.as<std::string>() == "hamming") {
 
-			LOG_USER(logger::out) << "reading ground-truth" << std::endl;
+		LOG_USER(logger::out) << "using Hamming loss" << std::endl;
 
-			trainingLoss = std::unique_ptr<RandLoss>(new RandLoss(crag, volumes, groundTruth));
+		trainingLoss = std::unique_ptr<HammingLoss>(new HammingLoss(crag, *bestEffort));
 
-		} else if (optionLoss.as<std::string>() == "overlap") {
+	} else if (optionLoss.as<std::string>() == "rand") {
 
-			LOG_USER(logger::out) << "using overlap loss" << std::endl;
+		LOG_USER(logger::out) << "using RAND loss" << std::endl;
 
-			LOG_USER(logger::out) << "reading ground-truth" << std::endl;
-			ExplicitVolume<int> groundTruth;
-			volumeStore.retrieveGroundTruth(groundTruth);
+		trainingLoss = std::unique_ptr<RandLoss>(new RandLoss(crag, getGroundTruthOverlaps()));
 
-			trainingLoss = std::unique_ptr<OverlapLoss>(new OverlapLoss(crag, volumes, groundTruth));
+	} else if (optionLoss.as<std::string>() == "overlap") {
 
-		} else if (optionLoss.as<std::string>() == "hausdorff") {
+		LOG_USER(logger::out) << "using overlap loss" << std::endl;
 
-			LOG_USER(logger::out) << "using hausdorff loss" << std::endl;
+		trainingLoss = std::unique_ptr<OverlapLoss>(new OverlapLoss(crag, getGroundTruthOverlaps(), groundTruth));
 
-			// get ground truth volumes
-			Crag        gtCrag;
-			CragVolumes gtVolumes(gtCrag);
-			CragImport  import;
-			import.readSupervoxels(groundTruth, gtCrag, gtVolumes, groundTruth.getResolution(), groundTruth.getOffset());
+	} else if (optionLoss.as<std::string>() == "hausdorff") {
 
-			trainingLoss = std::unique_ptr<HausdorffLoss>(new HausdorffLoss(crag, volumes, gtCrag, gtVolumes, optionMaxHausdorffDistance));
+		LOG_USER(logger::out) << "using hausdorff loss" << std::endl;
 
-		} else if (optionLoss.as<std::string>() == "topological") {
+		// get ground truth volumes
+		Crag        gtCrag;
+		CragVolumes gtVolumes(gtCrag);
+		CragImport  import;
+		import.readSupervoxels(groundTruth, gtCrag, gtVolumes, groundTruth.getResolution(), groundTruth.getOffset());
 
-			LOG_USER(logger::out) << "using topological loss" << std::endl;
+		trainingLoss = std::unique_ptr<HausdorffLoss>(new HausdorffLoss(crag, volumes, gtCrag, gtVolumes, optionMaxHausdorffDistance));
 
-			trainingLoss = std::unique_ptr<TopologicalLoss>(new TopologicalLoss(crag, *bestEffort));
+	} else if (optionLoss.as<std::string>() == "topological") {
 
-		} else {
+		LOG_USER(logger::out) << "using topological loss" << std::endl;
 
-			LOG_USER(logger::out) << "using custom loss " << optionLoss.as<std::string>() << std::endl;
+		trainingLoss = std::unique_ptr<TopologicalLoss>(new TopologicalLoss(crag, *bestEffort));
 
-			trainingLoss = std::unique_ptr<Loss>(new Loss(crag));
-			cragStore->retrieveCosts(crag, *trainingLoss, optionLoss);
-		}
+	} else {
 
-		if (optionNormalizeLoss) {
+		LOG_USER(logger::out) << "using custom loss " << optionLoss.as<std::string>() << std::endl;
 
-			LOG_USER(logger::out) << "normalizing loss..." << std::endl;
-			trainingLoss->normalize(crag, solverParameters);
-		}
+		trainingLoss = std::unique_ptr<Loss>(new Loss(crag));
+		cragStore.retrieveCosts(crag, *trainingLoss, optionLoss);
+	}
+
+	if (optionNormalizeLoss) {
+
+		LOG_USER(logger::out) << "normalizing loss..." << std::endl;
+		trainingLoss->normalize(crag, solverParameters);
+	}
+
+	LOG_USER(logger::out) << "storing training loss" << std::endl;
+
+	cragStore.saveCosts(crag, *trainingLoss, "training_loss");
+}
+
+int main(int argc, char** argv) {
+
+	UTIL_TIME_SCOPE("main");
+
+	try {
+
+		util::ProgramOptions::init(argc, argv);
+		logger::LogManager::init();
+
+		CragSolver::Parameters solverParameters;
+		if (optionNumIterations)
+			solverParameters.numIterations = optionNumIterations;
+		if (optionPretrain)
+			solverParameters.noConstraints = true;
+
+		// the first dataset is the main project, which holds the weights
+		std::vector<std::unique_ptr<Dataset>> datasets;
+		datasets.push_back(std::unique_ptr<Dataset>(new Dataset(optionProjectFile.as<std::string>())));
+		if (optionAdditionalProjectFiles)
+			for (std::string projectFile : split(optionAdditionalProjectFiles, ','))
+				datasets.push_back(std::unique_ptr<Dataset>(new Dataset(projectFile)));
 
-		LOG_USER(logger::out) << "storing training loss" << std::endl;
+		for (std::size_t i = 0; i < datasets.size(); i++)
+			prepareDataset(*datasets[i], solverParameters, i == 0);
 
-		cragStore->saveCosts(crag, *trainingLoss, "training_loss");
+		Dataset& mainDataset = *datasets[0];
 
 		// create initial set of weights for the given features
-		FeatureWeights weights(nodeFeatures, edgeFeatures, optionInitialWeightValues.as<double>());
+		FeatureWeights weights(mainDataset.nodeFeatures, mainDataset.edgeFeatures, optionInitialWeightValues.as<double>());
+
+		// all datasets have to agree on the features
+		for (const auto& dataset : datasets) {
+
+			FeatureWeights datasetWeights(dataset->nodeFeatures, dataset->edgeFeatures, 0);
+
+			for (Crag::NodeType type : Crag::NodeTypes)
+				if (datasetWeights[type].size() != weights[type].size())
+					UTIL_THROW_EXCEPTION(
+							UsageError,
+							"project " << dataset->projectFile << " has " << datasetWeights[type].size() <<
+							" features for node type " << type << ", but " << mainDataset.projectFile <<
+							" has " << weights[type].size());
+			for (Crag::EdgeType type : Crag::EdgeTypes)
+				if (datasetWeights[type].size() != weights[type].size())
+					UTIL_THROW_EXCEPTION(
+							UsageError,
+							"project " << dataset->projectFile << " has " << datasetWeights[type].size() <<
+							" features for edge type " << type << ", but " << mainDataset.projectFile <<
+							" has " << weights[type].size());
+		}
 
 		if (optionRestartTraining) {
 
 			FeatureWeights prevWeights;
-			cragStore->retrieveFeatureWeights(prevWeights);
+			mainDataset.cragStore->retrieveFeatureWeights(prevWeights);
 
 			// previous weights might be incomplete
 			for (Crag::NodeType type : Crag::NodeTypes)
@@ -347,18 +465,33 @@ int main(int argc, char** argv) {
 
 			LOG_USER(logger::out) << "dry run -- skip learning" << std::endl;
 			if (!optionReadOnly)
-				cragStore->saveFeatureWeights(weights);
+				mainDataset.cragStore->saveFeatureWeights(weights);
 			return 0;
 		}
 
-		CragSolverOracle oracle(
-				crag,
-				volumes,
-				nodeFeatures,
-				edgeFeatures,
-				*trainingLoss,
-				*bestEffort,
-				solverParameters);
+		SumOracle::Parameters oracleParameters;
+		oracleParameters.numThreads = optionNumDatasetThreads;
+		oracleParameters.batchSize  = optionBatchSize;
+		oracleParameters.seed       = optionBatchSeed;
+		SumOracle oracle(oracleParameters);
+
+		for (const auto& dataset : datasets) {
+
+			dataset->oracle = std::unique_ptr<CragSolverOracle>(
+					new CragSolverOracle(
+							dataset->crag,
+							dataset->volumes,
+							dataset->nodeFeatures,
+							dataset->edgeFeatures,
+							*dataset->trainingLoss,
+							*dataset->bestEffort,
+							solverParameters,
+							optionNumCostThreads.as<int>()));
+
+			oracle.add(*dataset->oracle);
+		}
+
+		LOG_USER(logger::out) << "training on " << oracle.size() << " projects" << std::endl;
 
 		UTIL_TIME_SCOPE("training");
 
@@ -394,7 +527,7 @@ int main(int argc, char** argv) {
 			}
 		}
 
-		cragStore->saveFeatureWeights(weights);
+		mainDataset.cragStore->saveFeatureWeights(weights);
 
 	} catch (boost::exception& e) {
 
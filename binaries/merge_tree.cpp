@@ -90,6 +90,11 @@ util::ProgramOption optionDontConsiderRegionSize(
 		util::_long_name        = "dontConsiderRegionSize",
 		util::_description_text = "By default, the scores are multiplied with the region size to encourage merging of small regions first. This option disables that.");
 
+util::ProgramOption optionNumThreads(
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to compute the initial edge statistics with. Set to 0 to use one thread per hardware thread.",
+		util::_default_value    = 0);
+
 using namespace logger;
 
 int main(int optionc, char** optionv) {
@@ -210,6 +215,7 @@ int main(int optionc, char** optionv) {
 
 		// extract merge tree
 		IterativeRegionMerging<3> merging(initialRegions.data());
+		merging.setNumThreads(optionNumThreads.as<int>());
 
 		MedianEdgeIntensity<3> mei(source.data());
 
@@ -0,0 +1,82 @@
+#include <tests.h>
+#include <crag/Crag.h>
+#include <io/Hdf5CragStore.h>
+
+namespace {
+
+std::vector<vigra::GridGraph<3>::Edge>
+randomGridEdges(const vigra::GridGraph<3>& gridGraph, int n) {
+
+	std::vector<vigra::GridGraph<3>::Edge> edges;
+	for (int i = 0; i < n; i++) {
+
+		vigra::GridGraph<3>::Node u(rand()%9, rand()%9, rand()%9);
+		vigra::GridGraph<3>::Node v = u;
+		v[rand()%3]++;
+
+		edges.push_back(gridGraph.findEdge(u, v));
+	}
+
+	return edges;
+}
+
+void
+checkEqual(const AffiliatedEdges& a, const std::vector<vigra::GridGraph<3>::Edge>& b) {
+
+	BOOST_REQUIRE_EQUAL(a.size(), b.size());
+
+	std::size_t i = 0;
+	for (vigra::GridGraph<3>::Edge e : a)
+		BOOST_CHECK(e == b[i++]);
+}
+
+} // anonymous namespace
+
+void affiliated_edges() {
+
+	Crag crag;
+	vigra::GridGraph<3> gridGraph(vigra::Shape3(10, 10, 10), vigra::DirectNeighborhood);
+	crag.setGridGraph(gridGraph);
+
+	for (int i = 0; i < 10; i++)
+		crag.addNode();
+
+	std::map<Crag::CragEdge, std::vector<vigra::GridGraph<3>::Edge>> expected;
+
+	for (int i = 0; i < 9; i++) {
+
+		Crag::CragEdge e = crag.addAdjacencyEdge(crag.nodeFromId(i), crag.nodeFromId(i + 1));
+		expected[e] = randomGridEdges(gridGraph, rand()%20);
+		crag.setAffiliatedEdges(e, expected[e]);
+	}
+
+	// replace with shorter and longer lists
+	Crag::CragEdge first = expected.begin()->first;
+	Crag::CragEdge last  = expected.rbegin()->first;
+	expected[first] = randomGridEdges(gridGraph, 2);
+	expected[last]  = randomGridEdges(gridGraph, 50);
+	crag.setAffiliatedEdges(first, expected[first]);
+	crag.setAffiliatedEdges(last, expected[last]);
+
+	for (const auto& p : expected)
+		checkEqual(crag.getAffiliatedEdges(p.first), p.second);
+
+	BOOST_CHECK(crag.getAffiliatedEdges(first).toVector() == expected[first]);
+
+	// affiliated edges are stored in the project file
+
+	Hdf5CragStore store("test_affiliated_edges.hdf");
+	store.saveCrag(crag);
+
+	Crag crag_;
+	store.retrieveCrag(crag_);
+
+	for (const auto& p : expected) {
+
+		Crag::CragEdge e = p.first;
+
+		for (Crag::CragEdge e_ : crag_.adjEdges(crag_.nodeFromId(crag.id(e.u()))))
+			if (crag_.id(crag_.oppositeNode(crag_.nodeFromId(crag.id(e.u())), e_)) == crag.id(e.v()))
+				checkEqual(crag_.getAffiliatedEdges(e_), p.second);
+	}
+}
@@ -0,0 +1,113 @@
+#include <map>
+#include <set>
+#include <tests.h>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <crag/BlockwiseAdjacencyAnnotator.h>
+#include <crag/PlanarAdjacencyAnnotator.h>
+
+namespace {
+
+// create a leaf node for each label, with a volume spanning the bounding box 
+// of the label
+std::map<int, Crag::Node>
+createLeafNodes(const vigra::MultiArray<3, int>& labels, Crag& crag, CragVolumes& volumes) {
+
+	std::map<int, util::box<int, 3>> bbs;
+	for (int z = 0; z < labels.shape(2); z++)
+	for (int y = 0; y < labels.shape(1); y++)
+	for (int x = 0; x < labels.shape(0); x++)
+		if (labels(x, y, z) != 0)
+			bbs[labels(x, y, z)].fit(util::box<int, 3>(x, y, z, x+1, y+1, z+1));
+
+	std::map<int, Crag::Node> labelNodes;
+	for (const auto& p : bbs) {
+
+		const util::box<int, 3>& bb = p.second;
+
+		std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(bb.width(), bb.height(), bb.depth(), 0);
+		volume->setOffset(bb.min().x(), bb.min().y(), bb.min().z());
+
+		for (int z = bb.min().z(); z < bb.max().z(); z++)
+		for (int y = bb.min().y(); y < bb.max().y(); y++)
+		for (int x = bb.min().x(); x < bb.max().x(); x++)
+			if (labels(x, y, z) == p.first)
+				(*volume)(x - bb.min().x(), y - bb.min().y(), z - bb.min().z()) = 1;
+
+		Crag::Node n = crag.addNode();
+		volumes.setVolume(n, volume);
+		labelNodes[p.first] = n;
+	}
+
+	return labelNodes;
+}
+
+// the adjacent node pairs and the ids of their affiliated edges
+std::map<std::pair<int, int>, std::set<std::uint64_t>>
+getAdjacencies(const Crag& crag) {
+
+	std::map<std::pair<int, int>, std::set<std::uint64_t>> adjacencies;
+	for (Crag::CragEdge e : crag.edges()) {
+
+		std::pair<int, int> p(
+				std::min(crag.id(e.u()), crag.id(e.v())),
+				std::max(crag.id(e.u()), crag.id(e.v())));
+
+		AffiliatedEdges affiliated = crag.getAffiliatedEdges(e);
+		adjacencies[p] = std::set<std::uint64_t>(affiliated.ids(), affiliated.ids() + affiliated.size());
+	}
+
+	return adjacencies;
+}
+
+} // anonymous namespace
+
+void blockwise_adjacency() {
+
+	// a label volume with a background border, such that the grid graph does 
+	// not start at the origin
+	vigra::MultiArray<3, int> labels(vigra::Shape3(8, 7, 7), 0);
+
+	for (int z = 1; z < 7; z++)
+	for (int y = 1; y < 6; y++)
+	for (int x = 1; x < 7; x++)
+		labels(x, y, z) = 1 + (x/3) + 3*(y/3) + 9*(z/4);
+
+	// some background inside
+	labels(3, 3, 3) = 0;
+	labels(4, 3, 4) = 0;
+
+	Crag        planarCrag;
+	CragVolumes planarVolumes(planarCrag);
+	createLeafNodes(labels, planarCrag, planarVolumes);
+
+	PlanarAdjacencyAnnotator planar(PlanarAdjacencyAnnotator::Direct);
+	planar.annotate(planarCrag, planarVolumes);
+
+	// several slab depths, including ones that split the volume unevenly
+	for (int slabDepth : { 1, 2, 3, 7 }) {
+
+		Crag        crag;
+		CragVolumes volumes(crag);
+		std::map<int, Crag::Node> labelNodes = createLeafNodes(labels, crag, volumes);
+
+		BlockwiseAdjacencyAnnotator blockwise;
+
+		for (int z = 0; z < labels.shape(2); z += slabDepth) {
+
+			int depth = std::min(slabDepth, (int)labels.shape(2) - z);
+
+			vigra::MultiArray<3, int> slab = labels.subarray(
+					vigra::Shape3(0, 0, z),
+					vigra::Shape3(labels.shape(0), labels.shape(1), z + depth));
+
+			blockwise.addSlab(slab, z);
+		}
+
+		blockwise.setLabelNodes(labelNodes);
+		blockwise.annotate(crag, volumes);
+
+		BOOST_CHECK(crag.getGridGraph().shape() == planarCrag.getGridGraph().shape());
+		BOOST_CHECK(getAdjacencies(crag) == getAdjacencies(planarCrag));
+	}
+}
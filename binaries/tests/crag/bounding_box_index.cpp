@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <tests.h>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <crag/BoundingBoxIndex.h>
+
+namespace {
+
+std::vector<int>
+ids(const Crag& crag, const std::vector<Crag::CragNode>& nodes) {
+
+	std::vector<int> ids;
+	for (Crag::CragNode n : nodes)
+		ids.push_back(crag.id(n));
+	std::sort(ids.begin(), ids.end());
+
+	return ids;
+}
+
+} // anonymous namespace
+
+void bounding_box_index() {
+
+	Crag crag;
+	CragVolumes volumes(crag);
+
+	// a row of 10x10 volumes, 20 apart, and one large volume covering all 
+	// of them
+	for (int i = 0; i < 5; i++) {
+
+		Crag::CragNode n = crag.addNode();
+
+		std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(10, 10, 1);
+		volume->data() = 1;
+		volume->setOffset(20*i, 0, 0);
+
+		volumes.setVolume(n, volume);
+	}
+
+	Crag::CragNode large = crag.addNode();
+	std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(100, 10, 1);
+	volume->data() = 1;
+	volume->setOffset(0, 0, 0);
+	volumes.setVolume(large, volume);
+
+	BoundingBoxIndex index(crag, volumes);
+
+	BOOST_CHECK_EQUAL(index.size(), 6);
+
+	typedef util::box<float, 2> Box;
+	typedef util::point<float, 2> Point;
+
+	// inside of the second volume
+	BOOST_CHECK(ids(crag, index.intersecting(Box(Point(22, 2), Point(25, 5)))) == std::vector<int>({1, 5}));
+
+	// between the second and third volume
+	BOOST_CHECK(ids(crag, index.intersecting(Box(Point(32, 2), Point(38, 5)))) == std::vector<int>({5}));
+	BOOST_CHECK(ids(crag, index.withinDistance(Box(Point(32, 2), Point(38, 5)), 3)) == std::vector<int>({1, 2, 5}));
+
+	// spanning several volumes
+	BOOST_CHECK(ids(crag, index.intersecting(Box(Point(5, 5), Point(45, 6)))) == std::vector<int>({0, 1, 2, 5}));
+
+	// outside of all volumes
+	BOOST_CHECK(index.intersecting(Box(Point(0, 20), Point(100, 30))).empty());
+	BOOST_CHECK(index.intersecting(Box(Point(-30, 0), Point(-20, 10))).empty());
+	BOOST_CHECK(ids(crag, index.withinDistance(Box(Point(-30, 0), Point(-20, 10)), 20)) == std::vector<int>({0, 5}));
+}
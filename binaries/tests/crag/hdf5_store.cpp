@@ -76,4 +76,108 @@ void hdf5_store() {
 	for (Crag::CragArc e : crag_.arcs())
 		BOOST_CHECK(
 				crag_.id(e.source()) == crag_.id(e.target()) - 1);
+
+	// single volumes can be read without the others
+	for (Crag::CragNode n : crag.nodes()) {
+
+		std::shared_ptr<CragVolume> b = store.retrieveVolume(crag_, crag_.nodeFromId(crag.id(n)));
+
+		if (!crag.isLeafNode(n)) {
+
+			BOOST_CHECK(!b);
+			continue;
+		}
+
+		std::shared_ptr<CragVolume> a = volumes[n];
+
+		BOOST_REQUIRE(b);
+		BOOST_CHECK_EQUAL(a->getOffset(), b->getOffset());
+		BOOST_CHECK(a->data() == b->data());
+	}
+
+	// project files with volumes concatenated into one uncompressed dataset 
+	// can still be read
+	{
+		vigra::HDF5File legacyFile("test_legacy.hdf", vigra::HDF5File::OpenMode::New);
+		legacyFile.cd_mk("/crag");
+		legacyFile.cd_mk("volumes");
+
+		std::vector<unsigned char> serialized;
+		std::vector<int> meta;
+		std::vector<float> offsets;
+		std::vector<float> resolutions;
+
+		for (Crag::CragNode n : crag.nodes()) {
+
+			if (!crag.isLeafNode(n))
+				continue;
+
+			std::shared_ptr<CragVolume> volume = volumes[n];
+			meta.push_back(crag.id(n));
+			meta.push_back(volume->width());
+			meta.push_back(volume->height());
+			meta.push_back(volume->depth());
+			offsets.push_back(volume->getOffset().x());
+			offsets.push_back(volume->getOffset().y());
+			offsets.push_back(volume->getOffset().z());
+			resolutions.push_back(volume->getResolution().x());
+			resolutions.push_back(volume->getResolution().y());
+			resolutions.push_back(volume->getResolution().z());
+			std::copy(volume->data().begin(), volume->data().end(), std::back_inserter(serialized));
+		}
+
+		legacyFile.write("serialized",  vigra::ArrayVectorView<unsigned char>(serialized.size(), &serialized[0]));
+		legacyFile.write("meta",        vigra::ArrayVectorView<int>(meta.size(), &meta[0]));
+		legacyFile.write("offsets",     vigra::ArrayVectorView<float>(offsets.size(), &offsets[0]));
+		legacyFile.write("resolutions", vigra::ArrayVectorView<float>(resolutions.size(), &resolutions[0]));
+	}
+
+	{
+		Hdf5CragStore legacyStore("test_legacy.hdf");
+		CragVolumes legacyVolumes(crag);
+		legacyStore.retrieveVolumes(legacyVolumes);
+
+		for (Crag::CragNode n : crag.nodes()) {
+
+			if (!crag.isLeafNode(n))
+				continue;
+
+			std::shared_ptr<CragVolume> a = volumes[n];
+			std::shared_ptr<CragVolume> b = legacyVolumes[n];
+			std::shared_ptr<CragVolume> c = legacyStore.retrieveVolume(crag, n);
+
+			BOOST_CHECK_EQUAL(a->getOffset(), b->getOffset());
+			BOOST_CHECK(a->data() == b->data());
+			BOOST_REQUIRE(c);
+			BOOST_CHECK(a->data() == c->data());
+		}
+
+		// re-save the volumes, while they are read on demand from the same 
+		// file
+		CragVolumes onDemandVolumes(crag);
+		legacyStore.retrieveVolumesOnDemand(onDemandVolumes);
+		legacyStore.saveVolumes(onDemandVolumes);
+
+		CragVolumes resavedVolumes(crag);
+		legacyStore.retrieveVolumes(resavedVolumes);
+
+		for (Crag::CragNode n : crag.nodes()) {
+
+			if (!crag.isLeafNode(n))
+				continue;
+
+			std::shared_ptr<CragVolume> a = volumes[n];
+			std::shared_ptr<CragVolume> b = resavedVolumes[n];
+
+			BOOST_CHECK_EQUAL(a->getOffset(), b->getOffset());
+			BOOST_CHECK_EQUAL(a->getResolution(), b->getResolution());
+			BOOST_CHECK(a->data() == b->data());
+		}
+	}
+
+	// the uncompressed dataset was replaced, not kept next to the new one
+	vigra::HDF5File resavedFile("test_legacy.hdf", vigra::HDF5File::OpenMode::ReadOnly);
+	BOOST_CHECK(resavedFile.existsDataset("/crag/volumes/voxels"));
+	BOOST_CHECK(!resavedFile.existsDataset("/crag/volumes/serialized"));
+	BOOST_CHECK(!resavedFile.existsDataset("/crag/volumes/voxels_new"));
 }
@@ -0,0 +1,113 @@
+#include <tests.h>
+#include <crag/Crag.h>
+
+namespace hierarchy_case {
+
+std::set<int>
+ids(const Crag& crag, const Crag::CragNodeSpan& nodes) {
+
+	std::set<int> ids;
+	for (Crag::CragNode n : nodes)
+		ids.insert(crag.id(n));
+
+	return ids;
+}
+
+template <typename Edges>
+std::set<int>
+ids(const Crag& crag, const Edges& edges) {
+
+	std::set<int> ids;
+	for (Crag::CragEdge e : edges)
+		ids.insert(crag.id(e));
+
+	return ids;
+}
+
+} using namespace hierarchy_case;
+
+void hierarchy() {
+
+	Crag crag;
+
+	Crag::CragNode a = crag.addNode();
+	Crag::CragNode b = crag.addNode();
+	Crag::CragNode c = crag.addNode();
+	Crag::CragNode d = crag.addNode();
+
+	Crag::CragEdge ab = crag.addAdjacencyEdge(a, b);
+	Crag::CragEdge bc = crag.addAdjacencyEdge(b, c);
+	Crag::CragEdge cd = crag.addAdjacencyEdge(c, d);
+
+	BOOST_CHECK_EQUAL(crag.getLevel(a), 0);
+
+	// levels are updated while the hierarchy is built
+
+	Crag::CragNode p = crag.addNode();
+	crag.addSubsetArc(a, p);
+	crag.addSubsetArc(b, p);
+	BOOST_CHECK_EQUAL(crag.getLevel(p), 1);
+
+	Crag::CragNode q = crag.addNode();
+	crag.addSubsetArc(c, q);
+	crag.addSubsetArc(d, q);
+
+	Crag::CragNode r = crag.addNode();
+	crag.addSubsetArc(p, r);
+	crag.addSubsetArc(q, r);
+	BOOST_CHECK_EQUAL(crag.getLevel(r), 2);
+
+	Crag::CragEdge pq = crag.addAdjacencyEdge(p, q);
+
+	BOOST_CHECK(crag.isDescendant(a, p));
+	BOOST_CHECK(crag.isDescendant(a, r));
+	BOOST_CHECK(!crag.isDescendant(a, q));
+	BOOST_CHECK(!crag.isDescendant(r, a));
+	BOOST_CHECK(!crag.isDescendant(r, r));
+
+	BOOST_CHECK(ids(crag, crag.leafNodes(a)) == std::set<int>({crag.id(a)}));
+	BOOST_CHECK(ids(crag, crag.leafNodes(p)) == std::set<int>({crag.id(a), crag.id(b)}));
+	BOOST_CHECK_EQUAL(crag.leafNodes(r).size(), 4);
+
+	BOOST_CHECK(ids(crag, crag.leafEdges(a)).empty());
+	BOOST_CHECK(ids(crag, crag.leafEdges(p)) == std::set<int>({crag.id(ab)}));
+	BOOST_CHECK(ids(crag, crag.leafEdges(r)) == std::set<int>({crag.id(ab), crag.id(bc), crag.id(cd)}));
+	BOOST_CHECK(ids(crag, crag.leafEdges(pq)) == std::set<int>({crag.id(bc)}));
+	BOOST_CHECK(ids(crag, crag.descendantEdges(pq)) == std::set<int>({crag.id(bc)}));
+
+	// a node with two parents
+
+	Crag::CragNode s = crag.addNode();
+	crag.addSubsetArc(b, s);
+	crag.addSubsetArc(c, s);
+
+	BOOST_CHECK(crag.isDescendant(b, s));
+	BOOST_CHECK(crag.isDescendant(b, p));
+	BOOST_CHECK(!crag.isDescendant(a, s));
+	BOOST_CHECK(ids(crag, crag.leafNodes(s)) == std::set<int>({crag.id(b), crag.id(c)}));
+	BOOST_CHECK(ids(crag, crag.leafEdges(s)) == std::set<int>({crag.id(bc)}));
+	BOOST_CHECK(ids(crag, crag.leafEdges(r)) == std::set<int>({crag.id(ab), crag.id(bc), crag.id(cd)}));
+	BOOST_CHECK(ids(crag, crag.leafEdges(pq)) == std::set<int>({crag.id(bc)}));
+
+	// an edge between nodes that share some of their leaves
+
+	Crag::CragNode t = crag.addNode();
+	crag.addSubsetArc(a, t);
+	crag.addSubsetArc(c, t);
+
+	Crag::CragEdge pt = crag.addAdjacencyEdge(p, t);
+
+	BOOST_CHECK(ids(crag, crag.leafEdges(pt)) == std::set<int>({crag.id(ab), crag.id(bc)}));
+	BOOST_CHECK_EQUAL(crag.leafEdges(pt).size(), 2);
+
+	// removing nodes updates the hierarchy
+
+	crag.erase(t);
+	crag.erase(s);
+	crag.erase(p);
+
+	BOOST_CHECK_EQUAL(crag.getLevel(r), 2);
+	BOOST_CHECK(crag.isRootNode(a));
+	BOOST_CHECK(ids(crag, crag.leafNodes(r)) == std::set<int>({crag.id(c), crag.id(d)}));
+	BOOST_CHECK(ids(crag, crag.leafEdges(r)) == std::set<int>({crag.id(cd)}));
+}
@@ -0,0 +1,174 @@
+#include <tests.h>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <crag/SparseCragVolume.h>
+
+namespace {
+
+// a diagonal tube through a 20x10x5 volume
+std::shared_ptr<CragVolume>
+createTube(float offset) {
+
+	std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(20, 10, 5, 0);
+	volume->setOffset(offset, offset, 0);
+
+	for (unsigned int z = 0; z < 5;  z++)
+	for (unsigned int y = 0; y < 10; y++)
+	for (unsigned int x = 0; x < 20; x++)
+		if (x >= 2*y && x < 2*y + 3 && z != 2)
+			(*volume)(x, y, z) = 1;
+
+	return volume;
+}
+
+bool
+isSet(const CragVolume& volume, int x, int y, int z) {
+
+	if (x < 0 || y < 0 || z < 0 || x >= (int)volume.width() || y >= (int)volume.height() || z >= (int)volume.depth())
+		return false;
+
+	return volume(x, y, z) != 0;
+}
+
+} // anonymous namespace
+
+void sparse_volume() {
+
+	std::shared_ptr<CragVolume> a = createTube(0);
+	std::shared_ptr<CragVolume> b = createTube(3);
+
+	SparseCragVolume sparseA(*a);
+	SparseCragVolume sparseB(*b);
+
+	// encoding
+
+	BOOST_CHECK_EQUAL(sparseA.getBoundingBox(), a->getBoundingBox());
+	BOOST_CHECK_EQUAL(sparseA.numRuns(), 40);
+	BOOST_CHECK_EQUAL(sparseA.numVoxels(), 4*(9*3 + 2));
+	BOOST_CHECK(sparseA.getSizeInBytes() < a->width()*a->height()*a->depth());
+
+	std::shared_ptr<CragVolume> materialized = sparseA.materialize();
+	BOOST_CHECK_EQUAL(materialized->getBoundingBox(), a->getBoundingBox());
+
+	for (unsigned int z = 0; z < 5;  z++)
+	for (unsigned int y = 0; y < 10; y++)
+	for (unsigned int x = 0; x < 20; x++) {
+
+		BOOST_CHECK_EQUAL((*materialized)(x, y, z), (*a)(x, y, z));
+		BOOST_CHECK_EQUAL(sparseA(x, y, z), (*a)(x, y, z) != 0);
+	}
+
+	std::size_t numVisited = 0;
+	sparseA.forEachVoxel([&](unsigned int x, unsigned int y, unsigned int z) {
+
+		BOOST_CHECK((*a)(x, y, z) != 0);
+		numVisited++;
+	});
+	BOOST_CHECK_EQUAL(numVisited, sparseA.numVoxels());
+
+	// creation from runs in scanline order
+
+	std::vector<SparseCragVolume::LineRun> runs;
+	sparseA.forEachRun([&](unsigned int begin, unsigned int end, unsigned int y, unsigned int z) {
+
+		runs.push_back(SparseCragVolume::LineRun(y, z, SparseCragVolume::Run(begin, end)));
+	});
+
+	SparseCragVolume fromRuns(20, 10, 5, runs);
+	BOOST_CHECK_EQUAL(fromRuns.numRuns(), sparseA.numRuns());
+	BOOST_CHECK_EQUAL(fromRuns.numVoxels(), sparseA.numVoxels());
+
+	for (unsigned int z = 0; z < 5;  z++)
+	for (unsigned int y = 0; y < 10; y++)
+	for (unsigned int x = 0; x < 20; x++)
+		BOOST_CHECK_EQUAL(fromRuns(x, y, z), sparseA(x, y, z));
+
+	// union and intersection, compared against voxel-wise tests in global 
+	// coordinates
+
+	std::vector<std::shared_ptr<const SparseCragVolume>> both;
+	both.push_back(std::make_shared<SparseCragVolume>(sparseA));
+	both.push_back(std::make_shared<SparseCragVolume>(sparseB));
+
+	std::shared_ptr<SparseCragVolume> u = SparseCragVolume::unite(both);
+	std::shared_ptr<SparseCragVolume> i = SparseCragVolume::intersect(sparseA, sparseB);
+
+	BOOST_CHECK_EQUAL(u->getBoundingBox(), a->getBoundingBox() + b->getBoundingBox());
+	BOOST_CHECK_EQUAL(i->getBoundingBox(), a->getBoundingBox().intersection(b->getBoundingBox()));
+
+	std::size_t unionSize = 0;
+	std::size_t intersectionSize = 0;
+
+	for (int z = 0; z < 5;  z++)
+	for (int y = 0; y < 13; y++)
+	for (int x = 0; x < 23; x++) {
+
+		bool inA = isSet(*a, x, y, z);
+		bool inB = isSet(*b, x - 3, y - 3, z);
+
+		BOOST_CHECK_EQUAL((*u)(x, y, z), inA || inB);
+		if (x >= 3 && y >= 3)
+			BOOST_CHECK_EQUAL((*i)(x - 3, y - 3, z), inA && inB);
+
+		unionSize        += (inA || inB);
+		intersectionSize += (inA && inB);
+	}
+
+	BOOST_CHECK_EQUAL(u->numVoxels(), unionSize);
+	BOOST_CHECK_EQUAL(i->numVoxels(), intersectionSize);
+	BOOST_CHECK_EQUAL(SparseCragVolume::intersectionSize(sparseA, sparseB), intersectionSize);
+	BOOST_CHECK_EQUAL(SparseCragVolume::intersectionSize(sparseB, sparseA), intersectionSize);
+
+	// the union agrees with the dense union
+	std::vector<std::shared_ptr<CragVolume>> dense;
+	dense.push_back(a);
+	dense.push_back(b);
+	std::shared_ptr<CragVolume> denseUnion = UnionVolume(dense).materialize();
+	std::shared_ptr<CragVolume> sparseUnion = u->materialize();
+
+	BOOST_CHECK_EQUAL(denseUnion->getBoundingBox(), sparseUnion->getBoundingBox());
+	for (unsigned int z = 0; z < denseUnion->depth();  z++)
+	for (unsigned int y = 0; y < denseUnion->height(); y++)
+	for (unsigned int x = 0; x < denseUnion->width();  x++)
+		BOOST_CHECK_EQUAL((*denseUnion)(x, y, z) != 0, (*sparseUnion)(x, y, z) != 0);
+
+	// disjoint volumes have an empty intersection
+	std::shared_ptr<CragVolume> far = createTube(100);
+	BOOST_CHECK_EQUAL(SparseCragVolume::intersect(sparseA, SparseCragVolume(*far))->numVoxels(), 0);
+	BOOST_CHECK_EQUAL(SparseCragVolume::intersectionSize(sparseA, SparseCragVolume(*far)), 0);
+
+	// CragVolumes with sparse leaf nodes give the same volumes as with dense 
+	// leaf nodes
+
+	Crag crag;
+	CragVolumes denseVolumes(crag);
+	CragVolumes sparseVolumes(crag);
+
+	Crag::CragNode leafA  = crag.addNode();
+	Crag::CragNode leafB  = crag.addNode();
+	Crag::CragNode parent = crag.addNode();
+	crag.addSubsetArc(leafA, parent);
+	crag.addSubsetArc(leafB, parent);
+
+	denseVolumes.setVolume(leafA, a);
+	denseVolumes.setVolume(leafB, b);
+	sparseVolumes.setVolume(leafA, std::make_shared<SparseCragVolume>(*a));
+	sparseVolumes.setVolume(leafB, std::make_shared<SparseCragVolume>(*b));
+
+	for (Crag::CragNode n : crag.nodes()) {
+
+		BOOST_CHECK_EQUAL(denseVolumes.getBoundingBox(n), sparseVolumes.getBoundingBox(n));
+		BOOST_CHECK_EQUAL(denseVolumes.getSparseVolume(n)->numVoxels(), sparseVolumes.getSparseVolume(n)->numVoxels());
+
+		std::shared_ptr<CragVolume> fromDense  = denseVolumes[n];
+		std::shared_ptr<CragVolume> fromSparse = sparseVolumes[n];
+
+		BOOST_CHECK_EQUAL(fromDense->getBoundingBox(), fromSparse->getBoundingBox());
+		for (unsigned int z = 0; z < fromDense->depth();  z++)
+		for (unsigned int y = 0; y < fromDense->height(); y++)
+		for (unsigned int x = 0; x < fromDense->width();  x++)
+			BOOST_CHECK_EQUAL((*fromDense)(x, y, z) != 0, (*fromSparse)(x, y, z) != 0);
+	}
+
+	BOOST_CHECK_EQUAL(denseVolumes.getBoundingBox(), sparseVolumes.getBoundingBox());
+}
@@ -0,0 +1,213 @@
+#include <tests.h>
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <crag/CragStackCombiner.h>
+
+namespace {
+
+// add a section with rectangular leaf candidates at pseudo-random positions, 
+// and a parent candidate for each pair of consecutive leaves
+void
+createSection(int z, unsigned int& seed, std::unique_ptr<Crag>& crag, std::unique_ptr<CragVolumes>& volumes) {
+
+	crag    = std::unique_ptr<Crag>(new Crag());
+	volumes = std::unique_ptr<CragVolumes>(new CragVolumes(*crag));
+
+	auto random = [&seed](int max) {
+
+		seed = seed*1103515245 + 12345;
+		return (int)((seed/65536)%max);
+	};
+
+	std::vector<Crag::CragNode> leafNodes;
+	for (int i = 0; i < 40; i++) {
+
+		std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(1 + random(15), 1 + random(15), 1);
+		volume->data() = 1;
+		volume->setOffset(random(200), random(200), z);
+
+		Crag::CragNode n = crag->addNode(Crag::SliceNode);
+		volumes->setVolume(n, volume);
+		leafNodes.push_back(n);
+	}
+
+	for (int i = 0; i + 1 < leafNodes.size(); i += 2) {
+
+		Crag::CragNode parent = crag->addNode(Crag::SliceNode);
+		crag->addSubsetArc(leafNodes[i], parent);
+		crag->addSubsetArc(leafNodes[i + 1], parent);
+	}
+}
+
+// a description of a combined CRAG by node and edge ids, to compare CRAGs 
+// created with different numbers of threads
+struct CombinedCrag {
+
+	std::vector<std::pair<int, int>>       nodes;
+	std::vector<std::vector<float>>        boundingBoxes;
+	std::vector<std::tuple<int, int, int>> edges;
+	std::vector<std::pair<int, int>>       arcs;
+};
+
+CombinedCrag
+describe(const Crag& crag, const CragVolumes& volumes) {
+
+	CombinedCrag description;
+
+	for (Crag::CragNode n : crag.nodes())
+		description.nodes.push_back(std::make_pair(crag.id(n), (int)crag.type(n)));
+	std::sort(description.nodes.begin(), description.nodes.end());
+
+	for (const auto& node : description.nodes) {
+
+		util::box<float, 3> bb = volumes.getBoundingBox(crag.nodeFromId(node.first));
+		description.boundingBoxes.push_back({
+				bb.min().x(), bb.min().y(), bb.min().z(),
+				bb.max().x(), bb.max().y(), bb.max().z()});
+	}
+
+	for (Crag::CragEdge e : crag.edges())
+		description.edges.push_back(std::make_tuple(crag.id(e.u()), crag.id(e.v()), (int)crag.type(e)));
+	for (Crag::CragArc a : crag.arcs())
+		description.arcs.push_back(std::make_pair(crag.id(a.source()), crag.id(a.target())));
+
+	std::sort(description.edges.begin(), description.edges.end());
+	std::sort(description.arcs.begin(), description.arcs.end());
+
+	return description;
+}
+
+} // anonymous namespace
+
+void stack_combiner() {
+
+	unsigned int seed = 42;
+
+	std::vector<std::unique_ptr<Crag>>        crags(3);
+	std::vector<std::unique_ptr<CragVolumes>> volumes(3);
+	for (int z = 0; z < 3; z++)
+		createSection(z, seed, crags[z], volumes[z]);
+
+	// count the pairs of candidates in successive sections with overlapping 
+	// bounding boxes
+	int numNodes = 0;
+	int numLinks = 0;
+	for (int z = 0; z < 3; z++) {
+
+		numNodes += crags[z]->nodes().size();
+
+		if (z == 0)
+			continue;
+
+		for (Crag::CragNode i : crags[z-1]->nodes())
+			for (Crag::CragNode j : crags[z]->nodes())
+				if (volumes[z-1]->getBoundingBox(i).project<2>().intersects(volumes[z]->getBoundingBox(j).project<2>()))
+					numLinks++;
+	}
+
+	BOOST_CHECK(numLinks > 0);
+
+	Crag crag;
+	CragVolumes cragVolumes(crag);
+
+	CragStackCombiner combiner;
+	combiner.combine(crags, volumes, crag, cragVolumes);
+
+	int numSliceNodes      = 0;
+	int numAssignmentNodes = 0;
+	for (Crag::CragNode n : crag.nodes()) {
+
+		if (crag.type(n) == Crag::SliceNode)
+			numSliceNodes++;
+		if (crag.type(n) == Crag::AssignmentNode) {
+
+			numAssignmentNodes++;
+
+			// both linked candidates overlap
+			std::vector<util::box<float, 2>> bbs;
+			for (Crag::CragArc a : crag.inArcs(n))
+				bbs.push_back(cragVolumes.getBoundingBox(a.source()).project<2>());
+
+			BOOST_CHECK_EQUAL(bbs.size(), 2);
+			BOOST_CHECK(bbs[0].intersects(bbs[1]));
+		}
+	}
+
+	BOOST_CHECK_EQUAL(numSliceNodes, numNodes);
+	BOOST_CHECK_EQUAL(numAssignmentNodes, numLinks);
+}
+
+void stack_combiner_reader() {
+
+	const int numSections = 7;
+
+	// combine with pre-loaded sections as reference
+
+	std::vector<std::unique_ptr<Crag>>        crags(numSections);
+	std::vector<std::unique_ptr<CragVolumes>> volumes(numSections);
+	for (int z = 0; z < numSections; z++) {
+
+		unsigned int seed = 42 + z;
+		createSection(z, seed, crags[z], volumes[z]);
+	}
+
+	Crag referenceCrag;
+	CragVolumes referenceVolumes(referenceCrag);
+
+	CragStackCombiner referenceCombiner;
+	referenceCombiner.setNumThreads(1);
+	referenceCombiner.combine(crags, volumes, referenceCrag, referenceVolumes);
+
+	CombinedCrag reference = describe(referenceCrag, referenceVolumes);
+
+	BOOST_CHECK(reference.arcs.size() > 0);
+
+	// read the sections on demand, for different numbers of threads and 
+	// window sizes
+
+	for (int numThreads : {1, 2, 4})
+	for (unsigned int windowSize : {1u, 3u, 0u}) {
+
+		std::mutex       readMutex;
+		std::vector<int> readOrder;
+
+		auto readSection = [&](unsigned int z, std::unique_ptr<Crag>& sectionCrag, std::unique_ptr<CragVolumes>& sectionVolumes) {
+
+			unsigned int seed = 42 + z;
+			createSection(z, seed, sectionCrag, sectionVolumes);
+
+			std::lock_guard<std::mutex> lock(readMutex);
+			readOrder.push_back(z);
+		};
+
+		Crag crag;
+		CragVolumes cragVolumes(crag);
+
+		CragStackCombiner combiner;
+		combiner.setNumThreads(numThreads);
+		combiner.setMaxSectionsInFlight(windowSize);
+		combiner.combine(numSections, readSection, crag, cragVolumes);
+
+		// each section is read once, and all sections of a window are read 
+		// before the next window
+		unsigned int window = (windowSize > 0 ? windowSize : 2*numThreads);
+
+		BOOST_CHECK_EQUAL(readOrder.size(), numSections);
+		for (std::size_t i = 1; i < readOrder.size(); i++)
+			BOOST_CHECK(readOrder[i - 1]/window <= readOrder[i]/window);
+		std::sort(readOrder.begin(), readOrder.end());
+		for (int z = 0; z < (int)readOrder.size(); z++)
+			BOOST_CHECK_EQUAL(readOrder[z], z);
+
+		// the result does not depend on the number of threads
+		CombinedCrag combined = describe(crag, cragVolumes);
+
+		BOOST_CHECK(combined.nodes == reference.nodes);
+		BOOST_CHECK(combined.boundingBoxes == reference.boundingBoxes);
+		BOOST_CHECK(combined.edges == reference.edges);
+		BOOST_CHECK(combined.arcs  == reference.arcs);
+	}
+}
@@ -7,5 +7,14 @@ BEGIN_TEST_SUITE(crag)
 	ADD_TEST_CASE(hdf5_store)
 	ADD_TEST_CASE(crag_iterators)
 	ADD_TEST_CASE(volumes)
+	ADD_TEST_CASE(volume_cache)
+	ADD_TEST_CASE(sparse_volume)
+	ADD_TEST_CASE(volume_source)
+	ADD_TEST_CASE(affiliated_edges)
+	ADD_TEST_CASE(hierarchy)
+	ADD_TEST_CASE(bounding_box_index)
+	ADD_TEST_CASE(blockwise_adjacency)
+	ADD_TEST_CASE(stack_combiner)
+	ADD_TEST_CASE(stack_combiner_reader)
 
 END_TEST_SUITE()
@@ -0,0 +1,96 @@
+#include <tests.h>
+#include <atomic>
+#include <thread>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <crag/CragVolumeCache.h>
+
+void volume_cache() {
+
+	// each volume has 1000 bytes
+	CragVolumeCache cache(2500);
+
+	int numMaterialized = 0;
+	auto materialize = [&numMaterialized]{
+
+		numMaterialized++;
+		return std::make_shared<CragVolume>(10, 10, 10);
+	};
+
+	cache.get(0, materialize);
+	cache.get(1, materialize);
+	cache.get(0, materialize);
+
+	BOOST_CHECK_EQUAL(numMaterialized, 2);
+	BOOST_CHECK_EQUAL(cache.getStatistics().hits, 1);
+	BOOST_CHECK_EQUAL(cache.getStatistics().misses, 2);
+	BOOST_CHECK_EQUAL(cache.getStatistics().bytes, 2000);
+
+	// exceeds the budget, 1 is the least recently used
+	cache.get(2, materialize);
+
+	BOOST_CHECK_EQUAL(cache.getStatistics().evictions, 1);
+	BOOST_CHECK_EQUAL(cache.getStatistics().entries, 2);
+	BOOST_CHECK_EQUAL(cache.getStatistics().bytes, 2000);
+
+	cache.get(0, materialize);
+	BOOST_CHECK_EQUAL(numMaterialized, 3);
+	cache.get(1, materialize);
+	BOOST_CHECK_EQUAL(numMaterialized, 4);
+
+	// volumes larger than the budget are not kept
+	cache.get(3, []{ return std::make_shared<CragVolume>(10, 10, 30); });
+	BOOST_CHECK_EQUAL(cache.getStatistics().entries, 2);
+
+	cache.clear();
+	BOOST_CHECK_EQUAL(cache.getStatistics().entries, 0);
+	BOOST_CHECK_EQUAL(cache.getStatistics().bytes, 0);
+
+	// concurrent access to CragVolumes
+
+	Crag crag;
+	CragVolumes volumes(crag);
+
+	std::vector<Crag::CragNode> leafs;
+	for (int i = 0; i < 10; i++) {
+
+		Crag::CragNode n = crag.addNode();
+		std::shared_ptr<CragVolume> v = std::make_shared<CragVolume>(10, 10, 10);
+		v->setOffset(i, 0, 0);
+		v->data() = 1;
+		volumes.setVolume(n, v);
+		leafs.push_back(n);
+	}
+
+	std::vector<Crag::CragNode> parents;
+	for (int i = 0; i < 9; i++) {
+
+		Crag::CragNode n = crag.addNode();
+		crag.addSubsetArc(leafs[i], n);
+		crag.addSubsetArc(leafs[i+1], n);
+		parents.push_back(n);
+	}
+
+	volumes.setCacheSize(5*1100);
+
+	// boost test macros are not thread-safe, count errors instead
+	std::atomic<int> numErrors(0);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+		threads.emplace_back([&]{
+
+			for (int j = 0; j < 100; j++)
+				for (Crag::CragNode n : parents)
+					if (!(volumes[n]->getBoundingBox() == volumes.getBoundingBox(n)))
+						numErrors++;
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	BOOST_CHECK_EQUAL(numErrors.load(), 0);
+
+	BOOST_CHECK_EQUAL(volumes[parents[0]]->width(), 11);
+	BOOST_CHECK(volumes.getCacheStatistics().bytes <= 5*1100);
+	BOOST_CHECK(volumes.getCacheStatistics().evictions > 0);
+}
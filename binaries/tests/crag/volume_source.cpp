@@ -0,0 +1,90 @@
+#include <tests.h>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <crag/CragVolumeSource.h>
+
+namespace {
+
+// provides 10x10x10 leaf volumes, shifted by the node id
+class TestVolumeSource : public CragVolumeSource {
+
+public:
+
+	TestVolumeSource(const Crag& crag) :
+		_crag(crag),
+		numReads(0) {}
+
+	std::shared_ptr<CragVolume> getVolume(Crag::CragNode n) override {
+
+		numReads++;
+
+		auto volume = std::make_shared<CragVolume>(10, 10, 10, 1);
+		volume->setOffset(_crag.id(n), 0, 0);
+		return volume;
+	}
+
+	util::box<float, 3> getBoundingBox(Crag::CragNode n) override {
+
+		return util::box<float, 3>(
+				util::point<float, 3>(_crag.id(n), 0, 0),
+				util::point<float, 3>(_crag.id(n) + 10, 10, 10));
+	}
+
+private:
+
+	const Crag& _crag;
+
+public:
+
+	int numReads;
+};
+
+} // anonymous namespace
+
+void volume_source() {
+
+	Crag crag;
+	CragVolumes volumes(crag);
+
+	Crag::CragNode a = crag.addNode();
+	Crag::CragNode b = crag.addNode();
+	Crag::CragNode c = crag.addNode();
+	Crag::CragNode p = crag.addNode();
+	crag.addSubsetArc(a, p);
+	crag.addSubsetArc(b, p);
+
+	// c has its own volume and is not read from the source
+	auto volumeC = std::make_shared<CragVolume>(5, 5, 5, 1);
+	volumeC->setOffset(100, 0, 0);
+	volumes.setVolume(c, volumeC);
+
+	auto source = std::make_shared<TestVolumeSource>(crag);
+	volumes.setVolumeSource(source);
+
+	// bounding boxes don't need the volumes
+	BOOST_CHECK(volumes.getBoundingBox(a) == util::box<float, 3>(util::point<float, 3>(0, 0, 0), util::point<float, 3>(10, 10, 10)));
+	BOOST_CHECK(volumes.getBoundingBox(p) == util::box<float, 3>(util::point<float, 3>(0, 0, 0), util::point<float, 3>(11, 10, 10)));
+	BOOST_CHECK(volumes.getBoundingBox() == util::box<float, 3>(util::point<float, 3>(0, 0, 0), util::point<float, 3>(105, 10, 10)));
+	BOOST_CHECK_EQUAL(source->numReads, 0);
+
+	BOOST_CHECK(volumes[c] == volumeC);
+	BOOST_CHECK_EQUAL(source->numReads, 0);
+
+	BOOST_CHECK_EQUAL(volumes[a]->getOffset().x(), 0);
+	BOOST_CHECK_EQUAL(volumes[b]->getOffset().x(), 1);
+	BOOST_CHECK_EQUAL(source->numReads, 2);
+
+	// read leaf volumes are cached
+	volumes[a];
+	BOOST_CHECK_EQUAL(source->numReads, 2);
+
+	BOOST_CHECK_EQUAL(volumes[p]->width(), 11);
+	BOOST_CHECK_EQUAL(volumes.getSparseVolume(a)->numVoxels(), 1000u);
+
+	// without a cache, every access reads the volume again
+	volumes.setCacheSize(0);
+	int numReads = source->numReads;
+	volumes[a];
+	volumes[a];
+	BOOST_CHECK_EQUAL(source->numReads, numReads + 2);
+}
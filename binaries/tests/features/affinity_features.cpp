@@ -0,0 +1,70 @@
+#include <tests.h>
+#include <features/EdgeFeatures.h>
+#include <features/AffinityFeatureProvider.h>
+
+void affinity_features() {
+
+	// a 2x4x1 grid, leaf a is the column x=0, leaves b and c split the column
+	// x=1 at y=2, and node q is the union of b and c
+
+	Crag crag;
+	vigra::GridGraph<3> gridGraph(vigra::Shape3(2, 4, 1), vigra::DirectNeighborhood);
+	crag.setGridGraph(gridGraph);
+
+	Crag::CragNode a = crag.addNode();
+	Crag::CragNode b = crag.addNode();
+	Crag::CragNode c = crag.addNode();
+	Crag::CragNode q = crag.addNode();
+
+	crag.addSubsetArc(b, q);
+	crag.addSubsetArc(c, q);
+
+	Crag::CragEdge ab = crag.addAdjacencyEdge(a, b);
+	Crag::CragEdge ac = crag.addAdjacencyEdge(a, c);
+	Crag::CragEdge aq = crag.addAdjacencyEdge(a, q);
+
+	std::vector<vigra::GridGraph<3>::Edge> abEdges;
+	std::vector<vigra::GridGraph<3>::Edge> acEdges;
+	for (int y = 0; y < 4; y++)
+		(y < 2 ? abEdges : acEdges).push_back(
+				gridGraph.findEdge(
+						vigra::GridGraph<3>::Node(0, y, 0),
+						vigra::GridGraph<3>::Node(1, y, 0)));
+	crag.setAffiliatedEdges(ab, abEdges);
+	crag.setAffiliatedEdges(ac, acEdges);
+
+	// the affinities of the grid edges between the columns are 0.1, ..., 0.4
+	ExplicitVolume<float> xAffinities(2, 4, 1);
+	ExplicitVolume<float> yAffinities(2, 4, 1);
+	ExplicitVolume<float> zAffinities(2, 4, 1);
+	xAffinities.data() = 0;
+	yAffinities.data() = 0;
+	zAffinities.data() = 0;
+	for (int y = 0; y < 4; y++)
+		xAffinities(1, y, 0) = 0.1*(y + 1);
+
+	EdgeFeatures edgeFeatures(crag);
+	AffinityFeatureProvider provider(crag, xAffinities, yAffinities, zAffinities);
+	provider.appendFeatures(crag, edgeFeatures);
+
+	// the affinity range is [0, 0.4], the quantiles are accurate up to one
+	// bin width
+	double binWidth = 0.4/4096;
+
+	// count, min, 25%, median, 75%, max, mean
+	FeatureRow features = edgeFeatures[aq];
+	BOOST_REQUIRE_EQUAL(features.size(), 9);
+	BOOST_CHECK_EQUAL(features[0], 4);
+	BOOST_CHECK_CLOSE(features[1], 0.1, 1e-4);
+	BOOST_CHECK_SMALL(features[2] - 0.2, binWidth);
+	BOOST_CHECK_SMALL(features[3] - 0.3, binWidth);
+	BOOST_CHECK_SMALL(features[4] - 0.4, binWidth);
+	BOOST_CHECK_CLOSE(features[5], 0.4, 1e-4);
+	BOOST_CHECK_CLOSE(features[6], 0.25, 1e-4);
+
+	features = edgeFeatures[ab];
+	BOOST_REQUIRE_EQUAL(features.size(), 9);
+	BOOST_CHECK_EQUAL(features[0], 2);
+	BOOST_CHECK_SMALL(features[2] - 0.1, binWidth);
+	BOOST_CHECK_SMALL(features[3] - 0.2, binWidth);
+}
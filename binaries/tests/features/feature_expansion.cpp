@@ -0,0 +1,139 @@
+#include <tests.h>
+#include <features/NodeFeatures.h>
+#include <features/EdgeFeatures.h>
+#include <features/FeatureWeights.h>
+#include <features/PairwiseFeatureProvider.h>
+#include <features/SquareFeatureProvider.h>
+
+namespace {
+
+// the feature vector as it used to be materialized by the square, pairwise, 
+// and bias feature providers
+std::vector<double>
+materialize(const std::vector<double>& base, bool squares, bool pairwise) {
+
+	std::vector<double> features = base;
+
+	if (squares)
+		for (double f : base)
+			features.push_back(f*f);
+
+	if (pairwise) {
+
+		std::vector<double> factors = features;
+		for (unsigned int i = 0; i < factors.size(); i++)
+			for (unsigned int j = i; j < factors.size(); j++)
+				features.push_back(factors[i]*factors[j]);
+	}
+
+	// bias
+	features.push_back(1);
+
+	return features;
+}
+
+void
+checkExpansion(bool squares, bool pairwise) {
+
+	Crag crag;
+	std::vector<Crag::CragNode> nodes;
+	for (int i = 0; i < 3; i++)
+		nodes.push_back(crag.addNode());
+
+	NodeFeatures nodeFeatures(crag);
+	EdgeFeatures edgeFeatures(crag);
+
+	std::vector<std::vector<double>> base = {
+		{ 0.5, 0.25, 1.0, 0.1 },
+		{ 0.0, 0.75, 0.3, 0.9 },
+		{ 1.0, 0.6, 0.0, 0.45 }
+	};
+
+	for (int i = 0; i < 3; i++)
+		for (double f : base[i])
+			nodeFeatures.append(nodes[i], f);
+	nodeFeatures.appendFeatureNames(Crag::VolumeNode, { "a", "b", "c", "d" });
+
+	if (squares) {
+
+		SquareFeatureProvider provider(crag, true);
+		provider.appendFeatures(crag, nodeFeatures);
+	}
+
+	if (pairwise) {
+
+		PairwiseFeatureProvider provider(crag, true);
+		provider.appendFeatures(crag, nodeFeatures);
+	}
+
+	for (int i = 0; i < 3; i++)
+		nodeFeatures.append(nodes[i], 1);
+	nodeFeatures.appendFeatureName(Crag::VolumeNode, "bias");
+
+	std::vector<double> expected = materialize(base[0], squares, pairwise);
+
+	BOOST_CHECK_EQUAL(nodeFeatures.storedDims(Crag::VolumeNode), 5);
+	BOOST_CHECK_EQUAL(nodeFeatures.dims(Crag::VolumeNode), expected.size());
+	BOOST_CHECK_EQUAL(nodeFeatures.getFeatureNames(Crag::VolumeNode).size(), expected.size());
+
+	std::vector<double> weights(expected.size());
+	for (unsigned int k = 0; k < weights.size(); k++)
+		weights[k] = 1.0/(k + 1) - 0.3;
+
+	std::vector<double> gradient(expected.size(), 0);
+	std::vector<double> expectedGradient(expected.size(), 0);
+
+	for (int i = 0; i < 3; i++) {
+
+		expected = materialize(base[i], squares, pairwise);
+
+		BOOST_CHECK(nodeFeatures.expand(nodes[i]) == expected);
+
+		double expectedDot = 0;
+		for (unsigned int k = 0; k < expected.size(); k++)
+			expectedDot += weights[k]*expected[k];
+
+		// same order of operations, the results are identical
+		BOOST_CHECK_EQUAL(nodeFeatures.dot(nodes[i], weights), expectedDot);
+
+		int sign = (i == 1 ? -1 : 1);
+		nodeFeatures.accumulate(nodes[i], sign, gradient);
+		for (unsigned int k = 0; k < expected.size(); k++)
+			expectedGradient[k] += expected[k]*sign;
+	}
+
+	BOOST_CHECK(gradient == expectedGradient);
+
+	// the batched products give the same results, independent of the number 
+	// of threads
+	FeatureWeights featureWeights;
+	featureWeights[Crag::VolumeNode] = weights;
+
+	for (unsigned int numThreads : { 1, 3 }) {
+
+		Crag::NodeMap<double> costs(crag);
+		nodeFeatures.computeCosts(featureWeights, costs, numThreads);
+
+		for (int i = 0; i < 3; i++)
+			BOOST_CHECK_EQUAL(costs[nodes[i]], nodeFeatures.dot(nodes[i], weights));
+
+		FeatureWeights batchedGradient;
+		batchedGradient[Crag::VolumeNode] = std::vector<double>(weights.size(), 0);
+		nodeFeatures.accumulateAll(
+				[&](Crag::CragNode n) { return (n == nodes[1] ? -1 : 1); },
+				batchedGradient,
+				numThreads);
+
+		BOOST_CHECK(batchedGradient[Crag::VolumeNode] == expectedGradient);
+	}
+}
+
+} // anonymous namespace
+
+void feature_expansion() {
+
+	checkExpansion(false, false);
+	checkExpansion(true, false);
+	checkExpansion(false, true);
+	checkExpansion(true, true);
+}
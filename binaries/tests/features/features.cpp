@@ -46,4 +46,34 @@ void features() {
 		BOOST_CHECK_EQUAL(features.dims(Crag::AdjacencyEdge), 2);
 		BOOST_CHECK_EQUAL(features.dims(Crag::NoAssignmentEdge), 0);
 	}
+
+	{
+		NodeFeatures features(crag);
+
+		features.reserve(Crag::VolumeNode, 3, 2);
+
+		// rows grow beyond the reserved size
+		for (int i = 0; i < 5; i++) {
+
+			features.append(n1, i);
+			features.append(n2, 2*i);
+		}
+		features.set(n3, std::vector<double>{0, 0, 0, 0, 0});
+
+		BOOST_CHECK_EQUAL(features.dims(Crag::VolumeNode), 5);
+		BOOST_CHECK_EQUAL(features[n1].size(), 5);
+		BOOST_CHECK_EQUAL(features[n1][4], 4);
+		BOOST_CHECK_EQUAL(features[n2][4], 8);
+		BOOST_CHECK_EQUAL(features[n3][4], 0);
+
+		features.normalize();
+
+		BOOST_CHECK_EQUAL(features[n1][0], 0);
+		BOOST_CHECK_EQUAL(features[n1][4], 0.5);
+		BOOST_CHECK_EQUAL(features[n2][4], 1);
+		BOOST_CHECK_EQUAL(features[n3][4], 0);
+
+		features.append(n1, 1);
+		BOOST_CHECK_THROW(features.dims(Crag::VolumeNode), UsageError);
+	}
 }
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <random>
+#include <tests.h>
+#include <crag/Crag.h>
+#include <features/LeafEdgeSummaries.h>
+#include <features/QuantileSketch.h>
+#include <features/ValueSummary.h>
+
+namespace {
+
+// collects the ids of the summarized leaf edges
+struct EdgeIds {
+
+	void merge(const EdgeIds& other) {
+
+		ids.insert(ids.end(), other.ids.begin(), other.ids.end());
+	}
+
+	std::vector<int> ids;
+};
+
+} // anonymous namespace
+
+void leaf_edge_summaries() {
+
+	Crag crag;
+
+	Crag::CragNode a = crag.addNode();
+	Crag::CragNode b = crag.addNode();
+	Crag::CragNode c = crag.addNode();
+	Crag::CragNode d = crag.addNode();
+	Crag::CragNode p = crag.addNode();
+	Crag::CragNode q = crag.addNode();
+
+	crag.addSubsetArc(a, p);
+	crag.addSubsetArc(b, p);
+	crag.addSubsetArc(c, q);
+	crag.addSubsetArc(d, q);
+
+	Crag::CragEdge ac = crag.addAdjacencyEdge(a, c);
+	Crag::CragEdge bc = crag.addAdjacencyEdge(b, c);
+	Crag::CragEdge bd = crag.addAdjacencyEdge(b, d);
+	Crag::CragEdge pq = crag.addAdjacencyEdge(p, q);
+	Crag::CragEdge aq = crag.addAdjacencyEdge(a, q);
+
+	LeafEdgeSummaries<EdgeIds> summaries(crag);
+
+	int numSummarized = 0;
+	summaries.compute(
+			[&](Crag::CragEdge e) {
+
+				numSummarized++;
+
+				EdgeIds summary;
+				summary.ids.push_back(crag.id(e));
+				return summary;
+			},
+			1);
+
+	BOOST_CHECK_EQUAL(numSummarized, 3);
+
+	std::vector<int> ids = summaries.get(pq).ids;
+	std::sort(ids.begin(), ids.end());
+	BOOST_CHECK_EQUAL(ids.size(), 3);
+	BOOST_CHECK_EQUAL(ids[0], crag.id(ac));
+	BOOST_CHECK_EQUAL(ids[1], crag.id(bc));
+	BOOST_CHECK_EQUAL(ids[2], crag.id(bd));
+
+	ids = summaries.get(aq).ids;
+	BOOST_CHECK_EQUAL(ids.size(), 1);
+	BOOST_CHECK_EQUAL(ids[0], crag.id(ac));
+
+	// merged summaries agree with summaries of all values
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> uniform(0, 1);
+
+	QuantileSketch::Binning binning(0, 1, 1000);
+
+	std::vector<double> values;
+	ValueSummary   summary;
+	QuantileSketch sketch;
+
+	for (int part = 0; part < 5; part++) {
+
+		ValueSummary partSummary;
+		std::vector<unsigned int> bins;
+
+		for (int i = 0; i < 100*(part + 1); i++) {
+
+			double value = uniform(random);
+
+			values.push_back(value);
+			partSummary.add(value);
+			bins.push_back(binning.bin(value));
+		}
+
+		summary.merge(partSummary);
+		sketch.merge(QuantileSketch(bins));
+	}
+
+	double sum = 0;
+	for (double value : values)
+		sum += value;
+
+	BOOST_CHECK_EQUAL(summary.count(), values.size());
+	BOOST_CHECK_EQUAL(sketch.size(), values.size());
+	BOOST_CHECK_CLOSE(summary.mean(), sum/values.size(), 1e-6);
+	BOOST_CHECK_EQUAL(summary.min(), *std::min_element(values.begin(), values.end()));
+	BOOST_CHECK_EQUAL(summary.max(), *std::max_element(values.begin(), values.end()));
+
+	std::sort(values.begin(), values.end());
+
+	for (std::size_t rank : {std::size_t(0), values.size()/4, values.size()/2, values.size() - 1})
+		BOOST_CHECK_SMALL(sketch.valueAtRank(rank, binning) - values[rank], 1e-3);
+}
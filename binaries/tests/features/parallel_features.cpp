@@ -0,0 +1,89 @@
+#include <tests.h>
+#include <cmath>
+#include <features/NodeFeatures.h>
+#include <features/EdgeFeatures.h>
+#include <features/FeatureProvider.h>
+
+namespace parallel_features_test {
+
+class TestFeatureProvider : public FeatureProvider<TestFeatureProvider> {
+
+public:
+
+	TestFeatureProvider(const Crag& crag) : _crag(crag) {}
+
+	template <typename ContainerT>
+	void appendNodeFeatures(const Crag::CragNode n, ContainerT& adaptor) {
+
+		int id = _crag.id(n);
+
+		adaptor.append(id);
+		adaptor.append(sin(id));
+
+		// depends on the features appended so far
+		double sum = 0;
+		for (double f : adaptor.getFeatures())
+			sum += f;
+		adaptor.append(sum);
+	}
+
+	template <typename ContainerT>
+	void appendEdgeFeatures(const Crag::CragEdge e, ContainerT& adaptor) {
+
+		adaptor.append(_crag.id(e.u())*_crag.id(e.v()));
+	}
+
+protected:
+
+	bool supportsParallelExtraction() const override { return true; }
+
+private:
+
+	const Crag& _crag;
+};
+
+} // namespace parallel_features_test
+
+void parallel_features() {
+
+	Crag crag;
+
+	std::vector<Crag::CragNode> nodes;
+	for (int i = 0; i < 10000; i++)
+		nodes.push_back(crag.addNode());
+	for (int i = 1; i < 10000; i++)
+		crag.addAdjacencyEdge(nodes[i-1], nodes[i]);
+
+	NodeFeatures serialNodeFeatures(crag);
+	EdgeFeatures serialEdgeFeatures(crag);
+	NodeFeatures parallelNodeFeatures(crag);
+	EdgeFeatures parallelEdgeFeatures(crag);
+
+	parallel_features_test::TestFeatureProvider provider(crag);
+
+	provider.appendFeatures(crag, serialNodeFeatures);
+	provider.appendFeatures(crag, serialEdgeFeatures);
+
+	provider.setNumThreads(4);
+	provider.appendFeatures(crag, parallelNodeFeatures);
+	provider.appendFeatures(crag, parallelEdgeFeatures);
+
+	BOOST_CHECK_EQUAL(parallelNodeFeatures.dims(Crag::VolumeNode), 3);
+	BOOST_CHECK_EQUAL(parallelEdgeFeatures.dims(Crag::AdjacencyEdge), 1);
+
+	for (Crag::CragNode n : crag.nodes()) {
+
+		FeatureRow serial   = serialNodeFeatures[n];
+		FeatureRow parallel = parallelNodeFeatures[n];
+
+		BOOST_CHECK_EQUAL_COLLECTIONS(serial.begin(), serial.end(), parallel.begin(), parallel.end());
+	}
+
+	for (Crag::CragEdge e : crag.edges()) {
+
+		FeatureRow serial   = serialEdgeFeatures[e];
+		FeatureRow parallel = parallelEdgeFeatures[e];
+
+		BOOST_CHECK_EQUAL_COLLECTIONS(serial.begin(), serial.end(), parallel.begin(), parallel.end());
+	}
+}
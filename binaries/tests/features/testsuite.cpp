@@ -7,7 +7,11 @@ BEGIN_TEST_SUITE(features)
 	ADD_TEST_CASE(overlap)
 	ADD_TEST_CASE(pointiness)
 	ADD_TEST_CASE(features)
+	ADD_TEST_CASE(parallel_features)
+	ADD_TEST_CASE(leaf_edge_summaries)
+	ADD_TEST_CASE(affinity_features)
 	ADD_TEST_CASE(feature_weights)
+	ADD_TEST_CASE(feature_expansion)
 
 END_TEST_SUITE()
 
@@ -0,0 +1,129 @@
+#include <set>
+#include <tests.h>
+#include <inference/CycleSeparator.h>
+
+namespace {
+
+std::set<int>
+pathEdges(const CycleSeparator::Cycle& cycle) {
+
+	return std::set<int>(cycle.path.begin(), cycle.path.end());
+}
+
+} // anonymous namespace
+
+void cycle_separator() {
+
+	/**
+	 *  Adjacencies (selected edges in upper case, n5 is not selected):
+	 *
+	 *         d                   j
+	 *    n1--------n4--n5    n6-------n8
+	 *    | \       |  g        \     /
+	 *   A|  \f     |C          H\   /I
+	 *    |   \     |             \ /
+	 *    n2---n3---+             n7
+	 *       B
+	 */
+
+	Crag crag;
+	Crag::CragNode n1 = crag.addNode();
+	Crag::CragNode n2 = crag.addNode();
+	Crag::CragNode n3 = crag.addNode();
+	Crag::CragNode n4 = crag.addNode();
+	Crag::CragNode n5 = crag.addNode();
+	Crag::CragNode n6 = crag.addNode();
+	Crag::CragNode n7 = crag.addNode();
+	Crag::CragNode n8 = crag.addNode();
+
+	Crag::CragEdge a = crag.addAdjacencyEdge(n1, n2);
+	Crag::CragEdge b = crag.addAdjacencyEdge(n2, n3);
+	Crag::CragEdge c = crag.addAdjacencyEdge(n3, n4);
+	Crag::CragEdge d = crag.addAdjacencyEdge(n1, n4);
+	Crag::CragEdge f = crag.addAdjacencyEdge(n1, n3);
+	Crag::CragEdge g = crag.addAdjacencyEdge(n4, n5);
+	Crag::CragEdge h = crag.addAdjacencyEdge(n6, n7);
+	Crag::CragEdge i = crag.addAdjacencyEdge(n7, n8);
+	Crag::CragEdge j = crag.addAdjacencyEdge(n6, n8);
+
+	CragSolution solution(crag);
+	for (Crag::CragNode n : crag.nodes())
+		solution.setSelected(n, n != n5);
+	for (Crag::CragEdge e : crag.edges())
+		solution.setSelected(e, false);
+	solution.setSelected(a, true);
+	solution.setSelected(b, true);
+	solution.setSelected(c, true);
+	solution.setSelected(h, true);
+	solution.setSelected(i, true);
+
+	CycleSeparator::Parameters parameters;
+	parameters.numThreads = 2;
+
+	{
+		CycleSeparator separator(crag, parameters);
+		std::vector<CycleSeparator::Cycle> cycles = separator.findViolatedCycles(solution);
+
+		// g is cut, but n5 is not selected
+		BOOST_REQUIRE_EQUAL(cycles.size(), 3);
+
+		// shortest first, ties broken by the id of the cut edge
+		BOOST_CHECK_EQUAL(cycles[0].cutEdge, crag.id(f));
+		BOOST_CHECK_EQUAL(cycles[1].cutEdge, crag.id(j));
+		BOOST_CHECK_EQUAL(cycles[2].cutEdge, crag.id(d));
+
+		BOOST_CHECK(pathEdges(cycles[0]) == std::set<int>({crag.id(a), crag.id(b)}));
+		BOOST_CHECK(pathEdges(cycles[1]) == std::set<int>({crag.id(h), crag.id(i)}));
+		BOOST_CHECK(pathEdges(cycles[2]) == std::set<int>({crag.id(a), crag.id(b), crag.id(c)}));
+
+		for (const CycleSeparator::Cycle& cycle : cycles)
+			BOOST_CHECK_EQUAL(cycle.violation, 1.0);
+
+		BOOST_CHECK_EQUAL(separator.getComponent(n1), separator.getComponent(n4));
+		BOOST_CHECK_EQUAL(separator.getComponent(n6), separator.getComponent(n8));
+		BOOST_CHECK(separator.getComponent(n1) != separator.getComponent(n6));
+		BOOST_CHECK_EQUAL(separator.getComponent(n5), -1);
+	}
+
+	{
+		// fractional values make d more violated than f and j
+		std::vector<double> edgeValues(crag.id(j) + 1, 1.0);
+		edgeValues[crag.id(d)] = 0.0;
+		edgeValues[crag.id(f)] = 0.5;
+		edgeValues[crag.id(g)] = 0.0;
+		edgeValues[crag.id(j)] = 0.75;
+
+		parameters.ordering = CycleSeparator::MostViolated;
+		CycleSeparator separator(crag, parameters);
+		std::vector<CycleSeparator::Cycle> cycles = separator.findViolatedCycles(solution, edgeValues);
+
+		BOOST_REQUIRE_EQUAL(cycles.size(), 3);
+		BOOST_CHECK_EQUAL(cycles[0].cutEdge, crag.id(d));
+		BOOST_CHECK_EQUAL(cycles[1].cutEdge, crag.id(f));
+		BOOST_CHECK_EQUAL(cycles[2].cutEdge, crag.id(j));
+		BOOST_CHECK_CLOSE(cycles[0].violation, 1.0,  1e-6);
+		BOOST_CHECK_CLOSE(cycles[1].violation, 0.5,  1e-6);
+		BOOST_CHECK_CLOSE(cycles[2].violation, 0.25, 1e-6);
+	}
+
+	{
+		// only the shortest cycle
+		parameters.ordering  = CycleSeparator::Shortest;
+		parameters.maxCycles = 1;
+		CycleSeparator separator(crag, parameters);
+		std::vector<CycleSeparator::Cycle> cycles = separator.findViolatedCycles(solution);
+
+		BOOST_REQUIRE_EQUAL(cycles.size(), 1);
+		BOOST_CHECK_EQUAL(cycles[0].cutEdge, crag.id(f));
+	}
+
+	{
+		// a consistent solution has no violated cycles
+		solution.setSelected(d, true);
+		solution.setSelected(f, true);
+		solution.setSelected(j, true);
+
+		CycleSeparator separator(crag, parameters);
+		BOOST_CHECK(separator.findViolatedCycles(solution).empty());
+	}
+}
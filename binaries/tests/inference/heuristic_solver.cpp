@@ -0,0 +1,151 @@
+#include <tests.h>
+#include <inference/CycleSeparator.h>
+#include <inference/HeuristicMultiCutSolver.h>
+
+namespace {
+
+// count the selected nodes on each root-to-leaf path
+void
+checkTreePaths(const Crag& crag, const CragSolution& solution, Crag::CragNode n, int numAbove, bool forceExplanation) {
+
+	int numSelected = numAbove + solution.selected(n);
+
+	BOOST_CHECK(numSelected <= 1);
+
+	if (crag.isLeafNode(n) && forceExplanation)
+		BOOST_CHECK_EQUAL(numSelected, 1);
+
+	for (Crag::CragArc a : crag.inArcs(n))
+		checkTreePaths(crag, solution, a.source(), numSelected, forceExplanation);
+}
+
+void
+checkFeasible(const Crag& crag, const CragSolution& solution, bool forceExplanation) {
+
+	for (Crag::CragNode n : crag.nodes())
+		if (crag.isRootNode(n))
+			checkTreePaths(crag, solution, n, 0, forceExplanation);
+
+	// rejected candidates are not merged
+	for (Crag::CragEdge e : crag.edges())
+		if (solution.selected(e))
+			BOOST_CHECK(solution.selected(crag.u(e)) && solution.selected(crag.v(e)));
+
+	// the merges are transitive
+	CycleSeparator separator(crag);
+	BOOST_CHECK(separator.findViolatedCycles(solution).empty());
+}
+
+} // anonymous namespace
+
+void heuristic_solver() {
+
+	/**
+	 *  Subsets:
+	 *
+	 *         n5        n6
+	 *        / \       /  \
+	 *      n1   n2    n3   n4
+	 *
+	 *  Adjacencies:
+	 *
+	 *              d
+	 *         n5--------n6
+	 *           \     /
+	 *
+	 *          e  \ /  f
+	 *
+	 *             / \
+	 *      n1---n2----n3---n4
+	 *         a    b     c
+	 */
+
+	Crag crag;
+	Crag::CragNode n1 = crag.addNode();
+	Crag::CragNode n2 = crag.addNode();
+	Crag::CragNode n3 = crag.addNode();
+	Crag::CragNode n4 = crag.addNode();
+	Crag::CragNode n5 = crag.addNode();
+	Crag::CragNode n6 = crag.addNode();
+
+	crag.addSubsetArc(n1, n5);
+	crag.addSubsetArc(n2, n5);
+	crag.addSubsetArc(n3, n6);
+	crag.addSubsetArc(n4, n6);
+
+	Crag::CragEdge a = crag.addAdjacencyEdge(n1, n2);
+	Crag::CragEdge b = crag.addAdjacencyEdge(n2, n3);
+	Crag::CragEdge c = crag.addAdjacencyEdge(n3, n4);
+	Crag::CragEdge d = crag.addAdjacencyEdge(n5, n6);
+	Crag::CragEdge e = crag.addAdjacencyEdge(n5, n3);
+	Crag::CragEdge f = crag.addAdjacencyEdge(n2, n6);
+
+	HeuristicMultiCutSolver solver(crag);
+	CragSolution x(crag);
+
+	{
+		// merge n1 with n2 and n3 with n4, but not n2 with n3
+		Costs costs(crag);
+		for (Crag::CragNode n : crag.nodes())
+			costs.node[n] = (crag.isLeafNode(n) ? -1 : 10);
+		costs.edge[a] = -2;
+		costs.edge[b] =  3;
+		costs.edge[c] = -2;
+		solver.setCosts(costs);
+
+		BOOST_CHECK_EQUAL(solver.solve(x), HeuristicMultiCutSolver::SolutionFound);
+		checkFeasible(crag, x, false);
+
+		BOOST_CHECK(x.selected(n1) && x.selected(n2) && x.selected(n3) && x.selected(n4));
+		BOOST_CHECK(!x.selected(n5) && !x.selected(n6));
+		BOOST_CHECK(x.selected(a));
+		BOOST_CHECK(!x.selected(b));
+		BOOST_CHECK(x.selected(c));
+		BOOST_CHECK_EQUAL(solver.getValue(), -8);
+	}
+
+	{
+		// n5 is better than its children
+		Costs costs(crag);
+		for (Crag::CragNode n : crag.nodes())
+			costs.node[n] = (crag.isLeafNode(n) ? -1 : 10);
+		costs.node[n5] = -5;
+		costs.edge[a] = -2;
+		costs.edge[b] =  3;
+		costs.edge[c] = -2;
+		solver.setCosts(costs);
+
+		BOOST_CHECK_EQUAL(solver.solve(x), HeuristicMultiCutSolver::SolutionFound);
+		checkFeasible(crag, x, false);
+
+		BOOST_CHECK(x.selected(n5) && x.selected(n3) && x.selected(n4));
+		BOOST_CHECK(!x.selected(n1) && !x.selected(n2) && !x.selected(n6));
+		BOOST_CHECK(x.selected(c));
+		BOOST_CHECK(!x.selected(e));
+		BOOST_CHECK_EQUAL(solver.getValue(), -9);
+	}
+
+	{
+		// everything is expensive, but has to be explained
+		CragSolver::Parameters parameters;
+		parameters.forceExplanation = true;
+		HeuristicMultiCutSolver forcedSolver(crag, parameters);
+
+		Costs costs(crag);
+		for (Crag::CragNode n : crag.nodes())
+			costs.node[n] = 1;
+		costs.edge[d] = -1;
+		costs.edge[e] = -1;
+		costs.edge[f] = -1;
+		forcedSolver.setCosts(costs);
+
+		BOOST_CHECK_EQUAL(forcedSolver.solve(x), HeuristicMultiCutSolver::SolutionFound);
+		checkFeasible(crag, x, true);
+
+		// n5 and n6 explain all leaves with the fewest candidates, and are 
+		// merged
+		BOOST_CHECK(x.selected(n5) && x.selected(n6));
+		BOOST_CHECK(x.selected(d));
+		BOOST_CHECK_EQUAL(forcedSolver.getValue(), 1);
+	}
+}
@@ -0,0 +1,88 @@
+#include <tests.h>
+#include <inference/MultiCutSolver.h>
+
+void multicut_fix() {
+
+	/**
+	 *  Subsets:
+	 *
+	 *         n5
+	 *        / \
+	 *      n1   n2   n3   n4
+	 *
+	 *  Adjacencies:
+	 *
+	 *      n1---n2----n3---n4
+	 *         a    b     c
+	 */
+
+	Crag crag;
+	Crag::CragNode n1 = crag.addNode();
+	Crag::CragNode n2 = crag.addNode();
+	Crag::CragNode n3 = crag.addNode();
+	Crag::CragNode n4 = crag.addNode();
+	Crag::CragNode n5 = crag.addNode();
+
+	crag.addSubsetArc(n1, n5);
+	crag.addSubsetArc(n2, n5);
+
+	Crag::CragEdge a = crag.addAdjacencyEdge(n1, n2);
+	Crag::CragEdge b = crag.addAdjacencyEdge(n2, n3);
+	Crag::CragEdge c = crag.addAdjacencyEdge(n3, n4);
+
+	// merge n1 with n2 and n3 with n4, but not n2 with n3
+	Costs costs(crag);
+	for (Crag::CragNode n : crag.nodes())
+		costs.node[n] = (crag.isLeafNode(n) ? -1 : 10);
+	costs.edge[a] = -2;
+	costs.edge[b] =  3;
+	costs.edge[c] = -2;
+
+	MultiCutSolver solver(crag);
+	solver.setCosts(costs);
+
+	CragSolution x(crag);
+
+	auto checkOptimum = [&]() {
+
+		BOOST_CHECK_EQUAL(solver.solve(x), CragSolver::SolutionFound);
+		BOOST_CHECK(x.selected(n1) && x.selected(n2) && x.selected(n3) && x.selected(n4));
+		BOOST_CHECK(!x.selected(n5));
+		BOOST_CHECK(x.selected(a));
+		BOOST_CHECK(!x.selected(b));
+		BOOST_CHECK(x.selected(c));
+		BOOST_CHECK_EQUAL(solver.getValue(), -8);
+	};
+
+	checkOptimum();
+
+	// force n2 and n3 to be merged
+	solver.fix(b, true);
+	BOOST_CHECK_EQUAL(solver.solve(x), CragSolver::SolutionFound);
+	BOOST_CHECK(x.selected(b));
+	BOOST_CHECK(x.selected(n2) && x.selected(n3));
+	BOOST_CHECK_EQUAL(solver.getValue(), -5);
+
+	solver.release(b);
+	checkOptimum();
+
+	// force n1 and n2 to be separated
+	solver.fix(a, false);
+	BOOST_CHECK_EQUAL(solver.solve(x), CragSolver::SolutionFound);
+	BOOST_CHECK(!x.selected(a));
+	BOOST_CHECK(x.selected(c));
+	BOOST_CHECK_EQUAL(solver.getValue(), -6);
+
+	solver.release(a);
+	checkOptimum();
+
+	// force n5 to be selected instead of n1 and n2
+	solver.fix(n5, true);
+	BOOST_CHECK_EQUAL(solver.solve(x), CragSolver::SolutionFound);
+	BOOST_CHECK(x.selected(n5));
+	BOOST_CHECK(!x.selected(n1) && !x.selected(n2));
+	BOOST_CHECK_EQUAL(solver.getValue(), 10 - 1 - 1 - 2);
+
+	solver.release(n5);
+	checkOptimum();
+}
@@ -3,6 +3,9 @@
 BEGIN_TEST_SUITE(inference)
 
 	ADD_TEST_CASE(closed_set_solver)
+	ADD_TEST_CASE(cycle_separator)
+	ADD_TEST_CASE(heuristic_solver)
+	ADD_TEST_CASE(multicut_fix)
 
 END_TEST_SUITE()
 
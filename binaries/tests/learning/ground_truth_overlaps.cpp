@@ -0,0 +1,84 @@
+#include <tests.h>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <learning/GroundTruthOverlaps.h>
+
+void ground_truth_overlaps() {
+
+	Crag crag;
+	CragVolumes volumes(crag);
+
+	Crag::CragNode a = crag.addNode();
+	Crag::CragNode b = crag.addNode();
+	Crag::CragNode c = crag.addNode();
+	Crag::CragNode e = crag.addNode();
+	Crag::CragNode g = crag.addNode();
+
+	/*     g
+	 *    / \
+	 *   e   \
+	 *  / \   \
+	 * a   b   c
+	 */
+
+	crag.addSubsetArc(a, e);
+	crag.addSubsetArc(b, e);
+	crag.addSubsetArc(e, g);
+	crag.addSubsetArc(c, g);
+
+	// each leaf node covers two voxels of a 6x1x1 volume
+	std::shared_ptr<CragVolume> va = std::make_shared<CragVolume>(2, 1, 1);
+	std::shared_ptr<CragVolume> vb = std::make_shared<CragVolume>(2, 1, 1);
+	std::shared_ptr<CragVolume> vc = std::make_shared<CragVolume>(2, 1, 1);
+	va->data() = 1;
+	vb->data() = 1;
+	vc->data() = 1;
+	va->setOffset(0, 0, 0);
+	vb->setOffset(2, 0, 0);
+	vc->setOffset(4, 0, 0);
+
+	volumes.setVolume(a, va);
+	volumes.setVolume(b, vb);
+	volumes.setVolume(c, vc);
+
+	ExplicitVolume<int> groundTruth(6, 1, 1);
+	groundTruth(0, 0, 0) = 1;
+	groundTruth(1, 0, 0) = 1;
+	groundTruth(2, 0, 0) = 1;
+	groundTruth(3, 0, 0) = 2;
+	groundTruth(4, 0, 0) = 2;
+	groundTruth(5, 0, 0) = 0;
+
+	GroundTruthOverlaps overlaps(crag, volumes, groundTruth, 2);
+
+	BOOST_CHECK_EQUAL(overlaps[a].size(), 1);
+	BOOST_CHECK_EQUAL(overlaps[a].get(1), 2);
+	BOOST_CHECK_EQUAL(overlaps[a].get(2), 0);
+
+	BOOST_CHECK_EQUAL(overlaps[b].size(), 2);
+	BOOST_CHECK_EQUAL(overlaps[b].get(1), 1);
+	BOOST_CHECK_EQUAL(overlaps[b].get(2), 1);
+
+	BOOST_CHECK_EQUAL(overlaps[c].size(), 2);
+	BOOST_CHECK_EQUAL(overlaps[c].get(0), 1);
+	BOOST_CHECK_EQUAL(overlaps[c].get(2), 1);
+
+	BOOST_CHECK_EQUAL(overlaps[e].size(), 2);
+	BOOST_CHECK_EQUAL(overlaps[e].get(1), 3);
+	BOOST_CHECK_EQUAL(overlaps[e].get(2), 1);
+	BOOST_CHECK_EQUAL(overlaps[e].numVoxels(), 4);
+
+	BOOST_CHECK_EQUAL(overlaps[g].size(), 3);
+	BOOST_CHECK_EQUAL(overlaps[g].get(0), 1);
+	BOOST_CHECK_EQUAL(overlaps[g].get(1), 3);
+	BOOST_CHECK_EQUAL(overlaps[g].get(2), 2);
+	BOOST_CHECK_EQUAL(overlaps[g].numVoxels(), 6);
+
+	// overlaps are sorted by label
+	int previous = -1;
+	for (const GroundTruthOverlaps::Overlap& overlap : overlaps[g]) {
+
+		BOOST_CHECK(overlap.label > previous);
+		previous = overlap.label;
+	}
+}
@@ -0,0 +1,266 @@
+#include <limits>
+#include <tests.h>
+#include <crag/Crag.h>
+#include <learning/Loss.h>
+
+namespace {
+
+// check the tree-path constraints on all paths from n to a root, given the 
+// number of selected nodes below n
+bool
+pathsFeasible(const Crag& crag, const Crag::NodeMap<bool>& selected, Crag::CragNode n, int numSelected, bool forceExplanation) {
+
+	numSelected += selected[n];
+
+	if (numSelected > 1)
+		return false;
+
+	if (crag.isRootNode(n))
+		return (!forceExplanation || numSelected == 1);
+
+	for (Crag::CragArc a : crag.outArcs(n))
+		if (!pathsFeasible(crag, selected, a.target(), numSelected, forceExplanation))
+			return false;
+
+	return true;
+}
+
+// the range of the loss over all feasible multi-cut solutions, found by 
+// enumeration
+void
+enumerateRange(const Crag& crag, const Loss& loss, bool forceExplanation, double& min, double& max) {
+
+	std::vector<Crag::CragNode> nodes;
+	std::vector<Crag::CragEdge> edges;
+	for (Crag::CragNode n : crag.nodes())
+		nodes.push_back(n);
+	for (Crag::CragEdge e : crag.edges())
+		edges.push_back(e);
+
+	min =  std::numeric_limits<double>::infinity();
+	max = -std::numeric_limits<double>::infinity();
+
+	unsigned int numVariables = nodes.size() + edges.size();
+
+	for (unsigned int x = 0; x < (1u << numVariables); x++) {
+
+		Crag::NodeMap<bool> selected(crag);
+		for (unsigned int i = 0; i < nodes.size(); i++)
+			selected[nodes[i]] = (x >> i) & 1;
+
+		auto merged = [&](unsigned int i) { return (x >> (nodes.size() + i)) & 1; };
+
+		// tree-path constraints
+		bool feasible = true;
+		for (Crag::CragNode l : crag.nodes())
+			if (crag.isLeafNode(l) && !pathsFeasible(crag, selected, l, 0, forceExplanation))
+				feasible = false;
+
+		// merged nodes have to be selected
+		for (unsigned int i = 0; i < edges.size(); i++)
+			if (merged(i) && (!selected[edges[i].u()] || !selected[edges[i].v()]))
+				feasible = false;
+
+		if (!feasible)
+			continue;
+
+		// cycle constraints: nodes of a not merged edge are not connected
+		Crag::NodeMap<int> component(crag);
+		for (unsigned int i = 0; i < nodes.size(); i++)
+			component[nodes[i]] = i;
+
+		for (bool changed = true; changed;) {
+
+			changed = false;
+			for (unsigned int i = 0; i < edges.size(); i++) {
+
+				if (!merged(i))
+					continue;
+
+				int c = std::min(component[edges[i].u()], component[edges[i].v()]);
+				if (component[edges[i].u()] != c || component[edges[i].v()] != c) {
+
+					component[edges[i].u()] = c;
+					component[edges[i].v()] = c;
+					changed = true;
+				}
+			}
+		}
+
+		for (unsigned int i = 0; i < edges.size(); i++)
+			if (!merged(i) && selected[edges[i].u()] && selected[edges[i].v()] &&
+			    component[edges[i].u()] == component[edges[i].v()])
+				feasible = false;
+
+		if (!feasible)
+			continue;
+
+		double value = 0;
+		for (unsigned int i = 0; i < nodes.size(); i++)
+			if (selected[nodes[i]])
+				value += loss.node[nodes[i]];
+		for (unsigned int i = 0; i < edges.size(); i++)
+			if (merged(i))
+				value += loss.edge[edges[i]];
+
+		min = std::min(min, value);
+		max = std::max(max, value);
+	}
+}
+
+} // anonymous namespace
+
+void loss_normalization() {
+
+	Crag crag;
+
+	Crag::CragNode a = crag.addNode();
+	Crag::CragNode b = crag.addNode();
+	Crag::CragNode c = crag.addNode();
+	Crag::CragNode d = crag.addNode();
+	Crag::CragNode e = crag.addNode();
+	Crag::CragNode f = crag.addNode();
+	Crag::CragNode g = crag.addNode();
+	Crag::CragNode h = crag.addNode();
+
+	/*       g
+	 *     /   \
+	 *    e     f
+	 *   / \   / \
+	 *  a   b c   d   h
+	 */
+
+	crag.addSubsetArc(a, e);
+	crag.addSubsetArc(b, e);
+	crag.addSubsetArc(c, f);
+	crag.addSubsetArc(d, f);
+	crag.addSubsetArc(e, g);
+	crag.addSubsetArc(f, g);
+
+	Crag::CragEdge ab = crag.addAdjacencyEdge(a, b);
+	Crag::CragEdge bc = crag.addAdjacencyEdge(b, c);
+	Crag::CragEdge cd = crag.addAdjacencyEdge(c, d);
+	Crag::CragEdge ef = crag.addAdjacencyEdge(e, f);
+	Crag::CragEdge dh = crag.addAdjacencyEdge(d, h);
+
+	Loss loss(crag);
+	loss.constant = 0;
+	loss.node[a] =  1;
+	loss.node[b] = -2;
+	loss.node[c] =  0.5;
+	loss.node[d] = -1;
+	loss.node[e] =  3;
+	loss.node[f] = -4;
+	loss.node[g] =  2;
+	loss.node[h] =  1.5;
+
+	// without edge values, the bounds are exact
+	for (Crag::CragEdge edge : crag.edges())
+		loss.edge[edge] = 0;
+
+	for (bool forceExplanation : { false, true }) {
+
+		MultiCutSolver::Parameters parameters;
+		parameters.forceExplanation = forceExplanation;
+
+		double min, max, lower, upper;
+		enumerateRange(crag, loss, forceExplanation, min, max);
+		loss.findBounds(crag, parameters, lower, upper);
+
+		BOOST_CHECK_EQUAL(lower, min);
+		BOOST_CHECK_EQUAL(upper, max);
+	}
+
+	// with edge values, the bounds contain the exact range
+	loss.edge[ab] =  2;
+	loss.edge[bc] = -1;
+	loss.edge[cd] =  0.5;
+	loss.edge[ef] = -3;
+	loss.edge[dh] =  1;
+
+	for (bool forceExplanation : { false, true }) {
+
+		MultiCutSolver::Parameters parameters;
+		parameters.forceExplanation = forceExplanation;
+
+		double min, max, lower, upper;
+		enumerateRange(crag, loss, forceExplanation, min, max);
+		loss.findBounds(crag, parameters, lower, upper);
+
+		BOOST_CHECK(lower <= min);
+		BOOST_CHECK(upper >= max);
+
+		// the normalized loss of each solution is in [0,1]
+		Loss normalized(crag);
+		normalized.constant = 0;
+		for (Crag::CragNode n : crag.nodes())
+			normalized.node[n] = loss.node[n];
+		for (Crag::CragEdge edge : crag.edges())
+			normalized.edge[edge] = loss.edge[edge];
+		normalized.normalize(crag, lower, upper);
+
+		double normalizedMin, normalizedMax;
+		enumerateRange(crag, normalized, forceExplanation, normalizedMin, normalizedMax);
+
+		BOOST_CHECK(normalizedMin + normalized.constant >= -1e-10);
+		BOOST_CHECK(normalizedMax + normalized.constant <= 1 + 1e-10);
+	}
+
+	// a subset graph that is not a forest, with a leaf under two parents
+
+	Crag dag;
+
+	Crag::CragNode la = dag.addNode();
+	Crag::CragNode lb = dag.addNode();
+	Crag::CragNode lc = dag.addNode();
+	Crag::CragNode x  = dag.addNode();
+	Crag::CragNode y  = dag.addNode();
+
+	/*    x   y
+	 *   / \ / \
+	 *  b   a   c
+	 */
+
+	dag.addSubsetArc(la, x);
+	dag.addSubsetArc(lb, x);
+	dag.addSubsetArc(la, y);
+	dag.addSubsetArc(lc, y);
+
+	dag.addAdjacencyEdge(la, lb);
+	dag.addAdjacencyEdge(la, lc);
+
+	Loss dagLoss(dag);
+	dagLoss.constant = 0;
+	dagLoss.node[la] = -10;
+	dagLoss.node[lb] =   0;
+	dagLoss.node[lc] =   0;
+	dagLoss.node[x]  = -100;
+	dagLoss.node[y]  = -100;
+	for (Crag::CragEdge edge : dag.edges())
+		dagLoss.edge[edge] = 0;
+
+	for (bool forceExplanation : { false, true }) {
+
+		MultiCutSolver::Parameters parameters;
+		parameters.forceExplanation = forceExplanation;
+
+		double min, max, lower, upper;
+		enumerateRange(dag, dagLoss, forceExplanation, min, max);
+		dagLoss.findBounds(dag, parameters, lower, upper);
+
+		BOOST_CHECK(lower <= min);
+		BOOST_CHECK(upper >= max);
+	}
+
+	// without constraints, all nodes and edges can be selected independently
+	{
+		MultiCutSolver::Parameters parameters;
+		parameters.noConstraints = true;
+
+		double lower, upper;
+		loss.findBounds(crag, parameters, lower, upper);
+
+		BOOST_CHECK_EQUAL(lower, -2 - 1 - 4 - 1 - 3);
+		BOOST_CHECK_EQUAL(upper, 1 + 0.5 + 3 + 2 + 1.5 + 2 + 0.5 + 1);
+	}
+}
@@ -0,0 +1,78 @@
+#include <tests.h>
+#include <learning/SumOracle.h>
+
+namespace {
+
+// an oracle with a constant value and gradient
+class ConstantOracle : public Oracle<FeatureWeights> {
+
+public:
+
+	ConstantOracle(double value, std::vector<double> gradient) :
+		_value(value),
+		_gradient(gradient) {}
+
+	void valueGradientP(
+			const FeatureWeights&,
+			double&               value,
+			FeatureWeights&       gradient) override {
+
+		value = _value;
+		gradient[Crag::VolumeNode] = _gradient;
+	}
+
+private:
+
+	double              _value;
+	std::vector<double> _gradient;
+};
+
+} // anonymous namespace
+
+void sum_oracle() {
+
+	ConstantOracle a(1.0, { 1, 2, 3 });
+	ConstantOracle b(0.5, { 0.25, 0, -1 });
+
+	FeatureWeights weights;
+	weights[Crag::VolumeNode] = std::vector<double>(3, 0);
+
+	for (int numThreads : { 1, 2 }) {
+
+		SumOracle::Parameters parameters;
+		parameters.numThreads = numThreads;
+
+		SumOracle oracle(parameters);
+		oracle.add(a);
+		oracle.add(b);
+
+		double         value;
+		FeatureWeights gradient(weights);
+		oracle.valueGradientP(weights, value, gradient);
+
+		BOOST_CHECK_EQUAL(value, 1.5);
+		BOOST_CHECK(gradient[Crag::VolumeNode] == std::vector<double>({ 1.25, 2, 2 }));
+	}
+
+	// a batch of one oracle is scaled to the number of oracles
+	SumOracle::Parameters parameters;
+	parameters.batchSize = 1;
+
+	SumOracle oracle(parameters);
+	oracle.add(a);
+	oracle.add(b);
+
+	for (int i = 0; i < 10; i++) {
+
+		double         value;
+		FeatureWeights gradient(weights);
+		oracle.valueGradientP(weights, value, gradient);
+
+		if (value == 2.0)
+			BOOST_CHECK(gradient[Crag::VolumeNode] == std::vector<double>({ 2, 4, 6 }));
+		else if (value == 1.0)
+			BOOST_CHECK(gradient[Crag::VolumeNode] == std::vector<double>({ 0.5, 0, -2 }));
+		else
+			BOOST_CHECK(false);
+	}
+}
@@ -3,6 +3,9 @@
 BEGIN_TEST_SUITE(learning)
 
 	ADD_TEST_CASE(hamming_loss)
+	ADD_TEST_CASE(ground_truth_overlaps)
+	ADD_TEST_CASE(loss_normalization)
+	ADD_TEST_CASE(sum_oracle)
 
 END_TEST_SUITE()
 
@@ -0,0 +1,96 @@
+#include <tests.h>
+#include <algorithm>
+#include <random>
+#include <mergetree/EdgeQueue.h>
+#include <mergetree/EdgeHistogram.h>
+
+void edge_queue() {
+
+	EdgeQueue queue;
+
+	queue.push(3, 0.5);
+	queue.push(1, 0.2);
+	queue.push(7, 0.9);
+	queue.push(2, 0.2);
+
+	BOOST_CHECK_EQUAL(queue.size(), 4);
+	BOOST_CHECK_EQUAL(queue.top(), 1);
+
+	// change priorities in both directions
+	queue.push(7, 0.1);
+	BOOST_CHECK_EQUAL(queue.top(), 7);
+	queue.push(7, 1.0);
+	BOOST_CHECK_EQUAL(queue.top(), 1);
+	BOOST_CHECK_EQUAL(queue.size(), 4);
+
+	queue.remove(1);
+	queue.remove(1);
+	BOOST_CHECK(!queue.contains(1));
+	BOOST_CHECK_EQUAL(queue.size(), 3);
+
+	// equal priorities are ordered by id
+	queue.push(0, 0.2);
+	BOOST_CHECK_EQUAL(queue.top(), 0);
+	queue.pop();
+	BOOST_CHECK_EQUAL(queue.top(), 2);
+	queue.pop();
+	BOOST_CHECK_EQUAL(queue.top(), 3);
+	queue.pop();
+	BOOST_CHECK_EQUAL(queue.top(), 7);
+	BOOST_CHECK_EQUAL(queue.topPriority(), 1.0);
+	queue.pop();
+	BOOST_CHECK(queue.empty());
+
+	// random operations against a sorted reference
+	std::mt19937 random(42);
+	std::vector<float> priorities(100, -1);
+
+	for (int i = 0; i < 10000; i++) {
+
+		int id = random()%100;
+
+		if (random()%3 == 0) {
+
+			queue.remove(id);
+			priorities[id] = -1;
+
+		} else {
+
+			float priority = random()%50;
+			queue.push(id, priority);
+			priorities[id] = priority;
+		}
+
+		int best = -1;
+		for (int j = 0; j < 100; j++)
+			if (priorities[j] >= 0 && (best < 0 || priorities[j] < priorities[best]))
+				best = j;
+
+		if (best < 0)
+			BOOST_CHECK(queue.empty());
+		else
+			BOOST_CHECK_EQUAL(queue.top(), best);
+	}
+
+	// histograms
+
+	std::vector<unsigned int> binsA = {5, 1, 5, 3};
+	std::vector<unsigned int> binsB = {2, 5, 9};
+
+	EdgeHistogram a(binsA);
+	EdgeHistogram b(binsB);
+
+	BOOST_CHECK_EQUAL(a.size(), 4);
+
+	a.merge(b);
+	BOOST_CHECK_EQUAL(a.size(), 7);
+
+	// sorted: 1 2 3 5 5 5 9
+	float fraction;
+	BOOST_CHECK_EQUAL(a.rankBin(0, fraction), 1);
+	BOOST_CHECK_EQUAL(a.rankBin(3, fraction), 5);
+	BOOST_CHECK_CLOSE(fraction, 0.5/3, 1e-4);
+	BOOST_CHECK_EQUAL(a.rankBin(5, fraction), 5);
+	BOOST_CHECK_CLOSE(fraction, 2.5/3, 1e-4);
+	BOOST_CHECK_EQUAL(a.rankBin(6, fraction), 9);
+}
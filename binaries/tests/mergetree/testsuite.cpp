@@ -0,0 +1,7 @@
+#include <tests.h>
+
+BEGIN_TEST_SUITE(mergetree)
+
+	ADD_TEST_CASE(edge_queue)
+
+END_TEST_SUITE()
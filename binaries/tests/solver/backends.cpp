@@ -35,6 +35,25 @@ void testSolver(LinearSolverBackend* solver) {
 	BOOST_CHECK_EQUAL(x[0], 1);
 	for (int i = 1; i < numVars; i++)
 		BOOST_CHECK_EQUAL(x[i], 0);
+
+	// add a constraint incrementally, starting from the previous (now 
+	// infeasible) solution
+	LinearConstraints moreConstraints = constraints;
+	LinearConstraint notFirstConstraint;
+	notFirstConstraint.setCoefficient(0, 1.0);
+	notFirstConstraint.setRelation(Equal);
+	notFirstConstraint.setValue(0.0);
+	moreConstraints.add(notFirstConstraint);
+
+	solver->setInitialSolution(x);
+	solver->addConstraints(moreConstraints, constraints.size());
+	solver->solve(x, _);
+
+	BOOST_CHECK_EQUAL(x.getValue(), 4001);
+	BOOST_CHECK_EQUAL(x[1], 1);
+	for (int i = 0; i < numVars; i++)
+		if (i != 1)
+			BOOST_CHECK_EQUAL(x[i], 0);
 }
 
 } using namespace backends_test;
@@ -0,0 +1,93 @@
+#ifndef CANDIDATE_MC_CRAG_AFFILIATED_EDGES_H__
+#define CANDIDATE_MC_CRAG_AFFILIATED_EDGES_H__
+
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include <vigra/multi_gridgraph.hxx>
+
+/**
+ * A read-only view on the affiliated grid edges of a leaf edge. The grid edges 
+ * are stored as their 64-bit ids in the grid graph, which encode the linear 
+ * index of the first voxel and the direction of the edge. They are decoded on 
+ * the fly while iterating.
+ */
+class AffiliatedEdges {
+
+public:
+
+	typedef vigra::GridGraph<3>  GridGraphType;
+	typedef GridGraphType::Edge  GridEdge;
+
+	class const_iterator : public std::iterator<std::random_access_iterator_tag, GridEdge, std::ptrdiff_t, const GridEdge*, GridEdge> {
+
+	public:
+
+		const_iterator() :
+			_gridGraph(0),
+			_id(0) {}
+
+		const_iterator(const GridGraphType& gridGraph, const std::uint64_t* id) :
+			_gridGraph(&gridGraph),
+			_id(id) {}
+
+		GridEdge operator*() const { return _gridGraph->edgeFromId(*_id); }
+
+		GridEdge operator[](std::ptrdiff_t i) const { return _gridGraph->edgeFromId(_id[i]); }
+
+		const_iterator& operator++() { _id++; return *this; }
+		const_iterator& operator--() { _id--; return *this; }
+		const_iterator  operator++(int) { const_iterator i(*this); _id++; return i; }
+		const_iterator  operator--(int) { const_iterator i(*this); _id--; return i; }
+
+		const_iterator& operator+=(std::ptrdiff_t n) { _id += n; return *this; }
+		const_iterator& operator-=(std::ptrdiff_t n) { _id -= n; return *this; }
+		const_iterator  operator+(std::ptrdiff_t n) const { return const_iterator(*_gridGraph, _id + n); }
+		const_iterator  operator-(std::ptrdiff_t n) const { return const_iterator(*_gridGraph, _id - n); }
+
+		std::ptrdiff_t operator-(const const_iterator& other) const { return _id - other._id; }
+
+		bool operator==(const const_iterator& other) const { return _id == other._id; }
+		bool operator!=(const const_iterator& other) const { return _id != other._id; }
+		bool operator<(const const_iterator& other) const { return _id < other._id; }
+
+	private:
+
+		const GridGraphType* _gridGraph;
+		const std::uint64_t* _id;
+	};
+
+	AffiliatedEdges(const GridGraphType& gridGraph, const std::uint64_t* begin, const std::uint64_t* end) :
+		_gridGraph(gridGraph),
+		_begin(begin),
+		_end(end) {}
+
+	const_iterator begin() const { return const_iterator(_gridGraph, _begin); }
+
+	const_iterator end() const { return const_iterator(_gridGraph, _end); }
+
+	std::size_t size() const { return _end - _begin; }
+
+	bool empty() const { return _begin == _end; }
+
+	GridEdge operator[](std::size_t i) const { return _gridGraph.edgeFromId(_begin[i]); }
+
+	/**
+	 * Get the ids of the grid edges in the grid graph.
+	 */
+	const std::uint64_t* ids() const { return _begin; }
+
+	/**
+	 * Decode all grid edges into a vector.
+	 */
+	std::vector<GridEdge> toVector() const { return std::vector<GridEdge>(begin(), end()); }
+
+private:
+
+	const GridGraphType& _gridGraph;
+	const std::uint64_t* _begin;
+	const std::uint64_t* _end;
+};
+
+#endif // CANDIDATE_MC_CRAG_AFFILIATED_EDGES_H__
+
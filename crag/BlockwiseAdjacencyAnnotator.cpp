@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <limits>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include <util/timing.h>
+#include "BlockwiseAdjacencyAnnotator.h"
+
+logger::LogChannel blockwiseadjacencyannotatorlog("blockwiseadjacencyannotatorlog", "[BlockwiseAdjacencyAnnotator] ");
+
+extern util::ProgramOption optionCragType;
+
+namespace {
+
+// the largest coordinate that can be packed
+const unsigned int MaxCoordinate = (1u << 20) - 1;
+
+} // anonymous namespace
+
+BlockwiseAdjacencyAnnotator::BlockwiseAdjacencyAnnotator() :
+	_lastPair(0, 0),
+	_lastFaces(0),
+	_nextSection(0) {
+
+	for (int d = 0; d < 3; d++) {
+
+		_min[d] = std::numeric_limits<unsigned int>::max();
+		_max[d] = 0;
+	}
+}
+
+void
+BlockwiseAdjacencyAnnotator::addSlab(const vigra::MultiArrayView<3, int>& labels, unsigned int firstSection) {
+
+	if (firstSection != _nextSection)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"expected slab starting at section " << _nextSection << ", got " << firstSection);
+
+	unsigned int width  = labels.shape(0);
+	unsigned int height = labels.shape(1);
+	unsigned int depth  = labels.shape(2);
+
+	if (width > MaxCoordinate || height > MaxCoordinate || firstSection + depth > MaxCoordinate)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"label volumes larger than " << MaxCoordinate << " voxels in any dimension are not supported");
+
+	bool hasPrevious = (_previousSection.size() > 0);
+
+	if (hasPrevious && (_previousSection.shape(0) != width || _previousSection.shape(1) != height))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"slabs have to have the same size in x and y");
+
+	for (unsigned int z = 0; z < depth;  z++)
+	for (unsigned int y = 0; y < height; y++)
+	for (unsigned int x = 0; x < width;  x++) {
+
+		int label = labels(x, y, z);
+
+		if (label == 0)
+			continue;
+
+		unsigned int position[3] = { x, y, firstSection + z };
+		for (int d = 0; d < 3; d++) {
+
+			_min[d] = std::min(_min[d], position[d]);
+			_max[d] = std::max(_max[d], position[d] + 1);
+		}
+
+		if (x + 1 < width) {
+
+			int neighbor = labels(x + 1, y, z);
+			if (neighbor != 0 && neighbor != label)
+				addFace(label, neighbor, x, y, firstSection + z, 0);
+		}
+
+		if (y + 1 < height) {
+
+			int neighbor = labels(x, y + 1, z);
+			if (neighbor != 0 && neighbor != label)
+				addFace(label, neighbor, x, y, firstSection + z, 1);
+		}
+
+		if (z + 1 < depth) {
+
+			int neighbor = labels(x, y, z + 1);
+			if (neighbor != 0 && neighbor != label)
+				addFace(label, neighbor, x, y, firstSection + z, 2);
+		}
+
+		// across the slab border
+		if (z == 0 && hasPrevious) {
+
+			int neighbor = _previousSection(x, y);
+			if (neighbor != 0 && neighbor != label)
+				addFace(neighbor, label, x, y, firstSection - 1, 2);
+		}
+	}
+
+	if (depth > 0)
+		_previousSection = labels.bind<2>(depth - 1);
+
+	_nextSection = firstSection + depth;
+}
+
+void
+BlockwiseAdjacencyAnnotator::addFace(int a, int b, unsigned int x, unsigned int y, unsigned int z, unsigned int direction) {
+
+	std::pair<int, int> labelPair(std::min(a, b), std::max(a, b));
+
+	if (!_lastFaces || labelPair != _lastPair) {
+
+		_lastPair  = labelPair;
+		_lastFaces = &_faces[labelPair];
+	}
+
+	_lastFaces->push_back(pack(x, y, z, direction));
+}
+
+void
+BlockwiseAdjacencyAnnotator::annotate(Crag& crag, const CragVolumes& /*volumes*/) {
+
+	if (optionCragType.as<std::string>() == "empty")
+		return;
+
+	UTIL_TIME_METHOD;
+
+	// no labels?
+	if (_min[0] > _max[0])
+		return;
+
+	typedef vigra::GridGraph<3> GridGraphType;
+
+	GridGraphType grid(
+			vigra::Shape3(
+					_max[0] - _min[0],
+					_max[1] - _min[1],
+					_max[2] - _min[2]),
+			vigra::DirectNeighborhood);
+	crag.setGridGraph(grid);
+
+	const vigra::Shape3 steps[3] = {
+			vigra::Shape3(1, 0, 0),
+			vigra::Shape3(0, 1, 0),
+			vigra::Shape3(0, 0, 1)
+	};
+
+	unsigned int numAdded = 0;
+	std::vector<std::uint64_t> ids;
+
+	for (auto& p : _faces) {
+
+		int a = p.first.first;
+		int b = p.first.second;
+
+		if (!_labelNodes.count(a) || !_labelNodes.count(b))
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"no node given for label " << (_labelNodes.count(a) ? b : a));
+
+		Crag::CragEdge newEdge = crag.addAdjacencyEdge(
+				_labelNodes[a],
+				_labelNodes[b]);
+
+		ids.clear();
+		for (std::uint64_t face : p.second) {
+
+			vigra::Shape3 u(
+					((face >>  2) & MaxCoordinate) - _min[0],
+					((face >> 22) & MaxCoordinate) - _min[1],
+					((face >> 42) & MaxCoordinate) - _min[2]);
+			vigra::Shape3 v = u + steps[face & 3];
+
+			ids.push_back(grid.id(grid.findEdge(u, v)));
+		}
+		std::sort(ids.begin(), ids.end());
+
+		crag.setAffiliatedEdges(newEdge, ids.data(), ids.data() + ids.size());
+
+		// not needed anymore
+		std::vector<std::uint64_t>().swap(p.second);
+		numAdded++;
+
+		LOG_ALL(blockwiseadjacencyannotatorlog)
+				<< "adding leaf node adjacency between labels "
+				<< a << " and " << b << std::endl;
+	}
+
+	_faces.clear();
+	_lastFaces = 0;
+
+	LOG_USER(blockwiseadjacencyannotatorlog)
+			<< "added " << numAdded << " leaf node adjacency edges"
+			<< std::endl;
+
+	if (optionCragType.as<std::string>() == "full")
+		propagateLeafAdjacencies(crag);
+}
+
@@ -0,0 +1,85 @@
+#ifndef CANDIDATE_MC_CRAG_BLOCKWISE_ADJACENCY_ANNOTATOR_H__
+#define CANDIDATE_MC_CRAG_BLOCKWISE_ADJACENCY_ANNOTATOR_H__
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <vigra/multi_array.hxx>
+#include "AdjacencyAnnotator.h"
+
+/**
+ * An adjacency annotator that finds the adjacencies of leaf nodes while a 
+ * label volume is read slab by slab, such that the label volume never has to 
+ * be kept in memory as a whole. Two leaf nodes are adjacent, if their labels 
+ * are direct (6-) neighbors.
+ *
+ * Feed the slabs in order with addSlab(), tell the annotator which node 
+ * belongs to which label with setLabelNodes(), and call annotate() on the 
+ * CRAG the labels were imported into.
+ */
+class BlockwiseAdjacencyAnnotator : public AdjacencyAnnotator {
+
+public:
+
+	BlockwiseAdjacencyAnnotator();
+
+	/**
+	 * Find the adjacencies in the next slab of labels, including the ones to 
+	 * the last section of the previous slab. Label 0 is background.
+	 *
+	 * @param labels
+	 *              The labels of the slab.
+	 * @param firstSection
+	 *              The index of the first section of the slab in the volume. 
+	 *              Slabs have to be added in order, without gaps.
+	 */
+	void addSlab(const vigra::MultiArrayView<3, int>& labels, unsigned int firstSection);
+
+	/**
+	 * Set the leaf node for each label.
+	 */
+	void setLabelNodes(const std::map<int, Crag::Node>& labelNodes) { _labelNodes = labelNodes; }
+
+	/**
+	 * Add the found adjacency edges and their affiliated edges to the CRAG. 
+	 * The grid graph of the CRAG spans the bounding box of all non-background 
+	 * labels, as for the PlanarAdjacencyAnnotator.
+	 */
+	void annotate(Crag& crag, const CragVolumes& volumes) override;
+
+private:
+
+	// record the face between voxel (x, y, z) and its neighbor in the given 
+	// direction
+	void addFace(int a, int b, unsigned int x, unsigned int y, unsigned int z, unsigned int direction);
+
+	static std::uint64_t pack(unsigned int x, unsigned int y, unsigned int z, unsigned int direction) {
+
+		return
+				((std::uint64_t)z << 42) |
+				((std::uint64_t)y << 22) |
+				((std::uint64_t)x <<  2) |
+				direction;
+	}
+
+	// the faces between each pair of labels, packed as position of the first 
+	// voxel and direction to the second
+	std::map<std::pair<int, int>, std::vector<std::uint64_t>> _faces;
+
+	// the faces of the last label pair, to avoid a lookup per face
+	std::pair<int, int>         _lastPair;
+	std::vector<std::uint64_t>* _lastFaces;
+
+	// the last section of the previous slab
+	vigra::MultiArray<2, int> _previousSection;
+	unsigned int              _nextSection;
+
+	// bounding box of all non-background labels
+	unsigned int _min[3];
+	unsigned int _max[3];
+
+	std::map<int, Crag::Node> _labelNodes;
+};
+
+#endif // CANDIDATE_MC_CRAG_BLOCKWISE_ADJACENCY_ANNOTATOR_H__
+
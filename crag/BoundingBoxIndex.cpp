@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <util/Logger.h>
+#include "BoundingBoxIndex.h"
+
+logger::LogChannel boundingboxindexlog("boundingboxindexlog", "[BoundingBoxIndex] ");
+
+BoundingBoxIndex::BoundingBoxIndex(const Crag& crag, const CragVolumes& volumes) :
+	_minX(0),
+	_minY(0),
+	_cellSize(1),
+	_width(1),
+	_height(1) {
+
+	for (Crag::CragNode n : crag.nodes()) {
+
+		_nodes.push_back(n);
+		_boxes.push_back(volumes.getBoundingBox(n).project<2>());
+	}
+
+	if (_nodes.empty()) {
+
+		_cellBegin.resize(2, 0);
+		return;
+	}
+
+	float maxX = _boxes[0].max().x();
+	float maxY = _boxes[0].max().y();
+	_minX = _boxes[0].min().x();
+	_minY = _boxes[0].min().y();
+
+	double meanExtent = 0;
+	for (const util::box<float, 2>& box : _boxes) {
+
+		_minX = std::min(_minX, box.min().x());
+		_minY = std::min(_minY, box.min().y());
+		maxX  = std::max(maxX, box.max().x());
+		maxY  = std::max(maxY, box.max().y());
+
+		meanExtent += std::max(box.width(), box.height());
+	}
+	meanExtent /= _boxes.size();
+
+	// cells of about the size of a box, such that each box intersects only a 
+	// few cells, but not more cells than a few per box
+	double extentX = std::max(maxX - _minX, 1.0f);
+	double extentY = std::max(maxY - _minY, 1.0f);
+	double maxCells = 4.0*_boxes.size();
+
+	_cellSize = std::max(meanExtent, 1.0);
+	_cellSize = std::max((double)_cellSize, std::sqrt(extentX*extentY/maxCells));
+
+	_width  = std::max(1, (int)std::ceil(extentX/_cellSize));
+	_height = std::max(1, (int)std::ceil(extentY/_cellSize));
+
+	// count the entries per cell, then fill them
+
+	_cellBegin.resize(_width*_height + 1, 0);
+
+	for (const util::box<float, 2>& box : _boxes)
+		for (int y = cellY(box.min().y()); y <= cellY(box.max().y()); y++)
+		for (int x = cellX(box.min().x()); x <= cellX(box.max().x()); x++)
+			_cellBegin[y*_width + x + 1]++;
+
+	for (std::size_t c = 1; c < _cellBegin.size(); c++)
+		_cellBegin[c] += _cellBegin[c - 1];
+
+	std::vector<std::size_t> next(_cellBegin.begin(), _cellBegin.end() - 1);
+	_cellEntries.resize(_cellBegin.back());
+
+	for (std::size_t i = 0; i < _boxes.size(); i++) {
+
+		const util::box<float, 2>& box = _boxes[i];
+
+		for (int y = cellY(box.min().y()); y <= cellY(box.max().y()); y++)
+		for (int x = cellX(box.min().x()); x <= cellX(box.max().x()); x++)
+			_cellEntries[next[y*_width + x]++] = i;
+	}
+
+	LOG_DEBUG(boundingboxindexlog)
+			<< "indexed " << _boxes.size() << " bounding boxes in a grid of "
+			<< _width << "x" << _height << " cells of size " << _cellSize
+			<< " with " << _cellEntries.size() << " entries" << std::endl;
+}
+
+std::vector<Crag::CragNode>
+BoundingBoxIndex::intersecting(const util::box<float, 2>& query) const {
+
+	std::vector<Crag::CragNode> nodes;
+
+	if (_nodes.empty())
+		return nodes;
+
+	for (int y = cellY(query.min().y()); y <= cellY(query.max().y()); y++)
+	for (int x = cellX(query.min().x()); x <= cellX(query.max().x()); x++) {
+
+		int cell = y*_width + x;
+
+		for (std::size_t e = _cellBegin[cell]; e < _cellBegin[cell + 1]; e++) {
+
+			const util::box<float, 2>& box = _boxes[_cellEntries[e]];
+
+			if (box.max().x() < query.min().x() || query.max().x() < box.min().x() ||
+			    box.max().y() < query.min().y() || query.max().y() < box.min().y())
+				continue;
+
+			// a box is in several cells, report it only in the cell that 
+			// contains the lower corner of the intersection
+			if (cellX(std::max(box.min().x(), query.min().x())) != x ||
+			    cellY(std::max(box.min().y(), query.min().y())) != y)
+				continue;
+
+			nodes.push_back(_nodes[_cellEntries[e]]);
+		}
+	}
+
+	return nodes;
+}
+
+std::vector<Crag::CragNode>
+BoundingBoxIndex::withinDistance(const util::box<float, 2>& box, float distance) const {
+
+	return intersecting(
+			util::box<float, 2>(
+					util::point<float, 2>(box.min().x() - distance, box.min().y() - distance),
+					util::point<float, 2>(box.max().x() + distance, box.max().y() + distance)));
+}
+
+int
+BoundingBoxIndex::cellX(float x) const {
+
+	return std::min(_width - 1, std::max(0, (int)std::floor((x - _minX)/_cellSize)));
+}
+
+int
+BoundingBoxIndex::cellY(float y) const {
+
+	return std::min(_height - 1, std::max(0, (int)std::floor((y - _minY)/_cellSize)));
+}
+
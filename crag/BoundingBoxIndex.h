@@ -0,0 +1,64 @@
+#ifndef CANDIDATE_MC_CRAG_BOUNDING_BOX_INDEX_H__
+#define CANDIDATE_MC_CRAG_BOUNDING_BOX_INDEX_H__
+
+#include <vector>
+#include <util/box.hpp>
+#include "Crag.h"
+#include "CragVolumes.h"
+
+/**
+ * A uniform grid over the bounding boxes (in the x-y plane) of the nodes of a 
+ * CRAG, to find the nodes close to a query region without visiting all of 
+ * them. The bounding boxes are taken from the CragVolumes, without 
+ * materializing the volumes. Queries can be issued concurrently.
+ */
+class BoundingBoxIndex {
+
+public:
+
+	/**
+	 * Index all nodes of the given CRAG.
+	 */
+	BoundingBoxIndex(const Crag& crag, const CragVolumes& volumes);
+
+	/**
+	 * Get all nodes with a bounding box that intersects the given box. Each 
+	 * node is reported once.
+	 */
+	std::vector<Crag::CragNode> intersecting(const util::box<float, 2>& box) const;
+
+	/**
+	 * Get all nodes with a bounding box that is not further than distance 
+	 * away from the given box in x or y.
+	 */
+	std::vector<Crag::CragNode> withinDistance(const util::box<float, 2>& box, float distance) const;
+
+	/**
+	 * The number of indexed nodes.
+	 */
+	std::size_t size() const { return _nodes.size(); }
+
+private:
+
+	int cellX(float x) const;
+	int cellY(float y) const;
+
+	// the indexed nodes and their bounding boxes
+	std::vector<Crag::CragNode>      _nodes;
+	std::vector<util::box<float, 2>> _boxes;
+
+	// the grid
+	float _minX;
+	float _minY;
+	float _cellSize;
+	int   _width;
+	int   _height;
+
+	// the indices of the boxes intersecting cell c are 
+	// _cellEntries[_cellBegin[c]] to _cellEntries[_cellBegin[c+1]-1]
+	std::vector<std::size_t> _cellBegin;
+	std::vector<std::size_t> _cellEntries;
+};
+
+#endif // CANDIDATE_MC_CRAG_BOUNDING_BOX_INDEX_H__
+
@@ -1,3 +1,4 @@
+#include <iterator>
 #include "Crag.h"
 #include <util/assert.h>
 
@@ -6,102 +7,104 @@ Crag::CragNode Crag::Invalid;
 const std::vector<Crag::NodeType> Crag::NodeTypes = { VolumeNode, SliceNode, AssignmentNode, NoAssignmentNode };
 const std::vector<Crag::EdgeType> Crag::EdgeTypes = { AdjacencyEdge, SeparationEdge, AssignmentEdge, NoAssignmentEdge };
 
-int
-Crag::getLevel(Crag::CragNode n) const {
-
-	if (isLeafNode(n))
-		return 0;
+std::vector<Crag::CragEdge>
+Crag::leafEdges(CragEdge e) const {
 
-	int level = 0;
-	for (SubsetInArcIt e(getSubsetGraph(), toSubset(n)); e != lemon::INVALID; ++e)
-		level = std::max(getLevel(toRag(getSubsetGraph().source(e))), level);
+	CragHierarchy::NodeRange uLeafNodes = _hierarchy.leafNodes(e.u());
+	CragHierarchy::NodeRange vLeafNodes = _hierarchy.leafNodes(e.v());
 
-	return level + 1;
-}
+	// iterate over the smaller of both sets
+	CragNode a = e.u();
+	CragNode b = e.v();
+	CragHierarchy::NodeRange leaves = uLeafNodes;
+	if (vLeafNodes.second - vLeafNodes.first < uLeafNodes.second - uLeafNodes.first) {
 
-std::set<Crag::CragNode>
-Crag::leafNodes(CragNode n) const {
+		std::swap(a, b);
+		leaves = vLeafNodes;
+	}
 
-	std::set<CragNode> leafNodes;
-	recLeafNodes(n, leafNodes);
-
-	return leafNodes;
-}
+	std::vector<RagType::Edge> leafEdges;
 
-std::set<Crag::CragEdge>
-Crag::leafEdges(CragNode n) const {
+	for (const RagType::Node* l = leaves.first; l != leaves.second; l++)
+		for (CragEdge f : adjEdges(*l)) {
 
-	std::set<CragNode> nleafNodes = leafNodes(n);
-	std::set<CragEdge> leafEdges;
+			CragNode other = oppositeNode(*l, f);
 
-	for (CragNode u : nleafNodes)
-		for (CragNode v : nleafNodes) {
+			if (!isLeafNode(other) || !_hierarchy.containsLeaf(b, other))
+				continue;
 
-			if (id(u) >= id(v))
+			// edges with both leaves under a and b are found from both leaves, 
+			// count them only once
+			if (_hierarchy.containsLeaf(a, other) && _hierarchy.containsLeaf(b, *l) && id(other) < id(*l))
 				continue;
 
-			for (CragEdge e : adjEdges(u))
-				if (isLeafEdge(e))
-					if (nleafNodes.count(oppositeNode(u, e)))
-						leafEdges.insert(e);
+			leafEdges.push_back(f);
 		}
 
-	return leafEdges;
+	return toSortedCragEdges(leafEdges);
 }
 
-std::set<Crag::CragEdge>
-Crag::leafEdges(CragEdge e) const {
+std::vector<Crag::CragEdge>
+Crag::descendantEdges(CragEdge e) const {
 
-	std::set<CragEdge> leafEdges;
-	std::set<CragNode> uLeafNodes;
-	std::set<CragNode> vLeafNodes;
+	std::vector<CragEdge> descendants;
+	for (CragEdge f : descendantEdges(e.u(), e.v()))
+		if (id(f) != id(e))
+			descendants.push_back(f);
+
+	return descendants;
+}
 
-	recLeafNodes(u(e), uLeafNodes);
-	recLeafNodes(v(e), vLeafNodes);
+std::vector<Crag::CragEdge>
+Crag::descendantEdges(CragNode u, CragNode v) const {
 
-	for (CragNode n : uLeafNodes)
-		for (CragEdge e : adjEdges(n))
-			if (isLeafEdge(e))
-				if (vLeafNodes.count(oppositeNode(n, e)))
-					leafEdges.insert(e);
+	std::vector<RagType::Edge> descendants;
 
-	return leafEdges;
-}
+	if (!_hierarchy.isForest()) {
 
-std::set<Crag::CragEdge>
-Crag::descendantEdges(CragEdge e) const {
+		std::set<CragEdge> uEdges;
+		std::set<CragEdge> vEdges;
+		recCollectEdges(u, uEdges);
+		recCollectEdges(v, vEdges);
 
-	std::set<CragEdge> descendants = descendantEdges(e.u(), e.v());
-	descendants.erase(e);
+		std::set_intersection(
+			uEdges.begin(), uEdges.end(),
+			vEdges.begin(), vEdges.end(),
+			std::back_inserter(descendants));
 
-	return descendants;
-}
+		return toSortedCragEdges(descendants);
+	}
 
-std::set<Crag::CragEdge>
-Crag::descendantEdges(CragNode u, CragNode v) const {
+	// iterate over the smaller of both subtrees, and find the edges to nodes 
+	// in the other one
+	CragHierarchy::NodeRange uNodes = _hierarchy.containedNodes(u);
+	CragHierarchy::NodeRange vNodes = _hierarchy.containedNodes(v);
 
-	std::set<CragEdge> uEdges;
-	std::set<CragEdge> vEdges;
-	recCollectEdges(u, uEdges);
-	recCollectEdges(v, vEdges);
+	CragNode a = u;
+	CragNode b = v;
+	CragHierarchy::NodeRange nodes = uNodes;
+	if (vNodes.second - vNodes.first < uNodes.second - uNodes.first) {
 
-	std::set<CragEdge> descendants;
-	std::set_intersection(
-		uEdges.begin(), uEdges.end(),
-		vEdges.begin(), vEdges.end(),
-		std::inserter(descendants, descendants.end()));
+		std::swap(a, b);
+		nodes = vNodes;
+	}
 
-	return descendants;
-}
+	for (const RagType::Node* n = nodes.first; n != nodes.second; n++)
+		for (CragEdge f : adjEdges(*n)) {
 
-void
-Crag::recLeafNodes(CragNode n, std::set<CragNode>& leafNodes) const {
+			CragNode other = oppositeNode(*n, f);
 
-	if (isLeafNode(n))
-		leafNodes.insert(n);
-	else
-		for (auto a : inArcs(n))
-			recLeafNodes(a.source(), leafNodes);
+			if (!_hierarchy.isContained(*n, b) && !_hierarchy.isContained(other, b))
+				continue;
+
+			// count edges within the intersection of both subtrees only once
+			if (_hierarchy.isContained(other, a) && id(other) < id(*n))
+				continue;
+
+			descendants.push_back(f);
+		}
+
+	return toSortedCragEdges(descendants);
 }
 
 void
@@ -113,3 +116,36 @@ Crag::recCollectEdges(Crag::CragNode n, std::set<Crag::CragEdge>& edges) const {
 	for (Crag::CragArc a : inArcs(n))
 		recCollectEdges(a.source(), edges);
 }
+
+std::vector<Crag::CragEdge>
+Crag::toSortedCragEdges(std::vector<RagType::Edge>& edges) const {
+
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<CragEdge> cragEdges;
+	cragEdges.reserve(edges.size());
+	for (RagType::Edge e : edges)
+		cragEdges.push_back(CragEdge(*this, e));
+
+	return cragEdges;
+}
+
+std::uint64_t*
+Crag::allocateAffiliatedEdges(CragEdge e, std::size_t size) {
+
+	if (!isLeafEdge(e))
+		UTIL_THROW_EXCEPTION(UsageError, "affiliated edges can only be set for leaf edges");
+
+	AffiliatedEdgeRange& range = _affiliatedEdgeRanges[e];
+
+	// reuse the previous range of this edge, if large enough
+	if (size > range.end - range.begin) {
+
+		range.begin = _affiliatedEdgeIds.size();
+		_affiliatedEdgeIds.resize(_affiliatedEdgeIds.size() + size);
+	}
+
+	range.end = range.begin + size;
+
+	return _affiliatedEdgeIds.data() + range.begin;
+}
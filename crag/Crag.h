@@ -1,11 +1,14 @@
 #ifndef CANDIDATE_MC_CRAG_CRAG_H__
 #define CANDIDATE_MC_CRAG_CRAG_H__
 
+#include <algorithm>
 #include <set>
 #include <lemon/list_graph.h>
 #define WITH_LEMON
 #include <vigra/multi_gridgraph.hxx>
 #include <util/exceptions.h>
+#include "AffiliatedEdges.h"
+#include "CragHierarchy.h"
 
 /**
  * Candidate region adjacency graph.
@@ -244,9 +247,10 @@ public:
 	#include "CragIterators.h"
 
 	Crag() :
+		_hierarchy(_rag, _ssg),
 		_nodeTypes(_rag),
 		_edgeTypes(_rag),
-		_affiliatedEdges(_rag) {}
+		_affiliatedEdgeRanges(_rag) {}
 
 	virtual ~Crag() {}
 
@@ -361,23 +365,40 @@ public:
 
 	/**
 	 * Associate affiliated edges to a pair of adjacent leaf node regions. It is 
-	 * assumed that an adjacency edge has already been added between u and v.
+	 * assumed that an adjacency edge has already been added between u and v, 
+	 * and that the grid graph has been set.
 	 */
 	void setAffiliatedEdges(CragEdge e, const std::vector<vigra::GridGraph<3>::Edge>& edges) {
 
-		if (!isLeafEdge(e))
-			UTIL_THROW_EXCEPTION(UsageError, "affiliated edges can only be set for leaf edges");
-		 _affiliatedEdges[e] = edges;
+		std::uint64_t* ids = allocateAffiliatedEdges(e, edges.size());
+		for (const vigra::GridGraph<3>::Edge& edge : edges)
+			*ids++ = _gridGraph.id(edge);
 	}
 
 	/**
-	 * Get affiliated edges for a leaf edge.
+	 * Associate affiliated edges to a pair of adjacent leaf node regions, given 
+	 * by their ids in the grid graph.
 	 */
-	const std::vector<vigra::GridGraph<3>::Edge>& getAffiliatedEdges(CragEdge e) const {
+	void setAffiliatedEdges(CragEdge e, const std::uint64_t* begin, const std::uint64_t* end) {
+
+		std::copy(begin, end, allocateAffiliatedEdges(e, end - begin));
+	}
+
+	/**
+	 * Get affiliated edges for a leaf edge. The returned view is invalidated by 
+	 * setting affiliated edges.
+	 */
+	AffiliatedEdges getAffiliatedEdges(CragEdge e) const {
 
 		if (!isLeafEdge(e))
 			UTIL_THROW_EXCEPTION(UsageError, "affiliated edges only set for leaf edges");
-		return _affiliatedEdges[e];
+
+		const AffiliatedEdgeRange& range = _affiliatedEdgeRanges[e];
+
+		return AffiliatedEdges(
+				_gridGraph,
+				_affiliatedEdgeIds.data() + range.begin,
+				_affiliatedEdgeIds.data() + range.end);
 	}
 
 	const vigra::GridGraph<3>& getGridGraph() const { return _gridGraph; }
@@ -394,7 +415,22 @@ public:
 	 * Get the level of a node, i.e., the size of the longest subset-tree path 
 	 * to a leaf node. Leaf nodes have a value of zero.
 	 */
-	int getLevel(Crag::CragNode n) const;
+	int getLevel(Crag::CragNode n) const { return _hierarchy.getLevel(n); }
+
+	/**
+	 * Return true if the subset graph is a forest, i.e., no node has more than 
+	 * one parent.
+	 */
+	bool isForest() const { return _hierarchy.isForest(); }
+
+	/**
+	 * Return true if n is a descendant of (i.e., a subset of) the given 
+	 * ancestor.
+	 */
+	bool isDescendant(Crag::CragNode n, Crag::CragNode ancestor) const {
+
+		return (n != ancestor && _hierarchy.isContained(n, ancestor));
+	}
 
 	/**
 	 * Return true for candidates that are leaf nodes in the subset graph.
@@ -488,51 +524,71 @@ public:
 	const EdgeMap<EdgeType>& edgeTypes() const { return _edgeTypes; }
 
 	/**
-	 * Get all leaf nodes under the given node n.
+	 * Get all leaf nodes under the given node n. The returned span is 
+	 * invalidated by modifications of the CRAG.
 	 */
-	std::set<CragNode> leafNodes(CragNode n) const;
+	CragNodeSpan leafNodes(CragNode n) const { return CragNodeSpan(_hierarchy.leafNodes(n)); }
 
 	/**
-	 * Get all leaf edges under the given node n.
+	 * Get all leaf edges under the given node n. The returned span is 
+	 * invalidated by modifications of the CRAG.
 	 */
-	std::set<CragEdge> leafEdges(CragNode n) const;
+	CragEdgeSpan leafEdges(CragNode n) const { return CragEdgeSpan(*this, _hierarchy.leafEdges(n)); }
 
 	/**
-	 * Get all leaf edges under the given edge e.
+	 * Get all leaf edges under the given edge e, ordered by id.
 	 */
-	std::set<CragEdge> leafEdges(CragEdge e) const;
+	std::vector<CragEdge> leafEdges(CragEdge e) const;
 
 	/**
-	 * Get all edges that are descendants of e. These are all edges that are 
-	 * linking descendants of the nodes connected by e.
+	 * Get all edges that are descendants of e, ordered by id. These are all 
+	 * edges that are linking descendants of the nodes connected by e.
 	 */
-	std::set<CragEdge> descendantEdges(CragEdge e) const;
+	std::vector<CragEdge> descendantEdges(CragEdge e) const;
 
 	/**
-	 * Get all edges that are linking descendants of u and v.
+	 * Get all edges that are linking descendants of u and v, ordered by id.
 	 */
-	std::set<CragEdge> descendantEdges(CragNode u, CragNode v) const;
+	std::vector<CragEdge> descendantEdges(CragNode u, CragNode v) const;
 
 private:
 
-	void recLeafNodes(CragNode n, std::set<CragNode>& leafNodes) const;
-
 	void recCollectEdges(Crag::CragNode n, std::set<Crag::CragEdge>& edges) const;
 
+	std::vector<CragEdge> toSortedCragEdges(std::vector<RagType::Edge>& edges) const;
+
+	// make room for the given number of affiliated edges of a leaf edge
+	std::uint64_t* allocateAffiliatedEdges(CragEdge e, std::size_t size);
+
+	struct AffiliatedEdgeRange {
+
+		AffiliatedEdgeRange() : begin(0), end(0) {}
+
+		std::size_t begin;
+		std::size_t end;
+	};
+
 	// adjacency graph
 	lemon::ListGraph _rag;
 
 	// subset graph
 	lemon::ListDigraph _ssg;
 
+	// index of the subset graph, updated on modifications of _rag and _ssg
+	CragHierarchy _hierarchy;
+
 	NodeMap<NodeType> _nodeTypes;
 
 	EdgeMap<EdgeType> _edgeTypes;
 
 	vigra::GridGraph<3> _gridGraph;
 
-	// voxel edges between adjacent leaf nodes
-	EdgeMap<std::vector<vigra::GridGraph<3>::Edge>> _affiliatedEdges;
+	// voxel edges between adjacent leaf nodes, as ids in the grid graph, 
+	// stored in one array for all leaf edges
+	std::vector<std::uint64_t> _affiliatedEdgeIds;
+
+	// the part of _affiliatedEdgeIds of each leaf edge
+	EdgeMap<AffiliatedEdgeRange> _affiliatedEdgeRanges;
 };
 
 #endif // CANDIDATE_MC_CRAG_CRAG_H__
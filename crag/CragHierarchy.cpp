@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <util/assert.h>
+#include "CragHierarchy.h"
+
+template <typename Notifier>
+class CragHierarchy::Observer : public Notifier::ObserverBase {
+
+	typedef typename Notifier::Item Item;
+
+public:
+
+	Observer(CragHierarchy& hierarchy, Notifier& notifier) :
+		_hierarchy(hierarchy) {
+
+		this->attach(notifier);
+	}
+
+protected:
+
+	void add(const Item& item) override { _hierarchy.added(item); }
+
+	void add(const std::vector<Item>& items) override {
+
+		for (const Item& item : items)
+			_hierarchy.added(item);
+	}
+
+	void erase(const Item&)              override { _hierarchy.invalidate(); }
+	void erase(const std::vector<Item>&) override { _hierarchy.invalidate(); }
+	void build()                         override { _hierarchy.invalidate(); }
+	void clear()                         override { _hierarchy.invalidate(); }
+
+private:
+
+	CragHierarchy& _hierarchy;
+};
+
+CragHierarchy::CragHierarchy(const RagType& rag, const SubsetType& ssg) :
+	_rag(rag),
+	_ssg(ssg),
+	_levelsValid(false),
+	_indexValid(false),
+	_isForest(true) {
+
+	_nodeObserver.reset(new NodeObserver(*this, _ssg.notifier(SubsetType::Node())));
+	_arcObserver.reset(new ArcObserver(*this, _ssg.notifier(SubsetType::Arc())));
+	_edgeObserver.reset(new EdgeObserver(*this, _rag.notifier(RagType::Edge())));
+}
+
+CragHierarchy::~CragHierarchy() {}
+
+int
+CragHierarchy::getLevel(RagType::Node n) const {
+
+	ensureLevels();
+
+	return _levels[_rag.id(n)];
+}
+
+bool
+CragHierarchy::isForest() const {
+
+	ensureIndex();
+
+	return _isForest;
+}
+
+bool
+CragHierarchy::isContained(RagType::Node n, RagType::Node m) const {
+
+	ensureIndex();
+
+	if (_isForest) {
+
+		int p = _pre[_rag.id(n)];
+		return (_pre[_rag.id(m)] <= p && p < _subtreeEnd[_rag.id(m)]);
+	}
+
+	if (n == m)
+		return true;
+
+	// search upwards from n, ancestors of n have a larger level
+	int level = _levels[_rag.id(m)];
+
+	std::vector<SubsetType::Node> queue(1, _ssg.nodeFromId(_rag.id(n)));
+	std::vector<char> visited(_levels.size(), false);
+
+	for (std::size_t q = 0; q < queue.size(); q++)
+		for (SubsetType::OutArcIt a(_ssg, queue[q]); a != lemon::INVALID; ++a) {
+
+			SubsetType::Node parent = _ssg.target(a);
+			int id = _ssg.id(parent);
+
+			if (id == _rag.id(m))
+				return true;
+
+			if (visited[id] || _levels[id] >= level)
+				continue;
+
+			visited[id] = true;
+			queue.push_back(parent);
+		}
+
+	return false;
+}
+
+bool
+CragHierarchy::containsLeaf(RagType::Node n, RagType::Node leaf) const {
+
+	if (isForest())
+		return isContained(leaf, n);
+
+	// the leaf nodes are sorted by id
+	NodeRange leaves = leafNodes(n);
+
+	return std::binary_search(leaves.first, leaves.second, leaf);
+}
+
+CragHierarchy::NodeRange
+CragHierarchy::containedNodes(RagType::Node n) const {
+
+	ensureIndex();
+
+	UTIL_ASSERT(_isForest);
+
+	int id = _rag.id(n);
+
+	return NodeRange(
+			_preorder.data() + _pre[id],
+			_preorder.data() + _subtreeEnd[id]);
+}
+
+CragHierarchy::NodeRange
+CragHierarchy::leafNodes(RagType::Node n) const {
+
+	ensureIndex();
+
+	int id = _rag.id(n);
+
+	return NodeRange(
+			_leafNodes.data() + _leafNodesBegin[id],
+			_leafNodes.data() + _leafNodesEnd[id]);
+}
+
+CragHierarchy::EdgeRange
+CragHierarchy::leafEdges(RagType::Node n) const {
+
+	ensureIndex();
+
+	int id = _rag.id(n);
+
+	return EdgeRange(
+			_leafEdges.data() + _leafEdgesBegin[id],
+			_leafEdges.data() + _leafEdgesEnd[id]);
+}
+
+void
+CragHierarchy::added(SubsetType::Node n) {
+
+	_indexValid = false;
+
+	if (!_levelsValid)
+		return;
+
+	std::size_t id = _ssg.id(n);
+	if (id >= _levels.size())
+		_levels.resize(id + 1, 0);
+	_levels[id] = 0;
+}
+
+void
+CragHierarchy::added(SubsetType::Arc a) {
+
+	_indexValid = false;
+
+	if (!_levelsValid)
+		return;
+
+	// raise the levels of the new parent and its ancestors, as far as needed
+	std::vector<std::pair<SubsetType::Node, int>> stack;
+	stack.push_back(std::make_pair(_ssg.target(a), _levels[_ssg.id(_ssg.source(a))] + 1));
+
+	while (!stack.empty()) {
+
+		SubsetType::Node n = stack.back().first;
+		int level = stack.back().second;
+		stack.pop_back();
+
+		if (_levels[_ssg.id(n)] >= level)
+			continue;
+
+		_levels[_ssg.id(n)] = level;
+
+		for (SubsetType::OutArcIt b(_ssg, n); b != lemon::INVALID; ++b)
+			stack.push_back(std::make_pair(_ssg.target(b), level + 1));
+	}
+}
+
+void
+CragHierarchy::added(RagType::Edge) {
+
+	_indexValid = false;
+}
+
+void
+CragHierarchy::invalidate() {
+
+	_levelsValid = false;
+	_indexValid  = false;
+}
+
+void
+CragHierarchy::ensureLevels() const {
+
+	if (_levelsValid)
+		return;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (_levelsValid)
+		return;
+
+	// the index is a cache, building it does not change the observable state
+	const_cast<CragHierarchy*>(this)->buildLevels();
+	_levelsValid = true;
+}
+
+void
+CragHierarchy::ensureIndex() const {
+
+	ensureLevels();
+
+	if (_indexValid)
+		return;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (_indexValid)
+		return;
+
+	const_cast<CragHierarchy*>(this)->buildIndex();
+	_indexValid = true;
+}
+
+void
+CragHierarchy::buildLevels() {
+
+	// visit the nodes bottom-up, such that all children of a node are visited 
+	// before the node itself
+
+	_levels.assign(_ssg.maxNodeId() + 1, 0);
+
+	std::vector<int> numChildren(_levels.size(), 0);
+	for (SubsetType::ArcIt a(_ssg); a != lemon::INVALID; ++a)
+		numChildren[_ssg.id(_ssg.target(a))]++;
+
+	std::vector<SubsetType::Node> queue;
+	for (SubsetType::NodeIt n(_ssg); n != lemon::INVALID; ++n)
+		if (numChildren[_ssg.id(n)] == 0)
+			queue.push_back(n);
+
+	for (std::size_t q = 0; q < queue.size(); q++)
+		for (SubsetType::OutArcIt a(_ssg, queue[q]); a != lemon::INVALID; ++a) {
+
+			int parent = _ssg.id(_ssg.target(a));
+
+			_levels[parent] = std::max(_levels[parent], _levels[_ssg.id(queue[q])] + 1);
+
+			if (--numChildren[parent] == 0)
+				queue.push_back(_ssg.target(a));
+		}
+}
+
+void
+CragHierarchy::buildIndex() {
+
+	_isForest = true;
+	for (SubsetType::NodeIt n(_ssg); n != lemon::INVALID; ++n) {
+
+		SubsetType::OutArcIt a(_ssg, n);
+		if (a != lemon::INVALID && ++a != lemon::INVALID) {
+
+			_isForest = false;
+			break;
+		}
+	}
+
+	std::size_t size = _ssg.maxNodeId() + 1;
+
+	_leafNodes.clear();
+	_leafEdges.clear();
+	_leafNodesBegin.assign(size, 0);
+	_leafNodesEnd.assign(size, 0);
+	_leafEdgesBegin.assign(size, 0);
+	_leafEdgesEnd.assign(size, 0);
+
+	if (_isForest)
+		buildForestIndex();
+	else
+		buildDagIndex();
+}
+
+void
+CragHierarchy::buildForestIndex() {
+
+	std::size_t size = _ssg.maxNodeId() + 1;
+
+	_preorder.clear();
+	_pre.assign(size, 0);
+	_subtreeEnd.assign(size, 0);
+
+	// depth-first search from each root, which finds the lowest common 
+	// ancestor of each leaf edge on the fly (Tarjan's offline algorithm): when 
+	// the second node of a leaf edge is visited, the set of the first node has 
+	// been merged up to the lowest common ancestor
+	std::vector<int>  sets(size);
+	std::vector<int>  ancestors(size);
+	std::vector<int>  trees(size, -1);
+	std::vector<char> visited(size, false);
+
+	auto find = [&sets](int i) {
+
+		int root = i;
+		while (sets[root] != root)
+			root = sets[root];
+		while (sets[i] != root) {
+
+			int next = sets[i];
+			sets[i] = root;
+			i = next;
+		}
+		return root;
+	};
+
+	// the leaf edges with the preorder position of their lowest common 
+	// ancestor
+	std::vector<std::pair<int, RagType::Edge>> leafEdges;
+
+	std::vector<std::pair<SubsetType::Node, SubsetType::InArcIt>> stack;
+
+	for (SubsetType::NodeIt root(_ssg); root != lemon::INVALID; ++root) {
+
+		if (SubsetType::OutArcIt(_ssg, root) != lemon::INVALID)
+			continue;
+
+		int tree = _ssg.id(root);
+
+		stack.push_back(std::make_pair(SubsetType::Node(root), SubsetType::InArcIt(_ssg, root)));
+
+		while (!stack.empty()) {
+
+			SubsetType::Node n = stack.back().first;
+			int id = _ssg.id(n);
+
+			// entering n
+			if (trees[id] < 0) {
+
+				trees[id]           = tree;
+				sets[id]            = id;
+				ancestors[id]       = id;
+				_pre[id]            = _preorder.size();
+				_leafNodesBegin[id] = _leafNodes.size();
+				_preorder.push_back(toRag(n));
+			}
+
+			SubsetType::InArcIt& a = stack.back().second;
+
+			if (a != lemon::INVALID) {
+
+				SubsetType::Node child = _ssg.source(a);
+				++a;
+				stack.push_back(std::make_pair(child, SubsetType::InArcIt(_ssg, child)));
+				continue;
+			}
+
+			// leaving n
+			if (isLeaf(id)) {
+
+				RagType::Node leaf = toRag(n);
+				_leafNodes.push_back(leaf);
+				visited[id] = true;
+
+				for (RagType::IncEdgeIt e(_rag, leaf); e != lemon::INVALID; ++e) {
+
+					int other = _rag.id(_rag.oppositeNode(leaf, e));
+
+					if (visited[other] && trees[other] == tree)
+						leafEdges.push_back(std::make_pair(_pre[ancestors[find(other)]], RagType::Edge(e)));
+				}
+			}
+
+			_leafNodesEnd[id] = _leafNodes.size();
+			_subtreeEnd[id]   = _preorder.size();
+
+			stack.pop_back();
+
+			if (!stack.empty()) {
+
+				int parent = _ssg.id(stack.back().first);
+				sets[find(id)] = find(parent);
+				ancestors[find(parent)] = parent;
+			}
+		}
+	}
+
+	// sort the leaf edges by the preorder position of their lowest common 
+	// ancestor, then the leaf edges under each node are contiguous
+	std::vector<std::size_t> offsets(_preorder.size() + 1, 0);
+	for (const auto& p : leafEdges)
+		offsets[p.first + 1]++;
+	for (std::size_t i = 1; i < offsets.size(); i++)
+		offsets[i] += offsets[i - 1];
+
+	_leafEdges.resize(leafEdges.size());
+	std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+	for (const auto& p : leafEdges)
+		_leafEdges[next[p.first]++] = p.second;
+
+	for (SubsetType::NodeIt n(_ssg); n != lemon::INVALID; ++n) {
+
+		int id = _ssg.id(n);
+
+		// nodes on cycles are not reachable from a root
+		if (trees[id] < 0)
+			continue;
+
+		_leafEdgesBegin[id] = offsets[_pre[id]];
+		_leafEdgesEnd[id]   = offsets[_subtreeEnd[id]];
+	}
+}
+
+void
+CragHierarchy::buildDagIndex() {
+
+	std::size_t size = _ssg.maxNodeId() + 1;
+
+	_preorder.clear();
+	_pre.clear();
+	_subtreeEnd.clear();
+
+	// collect the leaf nodes of each node bottom-up, sorted by id
+
+	std::vector<std::vector<RagType::Node>> leafNodes(size);
+
+	std::vector<SubsetType::Node> nodes;
+	for (SubsetType::NodeIt n(_ssg); n != lemon::INVALID; ++n)
+		nodes.push_back(n);
+
+	std::sort(
+			nodes.begin(),
+			nodes.end(),
+			[this](SubsetType::Node a, SubsetType::Node b) {
+
+				return _levels[_ssg.id(a)] < _levels[_ssg.id(b)];
+			});
+
+	for (SubsetType::Node n : nodes) {
+
+		std::vector<RagType::Node>& leaves = leafNodes[_ssg.id(n)];
+
+		if (isLeaf(_ssg.id(n))) {
+
+			leaves.push_back(toRag(n));
+			continue;
+		}
+
+		for (SubsetType::InArcIt a(_ssg, n); a != lemon::INVALID; ++a) {
+
+			const std::vector<RagType::Node>& childLeaves = leafNodes[_ssg.id(_ssg.source(a))];
+			leaves.insert(leaves.end(), childLeaves.begin(), childLeaves.end());
+		}
+
+		std::sort(leaves.begin(), leaves.end());
+		leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+	}
+
+	// store them one after the other, together with the leaf edges between 
+	// them
+
+	std::vector<int> marks(size, -1);
+
+	for (SubsetType::Node n : nodes) {
+
+		int id = _ssg.id(n);
+
+		_leafNodesBegin[id] = _leafNodes.size();
+		_leafEdgesBegin[id] = _leafEdges.size();
+
+		for (RagType::Node leaf : leafNodes[id]) {
+
+			_leafNodes.push_back(leaf);
+			marks[_rag.id(leaf)] = id;
+		}
+
+		for (RagType::Node leaf : leafNodes[id])
+			for (RagType::IncEdgeIt e(_rag, leaf); e != lemon::INVALID; ++e) {
+
+				int other = _rag.id(_rag.oppositeNode(leaf, e));
+
+				if (marks[other] == id && _rag.id(leaf) < other)
+					_leafEdges.push_back(e);
+			}
+
+		_leafNodesEnd[id] = _leafNodes.size();
+		_leafEdgesEnd[id] = _leafEdges.size();
+	}
+}
+
+bool
+CragHierarchy::isLeaf(int id) const {
+
+	return SubsetType::InArcIt(_ssg, _ssg.nodeFromId(id)) == lemon::INVALID;
+}
@@ -0,0 +1,141 @@
+#ifndef CANDIDATE_MC_CRAG_CRAG_HIERARCHY_H__
+#define CANDIDATE_MC_CRAG_CRAG_HIERARCHY_H__
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <lemon/list_graph.h>
+
+/**
+ * An index over the subset graph of a CRAG, to answer hierarchy queries 
+ * (levels, leaf nodes, leaf edges, and descendant tests) without recursion.
+ *
+ * The index observes the adjacency and subset graph and is rebuilt lazily on 
+ * the first query after a modification. Levels are kept up-to-date while 
+ * nodes and subset arcs are added, such that a CRAG can be built bottom-up 
+ * while querying the levels of its nodes.
+ *
+ * If the subset graph is a forest, the nodes are numbered in depth-first 
+ * preorder, such that the descendants of a node form a contiguous interval. 
+ * The leaf nodes and the leaf edges (ordered by the lowest node containing 
+ * both of their leaves) are stored in the same order, which makes the leaf 
+ * nodes and leaf edges under each node contiguous ranges. If a node has more 
+ * than one parent, the leaf nodes and leaf edges are stored for each node 
+ * separately.
+ */
+class CragHierarchy {
+
+public:
+
+	typedef lemon::ListGraph   RagType;
+	typedef lemon::ListDigraph SubsetType;
+
+	typedef std::pair<const RagType::Node*, const RagType::Node*> NodeRange;
+	typedef std::pair<const RagType::Edge*, const RagType::Edge*> EdgeRange;
+
+	CragHierarchy(const RagType& rag, const SubsetType& ssg);
+
+	~CragHierarchy();
+
+	/**
+	 * Get the length of the longest subset-graph path from n to a leaf node.
+	 */
+	int getLevel(RagType::Node n) const;
+
+	/**
+	 * True, if the subset graph is a forest, i.e., no node has more than one 
+	 * parent.
+	 */
+	bool isForest() const;
+
+	/**
+	 * True, if n is equal to or a descendant of m.
+	 */
+	bool isContained(RagType::Node n, RagType::Node m) const;
+
+	/**
+	 * True, if the given leaf node is under n. Faster than isContained() if 
+	 * the subset graph is not a forest.
+	 */
+	bool containsLeaf(RagType::Node n, RagType::Node leaf) const;
+
+	/**
+	 * Get the nodes contained in n (including n), in preorder. Only available 
+	 * if the subset graph is a forest.
+	 */
+	NodeRange containedNodes(RagType::Node n) const;
+
+	/**
+	 * Get the leaf nodes under n.
+	 */
+	NodeRange leafNodes(RagType::Node n) const;
+
+	/**
+	 * Get the edges between leaf nodes under n.
+	 */
+	EdgeRange leafEdges(RagType::Node n) const;
+
+private:
+
+	template <typename Notifier>
+	class Observer;
+
+	typedef Observer<SubsetType::NodeNotifier> NodeObserver;
+	typedef Observer<SubsetType::ArcNotifier>  ArcObserver;
+	typedef Observer<RagType::EdgeNotifier>    EdgeObserver;
+
+	// notifications from the observers
+	void added(SubsetType::Node n);
+	void added(SubsetType::Arc a);
+	void added(RagType::Edge e);
+	void invalidate();
+
+	void ensureLevels() const;
+	void ensureIndex() const;
+
+	void buildLevels();
+	void buildIndex();
+	void buildForestIndex();
+	void buildDagIndex();
+
+	bool isLeaf(int id) const;
+
+	RagType::Node toRag(SubsetType::Node n) const { return _rag.nodeFromId(_ssg.id(n)); }
+
+	const RagType&    _rag;
+	const SubsetType& _ssg;
+
+	std::unique_ptr<NodeObserver> _nodeObserver;
+	std::unique_ptr<ArcObserver>  _arcObserver;
+	std::unique_ptr<EdgeObserver> _edgeObserver;
+
+	mutable std::mutex        _mutex;
+	mutable std::atomic<bool> _levelsValid;
+	mutable std::atomic<bool> _indexValid;
+
+	// the level of each node, by id
+	std::vector<int> _levels;
+
+	bool _isForest;
+
+	// forest only: the nodes in preorder, and for each node (by id) its 
+	// position in and the end of its subtree in _preorder
+	std::vector<RagType::Node> _preorder;
+	std::vector<int>           _pre;
+	std::vector<int>           _subtreeEnd;
+
+	// the leaf nodes and leaf edges under each node (by id) are 
+	// _leafNodes[_leafNodesBegin[id]] to _leafNodes[_leafNodesEnd[id]-1], and 
+	// similar for the leaf edges
+	std::vector<RagType::Node> _leafNodes;
+	std::vector<std::size_t>   _leafNodesBegin;
+	std::vector<std::size_t>   _leafNodesEnd;
+	std::vector<RagType::Edge> _leafEdges;
+	std::vector<std::size_t>   _leafEdgesBegin;
+	std::vector<std::size_t>   _leafEdgesEnd;
+};
+
+#endif // CANDIDATE_MC_CRAG_CRAG_HIERARCHY_H__
+
@@ -427,3 +427,146 @@ public:
 	}
 };
 
+
+class CragNodeSpanIterator : public std::iterator<std::input_iterator_tag, CragNode> {
+
+	const RagType::Node* _it;
+
+public:
+
+	CragNodeSpanIterator(const RagType::Node* i)
+		: _it(i) {}
+
+	CragNodeSpanIterator& operator++() {
+
+		++_it;
+		return *this;
+	}
+
+	CragNodeSpanIterator operator++(int) {
+
+		CragNodeSpanIterator tmp(*this);
+		operator++();
+		return tmp;
+	}
+
+	bool operator==(const CragNodeSpanIterator& rhs) {
+
+		return _it == rhs._it;
+	}
+
+	bool operator!=(const CragNodeSpanIterator& rhs) {
+
+		return _it != rhs._it;
+	}
+
+	CragNode operator*() {
+
+		return CragNode(*_it);
+	}
+};
+
+class CragEdgeSpanIterator : public std::iterator<std::input_iterator_tag, CragEdge> {
+
+	const Crag& _crag;
+	const RagType::Edge* _it;
+
+public:
+
+	CragEdgeSpanIterator(const Crag& g, const RagType::Edge* i)
+		: _crag(g), _it(i) {}
+
+	CragEdgeSpanIterator(const CragEdgeSpanIterator& i)
+		: _crag(i._crag), _it(i._it) {}
+
+	CragEdgeSpanIterator& operator++() {
+
+		++_it;
+		return *this;
+	}
+
+	CragEdgeSpanIterator operator++(int) {
+
+		CragEdgeSpanIterator tmp(*this);
+		operator++();
+		return tmp;
+	}
+
+	bool operator==(const CragEdgeSpanIterator& rhs) {
+
+		return _it == rhs._it;
+	}
+
+	bool operator!=(const CragEdgeSpanIterator& rhs) {
+
+		return _it != rhs._it;
+	}
+
+	CragEdge operator*() {
+
+		return CragEdge(_crag, *_it);
+	}
+};
+
+/**
+ * A contiguous range of nodes, stored in the hierarchy index of the CRAG. It 
+ * is invalidated by modifications of the CRAG.
+ */
+class CragNodeSpan {
+
+	friend class Crag;
+
+	const RagType::Node* _begin;
+	const RagType::Node* _end;
+
+	CragNodeSpan(CragHierarchy::NodeRange range) : _begin(range.first), _end(range.second) {}
+
+public:
+
+	typedef CragNodeSpanIterator iterator;
+	typedef const CragNodeSpanIterator const_iterator;
+
+	CragNodeSpanIterator begin() const { return CragNodeSpanIterator(_begin); }
+
+	CragNodeSpanIterator end() const { return CragNodeSpanIterator(_end); }
+
+	CragNodeSpanIterator cbegin() const { return begin(); }
+
+	CragNodeSpanIterator cend() const { return end(); }
+
+	size_t size() const { return _end - _begin; }
+
+	bool empty() const { return _begin == _end; }
+};
+
+/**
+ * A contiguous range of edges, stored in the hierarchy index of the CRAG. It 
+ * is invalidated by modifications of the CRAG.
+ */
+class CragEdgeSpan {
+
+	friend class Crag;
+
+	const Crag&          _crag;
+	const RagType::Edge* _begin;
+	const RagType::Edge* _end;
+
+	CragEdgeSpan(const Crag& crag, CragHierarchy::EdgeRange range) : _crag(crag), _begin(range.first), _end(range.second) {}
+
+public:
+
+	typedef CragEdgeSpanIterator iterator;
+	typedef const CragEdgeSpanIterator const_iterator;
+
+	CragEdgeSpanIterator begin() const { return CragEdgeSpanIterator(_crag, _begin); }
+
+	CragEdgeSpanIterator end() const { return CragEdgeSpanIterator(_crag, _end); }
+
+	CragEdgeSpanIterator cbegin() const { return begin(); }
+
+	CragEdgeSpanIterator cend() const { return end(); }
+
+	size_t size() const { return _end - _begin; }
+
+	bool empty() const { return _begin == _end; }
+};
@@ -1,10 +1,13 @@
+#include <algorithm>
 #include <features/HausdorffDistance.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/assert.h>
 #include <util/exceptions.h>
 #include <util/timing.h>
+#include "BoundingBoxIndex.h"
 #include "CragStackCombiner.h"
+#include "ParallelFor.h"
 
 logger::LogChannel cragstackcombinerlog("cragstackcombinerlog", "[CragStackCombiner] ");
 
@@ -36,10 +39,30 @@ util::ProgramOption optionMaxZLinkBoundingBoxDistance(
 		                          "distance.",
 		util::_default_value    = 0);
 
+util::ProgramOption optionCombineNumThreads(
+		util::_long_name        = "numThreads",
+		util::_module           = "crag.combine",
+		util::_description_text = "The number of threads to use to read and link the sections of a stack. Set "
+		                          "to 0 to use one thread per hardware thread. The combined CRAG does not depend "
+		                          "on this value. Each thread keeps its own cache of distance maps to find "
+		                          "Hausdorff distances (see features.hausdorffCacheSize), so the memory needed "
+		                          "grows with the number of threads.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionMaxSectionsInFlight(
+		util::_long_name        = "maxSectionsInFlight",
+		util::_module           = "crag.combine",
+		util::_description_text = "The maximal number of sections to read and link at the same time (in addition "
+		                          "to the last section of the previous batch). This bounds the memory needed to "
+		                          "combine a stack. Set to 0 to use twice the number of threads.",
+		util::_default_value    = 0);
+
 CragStackCombiner::CragStackCombiner() :
 	_maxHausdorffDistance(optionMaxZLinkHausdorffDistance),
 	_maxBbDistance(optionMaxZLinkBoundingBoxDistance),
-	_requireBbOverlap(optionRequireBoundingBoxOverlap) {}
+	_requireBbOverlap(optionRequireBoundingBoxOverlap),
+	_numThreads(optionCombineNumThreads),
+	_maxSectionsInFlight(optionMaxSectionsInFlight) {}
 
 void
 CragStackCombiner::combine(
@@ -50,111 +73,192 @@ CragStackCombiner::combine(
 
 	UTIL_ASSERT_REL(sourcesCrags.size(), ==, sourcesVolumes.size());
 
-	if (sourcesCrags.size() == 0)
+	combine(
+			sourcesCrags.size(),
+			[&](unsigned int z, std::unique_ptr<Crag>& crag, std::unique_ptr<CragVolumes>& volumes) {
+
+				crag    = std::move(sourcesCrags[z]);
+				volumes = std::move(sourcesVolumes[z]);
+			},
+			targetCrag,
+			targetVolumes);
+
+	// clear the sources
+	sourcesCrags.clear();
+	sourcesVolumes.clear();
+}
+
+void
+CragStackCombiner::combine(
+		unsigned int  numSections,
+		SectionReader readSection,
+		Crag&         targetCrag,
+		CragVolumes&  targetVolumes) {
+
+	if (numSections == 0)
 		return;
 
+	unsigned int numThreads = getNumThreads(_numThreads);
+	unsigned int windowSize = (_maxSectionsInFlight > 0 ? _maxSectionsInFlight : 2*numThreads);
+
 	LOG_USER(cragstackcombinerlog)
-			<< "combining CRAGs, "
+			<< "combining " << numSections << " CRAGs, "
 			<< (_requireBbOverlap ? "" : " do not ")
-			<< "require bounding box overlap"
+			<< "require bounding box overlap, using "
+			<< numThreads << " threads for up to "
+			<< windowSize << " sections at a time"
 			<< std::endl;
 
 	_prevNodeMap.clear();
 	_nextNodeMap.clear();
 
-	// get the resolution of source volumes
-	util::point<float, 3> res;
-	for (unsigned int z = 0; z < sourcesCrags.size(); z++)
-		if (sourcesCrags[z]->nodes().size() > 0) {
-
-			res = (*sourcesVolumes[z])[*sourcesCrags[z]->nodes().begin()]->getResolution();
-			break;
-		}
-
-	if (res.isZero())
-		UTIL_THROW_EXCEPTION(
-				UsageError,
-				"all provided CRAGs are empty");
-
 	// add one NoAssignmentNode between each pair of crags, and before first and 
-	// after last section
+	// after last section (their volumes are set as soon as we know the 
+	// resolution)
 	_noAssignmentNodes.clear();
-	for (unsigned int z = 0; z <= sourcesCrags.size(); z++) {
+	for (unsigned int z = 0; z <= numSections; z++) {
 
 		Crag::CragNode n = targetCrag.addNode(Crag::NoAssignmentNode);
 		_noAssignmentNodes.push_back(n);
 
 		LOG_ALL(cragstackcombinerlog) << "added no-assignment node with id " << targetCrag.id(n) << std::endl;
+	}
 
-		// set a dummy 1x1x1 volume
-		std::shared_ptr<CragVolume> dummy = std::make_shared<CragVolume>(1, 1, 1);
-		dummy->data() = 1;
-		dummy->setOffset(
-				sourcesVolumes[0]->getBoundingBox().min().x(),
-				sourcesVolumes[0]->getBoundingBox().min().y(),
-				sourcesVolumes[0]->getBoundingBox().min().z() + (z - 0.5)*res.z());
-		dummy->setResolution(res);
-
-		LOG_ALL(cragstackcombinerlog) << "bb of no-assignment node is " << dummy->getBoundingBox() << std::endl;
+	std::vector<std::unique_ptr<Crag>>        sourcesCrags(numSections);
+	std::vector<std::unique_ptr<CragVolumes>> sourcesVolumes(numSections);
 
-		targetVolumes.setVolume(n, dummy);
-	}
+	util::point<float, 3> firstSectionOffset;
+	bool haveResolution = false;
 
 	unsigned int nodesAdded = 0;
 
-	if (sourcesCrags.size() == 1)
-	{
-		_prevNodeMap = copyNodes(0, *sourcesCrags[0], targetCrag);
-		copyVolumes(*sourcesVolumes[0], targetVolumes, _prevNodeMap);
-	}
+	for (unsigned int begin = 0; begin < numSections; begin += windowSize) {
 
-	for (unsigned int z = 1; z < sourcesCrags.size(); z++) {
+		unsigned int end = std::min(begin + windowSize, numSections);
 
-		LOG_USER(cragstackcombinerlog) << "linking CRAG " << (z-1) << " and " << z << std::endl;
+		LOG_USER(cragstackcombinerlog) << "reading CRAGs " << begin << " to " << (end - 1) << std::endl;
 
-		std::vector<std::pair<Crag::CragNode, Crag::CragNode>> links =
-				findLinks(
-						*sourcesCrags[z-1],
-						*sourcesVolumes[z-1],
-						*sourcesCrags[z],
-						*sourcesVolumes[z]);
+		parallelFor(
+				end - begin,
+				numThreads,
+				[&](std::size_t i) {
 
-		if (z == 1)
-			_prevNodeMap = copyNodes(0, *sourcesCrags[0], targetCrag);
-		else
-			_prevNodeMap = _nextNodeMap;
+					unsigned int z = begin + i;
+
+					readSection(z, sourcesCrags[z], sourcesVolumes[z]);
+
+					if (!sourcesCrags[z] || !sourcesVolumes[z])
+						UTIL_THROW_EXCEPTION(
+								UsageError,
+								"no CRAG was provided for section " << z);
+				});
 
-		_nextNodeMap = copyNodes(z, *sourcesCrags[z], targetCrag);
+		if (begin == 0)
+			firstSectionOffset = sourcesVolumes[0]->getBoundingBox().min();
+
+		// get the resolution of source volumes
+		for (unsigned int z = begin; z < end && !haveResolution; z++)
+			if (sourcesCrags[z]->nodes().size() > 0) {
+
+				util::point<float, 3> res = (*sourcesVolumes[z])[*sourcesCrags[z]->nodes().begin()]->getResolution();
+				setNoAssignmentVolumes(firstSectionOffset, res, targetVolumes);
+				haveResolution = true;
+			}
 
-		for (const auto& pair : links) {
+		// link each section of this window to its predecessor
+		std::vector<std::vector<std::pair<Crag::CragNode, Crag::CragNode>>> links(end - begin);
 
-			Crag::CragNode assignment = targetCrag.addNode(Crag::AssignmentNode);
+		{
+			UTIL_TIME_SCOPE("link sections");
 
-			targetCrag.addAdjacencyEdge(_prevNodeMap[pair.first], assignment, Crag::AssignmentEdge);
-			targetCrag.addAdjacencyEdge(_nextNodeMap[pair.second], assignment, Crag::AssignmentEdge);
-			targetCrag.addSubsetArc(_prevNodeMap[pair.first], assignment);
-			targetCrag.addSubsetArc(_nextNodeMap[pair.second], assignment);
+			parallelFor(
+					end - begin,
+					numThreads,
+					[&](std::size_t i) {
+
+						unsigned int z = begin + i;
+
+						if (z == 0)
+							return;
+
+						LOG_DEBUG(cragstackcombinerlog) << "linking CRAG " << (z-1) << " and " << z << std::endl;
+
+						links[i] = findLinks(
+								*sourcesCrags[z-1],
+								*sourcesVolumes[z-1],
+								*sourcesCrags[z],
+								*sourcesVolumes[z]);
+					});
 		}
 
-		nodesAdded += links.size();
+		// merge into the target CRAG in section order
+		for (unsigned int z = begin; z < end; z++) {
 
-		copyVolumes(*sourcesVolumes[z-1], targetVolumes, _prevNodeMap);
-		if (z == sourcesCrags.size() - 1)
-			copyVolumes(*sourcesVolumes[z], targetVolumes, _nextNodeMap);
+			if (z == 0) {
 
-		// from now on, we don't need sourcesVolumes[z-1] and sourcesCrags[z-1] 
-		// anymore. free some memory.
-		sourcesCrags[z-1].reset();
-		sourcesVolumes[z-1].reset();
+				_nextNodeMap = copyNodes(0, *sourcesCrags[0], targetCrag);
+				continue;
+			}
+
+			_prevNodeMap = _nextNodeMap;
+			_nextNodeMap = copyNodes(z, *sourcesCrags[z], targetCrag);
+
+			for (const auto& pair : links[z - begin]) {
+
+				Crag::CragNode assignment = targetCrag.addNode(Crag::AssignmentNode);
+
+				targetCrag.addAdjacencyEdge(_prevNodeMap[pair.first], assignment, Crag::AssignmentEdge);
+				targetCrag.addAdjacencyEdge(_nextNodeMap[pair.second], assignment, Crag::AssignmentEdge);
+				targetCrag.addSubsetArc(_prevNodeMap[pair.first], assignment);
+				targetCrag.addSubsetArc(_nextNodeMap[pair.second], assignment);
+			}
+
+			nodesAdded += links[z - begin].size();
+
+			copyVolumes(*sourcesVolumes[z-1], targetVolumes, _prevNodeMap);
+
+			// from now on, we don't need sourcesVolumes[z-1] and 
+			// sourcesCrags[z-1] anymore. free some memory.
+			sourcesVolumes[z-1].reset();
+			sourcesCrags[z-1].reset();
+		}
 	}
 
-	// clear the sources
-	sourcesCrags.clear();
-	sourcesVolumes.clear();
+	copyVolumes(*sourcesVolumes[numSections - 1], targetVolumes, _nextNodeMap);
+	sourcesVolumes[numSections - 1].reset();
+	sourcesCrags[numSections - 1].reset();
+
+	if (!haveResolution)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"all provided CRAGs are empty");
 
 	LOG_USER(cragstackcombinerlog) << "added " << nodesAdded << " link nodes" << std::endl;
 }
 
+void
+CragStackCombiner::setNoAssignmentVolumes(
+		const util::point<float, 3>& firstSectionOffset,
+		const util::point<float, 3>& res,
+		CragVolumes&                 targetVolumes) {
+
+	for (unsigned int z = 0; z < _noAssignmentNodes.size(); z++) {
+
+		// set a dummy 1x1x1 volume
+		std::shared_ptr<CragVolume> dummy = std::make_shared<CragVolume>(1, 1, 1);
+		dummy->data() = 1;
+		dummy->setOffset(
+				firstSectionOffset.x(),
+				firstSectionOffset.y(),
+				firstSectionOffset.z() + (z - 0.5)*res.z());
+		dummy->setResolution(res);
+
+		LOG_ALL(cragstackcombinerlog) << "bb of no-assignment node is " << dummy->getBoundingBox() << std::endl;
+
+		targetVolumes.setVolume(_noAssignmentNodes[z], dummy);
+	}
+}
+
 std::map<Crag::CragNode, Crag::CragNode>
 CragStackCombiner::copyNodes(
 		unsigned int       z,
@@ -219,9 +323,7 @@ CragStackCombiner::findLinks(
 		const Crag&        cragA,
 		const CragVolumes& volsA,
 		const Crag&        cragB,
-		const CragVolumes& volsB) {
-
-	UTIL_TIME_METHOD;
+		const CragVolumes& volsB) const {
 
 	std::vector<std::pair<Crag::CragNode, Crag::CragNode>> links;
 
@@ -235,9 +337,45 @@ CragStackCombiner::findLinks(
 			volsA[*cragA.nodes().begin()]->getResolutionY());
 	HausdorffDistance hausdorff(_maxHausdorffDistance + maxResolution);
 
+	// without a bounding box criterion, all pairs have to be tested
+	bool useIndex = (_requireBbOverlap || _maxBbDistance > 0);
+
+	std::vector<Crag::CragNode> nodesB;
+	Crag::NodeMap<std::size_t>  positionsB(cragB);
+	for (Crag::CragNode j : cragB.nodes()) {
+
+		positionsB[j] = nodesB.size();
+		nodesB.push_back(j);
+	}
+
+	std::unique_ptr<BoundingBoxIndex> indexB;
+	if (useIndex)
+		indexB = std::unique_ptr<BoundingBoxIndex>(new BoundingBoxIndex(cragB, volsB));
+
+	std::vector<Crag::CragNode> candidates;
+
 	for (Crag::CragNode i : cragA.nodes()) {
 
-		for (Crag::CragNode j : cragB.nodes()) {
+		if (useIndex) {
+
+			// the index gives a superset of the nodes that pass the bounding 
+			// box tests below (padded by one voxel against rounding errors)
+			util::box<float, 2> bb_i = volsA.getBoundingBox(i).project<2>();
+			float padding = (_requireBbOverlap ? 0 : _maxBbDistance) + maxResolution;
+
+			candidates = indexB->withinDistance(bb_i, padding);
+
+			// test them in the same order as without the index
+			std::sort(
+					candidates.begin(),
+					candidates.end(),
+					[&](Crag::CragNode a, Crag::CragNode b) {
+
+						return positionsB[a] < positionsB[b];
+					});
+		}
+
+		for (Crag::CragNode j : (useIndex ? candidates : nodesB)) {
 
 			LOG_ALL(cragstackcombinerlog)
 					<< "check linking of nodes " << cragA.id(i)
@@ -274,7 +412,7 @@ CragStackCombiner::findLinks(
 			if (_maxHausdorffDistance > 0) {
 
 				double i_j, j_i;
-				hausdorff(*volsA[i], *volsB[j], i_j, j_i);
+				hausdorff(volsA[i], volsB[j], i_j, j_i);
 
 				double distance = std::max(i_j, j_i);
 
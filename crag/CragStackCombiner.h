@@ -1,6 +1,7 @@
 #ifndef CANDIDATE_MC_CRAG_CRAG_STACK_COMBINER_H__
 #define CANDIDATE_MC_CRAG_CRAG_STACK_COMBINER_H__
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include "Crag.h"
@@ -13,6 +14,15 @@ class CragStackCombiner {
 
 public:
 
+	/**
+	 * Creates the CRAG and volumes of section z. Called concurrently for 
+	 * different sections.
+	 */
+	typedef std::function<void(
+			unsigned int                  z,
+			std::unique_ptr<Crag>&        crag,
+			std::unique_ptr<CragVolumes>& volumes)> SectionReader;
+
 	CragStackCombiner();
 
 	/**
@@ -27,6 +37,35 @@ public:
 			Crag&                                      targetCrag,
 			CragVolumes&                               targetVolumes);
 
+	/**
+	 * Same as above, but the source CRAGs are created on demand by 
+	 * readSection. Sections are read and linked to their predecessor in 
+	 * parallel, in windows of a bounded number of sections. The windows are 
+	 * merged into the target CRAG in section order, such that the result does 
+	 * not depend on the number of threads. A section is deallocated as soon as 
+	 * it was linked to its successor.
+	 *
+	 * Each thread linking sections uses its own HausdorffDistance, such that 
+	 * the memory for cached distance maps grows with the number of threads.
+	 */
+	void combine(
+			unsigned int  numSections,
+			SectionReader readSection,
+			Crag&         targetCrag,
+			CragVolumes&  targetVolumes);
+
+	/**
+	 * Set the number of threads to read and link sections with, instead of 
+	 * crag.combine.numThreads. 0 uses one thread per hardware thread.
+	 */
+	void setNumThreads(int numThreads) { _numThreads = numThreads; }
+
+	/**
+	 * Set the number of sections to read and link at the same time, instead 
+	 * of crag.combine.maxSectionsInFlight. 0 uses twice the number of threads.
+	 */
+	void setMaxSectionsInFlight(unsigned int maxSectionsInFlight) { _maxSectionsInFlight = maxSectionsInFlight; }
+
 private:
 
 	std::map<Crag::CragNode, Crag::CragNode> copyNodes(
@@ -39,19 +78,25 @@ private:
 			CragVolumes& targetVolumes,
 			const std::map<Crag::CragNode, Crag::CragNode>& sourceTargetNodeMap);
 
-	std::vector<std::pair<Crag::CragNode, Crag::CragNode>> findLinks(const Crag& a, const Crag& b);
+	void setNoAssignmentVolumes(
+			const util::point<float, 3>& firstSectionOffset,
+			const util::point<float, 3>& resolution,
+			CragVolumes&                 targetVolumes);
 
 	std::vector<std::pair<Crag::CragNode, Crag::CragNode>> findLinks(
 			const Crag&        cragA,
 			const CragVolumes& volsA,
 			const Crag&        cragB,
-			const CragVolumes& volsB);
+			const CragVolumes& volsB) const;
 
 	double _maxHausdorffDistance;
 	double _maxBbDistance;
 
 	bool _requireBbOverlap;
 
+	int          _numThreads;
+	unsigned int _maxSectionsInFlight;
+
 	std::map<Crag::CragNode, Crag::CragNode> _prevNodeMap;
 	std::map<Crag::CragNode, Crag::CragNode> _nextNodeMap;
 
@@ -0,0 +1,45 @@
+#ifndef CANDIDATE_MC_CRAG_CRAG_VOLUME_CACHE_H__
+#define CANDIDATE_MC_CRAG_CRAG_VOLUME_CACHE_H__
+
+#include "CragVolume.h"
+#include "LruCache.h"
+
+/**
+ * The number of bytes a volume accounts for in a CragVolumeCache.
+ */
+struct CragVolumeSize {
+
+	std::size_t operator()(const CragVolume& volume) const {
+
+		return volume.width()*volume.height()*volume.depth()*sizeof(unsigned char);
+	}
+};
+
+/**
+ * A thread-safe cache for materialized candidate volumes by node id, with a 
+ * memory budget in bytes.
+ */
+class CragVolumeCache : public LruCache<int, CragVolume, CragVolumeSize> {
+
+public:
+
+	// enough shards such that feature extraction threads rarely request 
+	// volumes from the same shard at the same time
+	static const std::size_t DefaultNumShards = 16;
+
+	/**
+	 * Create a cache that holds at most maxBytes bytes of volume data.
+	 */
+	CragVolumeCache(std::size_t maxBytes, std::size_t numShards = DefaultNumShards) :
+		LruCache<int, CragVolume, CragVolumeSize>(maxBytes, numShards) {}
+
+	/**
+	 * The number of bytes a volume accounts for in the cache.
+	 */
+	static std::size_t getSizeInBytes(const CragVolume& volume) {
+
+		return CragVolumeSize()(volume);
+	}
+};
+
+#endif // CANDIDATE_MC_CRAG_CRAG_VOLUME_CACHE_H__
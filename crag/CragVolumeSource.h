@@ -0,0 +1,41 @@
+#ifndef CANDIDATE_MC_CRAG_CRAG_VOLUME_SOURCE_H__
+#define CANDIDATE_MC_CRAG_CRAG_VOLUME_SOURCE_H__
+
+#include <memory>
+#include "Crag.h"
+#include "CragVolume.h"
+
+/**
+ * Interface for providers of leaf node volumes, which CragVolumes reads on 
+ * demand instead of keeping them in memory. Implementations have to be safe 
+ * to call from several threads.
+ */
+class CragVolumeSource {
+
+public:
+
+	virtual ~CragVolumeSource() {}
+
+	/**
+	 * Read the volume of a leaf node. Returns an empty pointer, if there is no 
+	 * volume for this node.
+	 */
+	virtual std::shared_ptr<CragVolume> getVolume(Crag::CragNode n) = 0;
+
+	/**
+	 * Get the bounding box of the volume of a leaf node, without reading the 
+	 * volume.
+	 */
+	virtual util::box<float, 3> getBoundingBox(Crag::CragNode n) = 0;
+
+	/**
+	 * Get the resolution of the volume of a leaf node. The default reads the 
+	 * volume, implementations should override this if they can avoid that.
+	 */
+	virtual util::point<float, 3> getResolution(Crag::CragNode n) {
+
+		return getVolume(n)->getResolution();
+	}
+};
+
+#endif // CANDIDATE_MC_CRAG_CRAG_VOLUME_SOURCE_H__
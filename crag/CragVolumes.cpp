@@ -1,20 +1,72 @@
 #include "CragVolumes.h"
 #include <util/Logger.h>
+#include <util/ProgramOptions.h>
 #include <util/assert.h>
 
 logger::LogChannel cragvolumeslog("cragvolumeslog", "[CragVolumes] ");
 
+util::ProgramOption optionVolumeCacheSize(
+		util::_long_name        = "volumeCacheSize",
+		util::_module           = "crag",
+		util::_description_text = "The memory budget in MB for volumes of higher-order candidates that are kept "
+		                          "after being assembled from their leaf candidates. The least recently used "
+		                          "volumes are dropped first.",
+		util::_default_value    = 1024);
+
+util::ProgramOption optionSparseVolumes(
+		util::_long_name        = "sparseVolumes",
+		util::_module           = "crag",
+		util::_description_text = "Keep the volumes of leaf candidates read from a project file as run-length "
+		                          "encoded masks. This reduces memory considerably for elongated candidates. "
+		                          "Dense volumes are created on demand and kept within the volume cache budget.");
+
 CragVolumes::CragVolumes(const Crag& crag) :
 	_crag(crag),
-	_volumes(crag) {
-
-	_cache.set_max_size(1024);
-}
+	_volumes(crag),
+	_sparseVolumes(crag),
+	_boundingBoxes(crag),
+	_boundingBoxVersions(crag, 0),
+	_version(1),
+	_storeSparse(optionSparseVolumes),
+	_cache(optionVolumeCacheSize.as<std::size_t>()*1024*1024) {}
 
 void
 CragVolumes::setVolume(Crag::CragNode n, std::shared_ptr<CragVolume> volume) {
 
+	// compute the lazy bounding box now, such that later concurrent readers 
+	// don't modify the volume
+	volume->getBoundingBox();
+
 	_volumes[n] = UnionVolume(volume);
+	_volumes[n].getBoundingBox();
+	_sparseVolumes[n].reset();
+
+	// invalidate the bounding boxes of higher-order nodes
+	_version++;
+
+	setBoundingBoxDirty();
+}
+
+void
+CragVolumes::setVolume(Crag::CragNode n, std::shared_ptr<SparseCragVolume> volume) {
+
+	volume->getBoundingBox();
+
+	_volumes[n].clear();
+	_sparseVolumes[n] = volume;
+
+	_version++;
+
+	setBoundingBoxDirty();
+}
+
+void
+CragVolumes::setVolumeSource(std::shared_ptr<CragVolumeSource> source) {
+
+	_source = source;
+
+	_version++;
+
 	setBoundingBoxDirty();
 }
 
@@ -25,10 +77,112 @@ CragVolumes::operator[](Crag::CragNode n) const {
 	if (_volumes[n].numUnionVolumes() == 1)
 		return _volumes[n].getUnionVolume(0);
 
-	update(n);
+	return _cache.get(_crag.id(n), [this, n]{
+
+		std::shared_ptr<CragVolume> volume;
+
+		if (isSourceLeaf(n)) {
+
+			volume = _source->getVolume(n);
 
-	UnionVolume& v = _volumes[n];
-	return _cache.get(n, [v]{ return v.materialize(); });
+			if (!volume)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
+
+		} else if (_sparseVolumes[n])
+			volume = _sparseVolumes[n]->materialize();
+		else if (hasSparseLeafVolumes(n))
+			volume = getSparseVolume(n)->materialize();
+		else
+			volume = getUnionVolume(n).materialize();
+
+		volume->getBoundingBox();
+
+		LOG_ALL(cragvolumeslog) << "materialized volume of node " << _crag.id(n) << std::endl;
+
+		return volume;
+	});
+}
+
+std::shared_ptr<const SparseCragVolume>
+CragVolumes::getSparseVolume(Crag::CragNode n) const {
+
+	if (_sparseVolumes[n])
+		return _sparseVolumes[n];
+
+	if (_volumes[n].numUnionVolumes() == 1)
+		return std::make_shared<SparseCragVolume>(*_volumes[n].getUnionVolume(0));
+
+	if (isSourceLeaf(n))
+		return std::make_shared<SparseCragVolume>(*(*this)[n]);
+
+	if (_crag.isLeafNode(n))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
+
+	std::vector<std::shared_ptr<const SparseCragVolume>> leafVolumes;
+	for (Crag::CragNode l : _crag.leafNodes(n))
+		leafVolumes.push_back(getSparseVolume(l));
+
+	return SparseCragVolume::unite(leafVolumes);
+}
+
+util::box<float,3>
+CragVolumes::getBoundingBox(Crag::CragNode n) const {
+
+	if (_volumes[n].numUnionVolumes() > 0)
+		return _volumes[n].getBoundingBox();
+
+	if (_sparseVolumes[n])
+		return _sparseVolumes[n]->getBoundingBox();
+
+	if (isSourceLeaf(n))
+		return _source->getBoundingBox(n);
+
+	{
+		std::lock_guard<std::mutex> lock(_boundingBoxMutex);
+		if (_boundingBoxVersions[n] == _version)
+			return _boundingBoxes[n];
+	}
+
+	if (_crag.isLeafNode(n))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
+
+	util::box<float, 3> bb;
+	for (Crag::CragNode l : _crag.leafNodes(n))
+		bb += getBoundingBox(l);
+
+	std::lock_guard<std::mutex> lock(_boundingBoxMutex);
+	_boundingBoxes[n]       = bb;
+	_boundingBoxVersions[n] = _version;
+
+	return bb;
+}
+
+util::point<float, 3>
+CragVolumes::getResolution(Crag::CragNode n) const {
+
+	if (_volumes[n].numUnionVolumes() > 0)
+		return _volumes[n].getUnionVolume(0)->getResolution();
+
+	if (_sparseVolumes[n])
+		return _sparseVolumes[n]->getResolution();
+
+	if (isSourceLeaf(n))
+		return _source->getResolution(n);
+
+	// all leaf node volumes have the same resolution
+	if (!_crag.isLeafNode(n))
+		for (Crag::CragNode l : _crag.leafNodes(n))
+			return getResolution(l);
+
+	UTIL_THROW_EXCEPTION(
+			UsageError,
+			"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
 }
 
 bool
@@ -44,26 +198,38 @@ CragVolumes::is2D() const {
 void
 CragVolumes::clearCache() {
 
+	LOG_DEBUG(cragvolumeslog)
+			<< "clearing volume cache, hits: " << getCacheStatistics().hits
+			<< ", misses: " << getCacheStatistics().misses
+			<< ", evictions: " << getCacheStatistics().evictions << std::endl;
+
 	_cache.clear();
 }
 
-void
-CragVolumes::update(Crag::CragNode n) const {
+UnionVolume
+CragVolumes::getUnionVolume(Crag::CragNode n) const {
 
-	// if this volume is empty, we need to find all leaf node volumes that 
-	// create it
-	if (_volumes[n].numUnionVolumes() == 0) {
+	// find all leaf node volumes that create this volume
+	if (_crag.isLeafNode(n))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
 
-		if (_crag.isLeafNode(n))
-			UTIL_THROW_EXCEPTION(
-					UsageError,
-					"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
+	auto leafNodes = _crag.leafNodes(n);
+	std::vector<std::shared_ptr<CragVolume>> leafVolumes;
 
-		auto leafNodes = _crag.leafNodes(n);
-		std::vector<std::shared_ptr<CragVolume>> leafVolumes;
+	for (Crag::CragNode l : leafNodes)
+		leafVolumes.push_back(this->operator[](l));
 
-		for (Crag::CragNode l : leafNodes)
-			leafVolumes.push_back(this->operator[](l));
-		_volumes[n] = UnionVolume(leafVolumes);
-	}
+	return UnionVolume(leafVolumes);
+}
+
+bool
+CragVolumes::hasSparseLeafVolumes(Crag::CragNode n) const {
+
+	for (Crag::CragNode l : _crag.leafNodes(n))
+		if (_sparseVolumes[l])
+			return true;
+
+	return false;
 }
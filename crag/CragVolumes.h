@@ -2,15 +2,19 @@
 #define CANDIDATE_MC_CRAG_CRAG_VOLUMES_H__
 
 #include <memory>
+#include <mutex>
 #include <imageprocessing/ExplicitVolume.h>
-#include <util/cache.hpp>
 #include "Crag.h"
 #include "CragVolume.h"
+#include "CragVolumeCache.h"
+#include "CragVolumeSource.h"
+#include "SparseCragVolume.h"
 #include "UnionVolume.h"
 
 /**
  * A node property map for Crags that provides the volumes of candidates as 
- * CragVolume.
+ * CragVolume. Once all leaf node volumes are set, the const methods can be 
+ * called concurrently from several threads.
  */
 class CragVolumes : public Volume {
 
@@ -26,12 +30,21 @@ public:
 
 	CragVolumes(CragVolumes&& other) :
 		_crag(other._crag),
-		_volumes(other._crag) {
+		_volumes(other._crag),
+		_sparseVolumes(other._crag),
+		_boundingBoxes(other._crag),
+		_boundingBoxVersions(other._crag, 0),
+		_version(1),
+		_storeSparse(other._storeSparse),
+		_source(other._source),
+		_cache(other._cache.getMaxBytes()) {
 
 		for (Crag::CragNode n : _crag.nodes()) {
 
 			_volumes[n] = other._volumes[n];
+			_sparseVolumes[n] = other._sparseVolumes[n];
 			other._volumes[n].clear();
+			other._sparseVolumes[n].reset();
 		}
 	}
 
@@ -40,12 +53,42 @@ public:
 	 */
 	void setVolume(Crag::CragNode n, std::shared_ptr<CragVolume> volume);
 
+	/**
+	 * Set the volume of a leaf node as a run-length encoded mask. Dense 
+	 * volumes of sparse leaf nodes are created on demand and kept in the 
+	 * volume cache.
+	 */
+	void setVolume(Crag::CragNode n, std::shared_ptr<SparseCragVolume> volume);
+
+	/**
+	 * Read the volumes of leaf nodes that have no volume set from the given 
+	 * source, when they are accessed. Read volumes are kept in the volume 
+	 * cache and dropped again if the cache budget is exceeded. Bounding boxes 
+	 * of these leaf nodes are taken from the source without reading the 
+	 * volumes.
+	 */
+	void setVolumeSource(std::shared_ptr<CragVolumeSource> source);
+
+	/**
+	 * Whether readers should store leaf node volumes as run-length encoded 
+	 * masks. Initialized from the program option crag.sparseVolumes.
+	 */
+	bool storesSparseVolumes() const { return _storeSparse; }
+	void setStoreSparseVolumes(bool storeSparse) { _storeSparse = storeSparse; }
+
 	/**
 	 * Get the volume of a candidate. If the candidate is a higher candidate, 
 	 * it's volume will be materialized from the leaf node volume it merges.
 	 */
 	std::shared_ptr<CragVolume> operator[](Crag::CragNode n) const;
 
+	/**
+	 * Get the volume of a candidate as a run-length encoded mask. For higher 
+	 * candidates, this is the union of the leaf node masks, which is created 
+	 * without materializing dense volumes. The result is not cached.
+	 */
+	std::shared_ptr<const SparseCragVolume> getSparseVolume(Crag::CragNode n) const;
+
 	/**
 	 * Get the bounding box of all volumes combined.
 	 */
@@ -57,11 +100,13 @@ public:
 	 * This does not materialize the volume and should be preferred over 
 	 * volumes[n].getBoundingBox().
 	 */
-	util::box<float,3> getBoundingBox(Crag::CragNode n) const {
+	util::box<float,3> getBoundingBox(Crag::CragNode n) const;
 
-		update(n);
-		return _volumes[n].getBoundingBox();
-	}
+	/**
+	 * Get the resolution of a volume. Like getBoundingBox(n), this does not 
+	 * materialize the volume.
+	 */
+	util::point<float, 3> getResolution(Crag::CragNode n) const;
 
 	/**
 	 * Get the Crag associated to the volumes.
@@ -79,29 +124,82 @@ public:
 	 */
 	void clearCache();
 
+	/**
+	 * Set the memory budget in bytes for volumes of higher-order nodes that 
+	 * are kept after being generated by operator[]().
+	 */
+	void setCacheSize(std::size_t bytes) { _cache.setMaxBytes(bytes); }
+
+	/**
+	 * Get hit, miss, and eviction counts of the volume cache.
+	 */
+	CragVolumeCache::Statistics getCacheStatistics() const { return _cache.getStatistics(); }
+
 protected:
 
 	util::box<float,3> computeBoundingBox() const override {
 
 		util::box<float, 3> bb;
 		for (Crag::CragNode n : _crag.nodes())
-			// Here we deliberatly ignore empty UnionVolumes. Since they are 
+			// Only leaf nodes have volumes assigned. Since higher nodes are 
 			// composed of leaf nodes anyway, their bounding box does not 
 			// contribute to the whole bounding box.
-			if (!_volumes[n].getBoundingBox().isZero())
-				bb += operator[](n)->getBoundingBox();
+			if (_volumes[n].numUnionVolumes() > 0)
+				bb += _volumes[n].getBoundingBox();
+			else if (_sparseVolumes[n])
+				bb += _sparseVolumes[n]->getBoundingBox();
+			else if (isSourceLeaf(n))
+				bb += _source->getBoundingBox(n);
 
 		return bb;
 	}
 
 private:
 
-	void update(Crag::CragNode n) const;
+	/**
+	 * Get the union of the leaf node volumes of a higher-order node.
+	 */
+	UnionVolume getUnionVolume(Crag::CragNode n) const;
+
+	/**
+	 * Check whether any of the leaf nodes of a higher-order node has a 
+	 * run-length encoded volume.
+	 */
+	bool hasSparseLeafVolumes(Crag::CragNode n) const;
+
+	/**
+	 * Check whether n is a leaf node with a volume to be read from the volume 
+	 * source.
+	 */
+	bool isSourceLeaf(Crag::CragNode n) const {
+
+		return
+				_source &&
+				_volumes[n].numUnionVolumes() == 0 &&
+				!_sparseVolumes[n] &&
+				_crag.isLeafNode(n);
+	}
 
 	const Crag& _crag;
 
-	mutable Crag::NodeMap<UnionVolume> _volumes;
-	mutable cache<Crag::CragNode, std::shared_ptr<CragVolume>> _cache;
+	// the volumes of the leaf nodes, either dense or run-length encoded
+	Crag::NodeMap<UnionVolume>                        _volumes;
+	Crag::NodeMap<std::shared_ptr<SparseCragVolume>> _sparseVolumes;
+
+	// bounding boxes of higher-order nodes, computed on demand and valid if 
+	// their version matches the version of the leaf volumes
+	mutable Crag::NodeMap<util::box<float, 3>> _boundingBoxes;
+	mutable Crag::NodeMap<std::size_t>         _boundingBoxVersions;
+	mutable std::mutex                         _boundingBoxMutex;
+	std::size_t                                _version;
+
+	bool _storeSparse;
+
+	// provides leaf node volumes that have not been set
+	std::shared_ptr<CragVolumeSource> _source;
+
+	// materialized volumes of higher-order nodes and sparse leaf nodes
+	mutable CragVolumeCache _cache;
 };
 
 #endif // CANDIDATE_MC_CRAG_CRAG_VOLUMES_H__
@@ -0,0 +1,374 @@
+#ifndef CANDIDATE_MC_CRAG_LRU_CACHE_H__
+#define CANDIDATE_MC_CRAG_LRU_CACHE_H__
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A thread-safe cache for shared values with a memory budget in bytes. If the 
+ * budget is exceeded, the least recently used values are evicted. Concurrent 
+ * requests for the same value wait for a single materialization.
+ *
+ * The values are distributed over shards by the hash of their key, each with 
+ * its own lock, such that concurrent requests for different keys rarely wait 
+ * for each other. The budget is shared by all shards.
+ *
+ * @param Key
+ *              The type to identify values, has to be hashable.
+ * @param Value
+ *              The type of the cached values, which are returned as 
+ *              std::shared_ptr<Value>.
+ * @param SizeOf
+ *              A functor returning the number of bytes a value accounts for 
+ *              in the cache.
+ */
+template <typename Key, typename Value, typename SizeOf>
+class LruCache {
+
+public:
+
+	struct Statistics {
+
+		Statistics() :
+			hits(0),
+			misses(0),
+			evictions(0),
+			entries(0),
+			bytes(0) {}
+
+		// number of requests answered from the cache
+		std::size_t hits;
+
+		// number of requests that needed a materialization
+		std::size_t misses;
+
+		// number of values removed to stay within the budget
+		std::size_t evictions;
+
+		// number of values and their size currently in the cache
+		std::size_t entries;
+		std::size_t bytes;
+	};
+
+	/**
+	 * Create a cache that holds at most maxBytes bytes of values, distributed 
+	 * over numShards shards.
+	 */
+	LruCache(std::size_t maxBytes, std::size_t numShards = 1) :
+		_maxBytes(maxBytes),
+		_bytes(0),
+		_nextToken(0),
+		_clock(0),
+		_hits(0),
+		_misses(0),
+		_evictions(0) {
+
+		for (std::size_t i = 0; i < std::max(numShards, (std::size_t)1); i++)
+			_shards.emplace_back(new Shard());
+	}
+
+	/**
+	 * Get the value for the given key. If it is not in the cache, it will be 
+	 * created by calling materialize().
+	 */
+	template <typename Materialize>
+	std::shared_ptr<Value> get(const Key& key, Materialize materialize);
+
+	/**
+	 * Remove all values from the cache.
+	 */
+	void clear();
+
+	/**
+	 * Change the memory budget, evicting values if necessary.
+	 */
+	void setMaxBytes(std::size_t maxBytes);
+
+	std::size_t getMaxBytes() const { return _maxBytes; }
+
+	/**
+	 * Get the hit, miss, and eviction counts and the current size of the 
+	 * cache.
+	 */
+	Statistics getStatistics() const;
+
+private:
+
+	typedef std::shared_future<std::shared_ptr<Value>> FutureType;
+	typedef std::list<Key>                             LruList;
+
+	struct Entry {
+
+		FutureType value;
+
+		// unique for each materialization, to recognize an entry after 
+		// materializing without holding the lock
+		std::size_t token;
+
+		// false while the value is being materialized
+		bool ready;
+
+		// the value of _clock at the last use, to find the least recently 
+		// used value over all shards
+		std::size_t lastUse;
+
+		std::size_t                 bytes;
+		typename LruList::iterator lruPosition;
+	};
+
+	struct Shard {
+
+		Shard() : bytes(0) {}
+
+		std::mutex mutex;
+
+		std::unordered_map<Key, Entry> entries;
+
+		// keys of ready entries, most recently used first
+		LruList lru;
+
+		std::size_t bytes;
+	};
+
+	Shard& shard(const Key& key) const {
+
+		return *_shards[std::hash<Key>()(key)%_shards.size()];
+	}
+
+	// add a materialized value to the cache, with the lock of the shard held
+	void finish(Shard& shard, const Key& key, std::size_t token, std::size_t bytes);
+
+	// remove the least recently used value of a shard, with its lock held
+	void evictLeastRecentlyUsed(Shard& shard);
+
+	// evict the least recently used values of all shards until the budget is 
+	// met, without holding any lock
+	void evict();
+
+	// never resized after construction
+	std::vector<std::unique_ptr<Shard>> _shards;
+
+	std::atomic<std::size_t> _maxBytes;
+	std::atomic<std::size_t> _bytes;
+	std::atomic<std::size_t> _nextToken;
+	std::atomic<std::size_t> _clock;
+
+	std::atomic<std::size_t> _hits;
+	std::atomic<std::size_t> _misses;
+	std::atomic<std::size_t> _evictions;
+};
+
+template <typename Key, typename Value, typename SizeOf>
+template <typename Materialize>
+std::shared_ptr<Value>
+LruCache<Key, Value, SizeOf>::get(const Key& key, Materialize materialize) {
+
+	Shard& s = shard(key);
+
+	std::promise<std::shared_ptr<Value>> promise;
+	FutureType  cached;
+	std::size_t token = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+
+		auto i = s.entries.find(key);
+
+		if (i != s.entries.end()) {
+
+			_hits++;
+
+			Entry& entry = i->second;
+			if (entry.ready) {
+
+				s.lru.splice(s.lru.begin(), s.lru, entry.lruPosition);
+				entry.lastUse = _clock++;
+			}
+
+			// keep a copy, the entry might get evicted while we wait
+			cached = entry.value;
+
+		} else {
+
+			_misses++;
+
+			token = _nextToken++;
+
+			Entry entry;
+			entry.value   = promise.get_future().share();
+			entry.token   = token;
+			entry.ready   = false;
+			entry.lastUse = 0;
+			entry.bytes   = 0;
+			s.entries.emplace(key, entry);
+		}
+	}
+
+	// wait without holding the lock, in case the value is still being 
+	// materialized by another thread
+	if (cached.valid())
+		return cached.get();
+
+	std::shared_ptr<Value> value;
+
+	try {
+
+		value = materialize();
+
+	} catch (...) {
+
+		promise.set_exception(std::current_exception());
+
+		std::lock_guard<std::mutex> lock(s.mutex);
+		auto i = s.entries.find(key);
+		if (i != s.entries.end() && i->second.token == token)
+			s.entries.erase(i);
+
+		throw;
+	}
+
+	promise.set_value(value);
+
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		finish(s, key, token, SizeOf()(*value));
+	}
+
+	evict();
+
+	return value;
+}
+
+template <typename Key, typename Value, typename SizeOf>
+void
+LruCache<Key, Value, SizeOf>::clear() {
+
+	for (auto& s : _shards) {
+
+		std::lock_guard<std::mutex> lock(s->mutex);
+
+		// threads materializing or waiting for a value keep their own 
+		// reference to it and are not affected
+		s->entries.clear();
+		s->lru.clear();
+		_bytes -= s->bytes;
+		s->bytes = 0;
+	}
+}
+
+template <typename Key, typename Value, typename SizeOf>
+void
+LruCache<Key, Value, SizeOf>::setMaxBytes(std::size_t maxBytes) {
+
+	_maxBytes = maxBytes;
+	evict();
+}
+
+template <typename Key, typename Value, typename SizeOf>
+typename LruCache<Key, Value, SizeOf>::Statistics
+LruCache<Key, Value, SizeOf>::getStatistics() const {
+
+	Statistics statistics;
+	statistics.hits      = _hits;
+	statistics.misses    = _misses;
+	statistics.evictions = _evictions;
+
+	for (const auto& s : _shards) {
+
+		std::lock_guard<std::mutex> lock(s->mutex);
+		statistics.entries += s->lru.size();
+		statistics.bytes   += s->bytes;
+	}
+
+	return statistics;
+}
+
+template <typename Key, typename Value, typename SizeOf>
+void
+LruCache<Key, Value, SizeOf>::finish(Shard& s, const Key& key, std::size_t token, std::size_t bytes) {
+
+	auto i = s.entries.find(key);
+
+	// the cache was cleared during the materialization
+	if (i == s.entries.end() || i->second.token != token)
+		return;
+
+	// never keep a value that does not fit into the budget
+	if (bytes > _maxBytes) {
+
+		s.entries.erase(i);
+		_evictions++;
+		return;
+	}
+
+	Entry& entry = i->second;
+
+	entry.ready   = true;
+	entry.lastUse = _clock++;
+	entry.bytes   = bytes;
+	s.lru.push_front(key);
+	entry.lruPosition = s.lru.begin();
+	s.bytes += bytes;
+	_bytes  += bytes;
+}
+
+template <typename Key, typename Value, typename SizeOf>
+void
+LruCache<Key, Value, SizeOf>::evictLeastRecentlyUsed(Shard& s) {
+
+	auto i = s.entries.find(s.lru.back());
+	s.lru.pop_back();
+
+	s.bytes -= i->second.bytes;
+	_bytes  -= i->second.bytes;
+	s.entries.erase(i);
+
+	_evictions++;
+}
+
+template <typename Key, typename Value, typename SizeOf>
+void
+LruCache<Key, Value, SizeOf>::evict() {
+
+	while (_bytes > _maxBytes) {
+
+		// find the shard with the least recently used value, holding one lock 
+		// at a time
+		Shard*      oldest        = 0;
+		std::size_t oldestLastUse = std::numeric_limits<std::size_t>::max();
+
+		for (auto& s : _shards) {
+
+			std::lock_guard<std::mutex> lock(s->mutex);
+
+			if (s->lru.empty())
+				continue;
+
+			std::size_t lastUse = s->entries.find(s->lru.back())->second.lastUse;
+			if (lastUse < oldestLastUse) {
+
+				oldest        = s.get();
+				oldestLastUse = lastUse;
+			}
+		}
+
+		if (!oldest)
+			return;
+
+		// the shard might have changed in the meantime, which only makes this 
+		// eviction less exact
+		std::lock_guard<std::mutex> lock(oldest->mutex);
+		if (!oldest->lru.empty() && _bytes > _maxBytes)
+			evictLeastRecentlyUsed(*oldest);
+	}
+}
+
+#endif // CANDIDATE_MC_CRAG_LRU_CACHE_H__
@@ -0,0 +1,88 @@
+#ifndef CANDIDATE_MC_CRAG_PARALLEL_FOR_H__
+#define CANDIDATE_MC_CRAG_PARALLEL_FOR_H__
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Get the number of worker threads to use for the given requested number of 
+ * threads. Values smaller than 1 request one thread per hardware thread.
+ */
+inline unsigned int
+getNumThreads(int requested) {
+
+	if (requested > 0)
+		return requested;
+
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/**
+ * Call f(i) for each i in [0,n) on the given number of threads. Indices are 
+ * handed out to the threads in chunks of chunkSize consecutive indices. If a 
+ * call throws, no further chunks are started and the first exception is 
+ * rethrown in the calling thread once all threads finished.
+ */
+template <typename F>
+void
+parallelFor(std::size_t n, unsigned int numThreads, F f, std::size_t chunkSize = 1) {
+
+	chunkSize  = std::max(chunkSize, (std::size_t)1);
+	numThreads = std::min((std::size_t)std::max(numThreads, 1u), (n + chunkSize - 1)/chunkSize);
+
+	if (numThreads <= 1) {
+
+		for (std::size_t i = 0; i < n; i++)
+			f(i);
+		return;
+	}
+
+	std::atomic<std::size_t> next(0);
+	std::atomic<bool>        failed(false);
+	std::exception_ptr       exception;
+	std::mutex               exceptionMutex;
+
+	auto worker = [&]() {
+
+		while (!failed) {
+
+			std::size_t begin = next.fetch_add(chunkSize);
+			if (begin >= n)
+				return;
+
+			std::size_t end = std::min(begin + chunkSize, n);
+
+			try {
+
+				for (std::size_t i = begin; i < end; i++)
+					f(i);
+
+			} catch (...) {
+
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+				if (!exception)
+					exception = std::current_exception();
+				failed = true;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 0; i < numThreads - 1; i++)
+		threads.emplace_back(worker);
+
+	// the calling thread takes part in the work
+	worker();
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+#endif // CANDIDATE_MC_CRAG_PARALLEL_FOR_H__
@@ -138,6 +138,9 @@ PlanarAdjacencyAnnotator::annotate(Crag& crag, const CragVolumes& volumes) {
 		crag.setAffiliatedEdges(
 				newEdge,
 				affiliatedEdges[*e]);
+
+		// the CRAG keeps a compact copy
+		std::vector<GridGraphType::Edge>().swap(affiliatedEdges[*e]);
 		numAdded++;
 
 		LOG_ALL(planaradjacencyannotatorlog)
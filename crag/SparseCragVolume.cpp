@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cmath>
+#include <util/assert.h>
+#include "SparseCragVolume.h"
+
+namespace {
+
+// position of the first voxel of a volume in the global discrete grid
+util::point<int, 3>
+discreteOrigin(const SparseCragVolume& volume) {
+
+	return util::point<int, 3>(
+			std::lround(volume.getOffset().x()/volume.getResolution().x()),
+			std::lround(volume.getOffset().y()/volume.getResolution().y()),
+			std::lround(volume.getOffset().z()/volume.getResolution().z()));
+}
+
+} // anonymous namespace
+
+SparseCragVolume::SparseCragVolume() :
+	_width(0),
+	_height(0),
+	_depth(0),
+	_lines(1, 0) {}
+
+SparseCragVolume::SparseCragVolume(unsigned int width, unsigned int height, unsigned int depth) :
+	_width(width),
+	_height(height),
+	_depth(depth),
+	_lines((std::size_t)height*depth + 1, 0) {}
+
+SparseCragVolume::SparseCragVolume(const CragVolume& volume) :
+	_width(volume.width()),
+	_height(volume.height()),
+	_depth(volume.depth()) {
+
+	setResolution(volume.getResolution());
+	setOffset(volume.getOffset());
+
+	_lines.reserve((std::size_t)_height*_depth + 1);
+	_lines.push_back(0);
+
+	for (unsigned int z = 0; z < _depth;  z++)
+	for (unsigned int y = 0; y < _height; y++) {
+
+		unsigned int x = 0;
+
+		while (x < _width) {
+
+			while (x < _width && volume(x, y, z) == 0)
+				x++;
+
+			if (x == _width)
+				break;
+
+			unsigned int begin = x;
+
+			while (x < _width && volume(x, y, z) != 0)
+				x++;
+
+			_runs.push_back(Run(begin, x));
+		}
+
+		_lines.push_back(_runs.size());
+	}
+
+	_runs.shrink_to_fit();
+}
+
+SparseCragVolume::SparseCragVolume(
+		unsigned int                width,
+		unsigned int                height,
+		unsigned int                depth,
+		const std::vector<LineRun>& runs) :
+	_width(width),
+	_height(height),
+	_depth(depth) {
+
+	_runs.reserve(runs.size());
+	_lines.reserve((std::size_t)_height*_depth + 1);
+	_lines.push_back(0);
+
+	for (const LineRun& lineRun : runs) {
+
+		UTIL_ASSERT(lineRun.y < _height && lineRun.z < _depth && lineRun.run.end <= _width);
+
+		std::size_t line = (std::size_t)lineRun.z*_height + lineRun.y;
+
+		UTIL_ASSERT_REL(line + 1, >=, _lines.size());
+
+		// close all scanlines before this one
+		while (_lines.size() <= line)
+			_lines.push_back(_runs.size());
+
+		_runs.push_back(lineRun.run);
+	}
+
+	while (_lines.size() < (std::size_t)_height*_depth + 1)
+		_lines.push_back(_runs.size());
+}
+
+bool
+SparseCragVolume::operator()(unsigned int x, unsigned int y, unsigned int z) const {
+
+	if (x >= _width || y >= _height || z >= _depth)
+		return false;
+
+	// the first run that ends after x
+	const Run* run = std::upper_bound(
+			beginLine(y, z),
+			endLine(y, z),
+			x,
+			[](unsigned int x, const Run& run) { return x < run.end; });
+
+	return run != endLine(y, z) && run->begin <= x;
+}
+
+std::size_t
+SparseCragVolume::numVoxels() const {
+
+	std::size_t size = 0;
+	for (const Run& run : _runs)
+		size += run.end - run.begin;
+
+	return size;
+}
+
+std::shared_ptr<CragVolume>
+SparseCragVolume::materialize() const {
+
+	auto volume = std::make_shared<CragVolume>(_width, _height, _depth, 0);
+	volume->setResolution(getResolution());
+	volume->setOffset(getOffset());
+
+	forEachRun([&volume](unsigned int begin, unsigned int end, unsigned int y, unsigned int z) {
+
+		for (unsigned int x = begin; x < end; x++)
+			(*volume)(x, y, z) = 1;
+	});
+
+	return volume;
+}
+
+std::shared_ptr<SparseCragVolume>
+SparseCragVolume::unite(const std::vector<std::shared_ptr<const SparseCragVolume>>& allVolumes) {
+
+	// empty volumes don't contribute to the bounding box
+	std::vector<std::shared_ptr<const SparseCragVolume>> volumes;
+	for (const auto& volume : allVolumes)
+		if (volume->width()*volume->height()*volume->depth() > 0)
+			volumes.push_back(volume);
+
+	if (volumes.empty()) {
+
+		auto empty = std::make_shared<SparseCragVolume>();
+		if (!allVolumes.empty())
+			empty->setResolution(allVolumes[0]->getResolution());
+		return empty;
+	}
+
+	const util::point<float, 3>& resolution = volumes[0]->getResolution();
+
+	// the extent of the union in the global discrete grid
+	util::box<float, 3> bb;
+	util::point<int, 3> min = discreteOrigin(*volumes[0]);
+	util::point<int, 3> max = min;
+
+	for (const auto& volume : volumes) {
+
+		UTIL_ASSERT_REL(volume->getResolution(), ==, resolution);
+
+		util::point<int, 3> origin = discreteOrigin(*volume);
+
+		min.x() = std::min(min.x(), origin.x());
+		min.y() = std::min(min.y(), origin.y());
+		min.z() = std::min(min.z(), origin.z());
+		max.x() = std::max(max.x(), origin.x() + (int)volume->width());
+		max.y() = std::max(max.y(), origin.y() + (int)volume->height());
+		max.z() = std::max(max.z(), origin.z() + (int)volume->depth());
+
+		bb += volume->getBoundingBox();
+	}
+
+	auto result = std::make_shared<SparseCragVolume>(
+			max.x() - min.x(),
+			max.y() - min.y(),
+			max.z() - min.z());
+	result->setResolution(resolution);
+	result->setOffset(bb.min());
+
+	// collect the runs of all volumes with the scanline they fall into in the 
+	// result, and bring them into scanline order
+	std::vector<std::pair<std::size_t, Run>> runs;
+
+	for (const auto& volume : volumes) {
+
+		util::point<int, 3> origin = discreteOrigin(*volume);
+		util::point<int, 3> shift  = origin - min;
+
+		volume->forEachRun([&](unsigned int begin, unsigned int end, unsigned int y, unsigned int z) {
+
+			std::size_t line = (std::size_t)(z + shift.z())*result->_height + y + shift.y();
+			runs.push_back(std::make_pair(line, Run(begin + shift.x(), end + shift.x())));
+		});
+	}
+
+	std::sort(
+			runs.begin(),
+			runs.end(),
+			[](const std::pair<std::size_t, Run>& a, const std::pair<std::size_t, Run>& b) {
+
+				return a.first < b.first || (a.first == b.first && a.second.begin < b.second.begin);
+			});
+
+	// merge overlapping and touching runs within each scanline
+	result->_runs.reserve(runs.size());
+
+	std::size_t line = 0;
+	for (const auto& p : runs) {
+
+		// close the scanlines before the one of this run
+		for (; line < p.first; line++)
+			result->_lines[line + 1] = result->_runs.size();
+
+		const Run& run = p.second;
+
+		if (result->_runs.size() > result->_lines[line] && run.begin <= result->_runs.back().end)
+			result->_runs.back().end = std::max(result->_runs.back().end, run.end);
+		else
+			result->_runs.push_back(run);
+	}
+
+	for (; line < result->_lines.size() - 1; line++)
+		result->_lines[line + 1] = result->_runs.size();
+
+	result->_runs.shrink_to_fit();
+
+	return result;
+}
+
+std::shared_ptr<SparseCragVolume>
+SparseCragVolume::intersect(const SparseCragVolume& a, const SparseCragVolume& b) {
+
+	UTIL_ASSERT_REL(a.getResolution(), ==, b.getResolution());
+
+	util::point<int, 3> originA = discreteOrigin(a);
+	util::point<int, 3> originB = discreteOrigin(b);
+
+	// the extent of the intersection in the global discrete grid
+	util::point<int, 3> min(
+			std::max(originA.x(), originB.x()),
+			std::max(originA.y(), originB.y()),
+			std::max(originA.z(), originB.z()));
+	util::point<int, 3> max(
+			std::min(originA.x() + (int)a.width(),  originB.x() + (int)b.width()),
+			std::min(originA.y() + (int)a.height(), originB.y() + (int)b.height()),
+			std::min(originA.z() + (int)a.depth(),  originB.z() + (int)b.depth()));
+
+	if (max.x() <= min.x() || max.y() <= min.y() || max.z() <= min.z()) {
+
+		auto empty = std::make_shared<SparseCragVolume>();
+		empty->setResolution(a.getResolution());
+		empty->setOffset(a.getOffset());
+		return empty;
+	}
+
+	auto result = std::make_shared<SparseCragVolume>(
+			max.x() - min.x(),
+			max.y() - min.y(),
+			max.z() - min.z());
+	result->setResolution(a.getResolution());
+	result->setOffset(
+			std::max(a.getOffset().x(), b.getOffset().x()),
+			std::max(a.getOffset().y(), b.getOffset().y()),
+			std::max(a.getOffset().z(), b.getOffset().z()));
+
+	result->_lines.clear();
+	result->_lines.push_back(0);
+
+	// x-shifts from a and b into the result
+	int shiftA = originA.x() - min.x();
+	int shiftB = originB.x() - min.x();
+
+	for (unsigned int z = 0; z < result->_depth;  z++)
+	for (unsigned int y = 0; y < result->_height; y++) {
+
+		unsigned int ay = y + min.y() - originA.y();
+		unsigned int az = z + min.z() - originA.z();
+		unsigned int by = y + min.y() - originB.y();
+		unsigned int bz = z + min.z() - originB.z();
+
+		const Run* i = a.beginLine(ay, az);
+		const Run* j = b.beginLine(by, bz);
+
+		while (i != a.endLine(ay, az) && j != b.endLine(by, bz)) {
+
+			int begin = std::max((int)i->begin + shiftA, (int)j->begin + shiftB);
+			int end   = std::min((int)i->end   + shiftA, (int)j->end   + shiftB);
+
+			if (begin < end)
+				result->_runs.push_back(Run(begin, end));
+
+			// advance the run that ends first
+			if ((int)i->end + shiftA < (int)j->end + shiftB)
+				i++;
+			else
+				j++;
+		}
+
+		result->_lines.push_back(result->_runs.size());
+	}
+
+	return result;
+}
+
+std::size_t
+SparseCragVolume::intersectionSize(const SparseCragVolume& a, const SparseCragVolume& b) {
+
+	UTIL_ASSERT_REL(a.getResolution(), ==, b.getResolution());
+
+	util::point<int, 3> originA = discreteOrigin(a);
+	util::point<int, 3> originB = discreteOrigin(b);
+
+	int minY = std::max(originA.y(), originB.y());
+	int minZ = std::max(originA.z(), originB.z());
+	int maxY = std::min(originA.y() + (int)a.height(), originB.y() + (int)b.height());
+	int maxZ = std::min(originA.z() + (int)a.depth(),  originB.z() + (int)b.depth());
+
+	std::size_t size = 0;
+
+	for (int z = minZ; z < maxZ; z++)
+	for (int y = minY; y < maxY; y++) {
+
+		const Run* i = a.beginLine(y - originA.y(), z - originA.z());
+		const Run* j = b.beginLine(y - originB.y(), z - originB.z());
+		const Run* endA = a.endLine(y - originA.y(), z - originA.z());
+		const Run* endB = b.endLine(y - originB.y(), z - originB.z());
+
+		// compare in global x coordinates
+		while (i != endA && j != endB) {
+
+			int beginX = std::max((int)i->begin + originA.x(), (int)j->begin + originB.x());
+			int endX   = std::min((int)i->end   + originA.x(), (int)j->end   + originB.x());
+
+			if (beginX < endX)
+				size += endX - beginX;
+
+			if ((int)i->end + originA.x() < (int)j->end + originB.x())
+				i++;
+			else
+				j++;
+		}
+	}
+
+	return size;
+}
@@ -0,0 +1,185 @@
+#ifndef CANDIDATE_MC_CRAG_SPARSE_CRAG_VOLUME_H__
+#define CANDIDATE_MC_CRAG_SPARSE_CRAG_VOLUME_H__
+
+#include <memory>
+#include <vector>
+#include <imageprocessing/DiscreteVolume.h>
+#include "CragVolume.h"
+
+/**
+ * A run-length encoded candidate mask. For each scanline (a row of voxels 
+ * along x) only the intervals of non-zero voxels are stored. This is much 
+ * smaller than a CragVolume for thin or elongated candidates, which leave most 
+ * of their bounding box empty.
+ *
+ * The discrete bounding box is the same as the one of the CragVolume the mask 
+ * was created from, such that materialize() restores the original volume.
+ */
+class SparseCragVolume : public DiscreteVolume {
+
+public:
+
+	/**
+	 * A half-open interval [begin, end) of non-zero voxels in a scanline.
+	 */
+	struct Run {
+
+		Run() : begin(0), end(0) {}
+		Run(unsigned int begin_, unsigned int end_) : begin(begin_), end(end_) {}
+
+		unsigned int begin;
+		unsigned int end;
+	};
+
+	/**
+	 * A run in the scanline at (y, z).
+	 */
+	struct LineRun {
+
+		LineRun(unsigned int y_, unsigned int z_, Run run_) : y(y_), z(z_), run(run_) {}
+
+		unsigned int y;
+		unsigned int z;
+		Run          run;
+	};
+
+	/**
+	 * Create an empty mask.
+	 */
+	SparseCragVolume();
+
+	/**
+	 * Create an empty mask with the given size in voxels.
+	 */
+	SparseCragVolume(unsigned int width, unsigned int height, unsigned int depth);
+
+	/**
+	 * Encode the non-zero voxels of a CragVolume.
+	 */
+	explicit SparseCragVolume(const CragVolume& volume);
+
+	/**
+	 * Create a mask with the given size in voxels from non-overlapping runs, 
+	 * given in scanline order.
+	 */
+	SparseCragVolume(
+			unsigned int                width,
+			unsigned int                height,
+			unsigned int                depth,
+			const std::vector<LineRun>& runs);
+
+	unsigned int width()  const { return _width; }
+	unsigned int height() const { return _height; }
+	unsigned int depth()  const { return _depth; }
+
+	/**
+	 * The runs of the scanline at (y, z), ordered by x.
+	 */
+	const Run* beginLine(unsigned int y, unsigned int z) const { return _runs.data() + _lines[z*_height + y]; }
+	const Run* endLine(unsigned int y, unsigned int z)   const { return _runs.data() + _lines[z*_height + y + 1]; }
+
+	/**
+	 * Call f(begin, end, y, z) for each run, in scanline order.
+	 */
+	template <typename F>
+	void forEachRun(F f) const;
+
+	/**
+	 * Call f(x, y, z) for each non-zero voxel, in scanline order.
+	 */
+	template <typename F>
+	void forEachVoxel(F f) const;
+
+	/**
+	 * Test whether the voxel at the given discrete position is set.
+	 */
+	bool operator()(unsigned int x, unsigned int y, unsigned int z) const;
+
+	std::size_t numRuns() const { return _runs.size(); }
+
+	/**
+	 * The number of non-zero voxels.
+	 */
+	std::size_t numVoxels() const;
+
+	/**
+	 * The memory used by the encoding.
+	 */
+	std::size_t getSizeInBytes() const {
+
+		return _runs.size()*sizeof(Run) + _lines.size()*sizeof(std::size_t);
+	}
+
+	/**
+	 * Convert this mask into a CragVolume, with voxels set to 1.
+	 */
+	std::shared_ptr<CragVolume> materialize() const;
+
+	/**
+	 * Get the union of several masks of the same resolution. The bounding box 
+	 * of the result is the union of the bounding boxes.
+	 */
+	static std::shared_ptr<SparseCragVolume> unite(
+			const std::vector<std::shared_ptr<const SparseCragVolume>>& volumes);
+
+	/**
+	 * Get the intersection of two masks of the same resolution. The bounding 
+	 * box of the result is the intersection of the bounding boxes.
+	 */
+	static std::shared_ptr<SparseCragVolume> intersect(
+			const SparseCragVolume& a,
+			const SparseCragVolume& b);
+
+	/**
+	 * Count the voxels set in both masks, without creating the intersection.
+	 */
+	static std::size_t intersectionSize(
+			const SparseCragVolume& a,
+			const SparseCragVolume& b);
+
+protected:
+
+	util::box<unsigned int, 3> computeDiscreteBoundingBox() const override {
+
+		return util::box<unsigned int, 3>(
+				util::point<unsigned int, 3>(),
+				util::point<unsigned int, 3>(_width, _height, _depth));
+	}
+
+private:
+
+	unsigned int _width;
+	unsigned int _height;
+	unsigned int _depth;
+
+	// all runs, ordered by scanline
+	std::vector<Run> _runs;
+
+	// index of the first run of each scanline (z*height + y) in _runs, with a 
+	// final entry for the end of the last scanline
+	std::vector<std::size_t> _lines;
+};
+
+template <typename F>
+void
+SparseCragVolume::forEachRun(F f) const {
+
+	for (unsigned int z = 0; z < _depth;  z++)
+	for (unsigned int y = 0; y < _height; y++)
+		for (const Run* run = beginLine(y, z); run != endLine(y, z); run++)
+			f(run->begin, run->end, y, z);
+}
+
+template <typename F>
+void
+SparseCragVolume::forEachVoxel(F f) const {
+
+	forEachRun([&f](unsigned int begin, unsigned int end, unsigned int y, unsigned int z) {
+
+		for (unsigned int x = begin; x < end; x++)
+			f(x, y, z);
+	});
+}
+
+#endif // CANDIDATE_MC_CRAG_SPARSE_CRAG_VOLUME_H__
+
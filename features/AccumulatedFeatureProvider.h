@@ -1,13 +1,16 @@
 #ifndef CANDIDATE_MC_FEATURES_ACCUMULATED_FEATURE_PROVIDER_H__
 #define CANDIDATE_MC_FEATURES_ACCUMULATED_FEATURE_PROVIDER_H__
 
+#include <cmath>
 #include "FeatureProvider.h"
-
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/moment.hpp>
-
+#include "LeafEdgeSummaries.h"
+#include "ValueSummary.h"
+
+/**
+ * Statistics of the values of the voxels next to the affiliated grid edges of 
+ * adjacency edges. The statistics are computed once for each leaf edge and 
+ * merged for the other edges.
+ */
 class AccumulatedFeatureProvider : public FeatureProvider<AccumulatedFeatureProvider> {
 
 public:
@@ -18,46 +21,35 @@ public:
 			const std::string valuesName = "values") :
 		_crag(crag),
 		_values(values),
-		_valuesName(valuesName){}
+		_valuesName(valuesName),
+		_summaries(crag) {}
+
+	using FeatureProvider<AccumulatedFeatureProvider>::appendFeatures;
+
+	void appendFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) override {
+
+		_summaries.compute(
+				[this](Crag::CragEdge leafEdge) { return summarize(leafEdge); },
+				_numThreads);
+
+		FeatureProvider<AccumulatedFeatureProvider>::appendFeatures(crag, edgeFeatures);
+	}
 
 	template <typename ContainerT>
 	void appendEdgeFeatures(const Crag::CragEdge e, ContainerT& adaptor) {
 
 		if (_crag.type(e) == Crag::AdjacencyEdge)
 		{
-			// Define an accumulator set for calculating the mean and the
-			// 2nd moment and 3rd moment.
-			using namespace boost::accumulators;
-			typedef  stats<
-				tag::mean,
-				tag::moment<2>,
-				tag::moment<3>
-			> Stats;
-			accumulator_set<double, Stats> accumulator;
-
-			const auto & gridGraph = _crag.getGridGraph();
-
-			// push data into the accumulator
-			unsigned int numAffiliatedEdges = 0;
-			for (Crag::CragEdge leafEdge : _crag.leafEdges(e))
-				for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(leafEdge)) {
-					const auto ggU = gridGraph.u(ae);
-					const auto ggV = gridGraph.v(ae);
-
-					accumulator(_values[ggU]);
-					accumulator(_values[ggV]);
-
-					numAffiliatedEdges++;
-				}
-
-			// TODO: affilitatedEdgesProvider?
-			adaptor.append(numAffiliatedEdges);
-
-			// extract the features from the accumulator
-			adaptor.append(mean(accumulator));
-			adaptor.append(sqrt(moment<2>(accumulator)));
-			adaptor.append(moment<3>(accumulator));
+			ValueSummary summary = _summaries.get(e);
 
+			// TODO: affiliatedEdgesProvider?
+			// two values per affiliated edge
+			adaptor.append(summary.count()/2);
+
+			// mean, 2nd moment, and 3rd moment
+			adaptor.append(summary.mean());
+			adaptor.append(sqrt(summary.moment2()));
+			adaptor.append(summary.moment3());
 		}
 	}
 
@@ -73,11 +65,31 @@ public:
 		return names;
 	}
 
+protected:
+
+	bool supportsParallelExtraction() const override { return true; }
+
 private:
 
+	ValueSummary summarize(Crag::CragEdge leafEdge) const {
+
+		const auto& gridGraph = _crag.getGridGraph();
+
+		ValueSummary summary;
+		for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(leafEdge)) {
+
+			summary.add(_values[gridGraph.u(ae)]);
+			summary.add(_values[gridGraph.v(ae)]);
+		}
+
+		return summary;
+	}
+
 	const Crag& _crag;
 	const ExplicitVolume<float>& _values;
 	std::string _valuesName;
+
+	LeafEdgeSummaries<ValueSummary> _summaries;
 };
 
 #endif // CANDIDATE_MC_FEATURES_ACCUMULATED_FEATURE_PROVIDER_H__
@@ -1,15 +1,19 @@
 #ifndef CANDIDATE_MC_FEATURES_AFFINITY_FEATURE_PROVIDER_H__
 #define CANDIDATE_MC_FEATURES_AFFINITY_FEATURE_PROVIDER_H__
 
+#include <cmath>
+#include <limits>
 #include "FeatureProvider.h"
-
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/min.hpp>
-#include <boost/accumulators/statistics/max.hpp>
-#include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/moment.hpp>
-
+#include "LeafEdgeSummaries.h"
+#include "QuantileSketch.h"
+#include "ValueSummary.h"
+
+/**
+ * Statistics of the affinities of the affiliated grid edges of adjacency 
+ * edges. The statistics are computed once for each leaf edge and merged for 
+ * the other edges. Quantiles are found in a histogram with quantileBins bins 
+ * over the range of the affinities.
+ */
 class AffinityFeatureProvider : public FeatureProvider<AffinityFeatureProvider> {
 
 public:
@@ -19,77 +23,71 @@ public:
 			const ExplicitVolume<float>& xAffinities,
 			const ExplicitVolume<float>& yAffinities,
 			const ExplicitVolume<float>& zAffinities,
-			const std::string valuesName = "affinities") :
+			const std::string valuesName = "affinities",
+			unsigned int quantileBins = 4096) :
 		_crag(crag),
 		_xAffinities(xAffinities),
 		_yAffinities(yAffinities),
 		_zAffinities(zAffinities),
-		_valuesName(valuesName){}
+		_valuesName(valuesName),
+		_quantileBins(quantileBins),
+		_summaries(crag) {}
+
+	using FeatureProvider<AffinityFeatureProvider>::appendFeatures;
+
+	void appendFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) override {
+
+		float min = std::numeric_limits<float>::infinity();
+		float max = -std::numeric_limits<float>::infinity();
+
+		for (const ExplicitVolume<float>* affinities : {&_xAffinities, &_yAffinities, &_zAffinities})
+			for (float affinity : affinities->data()) {
+
+				min = std::min(min, affinity);
+				max = std::max(max, affinity);
+			}
+
+		_binning = QuantileSketch::Binning(min, max, _quantileBins);
+
+		_summaries.compute(
+				[this](Crag::CragEdge leafEdge) { return summarize(leafEdge); },
+				_numThreads);
+
+		FeatureProvider<AffinityFeatureProvider>::appendFeatures(crag, edgeFeatures);
+	}
 
 	template <typename ContainerT>
 	void appendEdgeFeatures(const Crag::CragEdge e, ContainerT& adaptor) {
 
 		if (_crag.type(e) == Crag::AdjacencyEdge)
 		{
-			using namespace boost::accumulators;
-			typedef  stats<
-				tag::min,
-				tag::max,
-				tag::mean,
-				tag::moment<2>,
-				tag::moment<3>
-			> Stats;
-			accumulator_set<double, Stats> accumulator;
-			std::vector<double> affinities;
-			const auto & gridGraph = _crag.getGridGraph();
-
-			for (Crag::CragEdge leafEdge : _crag.leafEdges(e))
-				for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(leafEdge)) {
-
-					const auto ggU = gridGraph.u(ae);
-					const auto ggV = gridGraph.v(ae);
-
-					auto max = std::max(ggU, ggV);
-					auto min = std::min(ggU, ggV);
-
-					double affinity;
-					if (max[0] != min[0])
-						affinity = _xAffinities[max];
-					else if (max[1] != min[1])
-						affinity = _yAffinities[max];
-					else
-						affinity = _zAffinities[max];
-
-					accumulator(affinity);
-					affinities.push_back(affinity);
-				}
+			Summary summary = _summaries.get(e);
+			std::size_t size = summary.values.count();
 
 			// TODO: affilitatedEdgesProvider?
 
 			// number of affiliated edges
-			adaptor.append(affinities.size());
+			adaptor.append(size);
+
+			if (size == 0) {
+
+				for (int i = 0; i < 8; i++)
+					adaptor.append(0);
+				return;
+			}
 
-			// extract the features from the accumulator
-			// quartiles and median are approximation on accumulator, so we will get information from std::nth_element
-			auto const quantile25 = affinities.size() / 4;
-			auto const median     = affinities.size() / 2;
+			auto const quantile25 = size / 4;
+			auto const median     = size / 2;
 			auto const quantile75 = quantile25 + median;
 
-			// quantile 25%
-			std::nth_element(affinities.begin(),                  affinities.begin() + quantile25, affinities.end());
-			//median
-			std::nth_element(affinities.begin() + quantile25 + 1, affinities.begin() + median,     affinities.end());
-			// quantile 75%
-			std::nth_element(affinities.begin() + median + 1,     affinities.begin() + quantile75, affinities.end());
-
-			adaptor.append(min(accumulator));
-			adaptor.append(affinities[quantile25]);
-			adaptor.append(affinities[median]);
-			adaptor.append(affinities[quantile75]);
-			adaptor.append(max(accumulator));
-			adaptor.append(mean(accumulator));
-			adaptor.append(sqrt(moment<2>(accumulator)));
-			adaptor.append(moment<3>(accumulator));
+			adaptor.append(summary.values.min());
+			adaptor.append(getQuantile(summary, quantile25));
+			adaptor.append(getQuantile(summary, median));
+			adaptor.append(getQuantile(summary, quantile75));
+			adaptor.append(summary.values.max());
+			adaptor.append(summary.values.mean());
+			adaptor.append(sqrt(summary.values.moment2()));
+			adaptor.append(summary.values.moment3());
 		}
 	}
 
@@ -110,13 +108,74 @@ public:
 		return names;
 	}
 
+protected:
+
+	bool supportsParallelExtraction() const override { return true; }
+
 private:
 
+	struct Summary {
+
+		void merge(const Summary& other) {
+
+			values.merge(other.values);
+			quantiles.merge(other.quantiles);
+		}
+
+		ValueSummary   values;
+		QuantileSketch quantiles;
+	};
+
+	Summary summarize(Crag::CragEdge leafEdge) const {
+
+		const auto& gridGraph = _crag.getGridGraph();
+
+		Summary summary;
+		std::vector<unsigned int> bins;
+
+		for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(leafEdge)) {
+
+			const auto ggU = gridGraph.u(ae);
+			const auto ggV = gridGraph.v(ae);
+
+			auto max = std::max(ggU, ggV);
+			auto min = std::min(ggU, ggV);
+
+			double affinity;
+			if (max[0] != min[0])
+				affinity = _xAffinities[max];
+			else if (max[1] != min[1])
+				affinity = _yAffinities[max];
+			else
+				affinity = _zAffinities[max];
+
+			summary.values.add(affinity);
+			bins.push_back(_binning.bin(affinity));
+		}
+
+		summary.quantiles = QuantileSketch(bins);
+
+		return summary;
+	}
+
+	// the interpolated quantile, clamped to the range of the summarized values
+	double getQuantile(const Summary& summary, std::size_t rank) const {
+
+		double value = summary.quantiles.valueAtRank(rank, _binning);
+
+		return std::max(summary.values.min(), std::min(summary.values.max(), value));
+	}
+
 	const Crag& _crag;
 	const ExplicitVolume<float>& _xAffinities;
 	const ExplicitVolume<float>& _yAffinities;
 	const ExplicitVolume<float>& _zAffinities;
 	std::string _valuesName;
+
+	unsigned int            _quantileBins;
+	QuantileSketch::Binning _binning;
+
+	LeafEdgeSummaries<Summary> _summaries;
 };
 
 #endif // CANDIDATE_MC_FEATURES_AFFINITY_FEATURE_PROVIDER_H__
@@ -128,7 +128,8 @@ private:
 
 	double differences(Crag::CragNode i, double overlap) {
 
-		CragVolume& vol_i = *_volumes[i];
+		std::shared_ptr<CragVolume> vol_iPtr = _volumes[i];
+		CragVolume& vol_i = *vol_iPtr;
 
 		double totalVolume = 0.0;
 		for (int z = 0; z < vol_i.depth();  z++)
@@ -157,8 +158,10 @@ private:
 		// list of voxel affinity values between the two slice nodes
 		std::vector<float> contactAffinities;
 
-		const CragVolume& vol_i = *_volumes[i];
-		const CragVolume& vol_j = *_volumes[j];
+		std::shared_ptr<CragVolume> vol_iPtr = _volumes[i];
+		const CragVolume& vol_i = *vol_iPtr;
+		std::shared_ptr<CragVolume> vol_jPtr = _volumes[j];
+		const CragVolume& vol_j = *vol_jPtr;
 
 		util::point<int,3> discreteGlobalOffset_i = vol_i.getOffset()/vol_i.getResolution();
 		util::point<int,3> discreteGlobalOffset_j = vol_j.getOffset()/vol_j.getResolution();
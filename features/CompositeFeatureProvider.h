@@ -25,6 +25,14 @@ public:
 			provider->appendFeatures(crag, edgeFeatures);
 	}
 
+	void setNumThreads(int numThreads) override {
+
+		FeatureProviderBase::setNumThreads(numThreads);
+
+		for (FeatureProviderBase* provider : _providers)
+			provider->setNumThreads(numThreads);
+	}
+
 	template <typename ProviderType, typename... Args>
 	void emplace_back(Args&&... args) {
 
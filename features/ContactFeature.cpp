@@ -1,9 +1,72 @@
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
 #include "ContactFeature.h"
 #include <util/Logger.h>
 #include <util/helpers.hpp>
 
 logger::LogChannel contactfeaturelog("contactfeaturelog", "[ContactFeature] ");
 
+void
+ContactFeature::prepare(unsigned int numThreads) {
+
+	std::call_once(_prepared, [this, numThreads]{
+
+		const auto& gridGraph = _crag.getGridGraph();
+
+		// find the voxels that are next to more than one leaf edge, by 
+		// remembering the id of the first leaf edge of each contact voxel
+		std::unordered_map<std::size_t, int> voxelEdges;
+
+		for (Crag::CragEdge e : _crag.edges()) {
+
+			if (!_crag.isLeafEdge(e))
+				continue;
+
+			int id = _crag.id(e);
+
+			for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(e))
+				for (vigra::GridGraph<3>::Node n : {gridGraph.u(ae), gridGraph.v(ae)}) {
+
+					std::size_t voxel = gridGraph.id(n);
+					auto voxelEdge = voxelEdges.emplace(voxel, id).first;
+
+					if (voxelEdge->second != id)
+						_sharedVoxels.insert(voxel);
+				}
+		}
+
+		_summaries.compute(
+				[this](Crag::CragEdge leafEdge) { return summarize(leafEdge); },
+				numThreads);
+
+		// count the voxels of each candidate once
+		std::vector<Crag::CragNode> nodes;
+		int maxNodeId = -1;
+		for (Crag::CragNode n : _crag.nodes()) {
+
+			maxNodeId = std::max(maxNodeId, _crag.id(n));
+
+			for (Crag::CragEdge e : _crag.adjEdges(n))
+				if (_crag.type(e) == Crag::AdjacencyEdge) {
+
+					nodes.push_back(n);
+					break;
+				}
+		}
+
+		_nodeCounts.resize(maxNodeId + 1);
+
+		parallelFor(
+				nodes.size(),
+				numThreads,
+				[&](std::size_t i) {
+
+					_nodeCounts[_crag.id(nodes[i])] = countVoxels(nodes[i]);
+				});
+	});
+}
+
 std::vector<double>
 ContactFeature::compute(Crag::CragEdge e) {
 
@@ -11,6 +74,8 @@ ContactFeature::compute(Crag::CragEdge e) {
 
 	LOG_ALL(contactfeaturelog) << "computing contact feature for thresholds " << _thresholds << std::endl;
 
+	prepare(1);
+
 	// number of voxels brighter than thresholds in contact, plus size
 	//
 	// initialize threshold counts with 1 for numerical stability (and because 
@@ -18,31 +83,23 @@ ContactFeature::compute(Crag::CragEdge e) {
 	std::vector<int> contactCounts(_thresholds.size() + 1, 1);
 	(*contactCounts.rbegin()) = 0;
 
-	// get all unique voxels adjacent to contact
-	std::set<vigra::GridGraph<3>::Node> contactVoxels;
-	const auto& gridGraph = _crag.getGridGraph();
-	for (Crag::CragEdge leafEdge : _crag.leafEdges(e))
-		for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(leafEdge)) {
-
-			contactVoxels.insert(gridGraph.u(ae));
-			contactVoxels.insert(gridGraph.v(ae));
-		}
-
-	// count voxels above thresholds
-	for (auto n : contactVoxels) {
+	ContactSummary summary = _summaries.get(e);
 
-		float value = _boundaries[n];
+	for (std::size_t i = 0; i < summary.counts.size(); i++)
+		contactCounts[i] += summary.counts[i];
 
-		for (int i = 0; i < _thresholds.size(); i++)
-			if (value > _thresholds[i])
-				contactCounts[i]++;
-
-		(*contactCounts.rbegin())++;
-	}
+	const auto& gridGraph = _crag.getGridGraph();
+	for (std::size_t voxel : summary.sharedVoxels)
+		count(_boundaries[gridGraph.nodeFromId(voxel)], contactCounts);
 
 	// count voxels inside candidates
-	std::vector<int> uCounts = countVoxels(e.u());
-	std::vector<int> vCounts = countVoxels(e.v());
+	std::vector<int> uCounts = _nodeCounts[_crag.id(e.u())];
+	std::vector<int> vCounts = _nodeCounts[_crag.id(e.v())];
+
+	if (uCounts.empty())
+		uCounts = countVoxels(e.u());
+	if (vCounts.empty())
+		vCounts = countVoxels(e.v());
 
 	double uVolRatio = (double)(*contactCounts.rbegin())/(*uCounts.rbegin());
 	double vVolRatio = (double)(*contactCounts.rbegin())/(*vCounts.rbegin());
@@ -86,10 +143,68 @@ ContactFeature::compute(Crag::CragEdge e) {
 	return features;
 }
 
+void
+ContactFeature::ContactSummary::merge(const ContactSummary& other) {
+
+	if (counts.size() < other.counts.size())
+		counts.resize(other.counts.size(), 0);
+
+	for (std::size_t i = 0; i < other.counts.size(); i++)
+		counts[i] += other.counts[i];
+
+	// keep each voxel next to several of the merged leaf edges only once
+	std::vector<std::size_t> merged;
+	merged.reserve(sharedVoxels.size() + other.sharedVoxels.size());
+	std::set_union(
+			sharedVoxels.begin(), sharedVoxels.end(),
+			other.sharedVoxels.begin(), other.sharedVoxels.end(),
+			std::back_inserter(merged));
+	sharedVoxels.swap(merged);
+}
+
+ContactFeature::ContactSummary
+ContactFeature::summarize(Crag::CragEdge leafEdge) const {
+
+	const auto& gridGraph = _crag.getGridGraph();
+
+	// the grid node ids of the contact voxels
+	std::vector<std::size_t> voxels;
+	for (vigra::GridGraph<3>::Edge ae : _crag.getAffiliatedEdges(leafEdge)) {
+
+		voxels.push_back(gridGraph.id(gridGraph.u(ae)));
+		voxels.push_back(gridGraph.id(gridGraph.v(ae)));
+	}
+
+	std::sort(voxels.begin(), voxels.end());
+	voxels.erase(std::unique(voxels.begin(), voxels.end()), voxels.end());
+
+	ContactSummary summary;
+	summary.counts.resize(_thresholds.size() + 1, 0);
+
+	for (std::size_t voxel : voxels)
+		if (_sharedVoxels.count(voxel))
+			summary.sharedVoxels.push_back(voxel);
+		else
+			count(_boundaries[gridGraph.nodeFromId(voxel)], summary.counts);
+
+	return summary;
+}
+
+void
+ContactFeature::count(float value, std::vector<int>& counts) const {
+
+	for (int i = 0; i < _thresholds.size(); i++)
+		if (value > _thresholds[i])
+			counts[i]++;
+
+	(*counts.rbegin())++;
+}
+
 std::vector<int>
 ContactFeature::countVoxels(Crag::CragNode n) {
 
-	const CragVolume& volume = *_volumes[n];
+	std::shared_ptr<CragVolume> volumePtr = _volumes[n];
+	const CragVolume& volume = *volumePtr;
 
 	const util::box<float, 3>&   nodeBoundingBox    = volume.getBoundingBox();
 	util::point<unsigned int, 3> nodeSize           = (nodeBoundingBox.max() - nodeBoundingBox.min())/volume.getResolution();
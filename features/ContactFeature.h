@@ -1,11 +1,20 @@
 #ifndef CANDIDATE_MC_FEATURES_CONTACT_FEATURE_H__
 #define CANDIDATE_MC_FEATURES_CONTACT_FEATURE_H__
 
+#include <mutex>
+#include <unordered_set>
 #include <crag/Crag.h>
 #include <crag/CragVolumes.h>
+#include "LeafEdgeSummaries.h"
 
 /**
  * Implementation of the "contact" feature used in Gala.
+ *
+ * The contact voxels of an edge are the voxels next to the affiliated grid 
+ * edges of its leaf edges. Most contact voxels belong to a single leaf edge, 
+ * for these only the counts per leaf edge are kept and summed for higher 
+ * edges. Voxels next to several leaf edges are kept explicitly, such that they 
+ * are counted only once.
  */
 class ContactFeature {
 
@@ -19,18 +28,59 @@ public:
 		_crag(crag),
 		_volumes(volumes),
 		_boundaries(boundaries),
-		_thresholds(thresholds) {}
+		_thresholds(thresholds),
+		_summaries(crag) {
+
+		// compute the lazy bounding box now, edges are processed in parallel
+		_boundaries.getBoundingBox();
+	}
+
+	/**
+	 * Summarize the contact voxels of all leaf edges and count the voxels of 
+	 * all candidates with adjacency edges. Called by compute() with one 
+	 * thread, if not called before.
+	 */
+	void prepare(unsigned int numThreads);
 
 	std::vector<double> compute(Crag::CragEdge e);
 
 private:
 
+	struct ContactSummary {
+
+		void merge(const ContactSummary& other);
+
+		// the number of contact voxels above each threshold, and the total 
+		// number as last element, for voxels next to only one leaf edge
+		std::vector<int> counts;
+
+		// the grid node ids of the contact voxels next to several leaf edges, 
+		// sorted and without duplicates
+		std::vector<std::size_t> sharedVoxels;
+	};
+
+	ContactSummary summarize(Crag::CragEdge leafEdge) const;
+
+	// add value to the threshold counts
+	void count(float value, std::vector<int>& counts) const;
+
 	std::vector<int> countVoxels(Crag::CragNode n);
 
 	const Crag& _crag;
 	const CragVolumes& _volumes;
 	const ExplicitVolume<float> _boundaries;
 	std::vector<float> _thresholds;
+
+	std::once_flag _prepared;
+
+	// the grid node ids of the voxels that are contact voxels of several leaf 
+	// edges
+	std::unordered_set<std::size_t> _sharedVoxels;
+
+	LeafEdgeSummaries<ContactSummary> _summaries;
+
+	// the voxel counts of candidates, by node id
+	std::vector<std::vector<int>> _nodeCounts;
 };
 
 #endif // CANDIDATE_MC_FEATURES_CONTACT_FEATURE_H__
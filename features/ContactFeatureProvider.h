@@ -19,6 +19,15 @@ public:
 		_valuesName(valuesName),
 		_contactFeature(crag, volumes, values) {}
 
+	using FeatureProvider<ContactFeatureProvider>::appendFeatures;
+
+	void appendFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) override {
+
+		_contactFeature.prepare(_numThreads);
+
+		FeatureProvider<ContactFeatureProvider>::appendFeatures(crag, edgeFeatures);
+	}
+
 	template <typename ContainerT>
 	void appendEdgeFeatures(const Crag::CragEdge e, ContainerT& adaptor) {
 
@@ -59,6 +68,10 @@ public:
 		return names;
 	}
 
+protected:
+
+	bool supportsParallelExtraction() const override { return true; }
+
 private:
 
 	const Crag&        _crag;
@@ -0,0 +1,52 @@
+#ifndef CANDIDATE_MC_FEATURES_DISTANCE_MAP_CACHE_H__
+#define CANDIDATE_MC_FEATURES_DISTANCE_MAP_CACHE_H__
+
+#include <vigra/multi_array.hxx>
+#include <util/box.hpp>
+#include <util/point.hpp>
+#include <crag/LruCache.h>
+
+/**
+ * The squared distance transform of the background of a 2D volume, padded on 
+ * each side, together with the placement of the volume it was computed for.
+ */
+struct DistanceMap {
+
+	// squared distances to the closest foreground voxel
+	vigra::MultiArray<2, double> distances;
+
+	// the discrete bounding box of the volume in the x-y plane
+	util::box<int, 2> discreteBoundingBox;
+
+	// the bounding box of the volume in world units
+	util::box<float, 3> boundingBox;
+
+	// the number of voxels the volume was padded with
+	int padX;
+	int padY;
+
+	std::size_t getSizeInBytes() const {
+
+		return distances.size()*sizeof(double);
+	}
+};
+
+/**
+ * The number of bytes a distance map accounts for in a DistanceMapCache.
+ */
+struct DistanceMapSize {
+
+	std::size_t operator()(const DistanceMap& distanceMap) const {
+
+		return distanceMap.getSizeInBytes();
+	}
+};
+
+/**
+ * A thread-safe cache for distance maps with a memory budget in bytes. If the 
+ * budget is exceeded, the least recently used distance maps are evicted.
+ */
+template <typename Key>
+using DistanceMapCache = LruCache<Key, const DistanceMap, DistanceMapSize>;
+
+#endif // CANDIDATE_MC_FEATURES_DISTANCE_MAP_CACHE_H__
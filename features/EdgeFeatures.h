@@ -6,10 +6,10 @@
 
 class EdgeFeatures {
 
-	typedef Features<Crag::CragEdge> FeaturesType;
-
 public:
 
+	typedef Features<Crag::CragEdge> FeaturesType;
+
 	EdgeFeatures(const Crag& crag) :
 			_crag(crag),
 			_features(Crag::EdgeTypes.size(), FeaturesType(crag)) {}
@@ -34,7 +34,11 @@ public:
 		return features(type).getFeatureNames();
 	}
 
-	const std::vector<double>& operator[](Crag::CragEdge e) const {
+	/**
+	 * Get the stored features of e (without the implicit ones of the 
+	 * expansion).
+	 */
+	FeatureRow operator[](Crag::CragEdge e) const {
 
 		return features(_crag.type(e))[e];
 	}
@@ -44,11 +48,114 @@ public:
 		features(_crag.type(e)).set(e, v);
 	}
 
+	template <typename Iterator>
+	void set(Crag::CragEdge e, Iterator begin, Iterator end) {
+
+		features(_crag.type(e)).set(e, begin, end);
+	}
+
+	/**
+	 * Reserve space for numRows feature vectors of the given type with 
+	 * numFeatures features each.
+	 */
+	void reserve(Crag::EdgeType type, std::size_t numRows, unsigned int numFeatures) {
+
+		features(type).reserve(numRows, numFeatures);
+	}
+
+	/**
+	 * The size of the expanded feature vectors of the given type.
+	 */
 	inline unsigned int dims(Crag::EdgeType type) const {
 
 		return features(type).dims();
 	}
 
+	/**
+	 * The number of stored features of the given type.
+	 */
+	inline unsigned int storedDims(Crag::EdgeType type) const {
+
+		return features(type).storedDims();
+	}
+
+	/**
+	 * Compute the given squares and pairwise products on the fly from the 
+	 * stored features of the given type, instead of storing them.
+	 */
+	void setExpansion(Crag::EdgeType type, const FeatureExpansion& expansion) {
+
+		features(type).setExpansion(expansion);
+	}
+
+	const FeatureExpansion& getExpansion(Crag::EdgeType type) const {
+
+		return features(type).getExpansion();
+	}
+
+	/**
+	 * The dot product of w with the expanded feature vector of e.
+	 */
+	inline double dot(Crag::CragEdge e, const std::vector<double>& w) const {
+
+		return features(_crag.type(e)).dot(e, w);
+	}
+
+	/**
+	 * Add scale times the expanded feature vector of e to g.
+	 */
+	inline void accumulate(Crag::CragEdge e, double scale, std::vector<double>& g) const {
+
+		features(_crag.type(e)).accumulate(e, scale, g);
+	}
+
+	/**
+	 * Set costs[e] to the dot product of the expanded feature vector of 
+	 * each edge e with the weights for its type, using the given number of 
+	 * threads. Edges without features get a cost of 0.
+	 */
+	void computeCosts(const FeatureWeights& weights, Crag::EdgeMap<double>& costs, unsigned int numThreads) const {
+
+		for (Crag::CragEdge e : _crag.edges())
+			costs[e] = 0;
+
+		for (Crag::EdgeType type : Crag::EdgeTypes) {
+
+			if (features(type).size() == 0)
+				continue;
+
+			features(type).dots(
+					weights[type],
+					[&](Crag::CragEdge e, double cost) { costs[e] = cost; },
+					numThreads);
+		}
+	}
+
+	/**
+	 * Add the expanded feature vector of each edge e, multiplied with 
+	 * scale(e), to the gradient for its type, using the given number of 
+	 * threads.
+	 */
+	template <typename Scale>
+	void accumulateAll(Scale scale, FeatureWeights& gradient, unsigned int numThreads) const {
+
+		for (Crag::EdgeType type : Crag::EdgeTypes) {
+
+			if (features(type).size() == 0)
+				continue;
+
+			features(type).accumulateAll(scale, gradient[type], numThreads);
+		}
+	}
+
+	/**
+	 * Get the expanded feature vector of e.
+	 */
+	inline std::vector<double> expand(Crag::CragEdge e) const {
+
+		return features(_crag.type(e)).expand(e);
+	}
+
 	void normalize() {
 
 		for (auto& f : _features)
@@ -75,6 +182,13 @@ public:
 			max[type] = features(type).getMax();
 	}
 
+	/**
+	 * Direct access to the features of the given type, e.g., to expose the 
+	 * feature matrix without copying it.
+	 */
+	FeaturesType& getFeatures(Crag::EdgeType type) { return features(type); }
+	const FeaturesType& getFeatures(Crag::EdgeType type) const { return features(type); }
+
 private:
 
 	inline FeaturesType& features(Crag::EdgeType type) {
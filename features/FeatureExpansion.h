@@ -0,0 +1,183 @@
+#ifndef CANDIDATE_MC_FEATURES_FEATURE_EXPANSION_H__
+#define CANDIDATE_MC_FEATURES_FEATURE_EXPANSION_H__
+
+#include <algorithm>
+#include <vector>
+#include <util/assert.h>
+
+/**
+ * Describes features that are not stored, but computed on the fly from the 
+ * first numBaseFeatures stored features of a feature row: the squares of the 
+ * base features, followed by all pairwise products of the base features (and 
+ * their squares, if present). The implicit features are placed directly after 
+ * the base features, i.e., the expanded feature vector is
+ *
+ *   [ base | squares | products | remaining stored features ]
+ *
+ * which is the same order in which SquareFeatureProvider, 
+ * PairwiseFeatureProvider, and any later feature providers used to append 
+ * them. The products are computed and summed in the same order as for the 
+ * materialized feature vector, so dot products and gradients are identical.
+ */
+class FeatureExpansion {
+
+public:
+
+	/**
+	 * Create an empty expansion, the expanded features are the stored ones.
+	 */
+	FeatureExpansion() :
+		_numBaseFeatures(0),
+		_squares(false),
+		_pairwise(false) {}
+
+	FeatureExpansion(unsigned int numBaseFeatures, bool squares, bool pairwise) :
+		_numBaseFeatures(numBaseFeatures),
+		_squares(squares),
+		_pairwise(pairwise) {}
+
+	inline bool empty() const { return !_squares && !_pairwise; }
+
+	inline unsigned int numBaseFeatures() const { return _numBaseFeatures; }
+	inline bool squares() const { return _squares; }
+	inline bool pairwise() const { return _pairwise; }
+
+	/**
+	 * The number of features that are computed on the fly.
+	 */
+	inline unsigned int numImplicitFeatures() const {
+
+		unsigned int numSquares  = (_squares ? _numBaseFeatures : 0);
+		unsigned int numFactors  = _numBaseFeatures + numSquares;
+		unsigned int numProducts = (_pairwise ? numFactors*(numFactors + 1)/2 : 0);
+
+		return numSquares + numProducts;
+	}
+
+	/**
+	 * The dot product of w with the expanded feature vector of row.
+	 */
+	template <typename Row>
+	inline double dot(const std::vector<double>& w, const Row& row) const {
+
+		UTIL_ASSERT_REL(w.size(), ==, row.size() + numImplicitFeatures());
+
+		double sum = 0;
+		forEach(row, 0, w.size(), [&](std::size_t k, double f) { sum += w[k]*f; });
+
+		return sum;
+	}
+
+	/**
+	 * Add scale times the expanded feature vector of row to g.
+	 */
+	template <typename Row>
+	inline void accumulate(const Row& row, double scale, std::vector<double>& g) const {
+
+		accumulate(row, scale, g, 0, g.size());
+	}
+
+	/**
+	 * Add scale times the expanded features begin to end-1 of row to the 
+	 * respective entries of g.
+	 */
+	template <typename Row>
+	inline void accumulate(const Row& row, double scale, std::vector<double>& g, std::size_t begin, std::size_t end) const {
+
+		UTIL_ASSERT_REL(g.size(), ==, row.size() + numImplicitFeatures());
+
+		forEach(row, begin, end, [&](std::size_t k, double f) { g[k] += f*scale; });
+	}
+
+	/**
+	 * Get the expanded feature vector of row.
+	 */
+	template <typename Row>
+	inline std::vector<double> expand(const Row& row) const {
+
+		std::vector<double> expanded(row.size() + numImplicitFeatures());
+		forEach(row, 0, expanded.size(), [&](std::size_t k, double f) { expanded[k] = f; });
+
+		return expanded;
+	}
+
+private:
+
+	/**
+	 * Call f(k, value) in order for each expanded feature k in [begin, end).
+	 */
+	template <typename Row, typename F>
+	inline void forEach(const Row& row, std::size_t begin, std::size_t end, F f) const {
+
+		if (empty()) {
+
+			for (std::size_t k = begin; k < std::min(end, (std::size_t)row.size()); k++)
+				f(k, row[k]);
+			return;
+		}
+
+		UTIL_ASSERT_REL(row.size(), >=, _numBaseFeatures);
+
+		std::size_t numBase     = _numBaseFeatures;
+		std::size_t numSquares  = (_squares ? numBase : 0);
+		std::size_t numFactors  = numBase + numSquares;
+		std::size_t numProducts = (_pairwise ? numFactors*(numFactors + 1)/2 : 0);
+
+		// base features in [0, numBase)
+		for (std::size_t k = begin; k < std::min(end, numBase); k++)
+			f(k, row[k]);
+
+		// squares in [numBase, numBase + numSquares)
+		std::size_t first = numBase;
+		for (std::size_t k = std::max(begin, first); k < std::min(end, first + numSquares); k++)
+			f(k, product(row[k - first], row[k - first]));
+
+		// products in [numFactors, numFactors + numProducts), the products 
+		// of factor i with factors j >= i are consecutive
+		first = numFactors;
+		if (numProducts > 0 && begin < first + numProducts && end > first) {
+
+			// the factors of the pairwise products: base features and squares
+			std::vector<double> factors(row.begin(), row.begin() + numBase);
+			for (std::size_t i = 0; i < numSquares; i++)
+				factors.push_back(product(row[i], row[i]));
+
+			std::size_t k = first;
+			for (std::size_t i = 0; i < numFactors && k < end; i++) {
+
+				std::size_t numI = numFactors - i;
+
+				if (k + numI <= begin) {
+
+					k += numI;
+					continue;
+				}
+
+				std::size_t j = i + (begin > k ? begin - k : 0);
+				for (k += j - i; j < numFactors && k < end; j++, k++)
+					f(k, product(factors[i], factors[j]));
+
+				// continue with the next i at the start of its products
+				k = first + (i + 1)*numFactors - i*(i + 1)/2;
+			}
+		}
+
+		// remaining stored features
+		first = numFactors + numProducts;
+		for (std::size_t k = std::max(begin, first); k < std::min(end, first + row.size() - numBase); k++)
+			f(k, row[numBase + k - first]);
+	}
+
+	// same as a stored product, which converts nan into 0
+	static inline double product(double a, double b) {
+
+		double p = a*b;
+		return (p != p ? 0 : p);
+	}
+
+	unsigned int _numBaseFeatures;
+	bool         _squares;
+	bool         _pairwise;
+};
+
+#endif // CANDIDATE_MC_FEATURES_FEATURE_EXPANSION_H__
@@ -17,12 +17,23 @@ util::ProgramOption optionDumpFeatureNames(
 	                          "for the respective node and edge types."
 );
 
+util::ProgramOption optionNumFeatureThreads(
+	util::_module           = "features",
+	util::_long_name        = "numThreads",
+	util::_description_text = "The number of threads to use for feature providers that support parallel extraction. "
+	                          "Set to 0 to use one thread per hardware thread. The extracted features do not depend "
+	                          "on this value.",
+	util::_default_value    = 1
+);
+
 void
 FeatureExtractor::extract(
 		FeatureProviderBase& featureProvider,
 		NodeFeatures& nodeFeatures,
 		EdgeFeatures& edgeFeatures) {
 
+	featureProvider.setNumThreads(optionNumFeatureThreads.as<int>());
+
 	extractNodeFeatures(featureProvider, nodeFeatures);
 	extractEdgeFeatures(featureProvider, nodeFeatures, edgeFeatures);
 }
@@ -1,10 +1,14 @@
 #ifndef CANDIDATE_MC_FEATURE_PROVIDER_H__
 #define CANDIDATE_MC_FEATURE_PROVIDER_H__
 
+#include <crag/ParallelFor.h>
+
 class FeatureProviderBase {
 
 public:
 
+	FeatureProviderBase() : _numThreads(1) {}
+
 	virtual ~FeatureProviderBase() {}
 
 	virtual void appendFeatures(
@@ -14,6 +18,16 @@ public:
 	virtual void appendFeatures(
 			const Crag& crag,
 			EdgeFeatures& edgeFeatures) = 0;
+
+	/**
+	 * Set the number of threads to use for providers that support parallel 
+	 * extraction. 0 uses one thread per hardware thread.
+	 */
+	virtual void setNumThreads(int numThreads) { _numThreads = getNumThreads(numThreads); }
+
+protected:
+
+	unsigned int _numThreads;
 };
 
 /**
@@ -26,10 +40,28 @@ public:
 
 	void appendFeatures(const Crag& crag, NodeFeatures& nodeFeatures) override {
 
-		for (auto n : crag.nodes()) {
+		reserveNodeFeatures(crag, nodeFeatures);
+
+		if (_numThreads > 1 && supportsParallelExtraction()) {
+
+			std::vector<Crag::CragNode> nodes;
+			for (auto n : crag.nodes())
+				nodes.push_back(n);
 
-			FeatureNodeAdaptor adaptor(nodeFeatures, n);
-			static_cast<Derived*>(this)->appendNodeFeatures(n, adaptor);
+			appendFeaturesParallel(
+					nodes,
+					nodeFeatures,
+					[this](Crag::CragNode n, BufferAdaptor<NodeFeatures, Crag::CragNode>& adaptor) {
+						static_cast<Derived*>(this)->appendNodeFeatures(n, adaptor);
+					});
+
+		} else {
+
+			for (auto n : crag.nodes()) {
+
+				FeatureNodeAdaptor adaptor(nodeFeatures, n);
+				static_cast<Derived*>(this)->appendNodeFeatures(n, adaptor);
+			}
 		}
 
 		for (const auto& p : getNodeFeatureNames())
@@ -38,10 +70,28 @@ public:
 
 	void appendFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) override {
 
-		for (auto e : crag.edges()) {
+		reserveEdgeFeatures(crag, edgeFeatures);
+
+		if (_numThreads > 1 && supportsParallelExtraction()) {
+
+			std::vector<Crag::CragEdge> edges;
+			for (auto e : crag.edges())
+				edges.push_back(e);
+
+			appendFeaturesParallel(
+					edges,
+					edgeFeatures,
+					[this](Crag::CragEdge e, BufferAdaptor<EdgeFeatures, Crag::CragEdge>& adaptor) {
+						static_cast<Derived*>(this)->appendEdgeFeatures(e, adaptor);
+					});
+
+		} else {
+
+			for (auto e : crag.edges()) {
 
-			FeatureEdgeAdaptor adaptor(edgeFeatures, e);
-			static_cast<Derived*>(this)->appendEdgeFeatures(e, adaptor);
+				FeatureEdgeAdaptor adaptor(edgeFeatures, e);
+				static_cast<Derived*>(this)->appendEdgeFeatures(e, adaptor);
+			}
 		}
 
 		for (const auto& p : getEdgeFeatureNames())
@@ -64,8 +114,111 @@ public:
 		return std::map<Crag::EdgeType, std::vector<std::string>>();
 	}
 
+protected:
+
+	/**
+	 * Return true, if appendNodeFeatures() and appendEdgeFeatures() can be 
+	 * called concurrently for different nodes and edges. Providers that keep 
+	 * state between calls must not override this. Providers can share 
+	 * CragVolumes between threads without locking, since its const methods 
+	 * can be called concurrently.
+	 */
+	virtual bool supportsParallelExtraction() const { return false; }
+
 private:
 
+	/**
+	 * Number of elements to extract features for before the collected 
+	 * features are appended to the feature rows. Bounds the memory needed for 
+	 * intermediate results.
+	 */
+	static const std::size_t ParallelBlockSize = 4096;
+
+	/**
+	 * Extract features for the given elements on several threads. Each thread 
+	 * collects the features of an element in a private buffer. After each 
+	 * block of elements, the buffers are appended to the feature rows in the 
+	 * order of the elements, such that the result is identical to the serial 
+	 * extraction.
+	 */
+	template <typename FeaturesType, typename KeyType, typename Extract>
+	void appendFeaturesParallel(
+			const std::vector<KeyType>& elements,
+			FeaturesType& features,
+			Extract extract) {
+
+		std::vector<std::vector<double>> buffers;
+
+		for (std::size_t blockBegin = 0; blockBegin < elements.size(); blockBegin += ParallelBlockSize) {
+
+			std::size_t blockSize = std::min((std::size_t)ParallelBlockSize, elements.size() - blockBegin);
+
+			buffers.resize(blockSize);
+			for (auto& buffer : buffers)
+				buffer.clear();
+
+			parallelFor(
+					blockSize,
+					_numThreads,
+					[&](std::size_t i) {
+
+						KeyType element = elements[blockBegin + i];
+						BufferAdaptor<FeaturesType, KeyType> adaptor(features, element, buffers[i]);
+						extract(element, adaptor);
+					});
+
+			for (std::size_t i = 0; i < blockSize; i++)
+				for (double value : buffers[i])
+					features.append(elements[blockBegin + i], value);
+		}
+	}
+
+	/**
+	 * Make room for the features this provider is going to add, as reported 
+	 * by getNodeFeatureNames().
+	 */
+	void reserveNodeFeatures(const Crag& crag, NodeFeatures& nodeFeatures) {
+
+		std::map<Crag::NodeType, std::size_t> numNodes;
+		for (auto n : crag.nodes())
+			numNodes[crag.type(n)]++;
+
+		for (const auto& p : getNodeFeatureNames()) {
+
+			// the names include the ones of features that are not stored
+			std::size_t numStored = nodeFeatures.getFeatureNames(p.first).size();
+			numStored -= std::min(numStored, (std::size_t)nodeFeatures.getExpansion(p.first).numImplicitFeatures());
+
+			nodeFeatures.reserve(
+					p.first,
+					numNodes[p.first],
+					numStored + p.second.size());
+		}
+	}
+
+	/**
+	 * Make room for the features this provider is going to add, as reported 
+	 * by getEdgeFeatureNames().
+	 */
+	void reserveEdgeFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) {
+
+		std::map<Crag::EdgeType, std::size_t> numEdges;
+		for (auto e : crag.edges())
+			numEdges[crag.type(e)]++;
+
+		for (const auto& p : getEdgeFeatureNames()) {
+
+			// the names include the ones of features that are not stored
+			std::size_t numStored = edgeFeatures.getFeatureNames(p.first).size();
+			numStored -= std::min(numStored, (std::size_t)edgeFeatures.getExpansion(p.first).numImplicitFeatures());
+
+			edgeFeatures.reserve(
+					p.first,
+					numEdges[p.first],
+					numStored + p.second.size());
+		}
+	}
+
 	/**
 	 * Adaptor to be used with RegionFeatures. Just appends to a vector, 
 	 * ignoring the "id" of the region.
@@ -77,7 +230,7 @@ private:
 
 		inline void append(double value)                           { _features.append(_n, value); }
 		inline void append(unsigned int /*ignored*/, double value) { _features.append(_n, value); }
-		inline const std::vector<double>& getFeatures(){ return _features[_n]; }
+		inline std::vector<double> getFeatures(){ return _features[_n].toVector(); }
 		inline const std::vector<std::string> getFeatureNames(Crag::NodeType type){ return _features.getFeatureNames(type); }
 
 	private:
@@ -97,7 +250,7 @@ private:
 
 		inline void append(double value)                           { _features.append(_e, value); }
 		inline void append(unsigned int /*ignored*/, double value) { _features.append(_e, value); }
-		inline const std::vector<double>& getFeatures(){ return _features[_e]; }
+		inline std::vector<double> getFeatures(){ return _features[_e].toVector(); }
 		inline const std::vector<std::string> getFeatureNames(Crag::EdgeType type){ return _features.getFeatureNames(type); }
 
 	private:
@@ -105,7 +258,34 @@ private:
 		EdgeFeatures&  _features;
 		Crag::CragEdge _e;
 	};
+
+	/**
+	 * Adaptor for parallel extraction. Appends to a thread-private buffer and 
+	 * only reads from the features.
+	 */
+	template <typename FeaturesType, typename KeyType>
+	class BufferAdaptor {
+
+	public:
+		BufferAdaptor(const FeaturesType& features, KeyType k, std::vector<double>& buffer) : _features(features), _k(k), _buffer(buffer) {}
+
+		inline void append(double value)                           { _buffer.push_back(value); }
+		inline void append(unsigned int /*ignored*/, double value) { _buffer.push_back(value); }
+		inline std::vector<double> getFeatures() {
+
+			std::vector<double> features = _features[_k].toVector();
+			features.insert(features.end(), _buffer.begin(), _buffer.end());
+			return features;
+		}
+		template <typename TypeT>
+		inline const std::vector<std::string> getFeatureNames(TypeT type){ return _features.getFeatureNames(type); }
+
+	private:
+
+		const FeaturesType&  _features;
+		KeyType              _k;
+		std::vector<double>& _buffer;
+	};
 };
 
 #endif // CANDIDATE_MC_FEATURE_PROVIDER_H__
-
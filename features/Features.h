@@ -2,34 +2,108 @@
 #define CANDIDATE_MC_FEATURES_FEATURES_H__
 
 #include <vector>
+#include <limits>
+#include <algorithm>
+#include <iostream>
 #include <util/exceptions.h>
+#include <crag/ParallelFor.h>
 #include "Crag.h"
+#include "FeatureExpansion.h"
 
+/**
+ * A read-only view on the contiguous feature vector of a single node or edge,
+ * as stored in Features. The view is invalidated by any modification of the
+ * Features it was obtained from.
+ */
+class FeatureRow {
+
+public:
+
+	typedef const double* const_iterator;
+	typedef const double* iterator;
+
+	FeatureRow() : _begin(0), _size(0) {}
+
+	FeatureRow(const double* begin, std::size_t size) : _begin(begin), _size(size) {}
+
+	inline const double* begin() const { return _begin; }
+	inline const double* end() const { return _begin + _size; }
+
+	inline std::size_t size() const { return _size; }
+	inline bool empty() const { return _size == 0; }
+
+	inline const double& operator[](std::size_t i) const { return _begin[i]; }
+
+	/**
+	 * Get a copy of this row as a vector.
+	 */
+	inline std::vector<double> toVector() const { return std::vector<double>(begin(), end()); }
+
+private:
+
+	const double* _begin;
+	std::size_t   _size;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const FeatureRow& row) {
+
+	os << "[";
+	for (std::size_t i = 0; i < row.size(); i++)
+		os << (i == 0 ? "" : ", ") << row[i];
+	os << "]";
+
+	return os;
+}
+
+/**
+ * Stores feature vectors for nodes or edges of a single type in one row-major
+ * matrix. Rows are assigned to elements in the order in which they receive
+ * their first feature and are found through a table indexed by the CRAG id of
+ * the element. Each row has room for a fixed number of features (the stride),
+ * which grows geometrically if a row runs out of space and can be set in
+ * advance with reserve().
+ *
+ * Squares and pairwise products of features are not stored, but described by 
+ * a FeatureExpansion. Use dot(), accumulate(), and expand() to work with the 
+ * expanded feature vectors of size dims().
+ */
 template <typename KeyType>
 class Features {
 
 public:
 
-	Features(const Crag& crag) : _crag(crag), _dimsDirty(true) {}
+	Features(const Crag& crag) : _crag(crag), _stride(0), _dimsDirty(true) {}
 
 	/**
-	 * Add a single feature to the feature vector for a node. Converts nan into 
+	 * Add a single feature to the feature vector for a node. Converts nan into
 	 * 0.
 	 */
 	inline void append(KeyType n, double feature) {
 
+		std::size_t row = getOrCreateRow(n);
+		unsigned int size = _rowSizes[row];
+
 		if (feature != feature)
 			feature = 0;
 
 		if (feature == std::numeric_limits<double>::infinity() || feature == -std::numeric_limits<double>::infinity()) {
 
+			// the names include the ones of the implicit features
+			unsigned int nameIndex = size;
+			if (size >= _expansion.numBaseFeatures())
+				nameIndex += _expansion.numImplicitFeatures();
+
 			std::string name = "(not known yet)";
-			if (_featureNames.size() > _features[n].size())
-				name = _featureNames[_features[n].size()];
-			std::cout << "Warning: feature " << _features[n].size() << " " << name << " of element " << _crag.id(n) << " is " << feature << std::endl;
+			if (_featureNames.size() > nameIndex)
+				name = _featureNames[nameIndex];
+			std::cout << "Warning: feature " << size << " " << name << " of element " << _crag.id(n) << " is " << feature << std::endl;
 		}
 
-		_features[n].push_back(feature);
+		if (size == _stride)
+			setStride(std::max(2*_stride, 1u));
+
+		_data[row*_stride + size] = feature;
+		_rowSizes[row]++;
 
 		_dimsDirty = true;
 	}
@@ -58,41 +132,74 @@ public:
 	 */
 	inline void set(KeyType n, const std::vector<double>& v) {
 
-		_features[n] = v;
+		set(n, v.begin(), v.end());
+	}
+
+	/**
+	 * Explicitly set a feature vector from a range of values.
+	 */
+	template <typename Iterator>
+	inline void set(KeyType n, Iterator begin, Iterator end) {
+
+		std::size_t  row  = getOrCreateRow(n);
+		unsigned int size = std::distance(begin, end);
+
+		if (size > _stride)
+			setStride(size);
+
+		std::copy(begin, end, _data.begin() + row*_stride);
+		_rowSizes[row] = size;
+
 		_dimsDirty = true;
 	}
 
 	/**
-	 * The size of the feature vectors.
+	 * Prepare the storage for the given number of rows with the given number
+	 * of features each. This avoids reallocations during feature extraction.
+	 */
+	void reserve(std::size_t numRows, unsigned int numFeatures) {
+
+		if (numFeatures > _stride)
+			setStride(numFeatures);
+
+		_data.reserve(numRows*_stride);
+		_rowSizes.reserve(numRows);
+		_rowKeys.reserve(numRows);
+	}
+
+	/**
+	 * The size of the expanded feature vectors, including the implicit 
+	 * features of the expansion.
 	 */
 	inline unsigned int dims() const {
 
+		return storedDims() + _expansion.numImplicitFeatures();
+	}
+
+	/**
+	 * The number of stored features per element.
+	 */
+	inline unsigned int storedDims() const {
+
 		if (!_dimsDirty)
 			return _dims;
 
 		_dims = 0;
 
-		bool first = true;
-		int firstId = -1;
-		for (auto& p : _features) {
-
-			KeyType n = p.first;
-			const std::vector<double>& f = p.second;
+		for (std::size_t row = 0; row < _rowSizes.size(); row++) {
 
-			if (first) {
+			if (row == 0) {
 
-				_dims = f.size();
-				first = false;
-				firstId = _crag.id(n);
+				_dims = _rowSizes[row];
 
 			} else {
 
-				if (f.size() != _dims)
+				if (_rowSizes[row] != _dims)
 					UTIL_THROW_EXCEPTION(
 							UsageError,
 							"Features contains vectors of different sizes: "
-							"expected " << _dims << " (as seen for id " << firstId << ")" <<
-							", found " << f.size() << " for id " << _crag.id(n));
+							"expected " << _dims << " (as seen for id " << _crag.id(_rowKeys[0]) << ")" <<
+							", found " << _rowSizes[row] << " for id " << _crag.id(_rowKeys[row]));
 			}
 		}
 
@@ -101,8 +208,8 @@ public:
 	}
 
 	/**
-	 * Normalize all features, such that they are in the range [0,1]. The min 
-	 * and max values used for the transformation can be queried with getMin() 
+	 * Normalize all features, such that they are in the range [0,1]. The min
+	 * and max values used for the transformation can be queried with getMin()
 	 * and getMax().
 	 */
 	void normalize() {
@@ -112,8 +219,8 @@ public:
 	}
 
 	/**
-	 * Normalize all features, but instead of searching for the min and max, use 
-	 * the provided ones. This will also set the min and max returned by 
+	 * Normalize all features, but instead of searching for the min and max, use
+	 * the provided ones. This will also set the min and max returned by
 	 * getMin() and getMax().
 	 */
 	void normalize(
@@ -147,36 +254,213 @@ public:
 		return _max;
 	}
 
-	const std::vector<double>& operator[](KeyType k) const { return _features[k]; }
+	/**
+	 * Set the implicit features to compute from the stored ones.
+	 */
+	void setExpansion(const FeatureExpansion& expansion) {
+
+		_expansion = expansion;
+	}
+
+	const FeatureExpansion& getExpansion() const {
+
+		return _expansion;
+	}
+
+	/**
+	 * The dot product of w with the expanded feature vector of an element.
+	 */
+	inline double dot(KeyType k, const std::vector<double>& w) const {
+
+		return _expansion.dot(w, (*this)[k]);
+	}
+
+	/**
+	 * Add scale times the expanded feature vector of an element to g.
+	 */
+	inline void accumulate(KeyType k, double scale, std::vector<double>& g) const {
+
+		_expansion.accumulate((*this)[k], scale, g);
+	}
+
+	/**
+	 * Get the expanded feature vector of an element.
+	 */
+	inline std::vector<double> expand(KeyType k) const {
+
+		return _expansion.expand((*this)[k]);
+	}
+
+	/**
+	 * Compute the dot products of w with the expanded feature vectors of all 
+	 * elements, i.e., the product of the feature matrix with w, and pass them 
+	 * to set(element, value). Rows are handed out to the given number of 
+	 * threads.
+	 */
+	template <typename Set>
+	void dots(const std::vector<double>& w, Set set, unsigned int numThreads) const {
+
+		parallelFor(
+				_rowSizes.size(),
+				numThreads,
+				[&](std::size_t row) {
+
+					set(_rowKeys[row], _expansion.dot(w, getRow(row)));
+				},
+				256);
+	}
+
+	/**
+	 * Add the expanded feature vectors of all elements, multiplied with 
+	 * scale(element), to g, i.e., add the product of the transposed feature 
+	 * matrix with the vector of scales. The entries of g are split between 
+	 * the threads, such that each entry is summed in row order and the result 
+	 * does not depend on the number of threads.
+	 */
+	template <typename Scale>
+	void accumulateAll(Scale scale, std::vector<double>& g, unsigned int numThreads) const {
+
+		// only rows with a non-zero scale contribute
+		std::vector<std::pair<std::size_t, double>> rows;
+		for (std::size_t row = 0; row < _rowSizes.size(); row++) {
+
+			double s = scale(_rowKeys[row]);
+			if (s != 0)
+				rows.push_back(std::make_pair(row, s));
+		}
+
+		if (rows.empty())
+			return;
+
+		const std::size_t blockSize = 1024;
+		std::size_t numBlocks = (g.size() + blockSize - 1)/blockSize;
+
+		parallelFor(
+				numBlocks,
+				numThreads,
+				[&](std::size_t block) {
+
+					std::size_t begin = block*blockSize;
+					std::size_t end   = std::min(begin + blockSize, g.size());
+
+					for (const auto& p : rows)
+						_expansion.accumulate(getRow(p.first), p.second, g, begin, end);
+				});
+	}
+
+	/**
+	 * The number of elements with features.
+	 */
+	inline std::size_t size() const { return _rowSizes.size(); }
+
+	/**
+	 * Direct access to the stored features as a row-major matrix of size() 
+	 * rows with storedDims() features each, where consecutive rows are 
+	 * stride() values apart. The pointer is invalidated by adding features.
+	 */
+	inline const double* data() const { return _data.data(); }
+	inline       double* data()       { return _data.data(); }
+
+	inline unsigned int stride() const { return _stride; }
+
+	/**
+	 * The element a row of the feature matrix belongs to.
+	 */
+	inline KeyType rowKey(std::size_t row) const { return _rowKeys[row]; }
+
+	/**
+	 * Get the stored feature vector of an element. Returns an empty row for 
+	 * elements without features.
+	 */
+	FeatureRow operator[](KeyType k) const {
+
+		std::size_t id = _crag.id(k);
 
-protected:
+		if (id >= _rowIndex.size() || _rowIndex[id] < 0)
+			return FeatureRow();
 
-	// don't allow non-const access to feature vectors
-	std::vector<double>& operator[](KeyType k) { return _features[k]; }
+		return getRow(_rowIndex[id]);
+	}
 
 private:
 
+	inline FeatureRow getRow(std::size_t row) const {
+
+		return FeatureRow(_data.data() + row*_stride, _rowSizes[row]);
+	}
+
+	inline std::size_t getOrCreateRow(KeyType k) {
+
+		std::size_t id = _crag.id(k);
+
+		if (id >= _rowIndex.size())
+			_rowIndex.resize(id + 1, -1);
+
+		if (_rowIndex[id] >= 0)
+			return _rowIndex[id];
+
+		std::size_t row = _rowSizes.size();
+		_rowIndex[id] = row;
+		_rowSizes.push_back(0);
+		_rowKeys.push_back(k);
+		_data.resize(_data.size() + _stride);
+
+		return row;
+	}
+
+	/**
+	 * Change the number of features each row has room for and move the
+	 * existing rows accordingly.
+	 */
+	void setStride(unsigned int stride) {
+
+		if (stride == _stride)
+			return;
+
+		std::size_t numRows = _rowSizes.size();
+
+		std::vector<double> data(numRows*stride);
+		for (std::size_t row = 0; row < numRows; row++)
+			std::copy(
+					_data.begin() + row*_stride,
+					_data.begin() + row*_stride + std::min(_rowSizes[row], stride),
+					data.begin() + row*stride);
+
+		_data.swap(data);
+		_stride = stride;
+	}
+
+	/**
+	 * Remove unused space at the end of the rows, such that the rows form a
+	 * dense matrix of size numRows x storedDims().
+	 */
+	void compact() {
+
+		setStride(storedDims());
+		_data.shrink_to_fit();
+	}
+
 	void findMinMax() {
 
 		_min.clear();
 		_max.clear();
 
-		for (auto& p : _features) {
+		if (_rowSizes.empty())
+			return;
 
-			const std::vector<double>& f = p.second;
+		compact();
 
-			if (_min.size() == 0) {
+		_min.assign(_data.begin(), _data.begin() + _stride);
+		_max = _min;
 
-				_min = f;
-				_max = f;
+		for (std::size_t row = 1; row < _rowSizes.size(); row++) {
 
-			} else {
+			const double* f = _data.data() + row*_stride;
 
-				for (unsigned int i = 0; i < _min.size(); i++) {
+			for (unsigned int i = 0; i < _stride; i++) {
 
-					_min[i] = std::min(_min[i], f[i]);
-					_max[i] = std::max(_max[i], f[i]);
-				}
+				_min[i] = std::min(_min[i], f[i]);
+				_max[i] = std::max(_max[i], f[i]);
 			}
 		}
 	}
@@ -190,19 +474,19 @@ private:
 					UsageError,
 					"provided min and max have different sizes");
 
-		if (min.size() != dims())
+		if (min.size() != storedDims())
 			UTIL_THROW_EXCEPTION(
 					UsageError,
-					"provided min and max have different size " << min.size() << " than features " << dims());
+					"provided min and max have different size " << min.size() << " than features " << storedDims());
+
+		if (_rowSizes.empty())
+			return;
 
-		for (auto& p : _features) {
+		compact();
 
-			std::vector<double>& f = p.second;
+		for (std::size_t row = 0; row < _rowSizes.size(); row++) {
 
-			if (f.size() != min.size())
-				UTIL_THROW_EXCEPTION(
-						UsageError,
-						"encountered a feature with differnt size " << f.size() << " than given min " << min.size());
+			double* f = _data.data() + row*_stride;
 
 			for (unsigned int i = 0; i < min.size(); i++) {
 
@@ -216,14 +500,25 @@ private:
 
 	const Crag& _crag;
 
-	mutable std::map<KeyType, std::vector<double>> _features;
-	mutable std::vector<std::string>               _featureNames;
+	// row of each element, indexed by CRAG id (-1 for elements without row)
+	std::vector<int> _rowIndex;
+
+	// the element and number of features of each row
+	std::vector<KeyType>      _rowKeys;
+	std::vector<unsigned int> _rowSizes;
+
+	// row-major feature matrix, with _stride entries per row
+	std::vector<double> _data;
+	unsigned int        _stride;
+
+	mutable std::vector<std::string> _featureNames;
 
 	std::vector<double> _min, _max;
 
+	FeatureExpansion _expansion;
+
 	mutable unsigned int _dims;
 	mutable bool         _dimsDirty;
 };
 
 #endif // CANDIDATE_MC_FEATURES_FEATURES_H__
-
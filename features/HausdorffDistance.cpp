@@ -5,50 +5,71 @@
 #include <vigra/impex.hxx>
 #include <util/timing.h>
 #include <util/Logger.h>
+#include <util/ProgramOptions.h>
 
 logger::LogChannel hausdorffdistancelog("hausdorffdistancelog", "[HausdorffDistance] ");
 
+util::ProgramOption optionHausdorffCacheSize(
+		util::_long_name        = "hausdorffCacheSize",
+		util::_module           = "features",
+		util::_description_text = "The memory budget in MB for distance maps that are kept to compute Hausdorff "
+		                          "distances. The least recently used distance maps are dropped first.",
+		util::_default_value    = 512);
+
 HausdorffDistance::HausdorffDistance(int maxDistance) :
+	_distanceMaps(optionHausdorffCacheSize.as<std::size_t>()*1024*1024),
 	_maxDistance(maxDistance) {}
 
+void
+HausdorffDistance::operator()(
+		std::shared_ptr<const CragVolume> i,
+		std::shared_ptr<const CragVolume> j,
+		double& i_j,
+		double& j_i) {
+
+	i_j = volumesDistance(*i, j);
+	j_i = volumesDistance(*j, i);
+}
+
 void
 HausdorffDistance::operator()(const CragVolume& i, const CragVolume& j, double& i_j, double& j_i) {
 
-	if (_cache.count(std::make_pair(&i, &j))) {
+	// non-owning pointers, the caller keeps the volumes alive
+	auto noDelete = [](const CragVolume*){};
 
-		LOG_ALL(hausdorffdistancelog) << "reuse cached values" << std::endl;
+	(*this)(
+			std::shared_ptr<const CragVolume>(&i, noDelete),
+			std::shared_ptr<const CragVolume>(&j, noDelete),
+			i_j,
+			j_i);
+}
 
-		i_j = _cache[std::make_pair(&i, &j)].first;
-		j_i = _cache[std::make_pair(&i, &j)].second;
+double
+HausdorffDistance::volumesDistance(const CragVolume& volume_i, std::shared_ptr<const CragVolume> volume_j) {
 
-		return;
-	}
+	// don't compute the distance map if the volumes are too far apart
+	if (lowerBound(volume_i.getBoundingBox(), volume_j->getBoundingBox()) >= _maxDistance)
+		return _maxDistance;
 
-	volumesDistance(i, j, i_j);
-	volumesDistance(j, i, j_i);
+	std::shared_ptr<const DistanceMap> distances_j =
+			_distanceMaps.get(volume_j, [&]{ return computeDistanceMap(*volume_j); });
 
-	_cache[std::make_pair(&i, &j)] = std::make_pair(i_j, j_i);
+	return distance(volume_i, *distances_j);
 }
 
-void
-HausdorffDistance::volumesDistance(
-		const CragVolume& volume_i,
-		const CragVolume& volume_j,
-		double& i_j) {
-
-	if (lowerBound(volume_i, volume_j) >= _maxDistance) {
+double
+HausdorffDistance::distance(const CragVolume& volume_i, const DistanceMap& j) const {
 
-		i_j = _maxDistance;
-		return;
-	}
+	if (lowerBound(volume_i.getBoundingBox(), j.boundingBox) >= _maxDistance)
+		return _maxDistance;
 
 	const util::box<int, 2>& bb_i = (volume_i.getBoundingBox()/volume_i.getResolution()).project<2>();
-	const util::box<int, 2>& bb_j = (volume_j.getBoundingBox()/volume_j.getResolution()).project<2>();
+	const util::box<int, 2>& bb_j = j.discreteBoundingBox;
 
 	LOG_ALL(hausdorffdistancelog) << "bb_i: " << bb_i << " " << volume_i.getBoundingBox() << std::endl;
-	LOG_ALL(hausdorffdistancelog) << "bb_j: " << bb_j << " " << volume_j.getBoundingBox() << std::endl;
+	LOG_ALL(hausdorffdistancelog) << "bb_j: " << bb_j << " " << j.boundingBox << std::endl;
 
-	vigra::MultiArray<2, double>& distances_j = getDistanceMap(volume_j);
+	const vigra::MultiArray<2, double>& distances_j = j.distances;
 
 	double maxDistance = 0;
 	for (int y = 0; y < bb_i.height(); y++)
@@ -63,10 +84,8 @@ HausdorffDistance::volumesDistance(
 		// point relative to bb_j.min()
 		util::point<int, 2> p_j = p - bb_j.min();
 
-		LOG_ALL(hausdorffdistancelog) << "point " << p << " in i corresponds to point " << p_j << " in j" << std::endl;
-
 		// point relative to distance map
-		util::point<int, 2> p_d = p_j + util::point<int, 2>(_padX, _padY);
+		util::point<int, 2> p_d = p_j + util::point<int, 2>(j.padX, j.padY);
 
 		LOG_ALL(hausdorffdistancelog) << "point " << p << " in i corresponds to point " << p_d << " in distance map of j" << std::endl;
 
@@ -86,68 +105,77 @@ HausdorffDistance::volumesDistance(
 		}
 
 		maxDistance = std::max(maxDistance, distance);
+
+		// can't get worse than that
+		if (maxDistance >= _maxDistance)
+			return _maxDistance;
 	}
 
-	i_j = maxDistance;
+	LOG_ALL(hausdorffdistancelog) << "distance: " << maxDistance << std::endl;
 
-	LOG_ALL(hausdorffdistancelog) << "distance: " << i_j << std::endl;
+	return maxDistance;
 }
 
 double
-HausdorffDistance::lowerBound(const CragVolume& a, const CragVolume& b) {
+HausdorffDistance::lowerBound(const util::box<float, 3>& a, const util::box<float, 3>& b) const {
 
 	// get max x separation
 	double maxSeparationX =
 			std::max(
-					b.getBoundingBox().min().x() - a.getBoundingBox().min().x(),
-					a.getBoundingBox().max().x() - b.getBoundingBox().max().x());
+					b.min().x() - a.min().x(),
+					a.max().x() - b.max().x());
 
 	// get max y separation
 	double maxSeparationY =
 			std::max(
-					b.getBoundingBox().min().y() - a.getBoundingBox().min().y(),
-					a.getBoundingBox().max().y() - b.getBoundingBox().max().y());
+					b.min().y() - a.min().y(),
+					a.max().y() - b.max().y());
 
 	return std::max(maxSeparationX, maxSeparationY);
 }
 
-vigra::MultiArray<2, double>&
-HausdorffDistance::getDistanceMap(const CragVolume& volume) {
+std::shared_ptr<const DistanceMap>
+HausdorffDistance::computeDistanceMap(const CragVolume& volume) const {
+
+	std::shared_ptr<DistanceMap> distanceMap = std::make_shared<DistanceMap>();
 
-	if (_distanceMaps.count(&volume))
-		return _distanceMaps[&volume];
+	distanceMap->padX = (int)(ceil(_maxDistance/volume.getResolutionX()));
+	distanceMap->padY = (int)(ceil(_maxDistance/volume.getResolutionY()));
+	distanceMap->boundingBox = volume.getBoundingBox();
+	distanceMap->discreteBoundingBox = (volume.getBoundingBox()/volume.getResolution()).project<2>();
 
-	_padX = (int)(ceil(_maxDistance/volume.getResolutionX()));
-	_padY = (int)(ceil(_maxDistance/volume.getResolutionY()));
+	int padX = distanceMap->padX;
+	int padY = distanceMap->padY;
 
-	vigra::Shape2 size(volume.width() + 2*_padX, volume.height() + 2*_padY);
+	vigra::Shape2 size(volume.width() + 2*padX, volume.height() + 2*padY);
 
-	vigra::MultiArray<2, double>& distanceMap = _distanceMaps[&volume];
-	distanceMap.reshape(size);
-	distanceMap = 0;
+	vigra::MultiArray<2, double>& distances = distanceMap->distances;
+	distances.reshape(size);
+	distances = 0;
 
 	vigra::copyMultiArray(
 			volume.data().bind<2>(0),
-			distanceMap.subarray(
+			distances.subarray(
 					vigra::Shape2(
-							_padX,
-							_padY),
+							padX,
+							padY),
 					vigra::Shape2(
-							_padX + volume.width(),
-							_padY + volume.height())));
+							padX + volume.width(),
+							padY + volume.height())));
 
 	double pitch[2];
 	pitch[0] = volume.getResolutionX();
 	pitch[1] = volume.getResolutionY();
 
-
 	// perform distance transform with Euclidean norm
 	vigra::separableMultiDistSquared(
-			distanceMap,
-			distanceMap,
+			distances,
+			distances,
 			true, /* get distance from object */
 			pitch);
 
+	LOG_ALL(hausdorffdistancelog) << "computed distance map of size " << size << std::endl;
+
 	return distanceMap;
 }
 
@@ -1,17 +1,23 @@
 #ifndef CANDIDATE_MC_FEATURES_HAUSDORFF_DISTANCE_H__
 #define CANDIDATE_MC_FEATURES_HAUSDORFF_DISTANCE_H__
 
-#include <map>
+#include <memory>
 #include <crag/Crag.h>
 #include <crag/CragVolumes.h>
+#include "DistanceMapCache.h"
 
 /**
  * Computes the HausdorffDistance of pairs of CRAG volumes. Ignores the 
  * z-dimension and assumes the volumes to the nodes have a depth of 1. The 
- * functor has an internal cache that relies on the addresses of the given 
- * CragVolume objects, so be aware that re-allocation of your volumes can 
- * invalidate the cache. The cache can be cleared with a call to clearCache(), 
- * which is also usefull to free up memory.
+ * functor has an internal cache of distance maps for the given CragVolume 
+ * objects, which keeps the volumes alive as long as their distance map is 
+ * cached. The cache is limited to a memory budget (not counting the volumes), 
+ * and can be cleared with a call to clearCache(). All methods can be called 
+ * concurrently.
+ *
+ * For volumes that are not kept in memory, compute their distance maps with 
+ * computeDistanceMap() (or keep them in your own DistanceMapCache) and use 
+ * distance().
  */
 class HausdorffDistance {
 
@@ -32,33 +38,56 @@ public:
 	 * Compute the distances for volumes i and j. Results are returned in 
 	 * reference i_j (distance of node i to j) and j_i (vice versa).
 	 */
+	void operator()(
+			std::shared_ptr<const CragVolume> i,
+			std::shared_ptr<const CragVolume> j,
+			double& i_j,
+			double& j_i);
+
+	/**
+	 * Same as above, for volumes owned by the caller. The cache does not keep 
+	 * these volumes alive, call clearCache() before they are destroyed.
+	 */
 	void operator()(const CragVolume& i, const CragVolume& j, double& i_j, double& j_i);
 
+	/**
+	 * Compute the directed distance of volume i to the volume the given 
+	 * distance map was computed for.
+	 */
+	double distance(const CragVolume& i, const DistanceMap& j) const;
+
+	/**
+	 * Compute the distance map of a volume, without caching it.
+	 */
+	std::shared_ptr<const DistanceMap> computeDistanceMap(const CragVolume& volume) const;
+
 	/**
 	 * Free memory allocated for the cache.
 	 */
-	void clearCache() { _cache.clear(); _distanceMaps.clear(); }
+	void clearCache() { _distanceMaps.clear(); }
 
-private:
+	/**
+	 * The memory budget of the distance map cache in bytes.
+	 */
+	std::size_t getMaxCacheBytes() const { return _distanceMaps.getMaxBytes(); }
 
-	void volumesDistance(
-			const CragVolume& volume_i,
-			const CragVolume& volume_j,
-			double& i_j);
+	/**
+	 * The maximal distance reported by this functor.
+	 */
+	double getMaxDistance() const { return _maxDistance; }
 
-	// lower bound HausdorffDistance between a and b based on bounding boxes
-	double lowerBound(const CragVolume& a, const CragVolume& b);
+private:
 
-	vigra::MultiArray<2, double>& getDistanceMap(const CragVolume& volume);
+	double volumesDistance(const CragVolume& volume_i, std::shared_ptr<const CragVolume> volume_j);
 
-	std::map<std::pair<const CragVolume*, const CragVolume*>, std::pair<double, double>> _cache;
+	// lower bound HausdorffDistance between a and b based on bounding boxes
+	double lowerBound(const util::box<float, 3>& a, const util::box<float, 3>& b) const;
 
-	std::map<const CragVolume*, vigra::MultiArray<2, double>> _distanceMaps;
+	// the keys keep the volumes alive, such that their addresses are not 
+	// reused for other volumes while their distance maps are cached
+	DistanceMapCache<std::shared_ptr<const CragVolume>> _distanceMaps;
 
 	double _maxDistance;
-
-	int _padX;
-	int _padY;
 };
 
 #endif // CANDIDATE_MC_FEATURES_HAUSDORFF_DISTANCE_H__
@@ -0,0 +1,93 @@
+#ifndef CANDIDATE_MC_FEATURES_LEAF_EDGE_SUMMARIES_H__
+#define CANDIDATE_MC_FEATURES_LEAF_EDGE_SUMMARIES_H__
+
+#include <vector>
+#include <crag/Crag.h>
+#include <crag/ParallelFor.h>
+#include <util/assert.h>
+
+/**
+ * Summaries of the affiliated grid edges of CRAG edges. Each leaf edge is 
+ * summarized once. The summary of any other edge is obtained by merging the 
+ * summaries of its leaf edges, such that the grid edges of a leaf edge are not 
+ * visited again for each of its ancestor edges.
+ *
+ * Summary has to be default constructible and provide
+ *
+ *   void merge(const Summary& other);
+ */
+template <typename Summary>
+class LeafEdgeSummaries {
+
+public:
+
+	LeafEdgeSummaries(const Crag& crag) :
+		_crag(crag),
+		_computed(false) {}
+
+	/**
+	 * Summarize each leaf edge with summarize(leafEdge). summarize will be 
+	 * called concurrently, if numThreads is larger than one.
+	 */
+	template <typename Summarize>
+	void compute(Summarize summarize, unsigned int numThreads) {
+
+		std::vector<Crag::CragEdge> leafEdges;
+		int maxEdgeId = -1;
+
+		for (Crag::CragEdge e : _crag.edges()) {
+
+			maxEdgeId = std::max(maxEdgeId, _crag.id(e));
+			if (_crag.isLeafEdge(e))
+				leafEdges.push_back(e);
+		}
+
+		_summaries.clear();
+		_summaries.resize(maxEdgeId + 1);
+
+		parallelFor(
+				leafEdges.size(),
+				numThreads,
+				[&](std::size_t i) {
+
+					_summaries[_crag.id(leafEdges[i])] = summarize(leafEdges[i]);
+				});
+
+		_computed = true;
+	}
+
+	/**
+	 * Check whether compute() has been called.
+	 */
+	bool computed() const { return _computed; }
+
+	/**
+	 * Get the summary of an edge, merged from the summaries of its leaf 
+	 * edges. Can be called concurrently after compute().
+	 */
+	Summary get(Crag::CragEdge e) const {
+
+		UTIL_ASSERT(_computed);
+
+		if (_crag.isLeafEdge(e))
+			return _summaries[_crag.id(e)];
+
+		Summary summary;
+		for (Crag::CragEdge leafEdge : _crag.leafEdges(e))
+			summary.merge(_summaries[_crag.id(leafEdge)]);
+
+		return summary;
+	}
+
+private:
+
+	const Crag& _crag;
+
+	// the summaries of the leaf edges, by edge id
+	std::vector<Summary> _summaries;
+
+	bool _computed;
+};
+
+#endif // CANDIDATE_MC_FEATURES_LEAF_EDGE_SUMMARIES_H__
+
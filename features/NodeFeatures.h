@@ -6,10 +6,10 @@
 
 class NodeFeatures {
 
-	typedef Features<Crag::CragNode> FeaturesType;
-
 public:
 
+	typedef Features<Crag::CragNode> FeaturesType;
+
 	NodeFeatures(const Crag& crag) :
 			_crag(crag),
 			_features(Crag::NodeTypes.size(), FeaturesType(crag)) {}
@@ -34,7 +34,11 @@ public:
 		return features(type).getFeatureNames();
 	}
 
-	const std::vector<double>& operator[](Crag::CragNode n) const {
+	/**
+	 * Get the stored features of n (without the implicit ones of the 
+	 * expansion).
+	 */
+	FeatureRow operator[](Crag::CragNode n) const {
 
 		return features(_crag.type(n))[n];
 	}
@@ -44,11 +48,114 @@ public:
 		features(_crag.type(n)).set(n, v);
 	}
 
+	template <typename Iterator>
+	void set(Crag::CragNode n, Iterator begin, Iterator end) {
+
+		features(_crag.type(n)).set(n, begin, end);
+	}
+
+	/**
+	 * Reserve space for numRows feature vectors of the given type with 
+	 * numFeatures features each.
+	 */
+	void reserve(Crag::NodeType type, std::size_t numRows, unsigned int numFeatures) {
+
+		features(type).reserve(numRows, numFeatures);
+	}
+
+	/**
+	 * The size of the expanded feature vectors of the given type.
+	 */
 	inline unsigned int dims(Crag::NodeType type) const {
 
 		return features(type).dims();
 	}
 
+	/**
+	 * The number of stored features of the given type.
+	 */
+	inline unsigned int storedDims(Crag::NodeType type) const {
+
+		return features(type).storedDims();
+	}
+
+	/**
+	 * Compute the given squares and pairwise products on the fly from the 
+	 * stored features of the given type, instead of storing them.
+	 */
+	void setExpansion(Crag::NodeType type, const FeatureExpansion& expansion) {
+
+		features(type).setExpansion(expansion);
+	}
+
+	const FeatureExpansion& getExpansion(Crag::NodeType type) const {
+
+		return features(type).getExpansion();
+	}
+
+	/**
+	 * The dot product of w with the expanded feature vector of n.
+	 */
+	inline double dot(Crag::CragNode n, const std::vector<double>& w) const {
+
+		return features(_crag.type(n)).dot(n, w);
+	}
+
+	/**
+	 * Add scale times the expanded feature vector of n to g.
+	 */
+	inline void accumulate(Crag::CragNode n, double scale, std::vector<double>& g) const {
+
+		features(_crag.type(n)).accumulate(n, scale, g);
+	}
+
+	/**
+	 * Set costs[n] to the dot product of the expanded feature vector of 
+	 * each node n with the weights for its type, using the given number of 
+	 * threads. Nodes without features get a cost of 0.
+	 */
+	void computeCosts(const FeatureWeights& weights, Crag::NodeMap<double>& costs, unsigned int numThreads) const {
+
+		for (Crag::CragNode n : _crag.nodes())
+			costs[n] = 0;
+
+		for (Crag::NodeType type : Crag::NodeTypes) {
+
+			if (features(type).size() == 0)
+				continue;
+
+			features(type).dots(
+					weights[type],
+					[&](Crag::CragNode n, double cost) { costs[n] = cost; },
+					numThreads);
+		}
+	}
+
+	/**
+	 * Add the expanded feature vector of each node n, multiplied with 
+	 * scale(n), to the gradient for its type, using the given number of 
+	 * threads.
+	 */
+	template <typename Scale>
+	void accumulateAll(Scale scale, FeatureWeights& gradient, unsigned int numThreads) const {
+
+		for (Crag::NodeType type : Crag::NodeTypes) {
+
+			if (features(type).size() == 0)
+				continue;
+
+			features(type).accumulateAll(scale, gradient[type], numThreads);
+		}
+	}
+
+	/**
+	 * Get the expanded feature vector of n.
+	 */
+	inline std::vector<double> expand(Crag::CragNode n) const {
+
+		return features(_crag.type(n)).expand(n);
+	}
+
 	void normalize() {
 
 		for (auto& f : _features)
@@ -75,6 +182,13 @@ public:
 			max[type] = features(type).getMax();
 	}
 
+	/**
+	 * Direct access to the features of the given type, e.g., to expose the 
+	 * feature matrix without copying it.
+	 */
+	FeaturesType& getFeatures(Crag::NodeType type) { return features(type); }
+	const FeaturesType& getFeatures(Crag::NodeType type) const { return features(type); }
+
 private:
 
 	inline FeaturesType& features(Crag::NodeType type) {
@@ -1,9 +1,15 @@
 #ifndef CANDIDATE_MC_FEATURES_PAIRWISE_FEATURE_PROVIDER_H__
 #define CANDIDATE_MC_FEATURES_PAIRWISE_FEATURE_PROVIDER_H__
 
+#include <util/exceptions.h>
 #include "FeatureProvider.h"
 
-class PairwiseFeatureProvider : public FeatureProvider<PairwiseFeatureProvider> {
+/**
+ * Adds the pairwise products of all features (including the squares, if they 
+ * were added before). The products are not stored, but computed on the fly 
+ * from the features (see FeatureExpansion).
+ */
+class PairwiseFeatureProvider : public FeatureProviderBase {
 
 public:
 
@@ -11,94 +17,57 @@ public:
 		_crag(crag),
 		_featureForEdges(featureForEdges){}
 
-	template <typename ContainerT>
-	void appendNodeFeatures(const Crag::CragNode n, ContainerT& adaptor) {
+	void appendFeatures(const Crag& crag, NodeFeatures& nodeFeatures) override {
 
-		auto type =_crag.type(n);
-		auto iter = _nodeFeaturesNames.find(type);
-		if (iter == _nodeFeaturesNames.end())
-			for( unsigned int i = 0; i < adaptor.getFeatureNames(type).size(); i++)
-				_nodeFeaturesNames[type].push_back( adaptor.getFeatureNames(type)[i] );
+		for (auto type : Crag::NodeTypes) {
 
-		// compute all pairwise products of all features and add them as well
-		const std::vector<double>& features = adaptor.getFeatures();
-		unsigned int numOriginalFeatures = features.size();
-
-		for (unsigned int i = 0; i < numOriginalFeatures; i++)
-			for (unsigned int j = i; j < numOriginalFeatures; j++)
-				adaptor.append(features[i]*features[j]);
+			nodeFeatures.setExpansion(type, pairwiseExpansion(nodeFeatures.getExpansion(type), nodeFeatures.storedDims(type)));
+			nodeFeatures.appendFeatureNames(type, pairwiseNames(nodeFeatures.getFeatureNames(type)));
+		}
 	}
 
-	std::map<Crag::NodeType, std::vector<std::string>> getNodeFeatureNames() const override {
+	void appendFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) override {
 
-		std::map<Crag::NodeType, std::vector<std::string>> names;
-		for (auto type : Crag::NodeTypes){
+		if (!_featureForEdges)
+			return;
 
-			std::vector<std::string> featureNames;
-			auto iter = _nodeFeaturesNames.find(type);
-			if (iter != _nodeFeaturesNames.end())
-			{
-				featureNames = iter->second;
-				for (unsigned int i = 0; i < featureNames.size(); i++)
-					for (unsigned int j = i; j < featureNames.size(); j++)
-						names[type].push_back( featureNames[i] + "*" + featureNames[j]);
-			}
-		}
+		for (auto type : Crag::EdgeTypes) {
 
-		return names;
+			edgeFeatures.setExpansion(type, pairwiseExpansion(edgeFeatures.getExpansion(type), edgeFeatures.storedDims(type)));
+			edgeFeatures.appendFeatureNames(type, pairwiseNames(edgeFeatures.getFeatureNames(type)));
+		}
 	}
 
-	template <typename ContainerT>
-	void appendEdgeFeatures(const Crag::CragEdge e, ContainerT& adaptor) {
+private:
 
-		if (!_featureForEdges)
-			return;
+	FeatureExpansion pairwiseExpansion(const FeatureExpansion& expansion, unsigned int numFeatures) {
 
-		auto type =_crag.type(e);
-		auto iter = _edgeFeaturesNames.find(type);
-		if (iter == _edgeFeaturesNames.end()){
-			for( unsigned int i = 0; i < adaptor.getFeatureNames(type).size(); i++)
-				_edgeFeaturesNames[type].push_back( adaptor.getFeatureNames(type)[i] );
-		}
+		if (expansion.pairwise())
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"pairwise feature products were already added");
 
-		// compute all pairwise products of all features and add them as well
-		const std::vector<double>& features = adaptor.getFeatures();
-		unsigned int numOriginalFeatures = features.size();
+		// the squares have to be the last features
+		if (expansion.squares() && expansion.numBaseFeatures() != numFeatures)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"features were added after the squares");
 
-		for (unsigned int i = 0; i < numOriginalFeatures; i++)
-			for (unsigned int j = i; j < numOriginalFeatures; j++)
-				adaptor.append(features[i]*features[j]);
+		return FeatureExpansion(numFeatures, expansion.squares(), true);
 	}
 
-	std::map<Crag::EdgeType, std::vector<std::string>> getEdgeFeatureNames() const override {
+	std::vector<std::string> pairwiseNames(const std::vector<std::string>& featureNames) {
 
-		std::map<Crag::EdgeType, std::vector<std::string>> names;
-
-		if (!_featureForEdges)
-			return names;
-
-		for (auto type : Crag::EdgeTypes){
-			std::vector<std::string> featureNames;
-			auto iter = _edgeFeaturesNames.find(type);
-			if (iter != _edgeFeaturesNames.end())
-			{
-				featureNames = iter->second;
-				for (unsigned int i = 0; i < featureNames.size(); i++)
-					for (unsigned int j = i; j < featureNames.size(); j++)
-						names[type].push_back( featureNames[i] + "*" + featureNames[j]);
-			}
-		}
+		std::vector<std::string> names;
+		for (unsigned int i = 0; i < featureNames.size(); i++)
+			for (unsigned int j = i; j < featureNames.size(); j++)
+				names.push_back(featureNames[i] + "*" + featureNames[j]);
 
 		return names;
 	}
 
-private:
 	const Crag& _crag;
 	bool _featureForEdges;
-
-	std::map<Crag::NodeType, std::vector<std::string>> _nodeFeaturesNames;
-	std::map<Crag::EdgeType, std::vector<std::string>> _edgeFeaturesNames;
 };
 
 #endif // CANDIDATE_MC_FEATURES_PAIRWISE_FEATURE_PROVIDER_H__
-
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include "QuantileSketch.h"
+
+QuantileSketch::Binning::Binning(double min, double max, unsigned int numBins) :
+	_min(min),
+	_width(numBins > 0 ? (max - min)/numBins : 0),
+	_numBins(std::max(numBins, 1u)) {}
+
+unsigned int
+QuantileSketch::Binning::bin(double value) const {
+
+	if (_width <= 0 || value <= _min)
+		return 0;
+
+	return std::min((unsigned int)((value - _min)/_width), _numBins - 1);
+}
+
+double
+QuantileSketch::Binning::value(unsigned int bin, double fraction) const {
+
+	return _min + (bin + fraction)*_width;
+}
+
+double
+QuantileSketch::valueAtRank(std::size_t rank, const Binning& binning) const {
+
+	float fraction;
+	unsigned int bin = _histogram.rankBin(rank, fraction);
+
+	return binning.value(bin, fraction);
+}
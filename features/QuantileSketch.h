@@ -0,0 +1,72 @@
+#ifndef CANDIDATE_MC_FEATURES_QUANTILE_SKETCH_H__
+#define CANDIDATE_MC_FEATURES_QUANTILE_SKETCH_H__
+
+#include <vector>
+#include <cstddef>
+#include <mergetree/EdgeHistogram.h>
+
+/**
+ * A mergeable summary of a set of values to find quantiles. The values are 
+ * counted in a sparse EdgeHistogram with bins of equal width over a fixed 
+ * range. Quantiles are interpolated within their bin, such that the error is 
+ * at most the bin width.
+ */
+class QuantileSketch {
+
+public:
+
+	/**
+	 * The bins shared by all sketches of the same values.
+	 */
+	class Binning {
+
+	public:
+
+		Binning(double min = 0, double max = 1, unsigned int numBins = 4096);
+
+		unsigned int bin(double value) const;
+
+		double value(unsigned int bin, double fraction) const;
+
+	private:
+
+		double       _min;
+		double       _width;
+		unsigned int _numBins;
+	};
+
+	/**
+	 * Create an empty sketch.
+	 */
+	QuantileSketch() {}
+
+	/**
+	 * Create a sketch from the bins of a list of values. The list will be 
+	 * sorted.
+	 */
+	explicit QuantileSketch(std::vector<unsigned int>& bins) : _histogram(bins) {}
+
+	/**
+	 * Add the values of another sketch to this one.
+	 */
+	void merge(const QuantileSketch& other) { _histogram.merge(other._histogram); }
+
+	/**
+	 * The number of values in this sketch.
+	 */
+	std::size_t size() const { return _histogram.size(); }
+
+	/**
+	 * Get the value with the given rank, i.e., the value that would be at 
+	 * position rank if all values were sorted. rank has to be smaller than 
+	 * size().
+	 */
+	double valueAtRank(std::size_t rank, const Binning& binning) const;
+
+private:
+
+	EdgeHistogram _histogram;
+};
+
+#endif // CANDIDATE_MC_FEATURES_QUANTILE_SKETCH_H__
+
@@ -45,35 +45,36 @@ public:
 		_volumes(volumes),
 		_parameters(parameters) {
 
-			RegionFeatures<2, float, unsigned char>::Parameters parameters2d;
-			parameters2d.computeStatistics    = false;
-			parameters2d.computeShapeFeatures = true;
-			parameters2d.shapeFeaturesParameters.numAnglePoints              = _parameters.numAnglePoints;
-			parameters2d.shapeFeaturesParameters.contourVecAsArcSegmentRatio = _parameters.contourVecAsArcSegmentRatio;
-			parameters2d.shapeFeaturesParameters.numAngleHistBins            = _parameters.numAngleHistBins;
-
-			_2dRegionFeatures = RegionFeatures<2, float, unsigned char>(parameters2d);
-
-			RegionFeatures<3, float, unsigned char>::Parameters parameters3d;
-			parameters3d.computeStatistics    = false;
-			parameters3d.computeShapeFeatures = true;
-			parameters3d.shapeFeaturesParameters.numAnglePoints              = _parameters.numAnglePoints;
-			parameters3d.shapeFeaturesParameters.contourVecAsArcSegmentRatio = _parameters.contourVecAsArcSegmentRatio;
-			parameters3d.shapeFeaturesParameters.numAngleHistBins            = _parameters.numAngleHistBins;
-
-			_3dRegionFeatures = RegionFeatures<3, float, unsigned char>(parameters3d);
+			_parameters2d.computeStatistics    = false;
+			_parameters2d.computeShapeFeatures = true;
+			_parameters2d.shapeFeaturesParameters.numAnglePoints              = _parameters.numAnglePoints;
+			_parameters2d.shapeFeaturesParameters.contourVecAsArcSegmentRatio = _parameters.contourVecAsArcSegmentRatio;
+			_parameters2d.shapeFeaturesParameters.numAngleHistBins            = _parameters.numAngleHistBins;
+
+			_2dRegionFeatures = RegionFeatures<2, float, unsigned char>(_parameters2d);
+
+			_parameters3d.computeStatistics    = false;
+			_parameters3d.computeShapeFeatures = true;
+			_parameters3d.shapeFeaturesParameters.numAnglePoints              = _parameters.numAnglePoints;
+			_parameters3d.shapeFeaturesParameters.contourVecAsArcSegmentRatio = _parameters.contourVecAsArcSegmentRatio;
+			_parameters3d.shapeFeaturesParameters.numAngleHistBins            = _parameters.numAngleHistBins;
+
+			_3dRegionFeatures = RegionFeatures<3, float, unsigned char>(_parameters3d);
 		}
 
 	template <typename ContainerT>
 	void appendNodeFeatures(const Crag::CragNode n, ContainerT& adaptor) {
 
-		// the "label" image
-		const vigra::MultiArray<3, unsigned char>& labelImage = _volumes[n]->data();
+		// the "label" image, keep the volume alive while it is used
+		std::shared_ptr<CragVolume> volume = _volumes[n];
+		const vigra::MultiArray<3, unsigned char>& labelImage = volume->data();
 
+		// fill() is not const, use own instances since nodes are processed in 
+		// parallel
 		if (_crag.type(n) == Crag::SliceNode)
-			_2dRegionFeatures.fill(labelImage.bind<2>(0), adaptor);
+			RegionFeatures<2, float, unsigned char>(_parameters2d).fill(labelImage.bind<2>(0), adaptor);
 		else
-			_3dRegionFeatures.fill(labelImage, adaptor);
+			RegionFeatures<3, float, unsigned char>(_parameters3d).fill(labelImage, adaptor);
 	}
 
 	std::map<Crag::NodeType, std::vector<std::string>> getNodeFeatureNames() const override {
@@ -87,6 +88,10 @@ public:
 		return names;
 	}
 
+protected:
+
+	bool supportsParallelExtraction() const override { return true; }
+
 private:
 
 	const Crag&        _crag;
@@ -94,6 +99,10 @@ private:
 
 	Parameters _parameters;
 
+	RegionFeatures<2, float, unsigned char>::Parameters _parameters2d;
+	RegionFeatures<3, float, unsigned char>::Parameters _parameters3d;
+
+	// only used for the feature names
 	RegionFeatures<2, float, unsigned char> _2dRegionFeatures;
 	RegionFeatures<3, float, unsigned char> _3dRegionFeatures;
 };
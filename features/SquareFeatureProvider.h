@@ -1,9 +1,14 @@
 #ifndef CANDIDATE_MC_FEATURES_SQUARE_FEATURE_PROVIDER_H__
 #define CANDIDATE_MC_FEATURES_SQUARE_FEATURE_PROVIDER_H__
 
+#include <util/exceptions.h>
 #include "FeatureProvider.h"
 
-class SquareFeatureProvider : public FeatureProvider<SquareFeatureProvider> {
+/**
+ * Adds the squares of all features. The squares are not stored, but computed 
+ * on the fly from the features (see FeatureExpansion).
+ */
+class SquareFeatureProvider : public FeatureProviderBase {
 
 public:
 
@@ -11,86 +16,50 @@ public:
 		_crag(crag),
 		_featureForEdges(featureForEdges){}
 
-	template <typename ContainerT>
-	void appendNodeFeatures(const Crag::CragNode n, ContainerT& adaptor) {
+	void appendFeatures(const Crag& crag, NodeFeatures& nodeFeatures) override {
 
-		auto type =_crag.type(n);
-		auto iter = _nodeFeaturesNames.find(type);
-		if (iter == _nodeFeaturesNames.end())
-			for( unsigned int i = 0; i < adaptor.getFeatureNames(type).size(); i++)
-				_nodeFeaturesNames[type].push_back( adaptor.getFeatureNames(type)[i] );
+		for (auto type : Crag::NodeTypes) {
 
-		// compute all squares of all features and add them as well
-		const std::vector<double>& features = adaptor.getFeatures();
-		unsigned int numOriginalFeatures = features.size();
-
-		for (unsigned int i = 0; i < numOriginalFeatures; i++)
-			adaptor.append(features[i]*features[i]);
-	}
-
-	std::map<Crag::NodeType, std::vector<std::string>> getNodeFeatureNames() const override {
-
-		std::map<Crag::NodeType, std::vector<std::string>> names;
-		for (auto type : Crag::NodeTypes){
-			std::vector<std::string> featureNames;
-			auto iter = _nodeFeaturesNames.find(type);
-			if (iter != _nodeFeaturesNames.end())
-			{
-				featureNames = iter->second;
-				for (unsigned int i = 0; i < featureNames.size(); i++)
-					names[type].push_back(featureNames[i] + "²");
-			}
+			nodeFeatures.setExpansion(type, squareExpansion(nodeFeatures.getExpansion(type), nodeFeatures.storedDims(type)));
+			nodeFeatures.appendFeatureNames(type, squareNames(nodeFeatures.getFeatureNames(type)));
 		}
-		return names;
 	}
 
-	template <typename ContainerT>
-	void appendEdgeFeatures(const Crag::CragEdge e, ContainerT& adaptor) {
+	void appendFeatures(const Crag& crag, EdgeFeatures& edgeFeatures) override {
 
 		if (!_featureForEdges)
 			return;
 
-		auto type =_crag.type(e);
-		auto iter = _edgeFeaturesNames.find(type);
-		if (iter == _edgeFeaturesNames.end()){
-			for( unsigned int i = 0; i < adaptor.getFeatureNames(type).size(); i++)
-				_edgeFeaturesNames[type].push_back( adaptor.getFeatureNames(type)[i] );
+		for (auto type : Crag::EdgeTypes) {
+
+			edgeFeatures.setExpansion(type, squareExpansion(edgeFeatures.getExpansion(type), edgeFeatures.storedDims(type)));
+			edgeFeatures.appendFeatureNames(type, squareNames(edgeFeatures.getFeatureNames(type)));
 		}
+	}
+
+private:
 
-		// compute all squares of all features and add them as well
-		const std::vector<double>& features = adaptor.getFeatures();
-		unsigned int numOriginalFeatures = features.size();
-		for (unsigned int i = 0; i < numOriginalFeatures; i++)
-			adaptor.append(features[i]*features[i]);
+	FeatureExpansion squareExpansion(const FeatureExpansion& expansion, unsigned int numFeatures) {
+
+		if (!expansion.empty())
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"squares have to be added before any other feature products");
+
+		return FeatureExpansion(numFeatures, true, false);
 	}
 
-	std::map<Crag::EdgeType, std::vector<std::string>> getEdgeFeatureNames() const override {
+	std::vector<std::string> squareNames(const std::vector<std::string>& featureNames) {
 
-		std::map<Crag::EdgeType, std::vector<std::string>> names;
+		std::vector<std::string> names;
+		for (unsigned int i = 0; i < featureNames.size(); i++)
+			names.push_back(featureNames[i] + "²");
 
-		if (!_featureForEdges)
-			return names;
-
-		for (auto type : Crag::EdgeTypes){
-			std::vector<std::string> featureNames;
-			auto iter = _edgeFeaturesNames.find(type);
-			if (iter != _edgeFeaturesNames.end())
-			{
-				featureNames = iter->second;
-				for (unsigned int i = 0; i < featureNames.size(); i++)
-					names[type].push_back(featureNames[i] + "²");
-			}
-		}
 		return names;
 	}
 
-private:
 	const Crag& _crag;
 	bool _featureForEdges;
-
-	std::map<Crag::NodeType, std::vector<std::string>> _nodeFeaturesNames;
-	std::map<Crag::EdgeType, std::vector<std::string>> _edgeFeaturesNames;
 };
 
 #endif // CANDIDATE_MC_FEATURES_SQUARE_FEATURE_PROVIDER_H__
-
@@ -63,19 +63,21 @@ public:
 		_volumes(volumes),
 		_parameters(parameters) {
 
-			RegionFeatures<2, float, unsigned char>::Parameters parameters2d;
-			parameters2d.computeStatistics    = true;
-			parameters2d.computeShapeFeatures = false;
-			parameters2d.statisticsParameters.computeCoordinateStatistics = _parameters.computeCoordinateStatistics;
+			_parameters2d.computeStatistics    = true;
+			_parameters2d.computeShapeFeatures = false;
+			_parameters2d.statisticsParameters.computeCoordinateStatistics = _parameters.computeCoordinateStatistics;
 
-			_2dRegionFeatures = RegionFeatures<2, float, unsigned char>(parameters2d);
+			_2dRegionFeatures = RegionFeatures<2, float, unsigned char>(_parameters2d);
 
-			RegionFeatures<3, float, unsigned char>::Parameters parameters3d;
-			parameters3d.computeStatistics    = true;
-			parameters3d.computeShapeFeatures = false;
-			parameters3d.statisticsParameters.computeCoordinateStatistics = _parameters.computeCoordinateStatistics;
+			_parameters3d.computeStatistics    = true;
+			_parameters3d.computeShapeFeatures = false;
+			_parameters3d.statisticsParameters.computeCoordinateStatistics = _parameters.computeCoordinateStatistics;
 
-			_3dRegionFeatures = RegionFeatures<3, float, unsigned char>(parameters3d);
+			_3dRegionFeatures = RegionFeatures<3, float, unsigned char>(_parameters3d);
+
+			// compute the lazy bounding box now, nodes are processed in 
+			// parallel
+			_values.getBoundingBox();
 		}
 
 	template <typename ContainerT>
@@ -84,11 +86,15 @@ public:
 		if (_crag.type(n) == Crag::NoAssignmentNode)
 			return;
 
+		// get the volume only once, for higher or sparse nodes this 
+		// materializes it
+		std::shared_ptr<CragVolume> volume = _volumes[n];
+
 		// the bounding box of the volume
-		const util::box<float, 3>&   nodeBoundingBox    = _volumes[n]->getBoundingBox();
-		util::point<unsigned int, 3> nodeSize           = (nodeBoundingBox.max() - nodeBoundingBox.min())/_volumes[n]->getResolution();
+		const util::box<float, 3>&   nodeBoundingBox    = volume->getBoundingBox();
+		util::point<unsigned int, 3> nodeSize           = (nodeBoundingBox.max() - nodeBoundingBox.min())/volume->getResolution();
 		util::point<float, 3>        nodeOffset         = nodeBoundingBox.min() - _values.getBoundingBox().min();
-		util::point<unsigned int, 3> nodeDiscreteOffset = nodeOffset/_volumes[n]->getResolution();
+		util::point<unsigned int, 3> nodeDiscreteOffset = nodeOffset/volume->getResolution();
 
 		// a view to the values image for the node bounding box
 		typedef vigra::MultiArrayView<3, float>::difference_type Shape;
@@ -104,14 +110,19 @@ public:
 								nodeDiscreteOffset.z() + nodeSize.z()));
 
 		// the "label" image
-		const vigra::MultiArray<3, unsigned char>& labelImage = _volumes[n]->data();
+		const vigra::MultiArray<3, unsigned char>& labelImage = volume->data();
+
+		// fill() is not const, use own instances since nodes are processed in 
+		// parallel
+		RegionFeatures<2, float, unsigned char> regionFeatures2d(_parameters2d);
+		RegionFeatures<3, float, unsigned char> regionFeatures3d(_parameters3d);
 
 		if (_parameters.wholeVolume) {
 
 			if (_crag.type(n) == Crag::SliceNode)
-				_2dRegionFeatures.fill(valuesNodeImage.bind<2>(0), labelImage.bind<2>(0), adaptor);
+				regionFeatures2d.fill(valuesNodeImage.bind<2>(0), labelImage.bind<2>(0), adaptor);
 			else
-				_3dRegionFeatures.fill(valuesNodeImage, labelImage, adaptor);
+				regionFeatures3d.fill(valuesNodeImage, labelImage, adaptor);
 		}
 
 		if (_parameters.boundaryVoxels) {
@@ -119,9 +130,9 @@ public:
 			vigra::MultiArray<3, unsigned char> boundaryImage = getBoundaryVoxelMask(labelImage);
 
 			if (_crag.type(n) == Crag::SliceNode)
-				_2dRegionFeatures.fill(valuesNodeImage.bind<2>(0), boundaryImage.bind<2>(0), adaptor);
+				regionFeatures2d.fill(valuesNodeImage.bind<2>(0), boundaryImage.bind<2>(0), adaptor);
 			else
-				_3dRegionFeatures.fill(valuesNodeImage, boundaryImage, adaptor);
+				regionFeatures3d.fill(valuesNodeImage, boundaryImage, adaptor);
 		}
 	}
 
@@ -150,6 +161,10 @@ public:
 		return names;
 	}
 
+protected:
+
+	bool supportsParallelExtraction() const override { return true; }
+
 private:
 
 	vigra::MultiArray<3, unsigned char> getBoundaryVoxelMask(const vigra::MultiArray<3, unsigned char>& labelImage) {
@@ -204,6 +219,10 @@ private:
 
 	Parameters _parameters;
 
+	RegionFeatures<2, float, unsigned char>::Parameters _parameters2d;
+	RegionFeatures<3, float, unsigned char>::Parameters _parameters3d;
+
+	// only used for the feature names
 	RegionFeatures<2, float, unsigned char> _2dRegionFeatures;
 	RegionFeatures<3, float, unsigned char> _3dRegionFeatures;
 };
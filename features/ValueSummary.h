@@ -0,0 +1,74 @@
+#ifndef CANDIDATE_MC_FEATURES_VALUE_SUMMARY_H__
+#define CANDIDATE_MC_FEATURES_VALUE_SUMMARY_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+/**
+ * Count, raw moments, minimum, and maximum of a set of values. Two summaries 
+ * can be merged into the summary of the union of their values.
+ */
+class ValueSummary {
+
+public:
+
+	ValueSummary() :
+		_count(0),
+		_sum(0),
+		_sum2(0),
+		_sum3(0),
+		_min(std::numeric_limits<double>::infinity()),
+		_max(-std::numeric_limits<double>::infinity()) {}
+
+	void add(double value) {
+
+		_count++;
+		_sum  += value;
+		_sum2 += value*value;
+		_sum3 += value*value*value;
+		_min   = std::min(_min, value);
+		_max   = std::max(_max, value);
+	}
+
+	void merge(const ValueSummary& other) {
+
+		_count += other._count;
+		_sum   += other._sum;
+		_sum2  += other._sum2;
+		_sum3  += other._sum3;
+		_min    = std::min(_min, other._min);
+		_max    = std::max(_max, other._max);
+	}
+
+	std::size_t count() const { return _count; }
+
+	double min() const { return _min; }
+
+	double max() const { return _max; }
+
+	double mean() const { return _sum/_count; }
+
+	/**
+	 * The raw second moment, i.e., the mean of the squared values.
+	 */
+	double moment2() const { return _sum2/_count; }
+
+	/**
+	 * The raw third moment, i.e., the mean of the cubed values.
+	 */
+	double moment3() const { return _sum3/_count; }
+
+private:
+
+	std::size_t _count;
+
+	double _sum;
+	double _sum2;
+	double _sum3;
+	double _min;
+	double _max;
+};
+
+#endif // CANDIDATE_MC_FEATURES_VALUE_SUMMARY_H__
+
@@ -287,6 +287,11 @@ AssignmentSolver::findAssignments(CragSolution& solution) {
 
 	LOG_USER(assignmentlog) << "searching for optimal assignments..." << std::endl;
 
+	// the constraints don't change between calls, such that a previous 
+	// solution is a feasible start
+	if (_solution.size() > 0)
+		_solver->setInitialSolution(_solution);
+
 	std::string msg;
 	if (!_solver->solve(_solution, msg))
 		LOG_ERROR(assignmentlog) << "solver did not find optimal solution: " << msg << std::endl;
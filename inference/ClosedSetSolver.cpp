@@ -14,6 +14,8 @@ ClosedSetSolver::ClosedSetSolver(const Crag& crag, const Parameters& parameters)
 	_numNodes(0),
 	_numEdges(0),
 	_solver(0),
+	_numSolverConstraints(0),
+	_resetSolverConstraints(true),
 	_parameters(parameters) {
 
 	_numNodes = _crag.nodes().size();
@@ -240,8 +242,13 @@ ClosedSetSolver::findMinClosedSet(CragSolution& solution) {
 
 	LOG_USER(closedsetlog) << "searching for min closed set..." << std::endl;
 
-	// re-set constraints to inform solver about potential changes
-	_solver->setConstraints(_constraints);
+	updateSolverConstraints();
+
+	// the previous solution is a good start, even if it violates some of the 
+	// new constraints
+	if (_solution.size() > 0)
+		_solver->setInitialSolution(_solution);
+
 	std::string msg;
 	if (!_solver->solve(_solution, msg)) {
 
@@ -280,6 +287,27 @@ ClosedSetSolver::findMinClosedSet(CragSolution& solution) {
 	}
 }
 
+void
+ClosedSetSolver::updateSolverConstraints() {
+
+	if (_resetSolverConstraints) {
+
+		_solver->setConstraints(_constraints);
+		_resetSolverConstraints = false;
+
+	} else {
+
+		// pass only the constraints found since the last solve
+		LOG_DEBUG(closedsetlog)
+				<< "adding " << (_constraints.size() - _numSolverConstraints)
+				<< " new constraints to solver" << std::endl;
+
+		_solver->addConstraints(_constraints, _numSolverConstraints);
+	}
+
+	_numSolverConstraints = _constraints.size();
+}
+
 bool
 ClosedSetSolver::findViolatedConstraints(CragSolution& solution) {
 
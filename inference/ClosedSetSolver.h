@@ -49,6 +49,8 @@ private:
 
 	bool findViolatedConstraints(CragSolution& solution);
 
+	void updateSolverConstraints();
+
 	inline unsigned int nodeIdToVar(int nodeId) { return nodeId; }
 	inline unsigned int edgeIdToVar(int edgeId) { return _edgeIdToVarMap[edgeId]; }
 
@@ -63,6 +65,12 @@ private:
 	LinearSolverBackend* _solver;
 	Solution             _solution;
 
+	// the number of constraints in _constraints that have been passed to the 
+	// solver already, and whether the solver's constraints have to be 
+	// replaced since _constraints changed otherwise
+	unsigned int _numSolverConstraints;
+	bool         _resetSolverConstraints;
+
 	Parameters _parameters;
 };
 
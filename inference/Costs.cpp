@@ -3,125 +3,43 @@
 void
 Costs::propagateLeafValues(const Crag& crag) {
 
-	std::map<Crag::CragNode, std::set<Crag::CragNode>> leafNodes;
-
-	// collect leaf nodes under each crag node
-	for (Crag::CragNode n : crag.nodes())
-		if (crag.isRootNode(n))
-			collectLeafNodes(crag, n, leafNodes);
-
-	// get node values
-	for (Crag::CragNode n : crag.nodes())
-		node[n] = nodeValueFromLeafNodes(crag, n, leafNodes);
-
-	// get edge values
-	for (Crag::CragEdge e : crag.edges())
-		edge[e] = edgeValueFromLeafNodes(crag, e, leafNodes);
-}
-
-void
-Costs::propagateLeafEdgeValues(const Crag& crag) {
-
-	std::map<Crag::CragNode, std::set<Crag::CragNode>> leafNodes;
-
-	// collect leaf nodes under each crag node
-	for (Crag::CragNode n : crag.nodes())
-		if (crag.isRootNode(n))
-			collectLeafNodes(crag, n, leafNodes);
-
-	// get edge values
-	for (Crag::CragEdge e : crag.edges())
-		edge[e] = edgeValueFromLeafNodes(crag, e, leafNodes);
-}
-
-void
-Costs::collectLeafNodes(
-		const Crag&                                         crag,
-		Crag::CragNode                                      n,
-		std::map<Crag::CragNode, std::set<Crag::CragNode>>& leafNodes) {
-
-	unsigned int numChildren = 0;
-	for (Crag::CragArc e : crag.inArcs(n)) {
-
-		Crag::CragNode child = e.source();
-
-		collectLeafNodes(crag, child, leafNodes);
-		numChildren++;
-
-		for (Crag::CragNode m : leafNodes[child])
-			leafNodes[n].insert(m);
-	}
-
-	if (numChildren == 0)
-		leafNodes[n].insert(n);
-}
-
-double
-Costs::nodeValueFromLeafNodes(
-		const Crag&                                               crag,
-		const Crag::CragNode&                                     n,
-		const std::map<Crag::CragNode, std::set<Crag::CragNode>>& leafNodes) {
-
-	double value = 0;
-
 	// value of a node is the value of all contained leaf nodes plus all inner
 	// leaf edges
 
-	for (Crag::CragNode leaf : leafNodes.at(n)) {
-
-		value += node[leaf];
-
-		// all edges with leaf as u
-		for (Crag::CragEdge e : crag.adjEdges(leaf)) {
-
-			// leaf not u?
-			if (crag.u(e) != leaf)
-				continue;
+	for (Crag::CragNode n : crag.nodes()) {
 
-			Crag::CragNode neighbor = crag.v(e);
+		if (crag.isLeafNode(n))
+			continue;
 
-			// not a contained leaf node?
-			if (!leafNodes.at(n).count(neighbor))
-				continue;
+		double value = 0;
 
-			// e is an inside leaf edge
+		for (Crag::CragNode leaf : crag.leafNodes(n))
+			value += node[leaf];
+		for (Crag::CragEdge e : crag.leafEdges(n))
 			value += edge[e];
-		}
+
+		node[n] = value;
 	}
 
-	return value;
+	propagateLeafEdgeValues(crag);
 }
 
-double
-Costs::edgeValueFromLeafNodes(
-		const Crag&                                               crag,
-		const Crag::CragEdge&                                     e,
-		const std::map<Crag::CragNode, std::set<Crag::CragNode>>& leafNodes) {
-
-	double value = 0;
-
-	// value of an edge (u,v) is sum of values of all leaf edges between contained
-	// leaf nodes of u and v
-
-	const std::set<Crag::CragNode>& uLeafNodes = leafNodes.at(crag.u(e));
-	const std::set<Crag::CragNode>& vLeafNodes = leafNodes.at(crag.v(e));
+void
+Costs::propagateLeafEdgeValues(const Crag& crag) {
 
-	// for each leaf node of u
-	for (Crag::CragNode leaf : uLeafNodes) {
+	// value of an edge (u,v) is sum of values of all leaf edges between 
+	// contained leaf nodes of u and v
 
-		// for each adjacency edge
-		for (Crag::CragEdge f : crag.adjEdges(leaf)) {
+	for (Crag::CragEdge e : crag.edges()) {
 
-			Crag::CragNode neighbor = crag.oppositeNode(leaf, f);
+		if (crag.isLeafEdge(e))
+			continue;
 
-			// not a v-contained leaf node?
-			if (!vLeafNodes.count(neighbor))
-				continue;
+		double value = 0;
 
-			// f is an edge between leaf nodes of u and v
+		for (Crag::CragEdge f : crag.leafEdges(e))
 			value += edge[f];
-		}
-	}
 
-	return value;
+		edge[e] = value;
+	}
 }
@@ -24,23 +24,6 @@ public:
 
 	Crag::NodeMap<double> node;
 	Crag::EdgeMap<double> edge;
-
-private:
-
-	void collectLeafNodes(
-			const Crag&                                         crag,
-			Crag::CragNode                                      n,
-			std::map<Crag::CragNode, std::set<Crag::CragNode>>& leafNodes);
-
-	double nodeValueFromLeafNodes(
-			const Crag&                                               crag,
-			const Crag::CragNode&                                     n,
-			const std::map<Crag::CragNode, std::set<Crag::CragNode>>& leafNodes);
-
-	double edgeValueFromLeafNodes(
-			const Crag&                                               crag,
-			const Crag::CragEdge&                                     e,
-			const std::map<Crag::CragNode, std::set<Crag::CragNode>>& leafNodes);
 };
 
 #endif // CANDIDATE_MC_INFERENCE_COSTS_H__
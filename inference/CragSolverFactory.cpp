@@ -10,6 +10,11 @@ util::ProgramOption optionClosedSetSolver(
 		util::_long_name        = "closedSetSolver",
 		util::_description_text = "Use the closed set solver to get a solution.");
 
+util::ProgramOption optionHeuristicSolver(
+		util::_long_name        = "heuristicSolver",
+		util::_description_text = "Use greedy edge contraction and Kernighan-Lin refinement to get an approximate "
+		                          "multi-cut solution, without an ILP solver.");
+
 CragSolver*
 CragSolverFactory::createSolver(
 		const Crag& crag,
@@ -24,6 +29,10 @@ CragSolverFactory::createSolver(
 
 		return new ClosedSetSolver(crag, parameters);
 
+	} else if (optionHeuristicSolver) {
+
+		return new HeuristicMultiCutSolver(crag, parameters);
+
 	} else {
 
 		return new MultiCutSolver(crag, parameters);
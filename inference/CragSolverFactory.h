@@ -4,6 +4,7 @@
 #include "AssignmentSolver.h"
 #include "MultiCutSolver.h"
 #include "ClosedSetSolver.h"
+#include "HeuristicMultiCutSolver.h"
 
 class CragSolverFactory {
 
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <iterator>
+#include <crag/ParallelFor.h>
+#include <util/assert.h>
+#include "CycleSeparator.h"
+
+CycleSeparator::CycleSeparator(const Crag& crag, const Parameters& parameters) :
+	_crag(crag),
+	_parameters(parameters) {}
+
+std::vector<CycleSeparator::Cycle>
+CycleSeparator::findViolatedCycles(
+		const CragSolution&        solution,
+		const std::vector<double>& edgeValues) {
+
+	buildGraph(solution);
+	findComponents(solution);
+
+	// for each component, the edges that are not selected, but have both nodes 
+	// in the component
+	std::vector<std::vector<int>> cutEdges(_componentSizes.size());
+
+	for (Crag::CragEdge e : _crag.edges()) {
+
+		if (solution.selected(e))
+			continue;
+
+		int id = _crag.id(e);
+		int component = _components[_edgeU[id]];
+
+		if (component < 0 || component != _components[_edgeV[id]])
+			continue;
+
+		cutEdges[component].push_back(id);
+	}
+
+	// search the largest components first, such that they don't end up as the 
+	// last job of a single thread
+	std::vector<int> components;
+	for (std::size_t c = 0; c < cutEdges.size(); c++)
+		if (!cutEdges[c].empty())
+			components.push_back(c);
+
+	std::sort(
+			components.begin(),
+			components.end(),
+			[this](int a, int b) {
+
+				return _componentSizes[a] > _componentSizes[b] ||
+						(_componentSizes[a] == _componentSizes[b] && a < b);
+			});
+
+	std::vector<std::vector<Cycle>> componentCycles(components.size());
+
+	parallelFor(
+			components.size(),
+			getNumThreads(_parameters.numThreads),
+			[&](std::size_t i) {
+
+				searchComponent(
+						components[i],
+						cutEdges[components[i]],
+						edgeValues,
+						componentCycles[i]);
+			});
+
+	std::vector<Cycle> cycles;
+	for (std::vector<Cycle>& c : componentCycles)
+		std::move(c.begin(), c.end(), std::back_inserter(cycles));
+
+	sortCycles(cycles);
+
+	if (_parameters.maxCycles > 0 && cycles.size() > _parameters.maxCycles)
+		cycles.resize(_parameters.maxCycles);
+
+	return cycles;
+}
+
+void
+CycleSeparator::buildGraph(const CragSolution& solution) {
+
+	int maxNodeId = -1;
+	int maxEdgeId = -1;
+
+	for (Crag::CragNode n : _crag.nodes())
+		maxNodeId = std::max(maxNodeId, _crag.id(n));
+	for (Crag::CragEdge e : _crag.edges())
+		maxEdgeId = std::max(maxEdgeId, _crag.id(e));
+
+	_edgeU.assign(maxEdgeId + 1, -1);
+	_edgeV.assign(maxEdgeId + 1, -1);
+	_offsets.assign(maxNodeId + 2, 0);
+
+	// count the selected edges of each node
+	for (Crag::CragEdge e : _crag.edges()) {
+
+		int id = _crag.id(e);
+		int u  = _crag.id(_crag.u(e));
+		int v  = _crag.id(_crag.v(e));
+
+		_edgeU[id] = u;
+		_edgeV[id] = v;
+
+		if (solution.selected(e)) {
+
+			_offsets[u + 1]++;
+			_offsets[v + 1]++;
+		}
+	}
+
+	for (std::size_t i = 1; i < _offsets.size(); i++)
+		_offsets[i] += _offsets[i - 1];
+
+	_neighbors.resize(_offsets.back());
+	_neighborEdges.resize(_offsets.back());
+
+	std::vector<std::size_t> next(_offsets.begin(), _offsets.end() - 1);
+
+	for (Crag::CragEdge e : _crag.edges()) {
+
+		if (!solution.selected(e))
+			continue;
+
+		int id = _crag.id(e);
+		int u  = _edgeU[id];
+		int v  = _edgeV[id];
+
+		_neighbors[next[u]]       = v;
+		_neighborEdges[next[u]++] = id;
+		_neighbors[next[v]]       = u;
+		_neighborEdges[next[v]++] = id;
+	}
+}
+
+void
+CycleSeparator::findComponents(const CragSolution& solution) {
+
+	std::size_t numNodes = _offsets.size() - 1;
+
+	std::vector<int> components(numNodes, -1);
+	_positions.assign(numNodes, 0);
+	_componentSizes.clear();
+
+	std::vector<int> queue;
+
+	for (Crag::CragNode n : _crag.nodes()) {
+
+		int start = _crag.id(n);
+
+		if (!solution.selected(n) || components[start] >= 0)
+			continue;
+
+		int component = _componentSizes.size();
+		int size = 0;
+
+		queue.clear();
+		queue.push_back(start);
+		components[start] = component;
+
+		for (std::size_t q = 0; q < queue.size(); q++) {
+
+			int i = queue[q];
+			_positions[i] = size++;
+
+			for (std::size_t j = _offsets[i]; j < _offsets[i + 1]; j++) {
+
+				int k = _neighbors[j];
+				if (components[k] < 0) {
+
+					components[k] = component;
+					queue.push_back(k);
+				}
+			}
+		}
+
+		_componentSizes.push_back(size);
+	}
+
+	// rejected nodes are not part of any component
+	_components.assign(numNodes, -1);
+	for (Crag::CragNode n : _crag.nodes())
+		if (solution.selected(n))
+			_components[_crag.id(n)] = components[_crag.id(n)];
+}
+
+void
+CycleSeparator::searchComponent(
+		int                        component,
+		const std::vector<int>&    componentCutEdges,
+		const std::vector<double>& edgeValues,
+		std::vector<Cycle>&        cycles) const {
+
+	int size = _componentSizes[component];
+
+	// the search state, indexed by the position of a node in its component
+	std::vector<char> visited(size, false);
+	std::vector<int>  predNodes(size);
+	std::vector<int>  predEdges(size);
+	std::vector<int>  numTargets(size, 0);
+
+	std::vector<int> queue;
+	queue.reserve(size);
+
+	// group the cut edges by their first node, to answer all of them with one 
+	// search
+	std::vector<int> cutEdges = componentCutEdges;
+	std::sort(
+			cutEdges.begin(),
+			cutEdges.end(),
+			[this](int a, int b) {
+
+				return _edgeU[a] < _edgeU[b] || (_edgeU[a] == _edgeU[b] && a < b);
+			});
+
+	for (std::size_t begin = 0; begin < cutEdges.size();) {
+
+		int s = _edgeU[cutEdges[begin]];
+
+		std::size_t end = begin;
+		while (end < cutEdges.size() && _edgeU[cutEdges[end]] == s)
+			end++;
+
+		for (std::size_t i = begin; i < end; i++)
+			numTargets[_positions[_edgeV[cutEdges[i]]]]++;
+
+		// breadth-first search from s, until all targets are found
+		int remaining = end - begin;
+
+		queue.clear();
+		queue.push_back(s);
+		visited[_positions[s]] = true;
+
+		for (std::size_t q = 0; q < queue.size() && remaining > 0; q++) {
+
+			int i = queue[q];
+
+			for (std::size_t j = _offsets[i]; j < _offsets[i + 1]; j++) {
+
+				int k = _neighbors[j];
+				int p = _positions[k];
+
+				if (visited[p])
+					continue;
+
+				visited[p]   = true;
+				predNodes[p] = i;
+				predEdges[p] = _neighborEdges[j];
+				remaining   -= numTargets[p];
+				queue.push_back(k);
+			}
+		}
+
+		for (std::size_t i = begin; i < end; i++) {
+
+			int t = _edgeV[cutEdges[i]];
+
+			UTIL_ASSERT(visited[_positions[t]]);
+
+			Cycle cycle;
+			cycle.cutEdge = cutEdges[i];
+
+			for (int cur = t; cur != s; cur = predNodes[_positions[cur]])
+				cycle.path.push_back(predEdges[_positions[cur]]);
+
+			if (edgeValues.empty()) {
+
+				// all path edges are selected, the cut edge is not
+				cycle.violation = 1.0;
+
+			} else {
+
+				double lhs = -edgeValues[cycle.cutEdge];
+				for (int p : cycle.path)
+					lhs += edgeValues[p];
+
+				cycle.violation = lhs - (cycle.path.size() - 1.0);
+			}
+
+			cycles.push_back(std::move(cycle));
+		}
+
+		// reset the search state for the next group
+		for (int k : queue)
+			visited[_positions[k]] = false;
+		for (std::size_t i = begin; i < end; i++)
+			numTargets[_positions[_edgeV[cutEdges[i]]]] = 0;
+
+		begin = end;
+	}
+}
+
+void
+CycleSeparator::sortCycles(std::vector<Cycle>& cycles) const {
+
+	if (_parameters.ordering == Shortest)
+		std::sort(
+				cycles.begin(),
+				cycles.end(),
+				[](const Cycle& a, const Cycle& b) {
+
+					if (a.path.size() != b.path.size())
+						return a.path.size() < b.path.size();
+					if (a.violation != b.violation)
+						return a.violation > b.violation;
+					return a.cutEdge < b.cutEdge;
+				});
+	else
+		std::sort(
+				cycles.begin(),
+				cycles.end(),
+				[](const Cycle& a, const Cycle& b) {
+
+					if (a.violation != b.violation)
+						return a.violation > b.violation;
+					if (a.path.size() != b.path.size())
+						return a.path.size() < b.path.size();
+					return a.cutEdge < b.cutEdge;
+				});
+}
@@ -0,0 +1,130 @@
+#ifndef CANDIDATE_MC_INFERENCE_CYCLE_SEPARATOR_H__
+#define CANDIDATE_MC_INFERENCE_CYCLE_SEPARATOR_H__
+
+#include <vector>
+#include <crag/Crag.h>
+#include "CragSolution.h"
+
+/**
+ * Finds the cycle constraints of the multi-cut polytope violated by a CRAG 
+ * solution. A cycle is violated if an adjacency edge is not selected, but its 
+ * nodes are connected by a path of selected edges.
+ *
+ * The selected edges are copied into a compact adjacency array, in which each 
+ * entry carries the CRAG edge connecting the two nodes. Paths are found with a 
+ * breadth-first search, which gives the shortest path in number of edges. The 
+ * connected components of the selected edges are independent of each other 
+ * and get searched in parallel.
+ */
+class CycleSeparator {
+
+public:
+
+	enum Ordering {
+
+		// report the cycles with the fewest edges first
+		Shortest,
+
+		// report the cycles with the largest violation first
+		MostViolated
+	};
+
+	struct Parameters {
+
+		Parameters() :
+			ordering(Shortest),
+			maxCycles(0),
+			numThreads(1) {}
+
+		// the order in which to report violated cycles
+		Ordering ordering;
+
+		// the maximal number of cycles to report, 0 for all
+		unsigned int maxCycles;
+
+		// the number of threads to use, values smaller than 1 use one thread 
+		// per hardware thread
+		int numThreads;
+	};
+
+	/**
+	 * A violated cycle, consisting of a cut edge and a path of selected edges 
+	 * connecting its nodes. It gives the constraint
+	 *
+	 *   sum_{p in path} x_p - x_cut <= |path| - 1
+	 */
+	struct Cycle {
+
+		// the id of the edge that is not selected
+		int cutEdge;
+
+		// the ids of the selected edges from v(cutEdge) to u(cutEdge)
+		std::vector<int> path;
+
+		// the violation of the constraint by the edge values
+		double violation;
+	};
+
+	CycleSeparator(const Crag& crag, const Parameters& parameters = Parameters());
+
+	/**
+	 * Find violated cycles of the given solution.
+	 *
+	 * @param solution
+	 *              The selected nodes and edges. Cycles are only searched
+	 *              between selected nodes.
+	 * @param edgeValues
+	 *              Optional values of the edge variables by edge id, used to
+	 *              measure the violation of a cycle. If empty, the selection
+	 *              of the edges in the solution is used.
+	 */
+	std::vector<Cycle> findViolatedCycles(
+			const CragSolution&        solution,
+			const std::vector<double>& edgeValues = std::vector<double>());
+
+	/**
+	 * Get the connected component of a node, as found in the last call to 
+	 * findViolatedCycles(). Nodes that are not selected have component -1.
+	 */
+	int getComponent(Crag::CragNode n) const { return _components[_crag.id(n)]; }
+
+private:
+
+	void buildGraph(const CragSolution& solution);
+
+	void findComponents(const CragSolution& solution);
+
+	void searchComponent(
+			int                        component,
+			const std::vector<int>&    cutEdges,
+			const std::vector<double>& edgeValues,
+			std::vector<Cycle>&        cycles) const;
+
+	void sortCycles(std::vector<Cycle>& cycles) const;
+
+	const Crag& _crag;
+
+	Parameters _parameters;
+
+	// the nodes of each edge, by edge id
+	std::vector<int> _edgeU;
+	std::vector<int> _edgeV;
+
+	// the selected edges as adjacency array: the neighbors of node i are 
+	// _neighbors[_offsets[i]] to _neighbors[_offsets[i+1]-1], connected via 
+	// the edge _neighborEdges[j]
+	std::vector<std::size_t> _offsets;
+	std::vector<int>         _neighbors;
+	std::vector<int>         _neighborEdges;
+
+	// the component of each node, and the position of each node within its 
+	// component
+	std::vector<int> _components;
+	std::vector<int> _positions;
+
+	// the size of each component
+	std::vector<int> _componentSizes;
+};
+
+#endif // CANDIDATE_MC_INFERENCE_CYCLE_SEPARATOR_H__
+
@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <util/Logger.h>
+#include "HeuristicMultiCutSolver.h"
+
+logger::LogChannel heuristiclog("heuristiclog", "[HeuristicMultiCutSolver] ");
+
+namespace {
+
+// improvements smaller than this are considered rounding errors
+const double Epsilon = 1e-9;
+
+} // anonymous namespace
+
+HeuristicMultiCutSolver::HeuristicMultiCutSolver(const Crag& crag, const Parameters& parameters) :
+	_crag(crag),
+	_parameters(parameters),
+	_sign(parameters.minimize ? 1 : -1),
+	_value(0) {
+
+	int maxNodeId = -1;
+	int maxEdgeId = -1;
+
+	for (Crag::CragNode n : _crag.nodes())
+		maxNodeId = std::max(maxNodeId, _crag.id(n));
+	for (Crag::CragEdge e : _crag.edges())
+		maxEdgeId = std::max(maxEdgeId, _crag.id(e));
+
+	_nodeCosts.resize(maxNodeId + 1, 0);
+	_edgeCosts.resize(maxEdgeId + 1, 0);
+}
+
+void
+HeuristicMultiCutSolver::setCosts(const Costs& costs) {
+
+	for (Crag::CragNode n : _crag.nodes())
+		_nodeCosts[_crag.id(n)] = costs.node[n];
+
+	for (Crag::CragEdge e : _crag.edges())
+		_edgeCosts[_crag.id(e)] = costs.edge[e];
+}
+
+HeuristicMultiCutSolver::Status
+HeuristicMultiCutSolver::solve(CragSolution& solution) {
+
+	if (_parameters.noConstraints) {
+
+		selectByThreshold(solution);
+		return SolutionFound;
+	}
+
+	// score each candidate with its own costs and an optimistic share of the 
+	// costs of merging it with its neighbors
+
+	std::vector<double> potentials(_nodeCosts.size(), 0);
+
+	for (Crag::CragNode n : _crag.nodes()) {
+
+		double potential = getCost(n);
+		for (Crag::CragEdge e : _crag.adjEdges(n))
+			potential += 0.5*std::min(0.0, getCost(e));
+
+		potentials[_crag.id(n)] = potential;
+	}
+
+	std::vector<bool> takeNode(_nodeCosts.size(), false);
+	std::vector<int>  selected;
+
+	for (Crag::CragNode n : _crag.nodes())
+		if (_crag.isRootNode(n)) {
+
+			selectNodes(n, potentials, takeNode);
+			collectSelected(n, takeNode, selected);
+		}
+
+	// the index of each selected candidate in selected, -1 for rejected 
+	// candidates
+
+	std::vector<int> index(_nodeCosts.size(), -1);
+	for (std::size_t i = 0; i < selected.size(); i++)
+		index[selected[i]] = i;
+
+	std::vector<Edge> edges;
+	for (Crag::CragEdge e : _crag.edges()) {
+
+		int u = index[_crag.id(_crag.u(e))];
+		int v = index[_crag.id(_crag.v(e))];
+
+		if (u < 0 || v < 0)
+			continue;
+
+		Edge edge;
+		edge.u = u;
+		edge.v = v;
+		edge.weight = getCost(e);
+		edges.push_back(edge);
+	}
+
+	std::vector<int> labels = contractEdges(selected.size(), edges);
+
+	std::vector<std::vector<std::pair<int, double>>> neighbors(selected.size());
+	for (const Edge& edge : edges) {
+
+		neighbors[edge.u].push_back(std::make_pair(edge.v, edge.weight));
+		neighbors[edge.v].push_back(std::make_pair(edge.u, edge.weight));
+	}
+
+	Status status = (refine(labels, neighbors) ? SolutionFound : MaxIterationsReached);
+
+	_value = 0;
+	int numMerged = 0;
+
+	for (Crag::CragNode n : _crag.nodes()) {
+
+		bool nodeSelected = (index[_crag.id(n)] >= 0);
+
+		solution.setSelected(n, nodeSelected);
+		if (nodeSelected)
+			_value += _nodeCosts[_crag.id(n)];
+	}
+
+	for (Crag::CragEdge e : _crag.edges()) {
+
+		int u = index[_crag.id(_crag.u(e))];
+		int v = index[_crag.id(_crag.v(e))];
+
+		bool edgeSelected = (u >= 0 && v >= 0 && labels[u] == labels[v]);
+
+		solution.setSelected(e, edgeSelected);
+		if (edgeSelected) {
+
+			_value += _edgeCosts[_crag.id(e)];
+			numMerged++;
+		}
+	}
+
+	LOG_USER(heuristiclog)
+			<< "found solution with value " << _value << ", "
+			<< selected.size() << " candidates selected, "
+			<< numMerged << " adjacent candidates merged"
+			<< std::endl;
+
+	return status;
+}
+
+void
+HeuristicMultiCutSolver::selectByThreshold(CragSolution& solution) {
+
+	_value = 0;
+
+	for (Crag::CragNode n : _crag.nodes()) {
+
+		bool nodeSelected = (getCost(n) < 0);
+
+		solution.setSelected(n, nodeSelected);
+		if (nodeSelected)
+			_value += _nodeCosts[_crag.id(n)];
+	}
+
+	for (Crag::CragEdge e : _crag.edges()) {
+
+		bool edgeSelected = (getCost(e) < 0);
+
+		solution.setSelected(e, edgeSelected);
+		if (edgeSelected)
+			_value += _edgeCosts[_crag.id(e)];
+	}
+}
+
+double
+HeuristicMultiCutSolver::selectNodes(
+		Crag::CragNode             n,
+		const std::vector<double>& potentials,
+		std::vector<bool>&         takeNode) {
+
+	double potential = potentials[_crag.id(n)];
+
+	if (_crag.isLeafNode(n)) {
+
+		// leaf nodes can stay unexplained, unless forceExplanation is set
+		bool take = (_parameters.forceExplanation || potential < 0);
+
+		takeNode[_crag.id(n)] = take;
+		return (take ? potential : 0);
+	}
+
+	// the best choice for the subtrees of the children
+	double children = 0;
+	for (Crag::CragArc a : _crag.inArcs(n))
+		children += selectNodes(a.source(), potentials, takeNode);
+
+	takeNode[_crag.id(n)] = (potential < children);
+
+	return std::min(potential, children);
+}
+
+void
+HeuristicMultiCutSolver::collectSelected(
+		Crag::CragNode           n,
+		const std::vector<bool>& takeNode,
+		std::vector<int>&        selected) {
+
+	if (takeNode[_crag.id(n)]) {
+
+		selected.push_back(_crag.id(n));
+		return;
+	}
+
+	for (Crag::CragArc a : _crag.inArcs(n))
+		collectSelected(a.source(), takeNode, selected);
+}
+
+std::vector<int>
+HeuristicMultiCutSolver::contractEdges(int numNodes, const std::vector<Edge>& edges) {
+
+	// the summed weights between clusters, stored for both directions
+	std::vector<std::unordered_map<int, double>> adjacency(numNodes);
+
+	for (const Edge& edge : edges) {
+
+		adjacency[edge.u][edge.v] += edge.weight;
+		adjacency[edge.v][edge.u] += edge.weight;
+	}
+
+	// candidates for contraction, most negative weight first
+	typedef std::tuple<double, int, int> Contraction;
+	std::priority_queue<Contraction, std::vector<Contraction>, std::greater<Contraction>> queue;
+
+	for (int u = 0; u < numNodes; u++)
+		for (const auto& p : adjacency[u])
+			if (u < p.first && p.second < 0)
+				queue.push(std::make_tuple(p.second, u, p.first));
+
+	std::vector<int> parents(numNodes);
+	std::iota(parents.begin(), parents.end(), 0);
+
+	while (!queue.empty()) {
+
+		double weight;
+		int u, v;
+		std::tie(weight, u, v) = queue.top();
+		queue.pop();
+
+		// skip entries of contracted clusters or changed weights
+		if (parents[u] != u || parents[v] != v)
+			continue;
+
+		auto i = adjacency[u].find(v);
+		if (i == adjacency[u].end() || i->second != weight)
+			continue;
+
+		// merge the cluster with fewer neighbors into the other one
+		if (adjacency[u].size() < adjacency[v].size())
+			std::swap(u, v);
+
+		adjacency[u].erase(v);
+		adjacency[v].erase(u);
+
+		for (const auto& p : adjacency[v]) {
+
+			int w = p.first;
+
+			adjacency[w].erase(v);
+
+			double& merged = adjacency[u][w];
+			merged += p.second;
+			adjacency[w][u] = merged;
+
+			if (merged < 0)
+				queue.push(std::make_tuple(merged, std::min(u, w), std::max(u, w)));
+		}
+
+		adjacency[v].clear();
+		parents[v] = u;
+	}
+
+	std::vector<int> labels(numNodes);
+	for (int i = 0; i < numNodes; i++) {
+
+		int root = i;
+		while (parents[root] != root)
+			root = parents[root];
+
+		labels[i] = root;
+	}
+
+	return labels;
+}
+
+bool
+HeuristicMultiCutSolver::refine(
+		std::vector<int>&                                       labels,
+		const std::vector<std::vector<std::pair<int, double>>>& neighbors) {
+
+	for (int iteration = 0; iteration < _parameters.numIterations; iteration++) {
+
+		// number the clusters consecutively and collect their members
+
+		std::unordered_map<int, int>  clusterIds;
+		std::vector<std::vector<int>> members;
+
+		for (std::size_t v = 0; v < labels.size(); v++) {
+
+			auto i = clusterIds.find(labels[v]);
+			if (i == clusterIds.end()) {
+
+				i = clusterIds.insert(std::make_pair(labels[v], (int)members.size())).first;
+				members.emplace_back();
+			}
+
+			labels[v] = i->second;
+			members[i->second].push_back(v);
+		}
+
+		std::set<std::pair<int, int>> adjacentClusters;
+		for (std::size_t v = 0; v < labels.size(); v++)
+			for (const auto& p : neighbors[v])
+				if (labels[v] < labels[p.first])
+					adjacentClusters.insert(std::make_pair(labels[v], labels[p.first]));
+
+		bool improved = false;
+
+		// move candidates between adjacent clusters, or join them
+		for (const auto& clusters : adjacentClusters)
+			if (improvePair(clusters.first, clusters.second, labels, members, neighbors))
+				improved = true;
+
+		// split clusters, by moving candidates into a new, empty cluster
+		int numClusters = members.size();
+		for (int c = 0; c < numClusters; c++) {
+
+			if (members[c].size() < 2)
+				continue;
+
+			members.emplace_back();
+
+			if (improvePair(c, members.size() - 1, labels, members, neighbors))
+				improved = true;
+
+			if (members.back().empty())
+				members.pop_back();
+		}
+
+		LOG_DEBUG(heuristiclog)
+				<< "refinement iteration " << iteration
+				<< ": " << members.size() << " clusters"
+				<< std::endl;
+
+		if (!improved)
+			return true;
+	}
+
+	return false;
+}
+
+bool
+HeuristicMultiCutSolver::improvePair(
+		int                                                     a,
+		int                                                     b,
+		std::vector<int>&                                       labels,
+		std::vector<std::vector<int>>&                          members,
+		const std::vector<std::vector<std::pair<int, double>>>& neighbors) {
+
+	std::vector<int> nodes = members[a];
+	nodes.insert(nodes.end(), members[b].begin(), members[b].end());
+
+	if (nodes.empty())
+		return false;
+
+	// the change of the objective when moving a node to the other cluster, and 
+	// the change when joining both clusters
+	std::unordered_map<int, double> gains;
+	double joinGain = 0;
+
+	typedef std::pair<double, int> Move;
+	std::priority_queue<Move, std::vector<Move>, std::greater<Move>> queue;
+
+	for (int v : nodes) {
+
+		int own   = labels[v];
+		int other = (own == a ? b : a);
+
+		double gain = 0;
+		for (const auto& p : neighbors[v]) {
+
+			if (labels[p.first] == own)
+				gain -= p.second;
+			else if (labels[p.first] == other)
+				gain += p.second;
+
+			if (own == a && labels[p.first] == b)
+				joinGain += p.second;
+		}
+
+		gains[v] = gain;
+		queue.push(Move(gain, v));
+	}
+
+	// Kernighan-Lin: move each node once, always the one with the best gain, 
+	// and remember the best sequence of moves
+
+	std::unordered_set<int> moved;
+	std::vector<int>        moves;
+
+	double sum  = 0;
+	double best = 0;
+	std::size_t bestNumMoves = 0;
+
+	while (!queue.empty()) {
+
+		double gain = queue.top().first;
+		int v       = queue.top().second;
+		queue.pop();
+
+		if (moved.count(v) || gain != gains[v])
+			continue;
+
+		int from = labels[v];
+		int to   = (from == a ? b : a);
+
+		labels[v] = to;
+		moved.insert(v);
+		moves.push_back(v);
+
+		sum += gain;
+		if (sum < best - Epsilon) {
+
+			best = sum;
+			bestNumMoves = moves.size();
+		}
+
+		for (const auto& p : neighbors[v]) {
+
+			int u = p.first;
+
+			if (moved.count(u) || (labels[u] != a && labels[u] != b))
+				continue;
+
+			if (labels[u] == from)
+				gains[u] += 2*p.second;
+			else
+				gains[u] -= 2*p.second;
+
+			queue.push(Move(gains[u], u));
+		}
+	}
+
+	bool join = (joinGain < best - Epsilon);
+
+	// undo the moves after the best sequence, or all of them if joining is 
+	// better
+	std::size_t numKept = (join ? 0 : bestNumMoves);
+	for (std::size_t i = moves.size(); i > numKept; i--) {
+
+		int v = moves[i - 1];
+		labels[v] = (labels[v] == a ? b : a);
+	}
+
+	if (join)
+		for (int v : members[b])
+			labels[v] = a;
+
+	if (!join && bestNumMoves == 0)
+		return false;
+
+	members[a].clear();
+	members[b].clear();
+	for (int v : nodes)
+		members[labels[v]].push_back(v);
+
+	return true;
+}
@@ -0,0 +1,90 @@
+#ifndef CANDIDATE_MC_INFERENCE_HEURISTIC_MULTI_CUT_SOLVER_H__
+#define CANDIDATE_MC_INFERENCE_HEURISTIC_MULTI_CUT_SOLVER_H__
+
+#include <vector>
+#include <crag/Crag.h>
+#include "Costs.h"
+#include "CragSolver.h"
+
+/**
+ * An approximate solver for the same problem as MultiCutSolver, that does not 
+ * need an ILP solver.
+ *
+ * First, the candidates are selected by dynamic programming over the subset 
+ * tree, such that at most one candidate is selected on each root-to-leaf path 
+ * (exactly one, if forceExplanation is set). Each candidate is scored with its 
+ * own costs and half of the negative costs of its adjacency edges. Then, the 
+ * selected candidates are clustered with greedy additive edge contraction, 
+ * and the clustering is refined with Kernighan-Lin moves between pairs of 
+ * adjacent clusters. Only edges between selected candidates in the same 
+ * cluster are selected, which satisfies the rejection and cycle constraints.
+ *
+ * The force parent constraints of MultiCutSolver are not considered.
+ */
+class HeuristicMultiCutSolver : public CragSolver {
+
+public:
+
+	HeuristicMultiCutSolver(const Crag& crag, const Parameters& parameters = Parameters());
+
+	/**
+	 * Set the costs (or reward, if negative) of accepting a node or an edge.
+	 */
+	void setCosts(const Costs& costs) override;
+
+	Status solve(CragSolution& solution) override;
+
+	/**
+	 * Get the value of the current solution.
+	 */
+	double getValue() override { return _value; }
+
+private:
+
+	// an edge between two selected candidates, identified by their index in 
+	// the list of selected candidates
+	struct Edge {
+
+		int u;
+		int v;
+		double weight;
+	};
+
+	void selectByThreshold(CragSolution& solution);
+
+	double selectNodes(Crag::CragNode n, const std::vector<double>& potentials, std::vector<bool>& takeNode);
+
+	void collectSelected(Crag::CragNode n, const std::vector<bool>& takeNode, std::vector<int>& selected);
+
+	std::vector<int> contractEdges(int numNodes, const std::vector<Edge>& edges);
+
+	bool refine(
+			std::vector<int>&                                       labels,
+			const std::vector<std::vector<std::pair<int, double>>>& neighbors);
+
+	bool improvePair(
+			int                                                     a,
+			int                                                     b,
+			std::vector<int>&                                       labels,
+			std::vector<std::vector<int>>&                          members,
+			const std::vector<std::vector<std::pair<int, double>>>& neighbors);
+
+	double getCost(Crag::CragNode n) const { return _sign*_nodeCosts[_crag.id(n)]; }
+	double getCost(Crag::CragEdge e) const { return _sign*_edgeCosts[_crag.id(e)]; }
+
+	const Crag& _crag;
+
+	Parameters _parameters;
+
+	// 1 for minimization, -1 for maximization
+	double _sign;
+
+	// the costs by node and edge id
+	std::vector<double> _nodeCosts;
+	std::vector<double> _edgeCosts;
+
+	double _value;
+};
+
+#endif // CANDIDATE_MC_INFERENCE_HEURISTIC_MULTI_CUT_SOLVER_H__
+
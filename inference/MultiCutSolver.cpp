@@ -1,6 +1,4 @@
 #include <boost/filesystem.hpp>
-#include <lemon/dijkstra.h>
-#include <lemon/connectivity.h>
 #include <solver/SolverFactory.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
@@ -24,18 +22,57 @@ util::ProgramOption optionDismissPositiveCosts(
 		util::_description_text = "If set, the costs of non-leaf nodes and non-leaf edges that are positive "
 								  "will be set to inf.");
 
+util::ProgramOption optionCycleOrder(
+		util::_module           = "multicut",
+		util::_long_name        = "cycleOrder",
+		util::_description_text = "The order in which violated cycle constraints are added, if their number is limited "
+		                          "per iteration: 'shortest' for the cycles with the fewest edges first, 'mostViolated' "
+		                          "for the cycles with the largest violation by the current solution first.",
+		util::_default_value    = "shortest");
+
+util::ProgramOption optionNumSeparationThreads(
+		util::_module           = "multicut",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to use to search for violated cycle constraints. Set to 0 to use "
+		                          "one thread per hardware thread. The constraints found do not depend on this value.",
+		util::_default_value    = 1);
+
+util::ProgramOption optionHeuristicWarmStart(
+		util::_module           = "multicut",
+		util::_long_name        = "heuristicWarmStart",
+		util::_description_text = "Start the ILP solver from the solution found by greedy edge contraction and "
+		                          "Kernighan-Lin refinement.");
+
 MultiCutSolver::MultiCutSolver(const Crag& crag, const Parameters& parameters) :
 	_crag(crag),
 	_numNodes(0),
 	_numEdges(0),
 	_solver(0),
+	_heuristic(0),
+	_numSolverConstraints(0),
+	_resetSolverConstraints(true),
 	_parameters(parameters),
-	_numPositiveCostPinConstraints(0),
 	_labels(crag) {
 
 	_numNodes = _crag.nodes().size();
 	_numEdges = _crag.edges().size();
 
+	if (optionCycleOrder.as<std::string>() == "shortest")
+		_cycleSeparatorParameters.ordering = CycleSeparator::Shortest;
+	else if (optionCycleOrder.as<std::string>() == "mostViolated")
+		_cycleSeparatorParameters.ordering = CycleSeparator::MostViolated;
+	else
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"unknown cycle order " << optionCycleOrder.as<std::string>());
+
+	if (_parameters.maxConstraintsPerIteration > 0)
+		_cycleSeparatorParameters.maxCycles = _parameters.maxConstraintsPerIteration;
+	_cycleSeparatorParameters.numThreads = optionNumSeparationThreads.as<int>();
+
+	if (optionHeuristicWarmStart)
+		_heuristic = new HeuristicMultiCutSolver(crag, parameters);
+
 	SolverFactory factory;
 	_solver = factory.createLinearSolverBackend();
 
@@ -49,11 +86,17 @@ MultiCutSolver::~MultiCutSolver() {
 
 	if (_solver)
 		delete _solver;
+
+	if (_heuristic)
+		delete _heuristic;
 }
 
 void
 MultiCutSolver::setCosts(const Costs& costs) {
 
+	if (_heuristic)
+		_heuristic->setCosts(costs);
+
 	for (Crag::CragNode n : _crag.nodes())
 		_objective.setCoefficient(
 				nodeIdToVar(_crag.id(n)),
@@ -66,47 +109,86 @@ MultiCutSolver::setCosts(const Costs& costs) {
 
 	if (optionDismissPositiveCosts) {
 
-		if (_numPositiveCostPinConstraints > 0) {
-
-			LOG_USER(multicutlog) << "setting new costs invalidates previous pin constraints, resetting all constraints" << std::endl;
-
-			_constraints.clear();
-			_numPositiveCostPinConstraints = 0;
-			setInitialConstraints();
-		}
+		// the variables to pin to 0 for the new costs
+		std::vector<unsigned int> pinnedVariables;
 
 		for (Crag::CragNode n : _crag.nodes())
 			if (!_crag.isLeafNode(n)) {
 
 				int var = nodeIdToVar(_crag.id(n));
-				if (_objective.getCoefficients()[var] > 0) {
-
-					LinearConstraint pin;
-					pin.setCoefficient(var, 1.0);
-					pin.setRelation(Equal);
-					pin.setValue(0.0);
-
-					_constraints.add(pin);
-					_numPositiveCostPinConstraints++;
-				}
+				if (_objective.getCoefficients()[var] > 0)
+					pinnedVariables.push_back(var);
 			}
 
 		for (Crag::CragEdge e : _crag.edges())
 			if (!_crag.isLeafEdge(e)) {
 
 				int var = edgeIdToVar(_crag.id(e));
-				if (_objective.getCoefficients()[var] > 0) {
+				if (_objective.getCoefficients()[var] > 0)
+					pinnedVariables.push_back(var);
+			}
 
-					LinearConstraint pin;
-					pin.setCoefficient(var, 1.0);
-					pin.setRelation(Equal);
-					pin.setValue(0.0);
+		if (pinnedVariables != _pinnedVariables) {
 
-					_constraints.add(pin);
-					_numPositiveCostPinConstraints++;
-				}
-			}
+			LOG_USER(multicutlog) << "new costs change the pin constraints, resetting solver constraints" << std::endl;
+
+			_pinnedVariables = pinnedVariables;
+			updatePinConstraints();
+		}
+	}
+}
+
+void
+MultiCutSolver::fixVariable(unsigned int var, bool selected) {
+
+	auto i = _fixedVariables.find(var);
+	if (i != _fixedVariables.end() && i->second == selected)
+		return;
+
+	_fixedVariables[var] = selected;
+	updatePinConstraints();
+}
+
+void
+MultiCutSolver::releaseVariable(unsigned int var) {
+
+	if (_fixedVariables.erase(var) == 0)
+		return;
+
+	updatePinConstraints();
+}
+
+void
+MultiCutSolver::updatePinConstraints() {
+
+	_pinConstraints.clear();
+
+	for (unsigned int var : _pinnedVariables) {
+
+		if (_fixedVariables.count(var))
+			continue;
+
+		LinearConstraint pin;
+		pin.setCoefficient(var, 1.0);
+		pin.setRelation(Equal);
+		pin.setValue(0.0);
+
+		_pinConstraints.add(pin);
+	}
+
+	for (const auto& p : _fixedVariables) {
+
+		LinearConstraint pin;
+		pin.setCoefficient(p.first, 1.0);
+		pin.setRelation(Equal);
+		pin.setValue(p.second ? 1.0 : 0.0);
+
+		_pinConstraints.add(pin);
 	}
+
+	// the cycle constraints found so far stay valid, only the pin constraints 
+	// have to be replaced
+	_resetSolverConstraints = true;
 }
 
 MultiCutSolver::Status
@@ -114,6 +196,9 @@ MultiCutSolver::solve(CragSolution& solution) {
 
 	_solver->setObjective(_objective);
 
+	if (_heuristic)
+		setHeuristicSolution();
+
 	for (unsigned int i = 0; i < _parameters.numIterations; i++) {
 
 		LOG_USER(multicutlog)
@@ -359,13 +444,61 @@ MultiCutSolver::collectTreePathConstraints(Crag::CragNode n, std::vector<int>& p
 	return numConstraintsAdded;
 }
 
+void
+MultiCutSolver::setHeuristicSolution() {
+
+	CragSolution heuristicSolution(_crag);
+	_heuristic->solve(heuristicSolution);
+
+	// after new costs were set, the solution of the previous solve is a start 
+	// as well, keep it if it is at least as good for the new costs
+	if (_solution.size() == _numNodes + _numEdges) {
+
+		double previousValue = _objective.getConstant();
+		for (unsigned int i = 0; i < _solution.size(); i++)
+			if (_solution[i] > 0.5)
+				previousValue += _objective.getCoefficients()[i];
+
+		if (_parameters.minimize ?
+				previousValue <= _heuristic->getValue() :
+				previousValue >= _heuristic->getValue()) {
+
+			_solution.setValue(previousValue);
+
+			LOG_USER(multicutlog)
+					<< "starting from previous solution with value "
+					<< previousValue << std::endl;
+
+			return;
+		}
+	}
+
+	_solution.resize(_numNodes + _numEdges);
+
+	for (Crag::CragNode n : _crag.nodes())
+		_solution[nodeIdToVar(_crag.id(n))] = heuristicSolution.selected(n);
+	for (Crag::CragEdge e : _crag.edges())
+		_solution[edgeIdToVar(_crag.id(e))] = heuristicSolution.selected(e);
+
+	_solution.setValue(_heuristic->getValue());
+
+	LOG_USER(multicutlog)
+			<< "starting from heuristic solution with value "
+			<< _heuristic->getValue() << std::endl;
+}
+
 void
 MultiCutSolver::findCut(CragSolution& solution) {
 
 	LOG_USER(multicutlog) << "searching for cut..." << std::endl;
 
-	// re-set constraints to inform solver about potential changes
-	_solver->setConstraints(_constraints);
+	updateSolverConstraints();
+
+	// the previous solution is a good start, even if it violates some of the 
+	// new constraints
+	if (_solution.size() > 0)
+		_solver->setInitialSolution(_solution);
+
 	std::string msg;
 	if (!_solver->solve(_solution, msg)) {
 
@@ -404,166 +537,115 @@ MultiCutSolver::findCut(CragSolution& solution) {
 	}
 }
 
-bool
-MultiCutSolver::findViolatedConstraints(CragSolution& solution) {
+void
+MultiCutSolver::updateSolverConstraints() {
 
-    int treePathConstraintAdded =0;
-    int constraintsAdded = 0;
+	if (_resetSolverConstraints) {
 
-	if (_parameters.noConstraints)
-		return false;
+		if (_pinConstraints.size() > 0) {
 
+			LinearConstraints constraints = _constraints;
+			constraints.addAll(_pinConstraints);
+			_solver->setConstraints(constraints);
 
+		} else {
 
+			_solver->setConstraints(_constraints);
+		}
 
-	// Given the large number of adjacency edges, and that only a small subset 
-	// of them gets selected, it might be more efficient to create a new graph, 
-	// here, consisting only of the selected adjacency edges.
+		_resetSolverConstraints = false;
 
-	typedef lemon::ListGraph Cut;
-	Cut cutGraph;
-	for (unsigned int i = 0; i < _numNodes; i++)
-		cutGraph.addNode();
+	} else {
 
-	for (Crag::CragEdge e : _crag.edges())
-		if (solution.selected(e))
-			cutGraph.addEdge(_crag.u(e), _crag.v(e));
-
-	// find connected components in cut graph
-	lemon::connectedComponents(cutGraph, _labels);
-
-    if(optionLazyTreePathConstraints.as<bool>()){
-        for(auto & c : _allTreePathConstraints){
-            if(c.isViolated(_solution)){
-                _constraints.add(c);
-                ++treePathConstraintAdded;
-            }
-        }
-    }
+		// pass only the constraints found since the last solve
+		LOG_DEBUG(multicutlog)
+				<< "adding " << (_constraints.size() - _numSolverConstraints)
+				<< " new constraints to solver" << std::endl;
 
-	// label rejected nodes with -1
-	for (Crag::CragNode n : _crag.nodes())
-		if (!solution.selected(n))
-			_labels[n] = -1;
+		_solver->addConstraints(_constraints, _numSolverConstraints);
+	}
 
-	// for each not selected edge with nodes in the same connected component, 
-	// find the shortest path along connected nodes connecting them
-	for (Crag::CragEdge e : _crag.edges()) {
+	_numSolverConstraints = _constraints.size();
+}
 
-		// not selected
-		if (solution.selected(e))
-			continue;
+bool
+MultiCutSolver::findViolatedConstraints(CragSolution& solution) {
 
-		Crag::CragNode s = e.u();
-		Crag::CragNode t = e.v();
+	int treePathConstraintAdded =0;
+	int constraintsAdded = 0;
 
-		// in same component
-		if (_labels[s] != _labels[t] || !solution.selected(s))
-			continue;
+	if (_parameters.noConstraints)
+		return false;
 
-		LOG_ALL(multicutlog)
-				<< "nodes " << _crag.id(s)
-				<< " and " << _crag.id(t)
-				<< " (edge " << edgeIdToVar(_crag.id(e))
-				<< ") are cut, but in same component"
-				<< std::endl;
+	if(optionLazyTreePathConstraints.as<bool>()){
+		for(auto & c : _allTreePathConstraints){
+			if(c.isViolated(_solution)){
+				_constraints.add(c);
+				++treePathConstraintAdded;
+			}
+		}
+	}
 
-		// setup Dijkstra
-		One one;
-		lemon::Dijkstra<Cut, One> dijkstra(cutGraph, one);
+	// the values of the edge variables, to rank cycles by their violation
+	std::vector<double> edgeValues;
+	if (_cycleSeparatorParameters.ordering == CycleSeparator::MostViolated) {
 
-		// e = (s, t) was not selected -> there should be no path connecting s 
-		// and t
-		if (!dijkstra.run(s, t))
-			LOG_ERROR(multicutlog)
-					<< "dijkstra could not find a path!"
-					<< std::endl;
+		for (Crag::CragEdge e : _crag.edges()) {
 
-		LOG_ALL(multicutlog)
-				<< "nodes " << _crag.id(s)
-				<< " and " << _crag.id(t)
-				<< " are in same component "
-				<< _labels[_crag.v(e)]
-				<< std::endl;
+			unsigned int id = _crag.id(e);
+			if (id >= edgeValues.size())
+				edgeValues.resize(id + 1, 0);
+			edgeValues[id] = _solution[edgeIdToVar(id)];
+		}
+	}
 
-		LinearConstraint cycleConstraint;
+	// for each not selected edge with nodes in the same connected component, 
+	// find the shortest path along connected nodes connecting them
+	CycleSeparator separator(_crag, _cycleSeparatorParameters);
+	std::vector<CycleSeparator::Cycle> cycles = separator.findViolatedCycles(solution, edgeValues);
+
+	for (Crag::CragNode n : _crag.nodes())
+		_labels[n] = separator.getComponent(n);
+
+	for (const CycleSeparator::Cycle& cycle : cycles) {
 
-		int lenPath = 0;
+		LinearConstraint cycleConstraint;
 
-		// walk along the path between u and v
-		Crag::CragNode cur = t;
 		LOG_ALL(multicutlog)
-				<< "nodes " << _crag.id(s)
-				<< " and " << _crag.id(t)
-				<< " (edge " << edgeIdToVar(_crag.id(e)) << ")"
-				<< " are connected via path ";
-		while (cur != s) {
-
-			LOG_ALL(multicutlog)
-					<< _crag.id(cur)
-					<< " ";
-
-			Crag::Node pre(dijkstra.predNode(cur));
-
-			// here we have to iterate over all adjacent edges in order to 
-			// find (cur, pre) in CRAG, since there is no 1:1 mapping 
-			// between edges in cutGraph and _crag
-			Crag::CragIncEdgeIterator pathEdge = _crag.adjEdges(cur).begin();
-			for (; pathEdge != _crag.adjEdges(cur).end(); ++pathEdge)
-				if ((*pathEdge).opposite(cur) == pre)
-					break;
-
-			if (pathEdge == _crag.adjEdges(cur).end())
-				UTIL_THROW_EXCEPTION(
-						Exception,
-						"could not find path edge in CRAG");
-
-			if (!solution.selected(*pathEdge))
-				LOG_ERROR(multicutlog)
-						<< "edge " << edgeIdToVar(_crag.id(*pathEdge))
-						<< " is not selected, but found by dijkstra"
-						<< std::endl;
-				//UTIL_THROW_EXCEPTION(
-						//Exception,
-						//"edge " << edgeIdToVar(_crag.id(pathEdge)) << " is not selected, but found by dijkstra");
+				<< "edge " << edgeIdToVar(cycle.cutEdge)
+				<< " is cut, but its nodes are connected via edges ";
+
+		for (int pathEdge : cycle.path) {
 
 			cycleConstraint.setCoefficient(
-					edgeIdToVar(_crag.id(*pathEdge)),
+					edgeIdToVar(pathEdge),
 					1.0);
-			LOG_ALL(multicutlog)
-					<< "(edge " << edgeIdToVar(_crag.id(*pathEdge)) << ") ";
-
-			lenPath++;
-			cur = pre;
+			LOG_ALL(multicutlog) << edgeIdToVar(pathEdge) << " ";
 		}
-		LOG_ALL(multicutlog) << _crag.id(s) << std::endl;
+		LOG_ALL(multicutlog) << std::endl;
 
 		cycleConstraint.setCoefficient(
-				edgeIdToVar(_crag.id(e)),
+				edgeIdToVar(cycle.cutEdge),
 				-1.0);
 		cycleConstraint.setRelation(LessEqual);
-		cycleConstraint.setValue(lenPath - 1);
+		cycleConstraint.setValue(cycle.path.size() - 1.0);
 
 		LOG_ALL(multicutlog) << cycleConstraint << std::endl;
 
 		_constraints.add(cycleConstraint);
 
 		constraintsAdded++;
-
-		if (_parameters.maxConstraintsPerIteration > 0 &&
-			constraintsAdded >= _parameters.maxConstraintsPerIteration)
-			break;
 	}
 
 	LOG_USER(multicutlog)
 			<< "added " << constraintsAdded
 			<< " cycle constraints" << std::endl;
 
-    if(optionLazyTreePathConstraints.as<bool>()){
-    LOG_USER(multicutlog)
-            << "added " << treePathConstraintAdded
-            << " tree path  constraints" << std::endl;
-    }
+	if(optionLazyTreePathConstraints.as<bool>()){
+	LOG_USER(multicutlog)
+			<< "added " << treePathConstraintAdded
+			<< " tree path  constraints" << std::endl;
+	}
 
 	// propagate node labels to subsets
 	for (Crag::CragNode n : _crag.nodes())
@@ -7,6 +7,8 @@
 #include <vigra/tinyvector.hxx>
 #include "Costs.h"
 #include "CragSolver.h"
+#include "CycleSeparator.h"
+#include "HeuristicMultiCutSolver.h"
 
 class MultiCutSolver : public CragSolver {
 
@@ -28,17 +30,28 @@ public:
 	 */
 	double getValue() override { return _solution.getValue(); }
 
-private:
+	/**
+	 * Fix a node or an edge to be selected or not in subsequent solves, e.g., 
+	 * to enforce user constraints. Fixing an edge to be selected forces its 
+	 * nodes to be merged, fixing it to be not selected separates them. The 
+	 * constraints found so far and the current solution are kept.
+	 */
+	void fix(Crag::CragNode n, bool selected) { fixVariable(nodeIdToVar(_crag.id(n)), selected); }
+	void fix(Crag::CragEdge e, bool selected) { fixVariable(edgeIdToVar(_crag.id(e)), selected); }
 
-	// a property map returning 1 for every entry
-	struct One {
+	/**
+	 * Undo fix() for a node or an edge.
+	 */
+	void release(Crag::CragNode n) { releaseVariable(nodeIdToVar(_crag.id(n))); }
+	void release(Crag::CragEdge e) { releaseVariable(edgeIdToVar(_crag.id(e))); }
+
+private:
 
-		typedef int Value;
+	void fixVariable(unsigned int var, bool selected);
 
-		template <typename T>
-		int operator[](const T&) const { return 1; }
+	void releaseVariable(unsigned int var);
 
-	};
+	void updatePinConstraints();
 
 	void prepareSolver();
 
@@ -48,10 +61,14 @@ private:
 
 	int collectTreePathConstraints(Crag::CragNode n, std::vector<int>& pathIds);
 
+	void setHeuristicSolution();
+
 	void findCut(CragSolution& solution);
 
 	bool findViolatedConstraints(CragSolution& solution);
 
+	void updateSolverConstraints();
+
 	void propagateLabel(Crag::CragNode n, int label);
 
 	inline unsigned int nodeIdToVar(int nodeId) { return nodeId; }
@@ -68,11 +85,31 @@ private:
 	LinearSolverBackend* _solver;
 	Solution             _solution;
 
+	// finds the initial solution for the ILP solver, if requested
+	HeuristicMultiCutSolver* _heuristic;
+
+	// the number of constraints in _constraints that have been passed to the 
+	// solver already, and whether the solver's constraints have to be 
+	// replaced since _constraints changed otherwise
+	unsigned int _numSolverConstraints;
+	bool         _resetSolverConstraints;
+
 	Parameters _parameters;
 
+	CycleSeparator::Parameters _cycleSeparatorParameters;
+
     std::vector<LinearConstraint> _allTreePathConstraints;
 
-	int _numPositiveCostPinConstraints;
+	// variables of non-leaf nodes and edges with positive costs that are 
+	// pinned to 0 (if optionDismissPositiveCosts is set), and the constraints 
+	// to do so, kept apart from _constraints such that new costs do not 
+	// discard the cycle constraints found so far
+	std::vector<unsigned int> _pinnedVariables;
+	LinearConstraints         _pinConstraints;
+
+	// variables fixed by the user via fix(), their pin constraints are part 
+	// of _pinConstraints as well and take precedence over _pinnedVariables
+	std::map<unsigned int, bool> _fixedVariables;
 
 	Crag::NodeMap<int> _labels;
 };
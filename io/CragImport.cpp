@@ -1,3 +1,4 @@
+#include <cmath>
 #include <fstream>
 #include <limits>
 #include <vigra/impex.hxx>
@@ -5,6 +6,7 @@
 #include <util/ProgramOptions.h>
 #include <crag/MergeTreeParser.h>
 #include "CragImport.h"
+#include "VolumeSlabReader.h"
 
 util::ProgramOption optionMaxMerges(
 		util::_long_name        = "maxMerges",
@@ -32,6 +34,14 @@ util::ProgramOption option2dSupervoxels(
 		                          "a CRAG with SliceNodes instead of VolumeNodes. SliceNodes have more features that only apply "
 		                          "to 2D objects.");
 
+util::ProgramOption optionImportBlockDepth(
+		util::_long_name        = "importBlockDepth",
+		util::_description_text = "Read the supervoxel volume of a merge history in slabs of this many sections, "
+		                          "instead of all at once. Leaf candidates are stored as run-length encoded masks "
+		                          "and their adjacencies are found during the import, such that the memory needed "
+		                          "does not depend on the size of the supervoxel volume.",
+		util::_default_value    = 0);
+
 void
 CragImport::readCrag(
 		std::string           filename,
@@ -40,6 +50,8 @@ CragImport::readCrag(
 		util::point<float, 3> resolution,
 		util::point<float, 3> offset) {
 
+	_adjacencyAnnotator.reset();
+
 	int maxMerges = -1;
 	if (optionMaxMerges)
 		maxMerges = optionMaxMerges;
@@ -73,14 +85,34 @@ CragImport::readCragFromMergeHistory(
 		Costs&                     mergeCosts,
 		Crag::NodeMap<int>&        nodeToId) {
 
-	ExplicitVolume<int> ids;
-	readVolumeFromOption(ids, supervoxels);
+	_adjacencyAnnotator.reset();
 
-	bool is2D = false;
-	if (ids.depth() == 1 || option2dSupervoxels)
-		is2D = true;
+	std::map<int, Crag::Node> idToNode;
+
+	if (optionImportBlockDepth.as<int>() > 0) {
+
+		std::shared_ptr<BlockwiseAdjacencyAnnotator> annotator = std::make_shared<BlockwiseAdjacencyAnnotator>();
+
+		idToNode = readSupervoxels(
+				supervoxels,
+				crag,
+				volumes,
+				resolution,
+				offset,
+				optionImportBlockDepth.as<int>(),
+				annotator.get());
+
+		_adjacencyAnnotator = annotator;
+
+	} else {
+
+		ExplicitVolume<int> ids;
+		readVolumeFromOption(ids, supervoxels);
+
+		idToNode = readSupervoxels(ids, crag, volumes, resolution, offset);
+	}
 
-	std::map<int, Crag::Node> idToNode = readSupervoxels(ids, crag, volumes, resolution, offset);
+	bool is2D = (idToNode.empty() || crag.type(idToNode.begin()->second) == Crag::SliceNode);
 
 	// get the highest id
 	int maxId = -1;
@@ -201,12 +233,13 @@ CragImport::readCragFromMergeHistory(
 
 		for (Crag::CragNode n : crag.nodes()) {
 
-			const CragVolume& volume = *volumes[n];
+			// don't materialize the volumes, the bounding box is enough
+			long depth = std::lround(volumes.getBoundingBox(n).depth()/resolution.z());
 
-			if (volume.depth() != 1)
+			if (depth != 1)
 				UTIL_THROW_EXCEPTION(
 						UsageError,
-						"option '2dSupervoxels' was given, but after import, CRAG contains a node with depth " << volume.depth() << ". Check if the initial supervoxels are really 2D, and that the merge history only merges in 2D.");
+						"option '2dSupervoxels' was given, but after import, CRAG contains a node with depth " << depth << ". Check if the initial supervoxels are really 2D, and that the merge history only merges in 2D.");
 		}
 	}
 
@@ -222,6 +255,8 @@ CragImport::readCragFromCandidateSegmentation(
 		util::point<float, 3> resolution,
 		util::point<float, 3> offset) {
 
+	_adjacencyAnnotator.reset();
+
 	ExplicitVolume<int> ids;
 	readVolumeFromOption(ids, supervoxels);
 
@@ -359,3 +394,112 @@ CragImport::readSupervoxels(
 	return idToNode;
 }
 
+std::map<int, Crag::Node>
+CragImport::readSupervoxels(
+		std::string                  supervoxels,
+		Crag&                        crag,
+		CragVolumes&                 volumes,
+		util::point<float, 3>        resolution,
+		util::point<float, 3>        offset,
+		unsigned int                 slabDepth,
+		BlockwiseAdjacencyAnnotator* annotator) {
+
+	VolumeSlabReader<int> reader(supervoxels, slabDepth);
+
+	bool is2D = false;
+	if (reader.shape()[2] == 1 || option2dSupervoxels)
+		is2D = true;
+
+	// the runs of each supervoxel in global coordinates, in scanline order
+	struct Supervoxel {
+
+		util::box<int, 3>                      bb;
+		std::vector<SparseCragVolume::LineRun> runs;
+	};
+	std::map<int, Supervoxel> supervoxelRuns;
+
+	vigra::MultiArray<3, int> slab;
+	unsigned int firstSection;
+
+	while (reader.next(slab, firstSection)) {
+
+		LOG_USER(logger::out)
+				<< "reading supervoxels in sections " << firstSection
+				<< " to " << firstSection + slab.shape(2) - 1 << std::endl;
+
+		int         lastId = 0;
+		Supervoxel* lastSupervoxel = 0;
+
+		for (unsigned int z = 0; z < slab.shape(2); z++)
+		for (unsigned int y = 0; y < slab.shape(1); y++) {
+
+			unsigned int x = 0;
+			while (x < slab.shape(0)) {
+
+				int id = slab(x, y, z);
+				unsigned int begin = x;
+
+				while (x < slab.shape(0) && slab(x, y, z) == id)
+					x++;
+
+				if (id == 0)
+					continue;
+
+				if (!lastSupervoxel || id != lastId) {
+
+					lastId = id;
+					lastSupervoxel = &supervoxelRuns[id];
+				}
+
+				unsigned int section = firstSection + z;
+
+				lastSupervoxel->bb.fit(
+						util::box<int, 3>(
+								begin, y,   section,
+								x,     y+1, section+1));
+				lastSupervoxel->runs.push_back(
+						SparseCragVolume::LineRun(y, section, SparseCragVolume::Run(begin, x)));
+			}
+		}
+
+		if (annotator)
+			annotator->addSlab(slab, firstSection);
+	}
+
+	LOG_USER(logger::out) << "found " << supervoxelRuns.size() << " supervoxels" << std::endl;
+	LOG_USER(logger::out) << "allocating candidates..." << std::endl;
+
+	std::map<int, Crag::Node> idToNode;
+	for (auto& p : supervoxelRuns) {
+
+		const int&               id = p.first;
+		const util::box<int, 3>& bb = p.second.bb;
+
+		// make the runs relative to the bounding box
+		std::vector<SparseCragVolume::LineRun>& runs = p.second.runs;
+		for (SparseCragVolume::LineRun& lineRun : runs) {
+
+			lineRun.y         -= bb.min().y();
+			lineRun.z         -= bb.min().z();
+			lineRun.run.begin -= bb.min().x();
+			lineRun.run.end   -= bb.min().x();
+		}
+
+		Crag::Node n = crag.addNode(is2D ? Crag::SliceNode : Crag::VolumeNode);
+		std::shared_ptr<SparseCragVolume> volume = std::make_shared<SparseCragVolume>(bb.width(), bb.height(), bb.depth(), runs);
+		volume->setResolution(resolution);
+		volume->setOffset(offset + bb.min()*resolution);
+		volumes.setVolume(n, volume);
+		idToNode[id] = n;
+
+		// not needed anymore
+		std::vector<SparseCragVolume::LineRun>().swap(runs);
+	}
+
+	if (annotator)
+		annotator->setLabelNodes(idToNode);
+
+	LOG_USER(logger::out) << "supervoxels parsed" << std::endl;
+
+	return idToNode;
+}
@@ -2,6 +2,8 @@
 #define CANDIDATE_MC_IO_CRAG_IMPORT_H__
 
 #include <map>
+#include <memory>
+#include <crag/BlockwiseAdjacencyAnnotator.h>
 #include <crag/Crag.h>
 #include <crag/CragVolumes.h>
 #include <io/Hdf5VolumeReader.h>
@@ -64,6 +66,10 @@ public:
 	/**
 	 * Import a CRAG from a supervoxel image or volume and a merge history.
 	 *
+	 * If the option importBlockDepth is set, the supervoxel volume is read in 
+	 * slabs of that many sections, and the leaf node adjacencies are found on 
+	 * the way (see getAdjacencyAnnotator()).
+	 *
 	 * @param supervoxel
 	 *              Path to a supervoxel image or directory of images for 
 	 *              volumes. In the supervoxel volume, each voxel is labelled 
@@ -148,6 +154,48 @@ public:
 			CragVolumes&               volumes,
 			util::point<float, 3>      resolution,
 			util::point<float, 3>      offset);
+
+	/**
+	 * Read a flat CRAG from a supervoxel image or volume in slabs, such that 
+	 * only one slab has to be kept in memory. The volumes of the leaf nodes 
+	 * are stored as run-length encoded masks.
+	 *
+	 * @param supervoxels
+	 *              Path to a supervoxel image, directory of images, or HDF5 
+	 *              dataset ("file.hdf:dataset").
+	 * @param crag
+	 *              The CRAG to fill.
+	 * @param volumes
+	 *              A node map for the leaf node volmes.
+	 * @param resolution
+	 *              The resolution of the volume, to be stored in the volumes.
+	 * @param offset
+	 *              The offset of the volume, to be stored in the volumes.
+	 * @param slabDepth
+	 *              The number of sections to read at once.
+	 * @param annotator
+	 *              If given, the slabs are passed on to this annotator to find 
+	 *              the adjacencies of the leaf nodes.
+	 */
+	std::map<int, Crag::Node> readSupervoxels(
+			std::string                  supervoxels,
+			Crag&                        crag,
+			CragVolumes&                 volumes,
+			util::point<float, 3>        resolution,
+			util::point<float, 3>        offset,
+			unsigned int                 slabDepth,
+			BlockwiseAdjacencyAnnotator* annotator = 0);
+
+	/**
+	 * If the last import read the supervoxels in slabs, get an annotator that 
+	 * adds the leaf node adjacencies found on the way to the imported CRAG. 
+	 * Otherwise, returns a null pointer.
+	 */
+	std::shared_ptr<AdjacencyAnnotator> getAdjacencyAnnotator() { return _adjacencyAnnotator; }
+
+private:
+
+	std::shared_ptr<AdjacencyAnnotator> _adjacencyAnnotator;
 };
 
 #endif // CANDIDATE_MC_IO_CRAG_IMPORT_H__
@@ -80,6 +80,13 @@ public:
 	 */
 	virtual void retrieveVolumes(CragVolumes& volumes) = 0;
 
+	/**
+	 * Same as retrieveVolumes(), but leaf node volumes are only read when they 
+	 * are accessed. The store has to outlive the volumes. Stores that don't 
+	 * support this read all volumes right away.
+	 */
+	virtual void retrieveVolumesOnDemand(CragVolumes& volumes) { retrieveVolumes(volumes); }
+
 	/**
 	 * Retrieve features for the candidates (i.e., the nodes) of the CRAG 
 	 * associated to this store.
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <boost/lexical_cast.hpp>
 #include <util/Logger.h>
 #include <util/assert.h>
@@ -5,6 +7,38 @@
 
 logger::LogChannel hdf5storelog("hdf5storelog", "[Hdf5CragStore] ");
 
+namespace {
+
+// the number of voxels per compressed chunk of the voxel dataset
+const std::size_t VoxelChunkSize = 1 << 16;
+
+// the number of grid edge ids per compressed chunk of the affiliated edges
+const std::size_t AffiliatedEdgeChunkSize = 1 << 14;
+
+// vigra::HDF5File can neither remove nor rename datasets
+void
+removeDataset(vigra::HDF5File& file, const std::string& name) {
+
+	if (!file.existsDataset(name))
+		return;
+
+	if (H5Ldelete(file.getFileHandle(), name.c_str(), H5P_DEFAULT) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not remove dataset " << name);
+}
+
+void
+moveDataset(vigra::HDF5File& file, const std::string& from, const std::string& to) {
+
+	if (H5Lmove(file.getFileHandle(), from.c_str(), file.getFileHandle(), to.c_str(), H5P_DEFAULT, H5P_DEFAULT) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not rename dataset " << from << " to " << to);
+}
+
+} // anonymous namespace
+
 void
 Hdf5CragStore::saveCrag(const Crag& crag) {
 
@@ -45,40 +79,64 @@ Hdf5CragStore::saveCrag(const Crag& crag) {
 	_hdfFile.cd_mk("affiliated_edges");
 	int numEdges = 0;
 
-	// list of affilitated edges:
-	//
-	// u v n id_1 ... id_n
+	// affiliated edges, in compressed sparse row format:
 	//
-	// (u, v) ajacency edge
-	// n      number of affiliated edges
-	// id_i   id of ith affiliated edge
-	std::vector<int> aeIds;
+	// edges     u v for each leaf edge with affiliated edges 
+	// offsets   n+1 offsets into ids, the grid edges of the ith leaf edge 
+	//           are ids[offsets[i]] to ids[offsets[i+1]-1]
+	// ids       grid graph ids of the affiliated edges
+	std::vector<int>                edges;
+	std::vector<unsigned long long> offsets(1, 0);
+	std::vector<unsigned long long> ids;
 	for (Crag::CragEdge e : crag.edges()) {
 
 		if (!crag.isLeafEdge(e))
 			continue;
 
-		if (numEdges%100 == 0)
-			LOG_USER(hdf5storelog) << logger::delline << numEdges << " affiliated egde lists prepared" << std::flush;
+		AffiliatedEdges affiliatedEdges = crag.getAffiliatedEdges(e);
+		if (affiliatedEdges.empty())
+			continue;
+
+		static_assert(sizeof(std::uint64_t) == sizeof(unsigned long long), "grid edge ids are stored as unsigned long long");
 
-		aeIds.push_back(crag.id(crag.u(e)));
-		aeIds.push_back(crag.id(crag.v(e)));
-		aeIds.push_back(crag.getAffiliatedEdges(e).size());
-		for (vigra::GridGraph<3>::Edge ae : crag.getAffiliatedEdges(e))
-			aeIds.push_back(crag.getGridGraph().id(ae));
+		edges.push_back(crag.id(crag.u(e)));
+		edges.push_back(crag.id(crag.v(e)));
+		ids.insert(ids.end(), affiliatedEdges.ids(), affiliatedEdges.ids() + affiliatedEdges.size());
+		offsets.push_back(ids.size());
 
 		numEdges++;
 	}
-	LOG_USER(hdf5storelog) << logger::delline << numEdges << " affiliated egde lists prepared" << std::endl;
 
-	if (aeIds.size() == 0)
+	if (numEdges == 0)
 		return;
 
-	LOG_USER(hdf5storelog) << "writing affiliated edge lists..." << std::flush;
 	_hdfFile.write(
-			"list",
-			vigra::ArrayVectorView<int>(aeIds.size(), const_cast<int*>(&aeIds[0])));
-	LOG_USER(hdf5storelog) << " done." << std::endl;
+			"edges",
+			vigra::ArrayVectorView<int>(edges.size(), const_cast<int*>(&edges[0])));
+	_hdfFile.write(
+			"offsets",
+			vigra::ArrayVectorView<unsigned long long>(offsets.size(), const_cast<unsigned long long*>(&offsets[0])));
+
+	// 0 (none) ... 9 (most)
+	int compressionLevel = 3;
+
+	_hdfFile.createDataset<1, unsigned long long>(
+			"ids",
+			vigra::TinyVector<vigra::MultiArrayIndex, 1>(ids.size()),
+			0,
+			vigra::TinyVector<vigra::MultiArrayIndex, 1>(std::min(ids.size(), AffiliatedEdgeChunkSize)),
+			compressionLevel);
+
+	// write all ids at once, such that each compressed chunk is written only 
+	// once
+	_hdfFile.writeBlock(
+			"ids",
+			vigra::Shape1(0),
+			vigra::MultiArrayView<1, unsigned long long>(
+					vigra::Shape1(ids.size()),
+					ids.data()));
+
+	LOG_USER(hdf5storelog) << numEdges << " affiliated edge lists written" << std::endl;
 }
 
 void
@@ -137,112 +195,342 @@ Hdf5CragStore::retrieveCrag(Crag& crag) {
 		_hdfFile.cd("/crag");
 		_hdfFile.cd("affiliated_edges");
 
-		if (!_hdfFile.existsDataset("list"))
-			return;
+		if (_hdfFile.existsDataset("ids"))
+			readAffiliatedEdges(crag);
+		else if (_hdfFile.existsDataset("list"))
+			readAffiliatedEdgeList(crag);
 
-		vigra::ArrayVector<int> aeIds;
-		_hdfFile.readAndResize(
-				"list",
-				aeIds);
+	} catch (std::exception& e) {
 
-		for (unsigned int i = 0; i < aeIds.size();) {
+		LOG_USER(hdf5storelog) << "no grid-graph description found" << std::endl;
+	}
+}
 
-			Crag::CragNode u = crag.nodeFromId(aeIds[i]);
-			Crag::CragNode v = crag.nodeFromId(aeIds[i+1]);
-			int n = aeIds[i+2];
-			i += 3;
+void
+Hdf5CragStore::readAffiliatedEdges(Crag& crag) {
 
-			std::vector<vigra::GridGraph<3>::Edge> affiliatedEdges;
-			for (int j = 0; j < n; j++)
-				affiliatedEdges.push_back(crag.getGridGraph().edgeFromId(aeIds[i+j]));
-			i += n;
+	vigra::ArrayVector<int> edges;
+	vigra::ArrayVector<unsigned long long> offsets;
+	_hdfFile.readAndResize("edges", edges);
+	_hdfFile.readAndResize("offsets", offsets);
 
-			// find edge in CRAG and set affiliated edge list
-			if (affiliatedEdges.size()  > 0)
-				for (Crag::CragEdge e : crag.adjEdges(u))
-					if (crag.getAdjacencyGraph().oppositeNode(u, e) == v) {
+	UTIL_ASSERT_REL(edges.size(), ==, 2*(offsets.size() - 1));
 
-						crag.setAffiliatedEdges(e, affiliatedEdges);
-						break;
-					}
-		}
+	// read all ids at once, such that each compressed chunk is decompressed 
+	// only once
+	vigra::ArrayVector<unsigned long long> allIds;
+	_hdfFile.readAndResize("ids", allIds);
 
-	} catch (std::exception& e) {
+	UTIL_ASSERT_REL(allIds.size(), ==, offsets.back());
 
-		LOG_USER(hdf5storelog) << "no grid-graph description found" << std::endl;
+	std::vector<std::uint64_t> ids;
+
+	for (std::size_t i = 0; i + 1 < offsets.size(); i++) {
+
+		Crag::CragNode u = crag.nodeFromId(edges[2*i]);
+		Crag::CragNode v = crag.nodeFromId(edges[2*i + 1]);
+
+		ids.assign(allIds.begin() + offsets[i], allIds.begin() + offsets[i + 1]);
+
+		setAffiliatedEdges(crag, u, v, ids);
 	}
 }
 
+void
+Hdf5CragStore::readAffiliatedEdgeList(Crag& crag) {
+
+	// list of affilitated edges in older project files:
+	//
+	// u v n id_1 ... id_n
+	//
+	// (u, v) ajacency edge
+	// n      number of affiliated edges
+	// id_i   id of ith affiliated edge
+	vigra::ArrayVector<int> aeIds;
+	_hdfFile.readAndResize(
+			"list",
+			aeIds);
+
+	std::vector<std::uint64_t> ids;
+
+	for (unsigned int i = 0; i < aeIds.size();) {
+
+		Crag::CragNode u = crag.nodeFromId(aeIds[i]);
+		Crag::CragNode v = crag.nodeFromId(aeIds[i+1]);
+		int n = aeIds[i+2];
+		i += 3;
+
+		ids.assign(aeIds.begin() + i, aeIds.begin() + i + n);
+		i += n;
+
+		setAffiliatedEdges(crag, u, v, ids);
+	}
+}
+
+void
+Hdf5CragStore::setAffiliatedEdges(Crag& crag, Crag::CragNode u, Crag::CragNode v, const std::vector<std::uint64_t>& ids) {
+
+	if (ids.empty())
+		return;
+
+	// find edge in CRAG and set affiliated edge list
+	for (Crag::CragEdge e : crag.adjEdges(u))
+		if (crag.getAdjacencyGraph().oppositeNode(u, e) == v) {
+
+			crag.setAffiliatedEdges(e, ids.data(), ids.data() + ids.size());
+			break;
+		}
+}
+
 void
 Hdf5CragStore::saveVolumes(const CragVolumes& volumes) {
 
-	_hdfFile.cd_mk("/crag");
-	_hdfFile.cd_mk("volumes");
+	const Crag& crag = volumes.getCrag();
 
-	std::vector<unsigned char> serialized;
+	std::vector<Crag::CragNode> leafNodes;
 	std::vector<int> meta;
 	std::vector<float> offsets;
 	std::vector<float> resolutions;
 
-	int numNodes = 0;
-	for (Crag::NodeIt n(volumes.getCrag()); n != lemon::INVALID; ++n) {
+	// the position of the first voxel of each volume in the voxel dataset, 
+	// with a final entry for the total number of voxels
+	std::vector<unsigned long long> voxelOffsets(1, 0);
+
+	// collect the geometry of the leaf node volumes first, to create the 
+	// voxel dataset in its final size, without materializing the volumes
+	for (Crag::CragNode n : crag.nodes()) {
 
-		// only store leaf node volumes
-		if (!volumes.getCrag().isLeafNode(n))
+		if (!crag.isLeafNode(n))
 			continue;
 
-		if (numNodes%100 == 0)
-			LOG_USER(hdf5storelog) << logger::delline << numNodes << " node volumes prepared for writing" << std::flush;
-
-		const CragVolume& volume = *volumes[n];
-		meta.push_back(volumes.getCrag().id(n));
-		meta.push_back(volume.width());
-		meta.push_back(volume.height());
-		meta.push_back(volume.depth());
-		offsets.push_back(volume.getOffset().x());
-		offsets.push_back(volume.getOffset().y());
-		offsets.push_back(volume.getOffset().z());
-		resolutions.push_back(volume.getResolution().x());
-		resolutions.push_back(volume.getResolution().y());
-		resolutions.push_back(volume.getResolution().z());
-		std::copy(volume.data().begin(), volume.data().end(), std::back_inserter(serialized));
+		util::box<float, 3>   boundingBox = volumes.getBoundingBox(n);
+		util::point<float, 3> resolution  = volumes.getResolution(n);
+
+		unsigned int width  = std::lround(boundingBox.width()/resolution.x());
+		unsigned int height = std::lround(boundingBox.height()/resolution.y());
+		unsigned int depth  = std::lround(boundingBox.depth()/resolution.z());
+
+		leafNodes.push_back(n);
+		meta.push_back(crag.id(n));
+		meta.push_back(width);
+		meta.push_back(height);
+		meta.push_back(depth);
+		offsets.push_back(boundingBox.min().x());
+		offsets.push_back(boundingBox.min().y());
+		offsets.push_back(boundingBox.min().z());
+		resolutions.push_back(resolution.x());
+		resolutions.push_back(resolution.y());
+		resolutions.push_back(resolution.z());
+		voxelOffsets.push_back(
+				voxelOffsets.back() +
+				(unsigned long long)width*height*depth);
+	}
 
-		numNodes++;
+	int numNodes = leafNodes.size();
+	std::size_t numVoxels = voxelOffsets.back();
+
+	// The volumes might be read on demand from this store while they are 
+	// written. Therefore, they are written to a new dataset, and the previous 
+	// index and voxels stay valid until all volumes are written.
+	if (numVoxels > 0) {
+
+		std::lock_guard<std::mutex> lock(_volumeMutex);
+
+		_hdfFile.root();
+		_hdfFile.cd_mk("crag");
+		_hdfFile.cd_mk("volumes");
+
+		// 0 (none) ... 9 (most)
+		int compressionLevel = 3;
+
+		_hdfFile.createDataset<1, unsigned char>(
+				"voxels_new",
+				vigra::TinyVector<vigra::MultiArrayIndex, 1>(numVoxels),
+				0,
+				vigra::TinyVector<vigra::MultiArrayIndex, 1>(std::min(numVoxels, VoxelChunkSize)),
+				compressionLevel);
 	}
 
-	LOG_USER(hdf5storelog) << logger::delline << numNodes << " node volumes prepared for writing" << std::endl;
+	// get, write, and release one volume at a time
+	for (int i = 0; i < numNodes; i++) {
 
-	LOG_USER(hdf5storelog) << "writing node volumes... " << std::flush;
+		if (i%100 == 0)
+			LOG_USER(hdf5storelog) << logger::delline << i << " of " << numNodes << " node volumes written" << std::flush;
 
-	_hdfFile.write(
-			"serialized",
-			vigra::ArrayVectorView<unsigned char>(serialized.size(), const_cast<unsigned char*>(&serialized[0])));
+		std::size_t size = voxelOffsets[i + 1] - voxelOffsets[i];
+		if (size == 0)
+			continue;
+
+		// not holding the lock, since the volume might be read from this 
+		// store
+		std::shared_ptr<CragVolume> volume = volumes[leafNodes[i]];
+
+		UTIL_ASSERT_REL((std::size_t)volume->width()*volume->height()*volume->depth(), ==, size);
+
+		std::lock_guard<std::mutex> lock(_volumeMutex);
+
+		_hdfFile.writeBlock(
+				"/crag/volumes/voxels_new",
+				vigra::Shape1(voxelOffsets[i]),
+				vigra::MultiArrayView<1, unsigned char>(
+						vigra::Shape1(size),
+						volume->data().data()));
+	}
+
+	std::lock_guard<std::mutex> lock(_volumeMutex);
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("crag");
+	_hdfFile.cd_mk("volumes");
+
+	// write the index even if there are no volumes, to replace a previous one
 	_hdfFile.write(
 			"meta",
-			vigra::ArrayVectorView<int>(meta.size(), const_cast<int*>(&meta[0])));
+			vigra::ArrayVectorView<int>(meta.size(), meta.data()));
 	_hdfFile.write(
 			"offsets",
-			vigra::ArrayVectorView<float>(offsets.size(), const_cast<float*>(&offsets[0])));
+			vigra::ArrayVectorView<float>(offsets.size(), offsets.data()));
 	_hdfFile.write(
 			"resolutions",
-			vigra::ArrayVectorView<float>(resolutions.size(), const_cast<float*>(&resolutions[0])));
+			vigra::ArrayVectorView<float>(resolutions.size(), resolutions.data()));
+	_hdfFile.write(
+			"voxel_offsets",
+			vigra::ArrayVectorView<unsigned long long>(voxelOffsets.size(), voxelOffsets.data()));
 
-	LOG_USER(hdf5storelog) << "done." << std::endl;
+	// replace the previous voxels, and remove the ones of older project files 
+	// such that they are not kept next to the new ones
+	removeDataset(_hdfFile, "/crag/volumes/voxels");
+	removeDataset(_hdfFile, "/crag/volumes/serialized");
+	if (numVoxels > 0)
+		moveDataset(_hdfFile, "/crag/volumes/voxels_new", "/crag/volumes/voxels");
+
+	// the index has to be read again from the new volumes
+	_volumeIndex.clear();
+	_volumeIndexRead = false;
+
+	LOG_USER(hdf5storelog) << logger::delline << numNodes << " of " << numNodes << " node volumes written" << std::endl;
 }
 
 void
 Hdf5CragStore::retrieveVolumes(CragVolumes& volumes) {
 
+	std::lock_guard<std::mutex> lock(_volumeMutex);
+
+	readVolumeIndex();
+
+	int numNodes = 0;
+	for (const auto& p : _volumeIndex) {
+
+		if (numNodes%100 == 0)
+			LOG_USER(hdf5storelog) << logger::delline << numNodes << " of " << _volumeIndex.size() << " node volumes read" << std::flush;
+
+		std::shared_ptr<CragVolume> volume = readVolume(p.second);
+
+		UTIL_ASSERT(!volume->getBoundingBox().isZero());
+
+		Crag::Node n = volumes.getCrag().nodeFromId(p.first);
+		if (volumes.storesSparseVolumes())
+			volumes.setVolume(n, std::make_shared<SparseCragVolume>(*volume));
+		else
+			volumes.setVolume(n, volume);
+
+		numNodes++;
+	}
+
+	LOG_USER(hdf5storelog) << logger::delline << numNodes << " of " << _volumeIndex.size() << " node volumes read" << std::endl;
+}
+
+void
+Hdf5CragStore::retrieveVolumesOnDemand(CragVolumes& volumes) {
+
+	{
+		std::lock_guard<std::mutex> lock(_volumeMutex);
+		readVolumeIndex();
+	}
+
+	LOG_USER(hdf5storelog) << _volumeIndex.size() << " node volumes will be read on demand" << std::endl;
+
+	volumes.setVolumeSource(std::make_shared<VolumeSource>(*this, volumes.getCrag()));
+}
+
+std::shared_ptr<CragVolume>
+Hdf5CragStore::VolumeSource::getVolume(Crag::CragNode n) {
+
+	return _store.retrieveVolume(_crag, n);
+}
+
+util::box<float, 3>
+Hdf5CragStore::VolumeSource::getBoundingBox(Crag::CragNode n) {
+
+	VolumeRecord record = getRecord(n);
+
+	return util::box<float, 3>(
+			record.offset,
+			util::point<float, 3>(
+					record.offset.x() + record.width*record.resolution.x(),
+					record.offset.y() + record.height*record.resolution.y(),
+					record.offset.z() + record.depth*record.resolution.z()));
+}
+
+util::point<float, 3>
+Hdf5CragStore::VolumeSource::getResolution(Crag::CragNode n) {
+
+	return getRecord(n).resolution;
+}
+
+Hdf5CragStore::VolumeRecord
+Hdf5CragStore::VolumeSource::getRecord(Crag::CragNode n) {
+
+	// saveVolumes() might replace the index concurrently
+	std::lock_guard<std::mutex> lock(_store._volumeMutex);
+
+	_store.readVolumeIndex();
+
+	auto i = _store._volumeIndex.find(_crag.id(n));
+	if (i == _store._volumeIndex.end())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"node " << _crag.id(n) << " is a leaf node but has no volume assigned");
+
+	return i->second;
+}
+
+std::shared_ptr<CragVolume>
+Hdf5CragStore::retrieveVolume(const Crag& crag, Crag::CragNode n) {
+
+	std::lock_guard<std::mutex> lock(_volumeMutex);
+
+	readVolumeIndex();
+
+	auto i = _volumeIndex.find(crag.id(n));
+	if (i == _volumeIndex.end())
+		return std::shared_ptr<CragVolume>();
+
+	return readVolume(i->second);
+}
+
+void
+Hdf5CragStore::readVolumeIndex() {
+
+	if (_volumeIndexRead)
+		return;
+
 	_hdfFile.root();
 	_hdfFile.cd("/crag");
 	_hdfFile.cd("volumes");
 
-	vigra::MultiArray<1, unsigned char> serialized;
+	_volumeIndex.clear();
+
+	if (!_hdfFile.existsDataset("meta")) {
+
+		_volumeIndexRead = true;
+		return;
+	}
+
 	vigra::MultiArray<1, int> meta;
 	vigra::MultiArray<1, float> offsets;
 	vigra::MultiArray<1, float> resolutions;
 
-	_hdfFile.readAndResize("serialized", serialized);
 	_hdfFile.readAndResize("meta", meta);
 	_hdfFile.readAndResize("offsets", offsets);
 	_hdfFile.readAndResize("resolutions", resolutions);
@@ -253,34 +541,65 @@ Hdf5CragStore::retrieveVolumes(CragVolumes& volumes) {
 	UTIL_ASSERT_REL(meta.size()/4, ==, offsets.size()/3);
 	UTIL_ASSERT_REL(meta.size()/4, ==, resolutions.size()/3);
 
-	auto si = serialized.begin();
-	std::size_t oi = 0;
-	std::size_t ri = 0;
-	for (int i = 0; i < meta.size();) {
+	std::size_t numNodes = meta.size()/4;
 
-		int id = meta[i++];
-		int width = meta[i++];
-		int height = meta[i++];
-		int depth = meta[i++];
+	// Volumes are either stored in a compressed, chunked dataset with an 
+	// explicit index, or (in older project files) concatenated in an 
+	// uncompressed dataset in the order of meta.
+	vigra::MultiArray<1, unsigned long long> voxelOffsets;
+	if (_hdfFile.existsDataset("voxel_offsets")) {
 
-		std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(width, height, depth);
-		std::copy(si, si + width*height*depth, volume->data().begin());
-		si += width*height*depth;
+		_hdfFile.readAndResize("voxel_offsets", voxelOffsets);
+		UTIL_ASSERT_REL(voxelOffsets.size(), ==, numNodes + 1);
 
-		float x = resolutions[ri++];
-		float y = resolutions[ri++];
-		float z = resolutions[ri++];
-		volume->setResolution(x, y, z);
-		x = offsets[oi++];
-		y = offsets[oi++];
-		z = offsets[oi++];
-		volume->setOffset(x, y, z);
+		_voxelDataset = "/crag/volumes/voxels";
 
-		Crag::Node n = volumes.getCrag().nodeFromId(id);
-		volumes.setVolume(n, volume);
+	} else {
 
-		UTIL_ASSERT(!volume->getBoundingBox().isZero());
+		voxelOffsets.reshape(vigra::Shape1(numNodes + 1));
+		voxelOffsets[0] = 0;
+		for (std::size_t i = 0; i < numNodes; i++)
+			voxelOffsets[i + 1] = voxelOffsets[i] + (unsigned long long)meta[4*i + 1]*meta[4*i + 2]*meta[4*i + 3];
+
+		_voxelDataset = "/crag/volumes/serialized";
+	}
+
+	for (std::size_t i = 0; i < numNodes; i++) {
+
+		VolumeRecord record;
+		record.width      = meta[4*i + 1];
+		record.height     = meta[4*i + 2];
+		record.depth      = meta[4*i + 3];
+		record.offset     = util::point<float, 3>(offsets[3*i], offsets[3*i + 1], offsets[3*i + 2]);
+		record.resolution = util::point<float, 3>(resolutions[3*i], resolutions[3*i + 1], resolutions[3*i + 2]);
+		record.begin      = voxelOffsets[i];
+
+		_volumeIndex[meta[4*i]] = record;
+	}
+
+	_volumeIndexRead = true;
+}
+
+std::shared_ptr<CragVolume>
+Hdf5CragStore::readVolume(const VolumeRecord& record) {
+
+	std::shared_ptr<CragVolume> volume = std::make_shared<CragVolume>(record.width, record.height, record.depth);
+	std::size_t size = (std::size_t)record.width*record.height*record.depth;
+
+	if (size > 0) {
+
+		vigra::MultiArrayView<1, unsigned char> voxels(vigra::Shape1(size), volume->data().data());
+		_hdfFile.readBlock(
+				_voxelDataset,
+				vigra::Shape1(record.begin),
+				vigra::Shape1(size),
+				voxels);
 	}
+
+	volume->setResolution(record.resolution.x(), record.resolution.y(), record.resolution.z());
+	volume->setOffset(record.offset.x(), record.offset.y(), record.offset.z());
+
+	return volume;
 }
 
 void
@@ -302,7 +621,7 @@ Hdf5CragStore::saveNodeFeatures(const Crag& crag, const NodeFeatures& features)
 		if (numNodes == 0)
 			continue;
 
-		vigra::MultiArray<2, double> allFeatures(vigra::Shape2(features.dims(type) + 1, numNodes));
+		vigra::MultiArray<2, double> allFeatures(vigra::Shape2(features.storedDims(type) + 1, numNodes));
 
 		int nodeNum = 0;
 		for (Crag::CragNode n : crag.nodes()) {
@@ -310,15 +629,16 @@ Hdf5CragStore::saveNodeFeatures(const Crag& crag, const NodeFeatures& features)
 			if (crag.type(n) != type)
 				continue;
 
+			// columns of allFeatures are contiguous, copy the whole row at once
+			FeatureRow f = features[n];
 			allFeatures(0, nodeNum) = crag.id(n);
-			std::copy(
-					features[n].begin(),
-					features[n].end(),
-					allFeatures.bind<1>(nodeNum).begin() + 1);
+			std::copy(f.begin(), f.end(), &allFeatures(1, nodeNum));
 			nodeNum++;
 		}
 
-		_hdfFile.write(std::string("nodes_") + boost::lexical_cast<std::string>(type), allFeatures);
+		std::string dataset = std::string("nodes_") + boost::lexical_cast<std::string>(type);
+		_hdfFile.write(dataset, allFeatures);
+		writeFeatureExpansion(features.getExpansion(type), dataset);
 	}
 
 	LOG_USER(hdf5storelog) << "done." << std::endl;
@@ -343,18 +663,17 @@ Hdf5CragStore::retrieveNodeFeatures(const Crag& crag, NodeFeatures& features) {
 		int dims     = allFeatures.shape(0) - 1;
 		int numNodes = allFeatures.shape(1);
 
+		features.reserve(type, numNodes, dims);
+
 		for (int i = 0; i < numNodes; i++) {
 
 			Crag::CragNode n = crag.nodeFromId(allFeatures(0, i));
 
-			std::vector<double> f;
-			f.resize(dims);
-			std::copy(
-					allFeatures.bind<1>(i).begin() + 1,
-					allFeatures.bind<1>(i).end(),
-					f.begin());
-			features.set(n, f);
+			const double* f = &allFeatures(1, i);
+			features.set(n, f, f + dims);
 		}
+
+		features.setExpansion(type, readFeatureExpansion(std::string("nodes_") + boost::lexical_cast<std::string>(type)));
 	}
 }
 
@@ -377,7 +696,7 @@ Hdf5CragStore::saveEdgeFeatures(const Crag& crag, const EdgeFeatures& features)
 		if (numEdges == 0)
 			continue;
 
-		vigra::MultiArray<2, double> allFeatures(vigra::Shape2(features.dims(type) + 2, numEdges));
+		vigra::MultiArray<2, double> allFeatures(vigra::Shape2(features.storedDims(type) + 2, numEdges));
 
 		int edgeNum = 0;
 		for (Crag::CragEdge e : crag.edges()) {
@@ -385,16 +704,16 @@ Hdf5CragStore::saveEdgeFeatures(const Crag& crag, const EdgeFeatures& features)
 			if (crag.type(e) != type)
 				continue;
 
+			FeatureRow f = features[e];
 			allFeatures(0, edgeNum) = crag.id(e.u());
 			allFeatures(1, edgeNum) = crag.id(e.v());
-			std::copy(
-					features[e].begin(),
-					features[e].end(),
-					allFeatures.bind<1>(edgeNum).begin() + 2);
+			std::copy(f.begin(), f.end(), &allFeatures(2, edgeNum));
 			edgeNum++;
 		}
 
-		_hdfFile.write(std::string("edges_") + boost::lexical_cast<std::string>(type), allFeatures);
+		std::string dataset = std::string("edges_") + boost::lexical_cast<std::string>(type);
+		_hdfFile.write(dataset, allFeatures);
+		writeFeatureExpansion(features.getExpansion(type), dataset);
 	}
 
 	LOG_USER(hdf5storelog) << "done." << std::endl;
@@ -419,6 +738,8 @@ Hdf5CragStore::retrieveEdgeFeatures(const Crag& crag, EdgeFeatures& features) {
 		int dims     = allFeatures.shape(0) - 2;
 		int numEdges = allFeatures.shape(1);
 
+		features.reserve(type, numEdges, dims);
+
 		for (int i = 0; i < numEdges; i++) {
 
 			Crag::CragNode u = crag.nodeFromId(allFeatures(0, i));
@@ -434,17 +755,41 @@ Hdf5CragStore::retrieveEdgeFeatures(const Crag& crag, EdgeFeatures& features) {
 						IOError,
 						"can not find edge for nodes " << crag.id(u) << " and " << crag.id(v));
 
-			std::vector<double> f;
-			f.resize(dims);
-			std::copy(
-					allFeatures.bind<1>(i).begin() + 2,
-					allFeatures.bind<1>(i).end(),
-					f.begin());
-			features.set(*e, f);
+			const double* f = &allFeatures(2, i);
+			features.set(*e, f, f + dims);
 		}
+
+		features.setExpansion(type, readFeatureExpansion(std::string("edges_") + boost::lexical_cast<std::string>(type)));
 	}
 }
 
+void
+Hdf5CragStore::writeFeatureExpansion(const FeatureExpansion& expansion, std::string dataset) {
+
+	if (expansion.empty())
+		return;
+
+	vigra::MultiArray<1, int> e(3);
+	e[0] = expansion.numBaseFeatures();
+	e[1] = expansion.squares();
+	e[2] = expansion.pairwise();
+
+	_hdfFile.writeAttribute(dataset, "expansion", e);
+}
+
+FeatureExpansion
+Hdf5CragStore::readFeatureExpansion(std::string dataset) {
+
+	// older project files store all features
+	if (!_hdfFile.existsAttribute(dataset, "expansion"))
+		return FeatureExpansion();
+
+	vigra::MultiArray<1, int> e(3);
+	_hdfFile.readAttribute(dataset, "expansion", e);
+
+	return FeatureExpansion(e[0], e[1], e[2]);
+}
+
 void
 Hdf5CragStore::saveSkeletons(const Crag& crag, const Skeletons& skeletons) {
 
@@ -1,6 +1,9 @@
 #ifndef CANDIDATE_MC_IO_HDF_CRAG_STORE_H__
 #define CANDIDATE_MC_IO_HDF_CRAG_STORE_H__
 
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <vigra/hdf5impex.hxx>
 #include "Hdf5GraphReader.h"
 #include "Hdf5GraphWriter.h"
@@ -30,7 +33,8 @@ public:
 		Hdf5VolumeWriter(_hdfFile),
 		_hdfFile(
 				projectFile,
-				vigra::HDF5File::OpenMode::ReadWrite) {}
+				vigra::HDF5File::OpenMode::ReadWrite),
+		_volumeIndexRead(false) {}
 
 
 	/**
@@ -40,12 +44,16 @@ public:
 
 	/**
 	 * Save CRAG volumes. This will only store the volumes of leaf nodes, others 
-	 * can be assembled from them.
+	 * can be assembled from them. The volumes are written one after another 
+	 * into a compressed, chunked dataset, together with the position of each 
+	 * volume in it.
 	 */
 	void saveVolumes(const CragVolumes& volumes) override;
 
 	/**
-	 * Store features for the candidates (i.e., the nodes) of a CRAG.
+	 * Store features for the candidates (i.e., the nodes) of a CRAG. Only the 
+	 * stored features are written, the expansion to compute the implicit ones 
+	 * is kept as an attribute of the feature datasets.
 	 */
 	void saveNodeFeatures(const Crag& crag, const NodeFeatures& features) override;
 
@@ -93,6 +101,20 @@ public:
 	 */
 	void retrieveVolumes(CragVolumes& volumes) override;
 
+	/**
+	 * Prepare the given CragVolumes to read leaf node volumes from this store 
+	 * when they are accessed. Bounding boxes are answered from the stored 
+	 * geometry, without reading voxels.
+	 */
+	void retrieveVolumesOnDemand(CragVolumes& volumes) override;
+
+	/**
+	 * Retrieve the volume of a single leaf node, without reading the volumes 
+	 * of other nodes. Returns an empty pointer if no volume is stored for the 
+	 * node. Can be called concurrently, the reads are serialized internally.
+	 */
+	std::shared_ptr<CragVolume> retrieveVolume(const Crag& crag, Crag::CragNode n);
+
 	/**
 	 * Retrieve features for the candidates (i.e., the nodes) of the CRAG 
 	 * associated to this store.
@@ -196,10 +218,74 @@ private:
 	void writeGraphVolume(const GraphVolume& graphVolume);
 	void readGraphVolume(GraphVolume& graphVolume);
 
+	// read the affiliated edges from the current group, either in compressed 
+	// sparse row format or from the list of older project files
+	void readAffiliatedEdges(Crag& crag);
+	void readAffiliatedEdgeList(Crag& crag);
+	void setAffiliatedEdges(Crag& crag, Crag::CragNode u, Crag::CragNode v, const std::vector<std::uint64_t>& ids);
+
 	void writeWeights(const FeatureWeights& weights, std::string name);
 	void readWeights(FeatureWeights& weights, std::string name);
 
+	// write and read the expansion of the features in the given dataset of the 
+	// current group
+	void writeFeatureExpansion(const FeatureExpansion& expansion, std::string dataset);
+	FeatureExpansion readFeatureExpansion(std::string dataset);
+
+	/**
+	 * The geometry of a stored leaf node volume and the position of its first 
+	 * voxel in the voxel dataset.
+	 */
+	struct VolumeRecord {
+
+		unsigned int width;
+		unsigned int height;
+		unsigned int depth;
+
+		util::point<float, 3> offset;
+		util::point<float, 3> resolution;
+
+		std::size_t begin;
+	};
+
+	/**
+	 * Provides leaf node volumes from this store to CragVolumes.
+	 */
+	class VolumeSource : public CragVolumeSource {
+
+	public:
+
+		VolumeSource(Hdf5CragStore& store, const Crag& crag) :
+			_store(store),
+			_crag(crag) {}
+
+		std::shared_ptr<CragVolume> getVolume(Crag::CragNode n) override;
+
+		util::box<float, 3> getBoundingBox(Crag::CragNode n) override;
+
+		util::point<float, 3> getResolution(Crag::CragNode n) override;
+
+	private:
+
+		// get a copy of the stored geometry of a leaf node volume
+		VolumeRecord getRecord(Crag::CragNode n);
+
+		Hdf5CragStore& _store;
+		const Crag&    _crag;
+	};
+
+	void readVolumeIndex();
+	std::shared_ptr<CragVolume> readVolume(const VolumeRecord& record);
+
 	vigra::HDF5File _hdfFile;
+
+	// the stored leaf node volumes by node id, read on first access
+	std::map<int, VolumeRecord> _volumeIndex;
+	bool                        _volumeIndexRead;
+	std::string                 _voxelDataset;
+
+	// serializes access to the volumes in the HDF5 file
+	std::mutex _volumeMutex;
 };
 
 #endif // CANDIDATE_MC_IO_HDF_CRAG_STORE_H__
@@ -127,7 +127,8 @@ SolutionImageWriter::drawBoundary(
 		vigra::MultiArray<3, float>& components,
 		float                        value) {
 
-	const CragVolume& volume = *volumes[n];
+	std::shared_ptr<CragVolume> volumePtr = volumes[n];
+	const CragVolume& volume = *volumePtr;
 	const util::box<unsigned int, 3>& volumeDiscreteBB = volume.getDiscreteBoundingBox();
 	const util::point<float, 3>&      volumeOffset     = volume.getOffset();
 	util::point<unsigned int, 3>      begin            = (volumeOffset - _volumesBB.min())/volume.getResolution();
@@ -0,0 +1,148 @@
+#ifndef CANDIDATE_MC_IO_VOLUME_SLAB_READER_H__
+#define CANDIDATE_MC_IO_VOLUME_SLAB_READER_H__
+
+#include <memory>
+#include <string>
+#include <vigra/hdf5impex.hxx>
+#include <vigra/impex.hxx>
+#include <vigra/multi_array.hxx>
+#include <util/exceptions.h>
+#include "volumes.h"
+
+/**
+ * Reads a volume in slabs of consecutive sections, such that only one slab 
+ * has to be kept in memory. The volume is given in the same way as for 
+ * readVolumeFromOption(), i.e., either as "file.hdf:dataset", or as a single 
+ * image or directory of images with one image per section.
+ */
+template <typename T>
+class VolumeSlabReader {
+
+public:
+
+	/**
+	 * @param option
+	 *              The volume to read.
+	 * @param slabDepth
+	 *              The number of sections per slab. 0 reads the whole volume
+	 *              as one slab.
+	 */
+	VolumeSlabReader(std::string option, unsigned int slabDepth) :
+		_slabDepth(slabDepth),
+		_nextSection(0) {
+
+		size_t sepPos = option.find_first_of(":");
+		if (sepPos != std::string::npos) {
+
+			_dataset = option.substr(sepPos + 1);
+			_hdfFile = std::unique_ptr<vigra::HDF5File>(
+					new vigra::HDF5File(
+							option.substr(0, sepPos),
+							vigra::HDF5File::OpenMode::ReadOnly));
+
+			vigra::ArrayVector<hsize_t> shape = _hdfFile->getDatasetShape(_dataset);
+
+			if (shape.size() != 3)
+				UTIL_THROW_EXCEPTION(
+						IOError,
+						"dataset " << _dataset << " is not a 3D volume");
+
+			_shape = vigra::Shape3(shape[0], shape[1], shape[2]);
+
+		} else {
+
+			_files = getImageFiles(option);
+
+			if (_files.empty())
+				UTIL_THROW_EXCEPTION(
+						IOError,
+						"no images found in " << option);
+
+			vigra::ImageImportInfo info(_files[0].c_str());
+			_shape = vigra::Shape3(info.width(), info.height(), _files.size());
+		}
+
+		if (_slabDepth == 0 || _slabDepth > _shape[2])
+			_slabDepth = std::max((int)_shape[2], 1);
+	}
+
+	/**
+	 * The shape of the whole volume.
+	 */
+	const vigra::Shape3& shape() const { return _shape; }
+
+	/**
+	 * Read the next slab. Returns false if all sections have been read.
+	 *
+	 * @param slab
+	 *              Will be resized to the size of the slab.
+	 * @param firstSection
+	 *              The index of the first section of the slab in the volume.
+	 */
+	bool next(vigra::MultiArray<3, T>& slab, unsigned int& firstSection) {
+
+		if (_nextSection >= _shape[2])
+			return false;
+
+		firstSection = _nextSection;
+		unsigned int depth = std::min(_slabDepth, (unsigned int)(_shape[2] - _nextSection));
+
+		vigra::Shape3 slabShape(_shape[0], _shape[1], depth);
+		if (slab.shape() != slabShape)
+			slab.reshape(slabShape);
+
+		if (_hdfFile) {
+
+			_hdfFile->readBlock(
+					_dataset,
+					vigra::Shape3(0, 0, _nextSection),
+					slabShape,
+					slab);
+
+		} else {
+
+			for (unsigned int z = 0; z < depth; z++) {
+
+				const std::string& filename = _files[_nextSection + z];
+
+				try {
+
+					vigra::ImageImportInfo info(filename.c_str());
+
+					if (info.width() != _shape[0] || info.height() != _shape[1])
+						UTIL_THROW_EXCEPTION(
+								IOError,
+								"image " << filename << " has a different size than the first image");
+
+					importImage(info, slab.template bind<2>(z));
+
+				} catch (std::exception& e) {
+
+					UTIL_THROW_EXCEPTION(
+							IOError,
+							"error reading " << filename << ": " << e.what());
+				}
+			}
+		}
+
+		_nextSection += depth;
+
+		return true;
+	}
+
+private:
+
+	unsigned int  _slabDepth;
+	unsigned int  _nextSection;
+	vigra::Shape3 _shape;
+
+	// either read from an HDF5 dataset...
+	std::unique_ptr<vigra::HDF5File> _hdfFile;
+	std::string                      _dataset;
+
+	// ...or from images
+	std::vector<std::string> _files;
+};
+
+#endif // CANDIDATE_MC_IO_VOLUME_SLAB_READER_H__
+
@@ -8,11 +8,12 @@ AssignmentLoss::AssignmentLoss(
 		const Crag&                crag,
 		const CragVolumes&         volumes,
 		const ExplicitVolume<int>& groundTruth) :
-	Loss(crag),
-	_candidateSizes(crag),
-	_overlaps(crag) {
+	AssignmentLoss(crag, GroundTruthOverlaps(crag, volumes, groundTruth)) {}
 
-	computeSizesAndOverlaps(crag, volumes, groundTruth);
+AssignmentLoss::AssignmentLoss(
+		const Crag&                crag,
+		const GroundTruthOverlaps& overlaps) :
+	Loss(crag) {
 
 	// For each candidate i (SliceNode and AssignmentNode), get the minimal
 	//
@@ -28,6 +29,13 @@ AssignmentLoss::AssignmentLoss(
 
 	for (Crag::CragNode i : crag.nodes()) {
 
+		GroundTruthOverlaps::Overlaps overlaps_i = overlaps[i];
+
+		// For the size of the candidates, consider only voxels that do overlap 
+		// with a ground truth region. This way, we say that we don't care about 
+		// the background label in the ground truth.
+		int size_i = overlaps_i.numVoxels() - overlaps_i.get(0);
+
 		if (crag.type(i) == Crag::NoAssignmentNode) {
 
 			// NoAssignmentNodes don't have a loss
@@ -40,7 +48,7 @@ AssignmentLoss::AssignmentLoss(
 			// SliceNodes don't need a score, their selection is implied by 
 			// selecting AssignmentNodes. However, if they don't overlap with a 
 			// ground truth region at all, discourage taking them.
-			if (_candidateSizes[i] == 0)
+			if (size_i == 0)
 				node[i] = 1;
 			else
 				node[i] = 0;
@@ -50,14 +58,16 @@ AssignmentLoss::AssignmentLoss(
 
 		LOG_ALL(assignmentlosslog) << "computing loss for node " << crag.id(i) << std::endl;
 
-		int size_i = _candidateSizes[i];
 		int minScore = size_i;
 
 		// for each overlapping ground truth region
-		for (auto& p : _overlaps[i]) {
+		for (const GroundTruthOverlaps::Overlap& p : overlaps_i) {
 
-			int gtLabel = p.first;
-			int overlap = p.second;
+			int gtLabel = p.label;
+			int overlap = p.size;
+
+			if (gtLabel == 0)
+				continue;
 
 			LOG_ALL(assignmentlosslog) << "\toverlap with  gt region " << gtLabel << ": " << overlap << std::endl;
 			LOG_ALL(assignmentlosslog) << "\tdifference to gt region " << gtLabel << ": " << (size_i - overlap) << std::endl;
@@ -77,48 +87,3 @@ AssignmentLoss::AssignmentLoss(
 	for (Crag::CragEdge e : crag.edges())
 		edge[e] = 0;
 }
-
-void
-AssignmentLoss::computeSizesAndOverlaps(
-		const Crag& crag,
-		const CragVolumes& volumes,
-		const ExplicitVolume<int>& groundTruth) {
-
-	// candidate sizes and overlap with ground truth regions
-	for (Crag::CragNode n : crag.nodes()) {
-
-		_candidateSizes[n] = 0;
-
-		if (crag.type(n) == Crag::NoAssignmentNode)
-			continue;
-
-		const CragVolume& region = *volumes[n];
-
-		util::point<unsigned int, 3> offset =
-				(region.getOffset() - groundTruth.getOffset())/
-				groundTruth.getResolution();
-
-		LOG_ALL(assignmentlosslog) << "offset into ground-truth image: " << offset << std::endl;
-
-		for (unsigned int z = 0; z < region.getDiscreteBoundingBox().depth();  z++)
-		for (unsigned int y = 0; y < region.getDiscreteBoundingBox().height(); y++)
-		for (unsigned int x = 0; x < region.getDiscreteBoundingBox().width();  x++) {
-
-			if (!region.data()(x, y, z))
-				continue;
-
-			int gtLabel = groundTruth[offset + util::point<unsigned int, 3>(x, y, z)];
-
-			if (gtLabel == 0)
-				continue;
-
-			// For the size of the candidates, consider only voxels that do 
-			// overlap with a ground truth region. This way, we say that we 
-			// don't care about the background label in the ground truth.
-			_candidateSizes[n]++;
-
-			_overlaps[n][gtLabel]++;
-		}
-	}
-}
-
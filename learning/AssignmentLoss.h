@@ -3,6 +3,7 @@
 
 #include <imageprocessing/ExplicitVolume.h>
 #include <learning/Loss.h>
+#include "GroundTruthOverlaps.h"
 
 /**
  * Specialized loss for assignment models. Rewards overlap between slices.
@@ -16,16 +17,12 @@ public:
 			const CragVolumes&         volumes,
 			const ExplicitVolume<int>& groundTruth);
 
-private:
-
-	void computeSizesAndOverlaps(
-			const Crag& crag,
-			const CragVolumes& volumes,
-			const ExplicitVolume<int>& groundTruth);
-
-	Crag::NodeMap<int> _candidateSizes;
-
-	Crag::NodeMap<std::map<int, int>> _overlaps;
+	/**
+	 * Create an assignment loss from precomputed ground-truth overlaps.
+	 */
+	AssignmentLoss(
+			const Crag&                crag,
+			const GroundTruthOverlaps& overlaps);
 };
 
 #endif // CANDIDATE_MC_LEARNING_ASSIGNMENT_LOSS_H__
@@ -453,8 +453,7 @@ template <typename Weights>
 void
 BundleOptimizer::findMinLowerBound(Weights& w, double& value) {
 
-	for (const LinearConstraint& constraint : _bundleCollector.getNewConstraints())
-		_solver->addConstraint(constraint);
+	_solver->addConstraints(_bundleCollector.getNewConstraints());
 
 	Solution x;
 	std::string msg;
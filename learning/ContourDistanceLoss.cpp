@@ -1,4 +1,5 @@
 #include <io/CragImport.h>
+#include <crag/ParallelFor.h>
 #include <util/Logger.h>
 #include <util/timing.h>
 #include <imageprocessing/intersect.h>
@@ -11,45 +12,73 @@ ContourDistanceLoss::ContourDistanceLoss(
 		const CragVolumes& volumes,
 		const Crag&        gtCrag,
 		const CragVolumes& gtVolumes,
-		double maxHausdorffDistance) :
+		double maxHausdorffDistance,
+		int    numThreads) :
 	Loss(crag),
-	_distance(maxHausdorffDistance) {
+	_distance(maxHausdorffDistance),
+	_gtDistanceMaps(_distance.getMaxCacheBytes()) {
 
 	UTIL_TIME_METHOD;
 
+	// only ground-truth regions with intersecting bounding boxes can overlap
+	BoundingBoxIndex gtIndex(gtCrag, gtVolumes);
+
+	std::vector<Crag::CragNode> nodes;
+	for (Crag::CragNode n : crag.nodes())
+		nodes.push_back(n);
+
+	std::vector<double> constants(nodes.size(), 0);
+
 	// loss for each candidate
-	for (Crag::CragNode n : crag.nodes()) {
+	parallelFor(
+			nodes.size(),
+			getNumThreads(numThreads),
+			[&](std::size_t i) {
 
-		getLoss(n, volumes, gtCrag, gtVolumes);
-		LOG_ALL(contourdistancelosslog)
-				<< "loss of node " << crag.id(n)
-				<< " at " << volumes[n]->getBoundingBox()
-				<< ": " << node[n] << std::endl;
-	}
+				Crag::CragNode n = nodes[i];
+
+				node[n] = getLoss(n, volumes, gtCrag, gtVolumes, gtIndex, constants[i]);
+
+				LOG_ALL(contourdistancelosslog)
+						<< "loss of node " << crag.id(n)
+						<< " at " << volumes.getBoundingBox(n)
+						<< ": " << node[n] << std::endl;
+			},
+			4);
+
+	// add the constants in a fixed order, to not depend on the scheduling
+	for (double c : constants)
+		constant += c;
 
-	_distance.clearCache();
+	_gtDistanceMaps.clear();
 
 	LOG_USER(contourdistancelosslog) << "done." << std::endl;
 }
 
-void
+double
 ContourDistanceLoss::getLoss(
-		Crag::CragNode     n,
-		const CragVolumes& volumes,
-		const Crag&        gtCrag,
-		const CragVolumes& gtVolumes) {
+		Crag::CragNode          n,
+		const CragVolumes&      volumes,
+		const Crag&             gtCrag,
+		const CragVolumes&      gtVolumes,
+		const BoundingBoxIndex& gtIndex,
+		double&                 constant) {
+
+	Overlap  overlapFunctor;
+	Diameter diameter;
 
 	std::shared_ptr<CragVolume> volume = volumes[n];
 
 	double maxOverlapDiameter = 0;
 	std::shared_ptr<CragVolume> bestGtRegion;
+	Crag::CragNode              bestGtNode;
 
-	for (Crag::CragNode gt : gtCrag.nodes()) {
+	for (Crag::CragNode gt : gtIndex.intersecting(volume->getBoundingBox().project<2>())) {
 
 		std::shared_ptr<CragVolume> gtVolume = gtVolumes[gt];
 
 		// does overlap?
-		if (!_overlap.exceeds(*volume, *gtVolume, 0))
+		if (!overlapFunctor.exceeds(*volume, *gtVolume, 0))
 			continue;
 
 		// reward
@@ -57,12 +86,13 @@ ContourDistanceLoss::getLoss(
 		CragVolume overlap;
 		intersect(*volume, *gtVolume, overlap);
 
-		double overlapDiameter = _diameter(overlap);
+		double overlapDiameter = diameter(overlap);
 
 		if (maxOverlapDiameter < overlapDiameter) {
 
 			maxOverlapDiameter = overlapDiameter;
 			bestGtRegion = gtVolume;
+			bestGtNode   = gt;
 		}
 	}
 
@@ -77,12 +107,15 @@ ContourDistanceLoss::getLoss(
 				<< bestGtRegion->getBoundingBox()
 				<< std::endl;
 
-		double gtToCandidate, candidateToGt;
-		_distance(
-				*bestGtRegion,
-				*volume,
-				gtToCandidate,
-				candidateToGt);
+		// the candidate volume is not kept, so only the distance maps of the 
+		// ground-truth regions are cached
+		std::shared_ptr<const DistanceMap> gtDistances =
+				_gtDistanceMaps.get(
+						gtCrag.id(bestGtNode),
+						[&]{ return _distance.computeDistanceMap(*bestGtRegion); });
+
+		double gtToCandidate = _distance.distance(*bestGtRegion, *_distance.computeDistanceMap(*volume));
+		double candidateToGt = _distance.distance(*volume, *gtDistances);
 
 		LOG_ALL(contourdistancelosslog)
 				<< "distance to candidate: " << gtToCandidate
@@ -98,11 +131,11 @@ ContourDistanceLoss::getLoss(
 				<< std::endl;
 	}
 
-	// set the loss
-	node[n] = penalty - maxOverlapDiameter;
-
 	// add the constant (the maximally possible overlap with any ground truth 
 	// region, i.e., the diameter of the candidate)
-	double diameter = _diameter(*volume);
-	constant += diameter;
+	constant = diameter(*volume);
+
+	// the loss
+	return penalty - maxOverlapDiameter;
 }
+
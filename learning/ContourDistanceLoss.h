@@ -2,6 +2,7 @@
 #define CANDIDATE_MC_CONTOUR_DISTANCE_LOSS_H__
 
 #include <imageprocessing/ExplicitVolume.h>
+#include <crag/BoundingBoxIndex.h>
 #include <learning/Loss.h>
 #include <features/Diameter.h>
 #include <features/HausdorffDistance.h>
@@ -25,24 +26,35 @@ class ContourDistanceLoss : public Loss {
 
 public:
 
+	/**
+	 * @param numThreads
+	 *              The number of threads to compute the loss of the 
+	 *              candidates with. Values smaller than 1 use one thread per 
+	 *              hardware thread.
+	 */
 	ContourDistanceLoss(
 			const Crag&        crag,
 			const CragVolumes& volumes,
 			const Crag&        gtCrag,
 			const CragVolumes& gtVolumes,
-			double maxHausdorffDistance);
+			double maxHausdorffDistance,
+			int    numThreads = 0);
 
 private:
 
-	void getLoss(
-			Crag::CragNode     n,
-			const CragVolumes& volumes,
-			const Crag&        gtCrag,
-			const CragVolumes& gtVolumes);
+	// get the loss of candidate n, and its contribution to the constant
+	double getLoss(
+			Crag::CragNode          n,
+			const CragVolumes&      volumes,
+			const Crag&             gtCrag,
+			const CragVolumes&      gtVolumes,
+			const BoundingBoxIndex& gtIndex,
+			double&                 constant);
 
 	HausdorffDistance _distance;
-	Overlap           _overlap;
-	Diameter          _diameter;
+
+	// the distance maps of the ground-truth regions, by id
+	DistanceMapCache<int> _gtDistanceMaps;
 };
 
 
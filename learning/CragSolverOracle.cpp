@@ -39,10 +39,10 @@ CragSolverOracle::valueGradientP(
 	double mostViolatedEnergy = 0;
 	for (Crag::CragNode n : _crag.nodes())
 		if (_mostViolatedSolution.selected(n))
-			mostViolatedEnergy += nodeCost(n, weights);
+			mostViolatedEnergy += _featureCosts.node[n];
 	for (Crag::CragEdge e : _crag.edges())
 		if (_mostViolatedSolution.selected(e))
-			mostViolatedEnergy += edgeCost(e, weights);
+			mostViolatedEnergy += _featureCosts.edge[e];
 
 	double loss   = value - _B_c + mostViolatedEnergy;
 	double margin = value - loss;
@@ -113,19 +113,18 @@ CragSolverOracle::updateCosts(const FeatureWeights& weights) {
 	// We store B_c + Δ_c in _constant, and subtract v* from it to get the 
 	// value.
 
-	// wΦ
-	for (Crag::CragNode n : _crag.nodes())
-		_costs.node[n] = nodeCost(n, weights);
-	for (Crag::CragEdge e : _crag.edges())
-		_costs.edge[e] = edgeCost(e, weights);
+	// wΦ, computed once per iteration as one matrix-vector product per node 
+	// and edge type
+	_nodeFeatures.computeCosts(weights, _featureCosts.node, _numThreads);
+	_edgeFeatures.computeCosts(weights, _featureCosts.edge, _numThreads);
 
-	_currentBestSolver->setCosts(_costs);
+	_currentBestSolver->setCosts(_featureCosts);
 
 	// -Δ_l
 	for (Crag::CragNode n : _crag.nodes())
-		_costs.node[n] -= _loss.node[n];
+		_costs.node[n] = _featureCosts.node[n] - _loss.node[n];
 	for (Crag::CragEdge e : _crag.edges())
-		_costs.edge[e] -= _loss.edge[e];
+		_costs.edge[e] = _featureCosts.edge[e] - _loss.edge[e];
 
 	// Δ_c
 	_constant = _loss.constant;
@@ -134,10 +133,10 @@ CragSolverOracle::updateCosts(const FeatureWeights& weights) {
 	_B_c = 0;
 	for (Crag::CragNode n : _crag.nodes())
 		if (_bestEffort.selected(n))
-			_B_c += nodeCost(n, weights);
+			_B_c += _featureCosts.node[n];
 	for (Crag::CragEdge e : _crag.edges())
 		if (_bestEffort.selected(e))
-			_B_c += edgeCost(e, weights);
+			_B_c += _featureCosts.edge[e];
 	_constant += _B_c;
 
 	// L(w) = max_y <w,Φy'-Φy> + Δ(y',y)
@@ -168,23 +167,21 @@ CragSolverOracle::accumulateGradient(FeatureWeights& gradient) {
 
 	gradient.fill(0);
 
-	for (Crag::CragNode n : _crag.nodes()) {
-
-		int sign = _bestEffort.selected(n) - _mostViolatedSolution.selected(n);
-
-		const std::vector<double>& f = _nodeFeatures[n];
-		std::vector<double>&       g = gradient[_crag.type(n)];
-		for (unsigned int i = 0; i < f.size(); i++)
-			g[i] += f[i]*sign;
-	}
+	// the gradient is the product of the transposed feature matrices with 
+	// y' - y*
+	_nodeFeatures.accumulateAll(
+			[&](Crag::CragNode n) {
 
-	for (Crag::CragEdge e : _crag.edges()) {
+				return _bestEffort.selected(n) - _mostViolatedSolution.selected(n);
+			},
+			gradient,
+			_numThreads);
 
-		int sign = _bestEffort.selected(e) - _mostViolatedSolution.selected(e);
+	_edgeFeatures.accumulateAll(
+			[&](Crag::CragEdge e) {
 
-		const std::vector<double>& f = _edgeFeatures[e];
-		std::vector<double>&       g = gradient[_crag.type(e)];
-		for (unsigned int i = 0; i < f.size(); i++)
-			g[i] += f[i]*sign;
-	}
+				return _bestEffort.selected(e) - _mostViolatedSolution.selected(e);
+			},
+			gradient,
+			_numThreads);
 }
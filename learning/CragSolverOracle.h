@@ -2,6 +2,7 @@
 #define CANDIDATE_MC_LEARNING_CRAG_SOLVER_ORACLE_H__
 
 #include <crag/Crag.h>
+#include <crag/ParallelFor.h>
 #include <inference/CragSolverFactory.h>
 #include <features/NodeFeatures.h>
 #include <features/EdgeFeatures.h>
@@ -25,7 +26,8 @@ public:
 			const EdgeFeatures&     edgeFeatures,
 			const Loss&             loss,
 			const BestEffort&       bestEffort,
-			CragSolver::Parameters  parameters = CragSolver::Parameters()) :
+			CragSolver::Parameters  parameters = CragSolver::Parameters(),
+			int                     numThreads = 0) :
 		_crag(crag),
 		_volumes(volumes),
 		_nodeFeatures(nodeFeatures),
@@ -33,9 +35,11 @@ public:
 		_loss(loss),
 		_bestEffort(bestEffort),
 		_costs(_crag),
+		_featureCosts(_crag),
 		_mostViolatedSolution(_crag),
 		_mostViolatedSolver(CragSolverFactory::createSolver(crag, volumes, parameters)),
 		_currentBestSolver(CragSolverFactory::createSolver(crag, volumes, parameters)),
+		_numThreads(getNumThreads(numThreads)),
 		_iteration(0) {}
 
 	void valueGradientP(
@@ -49,35 +53,6 @@ private:
 
 	void accumulateGradient(FeatureWeights& gradient);
 
-	inline double nodeCost(Crag::CragNode n, const FeatureWeights& weights) const {
-
-		return dot(weights[_crag.type(n)], _nodeFeatures[n]);
-	}
-
-	inline double edgeCost(Crag::CragEdge e, const FeatureWeights& weights) const {
-
-		return dot(weights[_crag.type(e)], _edgeFeatures[e]);
-	}
-
-	inline double dot(const std::vector<double>& a, const std::vector<double>& b) const {
-
-		UTIL_ASSERT_REL(a.size(), ==, b.size());
-
-		double sum = 0;
-		auto ba = a.begin();
-		auto ea = a.end();
-		auto bb = b.begin();
-
-		while (ba != ea) {
-
-			sum += (*ba)*(*bb);
-			ba++;
-			bb++;
-		}
-
-		return sum;
-	}
-
 	const Crag&         _crag;
 	const CragVolumes&  _volumes;
 	const NodeFeatures& _nodeFeatures;
@@ -87,6 +62,9 @@ private:
 
 	Costs _costs;
 
+	// the costs wΦ of the current weights
+	Costs _featureCosts;
+
 	// constant to be added to the optimal value of the multi-cut solution
 	double _constant;
 
@@ -95,9 +73,15 @@ private:
 
 	CragSolution _mostViolatedSolution;
 
+	// kept across iterations, only the costs change: the cycle constraints 
+	// found for earlier weights stay valid and the previous solution is used 
+	// as a start for the next solve
 	std::unique_ptr<CragSolver> _mostViolatedSolver;
 	std::unique_ptr<CragSolver> _currentBestSolver;
 
+	// the number of threads to compute costs and gradients with
+	unsigned int _numThreads;
+
 	int _iteration;
 };
 
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <unordered_map>
+#include <crag/ParallelFor.h>
+#include <util/Logger.h>
+#include "GroundTruthOverlaps.h"
+
+logger::LogChannel groundtruthoverlapslog("groundtruthoverlapslog", "[GroundTruthOverlaps] ");
+
+namespace {
+
+// sort overlaps by label and add the sizes of equal labels
+void
+reduceOverlaps(std::vector<GroundTruthOverlaps::Overlap>& overlaps) {
+
+	std::sort(
+			overlaps.begin(),
+			overlaps.end(),
+			[](const GroundTruthOverlaps::Overlap& a, const GroundTruthOverlaps::Overlap& b) {
+
+				return a.label < b.label;
+			});
+
+	std::size_t j = 0;
+	for (std::size_t i = 0; i < overlaps.size(); i++) {
+
+		if (j > 0 && overlaps[j - 1].label == overlaps[i].label)
+			overlaps[j - 1].size += overlaps[i].size;
+		else
+			overlaps[j++] = overlaps[i];
+	}
+
+	overlaps.resize(j, GroundTruthOverlaps::Overlap(0, 0));
+	overlaps.shrink_to_fit();
+}
+
+} // anonymous namespace
+
+std::size_t
+GroundTruthOverlaps::Overlaps::get(int label) const {
+
+	const Overlap* overlap = std::lower_bound(
+			_begin,
+			_end,
+			label,
+			[](const Overlap& o, int label) { return o.label < label; });
+
+	if (overlap == _end || overlap->label != label)
+		return 0;
+
+	return overlap->size;
+}
+
+std::size_t
+GroundTruthOverlaps::Overlaps::numVoxels() const {
+
+	std::size_t size = 0;
+	for (const Overlap& overlap : *this)
+		size += overlap.size;
+
+	return size;
+}
+
+GroundTruthOverlaps::GroundTruthOverlaps(
+		const Crag&                crag,
+		const CragVolumes&         volumes,
+		const ExplicitVolume<int>& groundTruth,
+		int                        numThreads) :
+	_crag(crag),
+	_overlaps(crag) {
+
+	// group the candidates by level, such that each level only depends on the 
+	// ones below
+
+	std::vector<std::vector<Crag::CragNode>> levels;
+
+	for (Crag::CragNode n : crag.nodes()) {
+
+		if (crag.type(n) == Crag::NoAssignmentNode)
+			continue;
+
+		std::size_t level = crag.getLevel(n);
+		if (levels.size() <= level)
+			levels.resize(level + 1);
+
+		levels[level].push_back(n);
+	}
+
+	if (levels.empty())
+		return;
+
+	LOG_DEBUG(groundtruthoverlapslog)
+			<< "computing ground-truth overlaps of "
+			<< levels[0].size() << " leaf nodes" << std::endl;
+
+	computeLeafOverlaps(volumes, groundTruth, levels[0], getNumThreads(numThreads));
+
+	LOG_DEBUG(groundtruthoverlapslog)
+			<< "adding overlaps of " << levels.size() - 1
+			<< " higher levels" << std::endl;
+
+	for (std::size_t level = 1; level < levels.size(); level++)
+		parallelFor(
+				levels[level].size(),
+				getNumThreads(numThreads),
+				[&](std::size_t i) {
+
+					addOverlaps(levels[level][i]);
+				},
+				16);
+}
+
+void
+GroundTruthOverlaps::computeLeafOverlaps(
+		const CragVolumes&                 volumes,
+		const ExplicitVolume<int>&         groundTruth,
+		const std::vector<Crag::CragNode>& leafNodes,
+		unsigned int                       numThreads) {
+
+	parallelFor(
+			leafNodes.size(),
+			numThreads,
+			[&](std::size_t i) {
+
+				Crag::CragNode n = leafNodes[i];
+
+				std::shared_ptr<const SparseCragVolume> region = volumes.getSparseVolume(n);
+
+				util::point<unsigned int, 3> offset =
+						(region->getOffset() - groundTruth.getOffset())/
+						groundTruth.getResolution();
+
+				std::unordered_map<int, std::size_t> sizes;
+
+				// neighboring voxels mostly have the same label, count them 
+				// before touching the hash map
+				int         label = 0;
+				std::size_t count = 0;
+
+				region->forEachVoxel([&](unsigned int x, unsigned int y, unsigned int z) {
+
+					int gtLabel = groundTruth[offset + util::point<unsigned int, 3>(x, y, z)];
+
+					if (gtLabel != label && count > 0) {
+
+						sizes[label] += count;
+						count = 0;
+					}
+
+					label = gtLabel;
+					count++;
+				});
+
+				if (count > 0)
+					sizes[label] += count;
+
+				std::vector<Overlap>& overlaps = _overlaps[n];
+				overlaps.reserve(sizes.size());
+				for (const auto& p : sizes)
+					overlaps.push_back(Overlap(p.first, p.second));
+
+				reduceOverlaps(overlaps);
+			});
+}
+
+void
+GroundTruthOverlaps::addOverlaps(Crag::CragNode n) {
+
+	std::vector<Overlap>& overlaps = _overlaps[n];
+
+	// if the children partition the leaf nodes of n, add their overlaps, 
+	// otherwise the ones of the leaf nodes
+
+	std::size_t numChildLeafNodes = 0;
+	for (Crag::CragArc a : _crag.inArcs(n))
+		numChildLeafNodes += _crag.leafNodes(a.source()).size();
+
+	if (numChildLeafNodes == _crag.leafNodes(n).size()) {
+
+		for (Crag::CragArc a : _crag.inArcs(n)) {
+
+			const std::vector<Overlap>& childOverlaps = _overlaps[a.source()];
+			overlaps.insert(overlaps.end(), childOverlaps.begin(), childOverlaps.end());
+		}
+
+	} else {
+
+		for (Crag::CragNode l : _crag.leafNodes(n)) {
+
+			const std::vector<Overlap>& leafOverlaps = _overlaps[l];
+			overlaps.insert(overlaps.end(), leafOverlaps.begin(), leafOverlaps.end());
+		}
+	}
+
+	reduceOverlaps(overlaps);
+}
@@ -0,0 +1,101 @@
+#ifndef CANDIDATE_MC_LEARNING_GROUND_TRUTH_OVERLAPS_H__
+#define CANDIDATE_MC_LEARNING_GROUND_TRUTH_OVERLAPS_H__
+
+#include <vector>
+#include <crag/Crag.h>
+#include <crag/CragVolumes.h>
+#include <imageprocessing/ExplicitVolume.h>
+
+/**
+ * Sparse contingency table between the candidates of a CRAG and the regions of 
+ * a ground-truth volume, i.e., the number of voxels each candidate shares with 
+ * each ground-truth label (including the background label 0).
+ *
+ * The voxels of the leaf candidates are visited once, in parallel. The overlaps 
+ * of higher candidates are obtained by adding the overlaps of their children 
+ * (or, if the children share leaf nodes, of their leaf nodes). Each candidate 
+ * stores its overlaps as an array sorted by label.
+ */
+class GroundTruthOverlaps {
+
+public:
+
+	/**
+	 * The number of voxels a candidate shares with a ground-truth label.
+	 */
+	struct Overlap {
+
+		Overlap(int label_, std::size_t size_) : label(label_), size(size_) {}
+
+		int         label;
+		std::size_t size;
+	};
+
+	/**
+	 * The overlaps of one candidate, sorted by label.
+	 */
+	class Overlaps {
+
+	public:
+
+		Overlaps(const std::vector<Overlap>& overlaps) :
+			_begin(overlaps.data()),
+			_end(overlaps.data() + overlaps.size()) {}
+
+		const Overlap* begin() const { return _begin; }
+		const Overlap* end() const { return _end; }
+
+		std::size_t size() const { return _end - _begin; }
+		bool empty() const { return _begin == _end; }
+
+		/**
+		 * Get the overlap with the given label, 0 if there is none.
+		 */
+		std::size_t get(int label) const;
+
+		/**
+		 * The number of voxels of the candidate.
+		 */
+		std::size_t numVoxels() const;
+
+	private:
+
+		const Overlap* _begin;
+		const Overlap* _end;
+	};
+
+	/**
+	 * Compute the overlaps of all candidates with the ground truth.
+	 *
+	 * @param numThreads
+	 *              The number of threads to use. Values smaller than 1 use
+	 *              one thread per hardware thread.
+	 */
+	GroundTruthOverlaps(
+			const Crag&                crag,
+			const CragVolumes&         volumes,
+			const ExplicitVolume<int>& groundTruth,
+			int                        numThreads = 0);
+
+	/**
+	 * Get the overlaps of a candidate. NoAssignmentNodes don't have overlaps.
+	 */
+	Overlaps operator[](Crag::CragNode n) const { return Overlaps(_overlaps[n]); }
+
+private:
+
+	void computeLeafOverlaps(
+			const CragVolumes&                 volumes,
+			const ExplicitVolume<int>&         groundTruth,
+			const std::vector<Crag::CragNode>& leafNodes,
+			unsigned int                       numThreads);
+
+	void addOverlaps(Crag::CragNode n);
+
+	const Crag& _crag;
+
+	Crag::NodeMap<std::vector<Overlap>> _overlaps;
+};
+
+#endif // CANDIDATE_MC_LEARNING_GROUND_TRUTH_OVERLAPS_H__
+
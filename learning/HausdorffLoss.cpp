@@ -1,30 +1,90 @@
-#include <io/CragImport.h>
+#include <crag/BoundingBoxIndex.h>
+#include <crag/ParallelFor.h>
 #include <features/Diameter.h>
+#include <util/Logger.h>
+#include <util/timing.h>
 #include "HausdorffLoss.h"
 
+logger::LogChannel hausdorfflosslog("hausdorfflosslog", "[HausdorffLoss] ");
+
 HausdorffLoss::HausdorffLoss(
 		const Crag&        crag,
 		const CragVolumes& volumes,
 		const Crag&        gtCrag,
 		const CragVolumes& gtVolumes,
-		double maxHausdorffDistance) :
+		double maxHausdorffDistance,
+		int    numThreads) :
 	Loss(crag) {
 
-	Diameter          diameter;
+	UTIL_TIME_METHOD;
+
 	HausdorffDistance hausdorff(maxHausdorffDistance);
+	BoundingBoxIndex  gtIndex(gtCrag, gtVolumes);
+
+	// the distance maps of the ground-truth regions, by id (the volumes might 
+	// get re-materialized, so their addresses can't be used)
+	DistanceMapCache<int> gtDistanceMaps(hausdorff.getMaxCacheBytes());
+
+	std::vector<Crag::CragNode> nodes;
+	for (Crag::CragNode n : crag.nodes())
+		nodes.push_back(n);
+
+	parallelFor(
+			nodes.size(),
+			getNumThreads(numThreads),
+			[&](std::size_t i) {
+
+				Crag::CragNode n = nodes[i];
+
+				Diameter diameter;
+
+				std::shared_ptr<CragVolume> volume = volumes[n];
+
+				double loss = diameter(*volume);
 
-	for (Crag::CragNode n : crag.nodes()) {
+				std::vector<Crag::CragNode> gtCandidates =
+						gtIndex.withinDistance(
+								volume->getBoundingBox().project<2>(),
+								maxHausdorffDistance);
 
-		double loss = diameter(*volumes[n]);
+				// all other ground-truth regions are at least 
+				// maxHausdorffDistance away
+				if (gtCandidates.size() < gtIndex.size())
+					loss = std::min(loss, maxHausdorffDistance);
 
-		for (Crag::CragNode gt : gtCrag.nodes()) {
+				// computed once we need it
+				std::shared_ptr<const DistanceMap> distances;
 
-			double i_j, j_i;
-			hausdorff(*volumes[n], *gtVolumes[gt], i_j, j_i);
+				for (Crag::CragNode gt : gtCandidates) {
 
-			loss = std::min(loss, std::max(i_j, j_i));
-		}
+					std::shared_ptr<CragVolume> gtVolume = gtVolumes[gt];
 
-		node[n] = loss;
-	}
+					std::shared_ptr<const DistanceMap> gtDistances =
+							gtDistanceMaps.get(
+									gtCrag.id(gt),
+									[&]{ return hausdorff.computeDistanceMap(*gtVolume); });
+
+					double i_j = hausdorff.distance(*volume, *gtDistances);
+
+					// the other direction can't make it better
+					if (i_j >= loss)
+						continue;
+
+					if (!distances)
+						distances = hausdorff.computeDistanceMap(*volume);
+
+					double j_i = hausdorff.distance(*gtVolume, *distances);
+
+					loss = std::min(loss, std::max(i_j, j_i));
+				}
+
+				node[n] = loss;
+
+				LOG_ALL(hausdorfflosslog)
+						<< "loss of node " << crag.id(n) << " with "
+						<< gtCandidates.size() << " close ground-truth regions: "
+						<< loss << std::endl;
+			},
+			4);
 }
+
@@ -8,17 +8,28 @@
 /**
  * Loss that reflects the minimal hausdorff distance of each region with the 
  * ground truth.
+ *
+ * Only ground-truth regions with a bounding box within the maximal Hausdorff 
+ * distance of a candidate are considered, all others are known to be at least 
+ * that far away.
  */
 class HausdorffLoss : public Loss {
 
 public:
 
+	/**
+	 * @param numThreads
+	 *              The number of threads to compute the loss of the 
+	 *              candidates with. Values smaller than 1 use one thread per 
+	 *              hardware thread.
+	 */
 	HausdorffLoss(
 			const Crag&        crag,
 			const CragVolumes& volumes,
 			const Crag&        gtCrag,
 			const CragVolumes& gtVolumes,
-			double maxHausdorffDistance);
+			double maxHausdorffDistance,
+			int    numThreads = 0);
 };
 
 #endif // CANDIDATE_MC_LEARNING_HAUSDORFF_LOSS_H__
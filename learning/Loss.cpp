@@ -1,13 +1,65 @@
+#include <algorithm>
 #include "Loss.h"
 #include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
 
 logger::LogChannel losslog("losslog", "[Loss] ");
 
+util::ProgramOption optionLossNormalization(
+		util::_module           = "loss",
+		util::_long_name        = "normalization",
+		util::_description_text = "How to find the range of the loss for normalization: 'bounds' to bound it from the "
+		                          "node and edge values and the subset trees of the CRAG (fast, but the normalized "
+		                          "loss might not reach 0 or 1, and looser if the subset graph is not a forest), or 'exact' to minimize and maximize the loss with two "
+		                          "multi-cut solves.",
+		util::_default_value    = "bounds");
+
 void
 Loss::normalize(const Crag& crag, const MultiCutSolver::Parameters& params) {
 
 	double min, max;
 
+	if (optionLossNormalization.as<std::string>() == "exact")
+		findRange(crag, params, min, max);
+	else if (optionLossNormalization.as<std::string>() == "bounds")
+		findBounds(crag, params, min, max);
+	else
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"unknown loss normalization " << optionLossNormalization.as<std::string>());
+
+	normalize(crag, min, max);
+}
+
+void
+Loss::normalize(const Crag& crag, double min, double max) {
+
+	// All energies are between E(y^min) and E(y^max). We want E(y^min) to be 
+	// zero, and E(y^max) to be 1. Therefore, we subtract min from each E(y) and 
+	// scale it with 1.0/(max - min):
+	//
+	//  (E(y) + offset)*scale
+	//
+	//           = ([sum_i E(y_i)] + offset)*scale
+	//           = ([sum_i E(y_i)]*scale + offset*scale)
+	//
+	// -> We scale each loss by scale, and add offset*scale to the constant.
+
+	double offset = -min;
+	double scale  = 1.0/(max - min);
+
+	for (Crag::NodeIt n(crag); n != lemon::INVALID; ++n)
+		node[n] *= scale;
+	for (Crag::EdgeIt e(crag); e != lemon::INVALID; ++e)
+		edge[e] *= scale;
+
+	constant += offset*scale;
+}
+
+void
+Loss::findRange(const Crag& crag, const MultiCutSolver::Parameters& params, double& min, double& max) const {
+
 	{
 		LOG_DEBUG(losslog) << "searching for minimal loss value..." << std::endl;
 
@@ -34,26 +86,131 @@ Loss::normalize(const Crag& crag, const MultiCutSolver::Parameters& params) {
 
 		LOG_DEBUG(losslog) << "maximal value is " << max << std::endl;
 	}
+}
 
-	// All energies are between E(y^min) and E(y^max). We want E(y^min) to be 
-	// zero, and E(y^max) to be 1. Therefore, we subtract min from each E(y) and 
-	// scale it with 1.0/(max - min):
-	//
-	//  (E(y) + offset)*scale
-	//
-	//           = ([sum_i E(y_i)] + offset)*scale
-	//           = ([sum_i E(y_i)]*scale + offset*scale)
-	//
-	// -> We scale each loss by scale, and add offset*scale to the constant.
+void
+Loss::findBounds(const Crag& crag, const MultiCutSolver::Parameters& params, double& lower, double& upper) const {
 
-	double offset = -min;
-	double scale  = 1.0/(max - min);
+	lower = 0;
+	upper = 0;
 
-	for (Crag::NodeIt n(crag); n != lemon::INVALID; ++n)
-		node[n] *= scale;
-	for (Crag::EdgeIt e(crag); e != lemon::INVALID; ++e)
-		edge[e] *= scale;
+	// Without constraints, each node and edge can be selected independently. 
+	// This is also used as a looser bound if the subset graph is not a forest 
+	// (as in stacked CRAGs, where a slice node is part of several assignment 
+	// nodes), since the subtree bounds below assume that the subtrees of 
+	// different nodes are disjoint.
+	if (params.noConstraints || !crag.isForest()) {
 
-	constant += offset*scale;
-}
+		if (!params.noConstraints)
+			LOG_USER(losslog)
+					<< "subset graph is not a forest, bounding the loss by the "
+					<< "unconstrained range" << std::endl;
+
+		for (Crag::CragNode n : crag.nodes()) {
+
+			lower += std::min(node[n], 0.0);
+			upper += std::max(node[n], 0.0);
+		}
+
+		for (Crag::CragEdge e : crag.edges()) {
+
+			lower += std::min(edge[e], 0.0);
+			upper += std::max(edge[e], 0.0);
+		}
+
+		return;
+	}
+
+	// An edge can only be selected if both its nodes are selected, i.e., 
+	// y_e ≤ ½(y_u + y_v). Hence, adding half of the positive (negative) value 
+	// of each edge to its nodes gives an upper (lower) bound on the value of 
+	// any solution, considering the nodes only.
+	Crag::NodeMap<double> nodeLower(crag);
+	Crag::NodeMap<double> nodeUpper(crag);
+
+	for (Crag::CragNode n : crag.nodes()) {
+
+		nodeLower[n] = node[n];
+		nodeUpper[n] = node[n];
+	}
+
+	for (Crag::CragEdge e : crag.edges()) {
 
+		double half = 0.5*edge[e];
+
+		if (half < 0) {
+
+			nodeLower[e.u()] += half;
+			nodeLower[e.v()] += half;
+
+		} else {
+
+			nodeUpper[e.u()] += half;
+			nodeUpper[e.v()] += half;
+		}
+	}
+
+	// The tree-path constraints allow at most (exactly, if 
+	// forceExplanation) one selected node on each root-to-leaf path. The best 
+	// selection in the subtree of n is either n itself, or the best 
+	// selections in the subtrees of its children. Visit the nodes by level, 
+	// such that the children of a node are done before the node.
+
+	std::vector<Crag::CragNode> nodes;
+	for (Crag::CragNode n : crag.nodes())
+		nodes.push_back(n);
+
+	std::stable_sort(
+			nodes.begin(),
+			nodes.end(),
+			[&crag](Crag::CragNode a, Crag::CragNode b) {
+
+				return crag.getLevel(a) < crag.getLevel(b);
+			});
+
+	// the bounds of the best selections in the subtrees
+	Crag::NodeMap<double> subtreeLower(crag);
+	Crag::NodeMap<double> subtreeUpper(crag);
+
+	for (Crag::CragNode n : nodes) {
+
+		if (crag.isLeafNode(n)) {
+
+			if (params.forceExplanation) {
+
+				subtreeLower[n] = nodeLower[n];
+				subtreeUpper[n] = nodeUpper[n];
+
+			} else {
+
+				// selecting nothing is an option
+				subtreeLower[n] = std::min(nodeLower[n], 0.0);
+				subtreeUpper[n] = std::max(nodeUpper[n], 0.0);
+			}
+
+		} else {
+
+			double childrenLower = 0;
+			double childrenUpper = 0;
+
+			for (Crag::CragArc a : crag.inArcs(n)) {
+
+				childrenLower += subtreeLower[a.source()];
+				childrenUpper += subtreeUpper[a.source()];
+			}
+
+			subtreeLower[n] = std::min(nodeLower[n], childrenLower);
+			subtreeUpper[n] = std::max(nodeUpper[n], childrenUpper);
+		}
+
+		if (crag.isRootNode(n)) {
+
+			lower += subtreeLower[n];
+			upper += subtreeUpper[n];
+		}
+	}
+
+	LOG_DEBUG(losslog)
+			<< "loss values are between " << lower
+			<< " and " << upper << std::endl;
+}
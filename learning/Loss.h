@@ -17,11 +17,37 @@ public:
 
 	/**
 	 * Normalize the node and edge values, such that the loss is always between 
-	 * 0 and 1. For that, the loss is minimized and maximized on the given CRAG, 
-	 * with the given multi-cut parameters.
+	 * 0 and 1. Depending on the program option loss.normalization, the range 
+	 * of the loss is either bounded with findBounds() (the default), or found 
+	 * exactly with findRange().
 	 */
 	void normalize(const Crag& crag, const MultiCutSolver::Parameters& parameters);
 
+	/**
+	 * Scale the node and edge values and change the constant, such that loss 
+	 * values (without the constant) between min and max are mapped to [0,1].
+	 */
+	void normalize(const Crag& crag, double min, double max);
+
+	/**
+	 * Find the minimal and maximal value of the loss (without the constant) 
+	 * by minimizing and maximizing it on the given CRAG, with the given 
+	 * multi-cut parameters.
+	 */
+	void findRange(const Crag& crag, const MultiCutSolver::Parameters& parameters, double& min, double& max) const;
+
+	/**
+	 * Find a lower bound on the minimal and an upper bound on the maximal 
+	 * value of the loss (without the constant) without solving a multi-cut.  
+	 * The bounds respect the tree-path constraints of the given multi-cut 
+	 * parameters, but not the cycle constraints: The value of each edge is 
+	 * attributed half to each of its nodes (an edge can only be selected 
+	 * together with its nodes), and the best selection of nodes is found with 
+	 * dynamic programming over the subset trees of the CRAG. Without 
+	 * constraints, the bounds are exact.
+	 */
+	void findBounds(const Crag& crag, const MultiCutSolver::Parameters& parameters, double& lower, double& upper) const;
+
 	double constant;
 };
 
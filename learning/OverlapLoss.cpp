@@ -17,11 +17,15 @@ OverlapLoss::OverlapLoss(
 		const Crag&                crag,
 		const CragVolumes&         volumes,
 		const ExplicitVolume<int>& groundTruth) :
-	Loss(crag),
-	_candidateSizes(crag),
-	_overlaps(crag) {
+	OverlapLoss(crag, GroundTruthOverlaps(crag, volumes, groundTruth), groundTruth) {}
 
-	computeSizesAndOverlaps(crag, volumes, groundTruth);
+OverlapLoss::OverlapLoss(
+		const Crag&                crag,
+		const GroundTruthOverlaps& overlaps,
+		const ExplicitVolume<int>& groundTruth) :
+	Loss(crag) {
+
+	computeGroundTruthSizes(groundTruth);
 
 	// For each candidate i, get the gt region j with maximal overlap and set
 	//
@@ -49,16 +53,22 @@ OverlapLoss::OverlapLoss(
 
 		LOG_ALL(overlaplosslog) << "computing loss for node " << crag.id(i) << std::endl;
 
-		int size_i = _candidateSizes[i];
+		GroundTruthOverlaps::Overlaps overlaps_i = overlaps[i];
+
+		int size_i = overlaps_i.numVoxels();
 
 		// find most overlapping ground truth region
 		int bestGtSize = 0;
 		int maxOverlap = 0;
 
-		for (auto& p : _overlaps[i]) {
+		for (const GroundTruthOverlaps::Overlap& p : overlaps_i) {
+
+			int gtLabel = p.label;
+			int overlap = p.size;
+
+			if (gtLabel == 0)
+				continue;
 
-			int gtLabel = p.first;
-			int overlap = p.second;
 			int size_j  = _gtSizes[gtLabel];
 
 			LOG_ALL(overlaplosslog) << "\toverlap with  gt region " << gtLabel << ": " << overlap << std::endl;
@@ -80,49 +90,10 @@ OverlapLoss::OverlapLoss(
 }
 
 void
-OverlapLoss::computeSizesAndOverlaps(
-		const Crag& crag,
-		const CragVolumes& volumes,
-		const ExplicitVolume<int>& groundTruth) {
+OverlapLoss::computeGroundTruthSizes(const ExplicitVolume<int>& groundTruth) {
 
-	// ground truth sizes
 	_gtSizes.clear();
 	for (int l : groundTruth.data())
 		if (l > 0)
 			_gtSizes[l]++;
-
-	// candidate sizes and overlap with ground truth regions
-	for (Crag::CragNode n : crag.nodes()) {
-
-		_candidateSizes[n] = 0;
-
-		if (crag.type(n) == Crag::NoAssignmentNode)
-			continue;
-
-		const CragVolume& region = *volumes[n];
-
-		util::point<unsigned int, 3> offset =
-				(region.getOffset() - groundTruth.getOffset())/
-				groundTruth.getResolution();
-
-		LOG_ALL(overlaplosslog) << "offset into ground-truth image: " << offset << std::endl;
-
-		for (unsigned int z = 0; z < region.getDiscreteBoundingBox().depth();  z++)
-		for (unsigned int y = 0; y < region.getDiscreteBoundingBox().height(); y++)
-		for (unsigned int x = 0; x < region.getDiscreteBoundingBox().width();  x++) {
-
-			if (!region.data()(x, y, z))
-				continue;
-
-			_candidateSizes[n]++;
-
-			int gtLabel = groundTruth[offset + util::point<unsigned int, 3>(x, y, z)];
-
-			if (gtLabel == 0)
-				continue;
-
-			_overlaps[n][gtLabel]++;
-		}
-	}
 }
-
@@ -3,6 +3,7 @@
 
 #include <imageprocessing/ExplicitVolume.h>
 #include <learning/Loss.h>
+#include "GroundTruthOverlaps.h"
 
 /**
  * Simple overlap-based loss for candidates. The score for selecting a candidate 
@@ -22,17 +23,19 @@ public:
 			const CragVolumes&         volumes,
 			const ExplicitVolume<int>& groundTruth);
 
+	/**
+	 * Create an overlap loss from precomputed ground-truth overlaps.
+	 */
+	OverlapLoss(
+			const Crag&                crag,
+			const GroundTruthOverlaps& overlaps,
+			const ExplicitVolume<int>& groundTruth);
+
 private:
 
-	void computeSizesAndOverlaps(
-			const Crag& crag,
-			const CragVolumes& volumes,
-			const ExplicitVolume<int>& groundTruth);
+	void computeGroundTruthSizes(const ExplicitVolume<int>& groundTruth);
 
 	std::map<int, int> _gtSizes;
-	Crag::NodeMap<int> _candidateSizes;
-
-	Crag::NodeMap<std::map<int, int>> _overlaps;
 };
 
 #endif // CANDIDATE_MC_LEARNING_OVERLAP_LOSS_H__
@@ -25,37 +25,29 @@ RandLoss::RandLoss(
 		const Crag&                crag,
 		const CragVolumes&         volumes,
 		const ExplicitVolume<int>& groundTruth) :
-	Loss(crag),
-	_overlaps(crag) {
+	RandLoss(crag, GroundTruthOverlaps(crag, volumes, groundTruth)) {}
+
+RandLoss::RandLoss(
+		const Crag&                crag,
+		const GroundTruthOverlaps& overlaps) :
+	Loss(crag) {
 
 	bool balance = optionBalanceRandLoss;
 	bool restrictToLeaves = optionRestrictRandLossToLeaves;
 
-	LOG_DEBUG(randlosslog) << "getting candidate overlaps..." << std::endl;
-
-	// annotate all nodes with the max overlap area to any gt label
-	for (Crag::NodeIt n(crag); n != lemon::INVALID; ++n)
-		if (Crag::SubsetOutArcIt(crag.getSubsetGraph(), crag.toSubset(n)) == lemon::INVALID)
-			recurseRandLoss(crag, volumes, n, groundTruth);
-
 	LOG_DEBUG(randlosslog) << "setting foreground RAND loss" << std::endl;
 
 	// annotate nodes: loss is number of incorrectly merged pairs, minus number 
 	// of correctly merged pairs
-	for (Crag::NodeIt n(crag); n != lemon::INVALID; ++n) {
-
-		bool leafNode = (Crag::SubsetInArcIt(crag.getSubsetGraph(), crag.toSubset(n)) == lemon::INVALID);
+	for (Crag::CragNode n : crag.nodes()) {
 
-		if ((balance || restrictToLeaves) && !leafNode) {
+		if ((balance || restrictToLeaves) && !crag.isLeafNode(n)) {
 
 			node[n] = (restrictToLeaves ? std::numeric_limits<double>::infinity() : 0);
 			continue;
 		}
 
-		LOG_ALL(randlosslog)
-				<< "getting RAND score for node " << crag.id(n) << std::endl;
-
-		node[n] = foregroundNodeOverlapScore(_overlaps[n]) + backgroundNodeOverlapScore(_overlaps[n]);
+		node[n] = foregroundNodeOverlapScore(overlaps[n]) + backgroundNodeOverlapScore(overlaps[n]);
 
 		LOG_ALL(randlosslog)
 				<< "node " << crag.id(n)
@@ -64,33 +56,23 @@ RandLoss::RandLoss(
 	}
 
 	// annotate edges: set score of combined overlaps
-	for (Crag::EdgeIt e(crag); e != lemon::INVALID; ++e) {
-
-		Crag::Node u = crag.u(e);
-		Crag::Node v = crag.v(e);
+	for (Crag::CragEdge e : crag.edges()) {
 
-		bool leafEdge =
-				(Crag::SubsetInArcIt(crag.getSubsetGraph(), crag.toSubset(u)) == lemon::INVALID &&
-				 Crag::SubsetInArcIt(crag.getSubsetGraph(), crag.toSubset(v)) == lemon::INVALID);
-
-		if ((balance || restrictToLeaves) && !leafEdge) {
+		if ((balance || restrictToLeaves) && !crag.isLeafEdge(e)) {
 
 			// scores only for leaf edges
 			edge[e] = (restrictToLeaves ? std::numeric_limits<double>::infinity() : 0);
 			continue;
 		}
 
-		LOG_ALL(randlosslog)
-				<< "getting foreground RAND score for "
-				<< "edge (" << crag.id(crag.u(e))
-				<< ", "     << crag.id(crag.v(e)) << ")"
-				<< std::endl;
+		GroundTruthOverlaps::Overlaps overlapsU = overlaps[e.u()];
+		GroundTruthOverlaps::Overlaps overlapsV = overlaps[e.v()];
 
-		edge[e] = foregroundEdgeOverlapScore(_overlaps[u], _overlaps[v]) + backgroundEdgeOverlapScore(_overlaps[u], _overlaps[v]);
+		edge[e] = foregroundEdgeOverlapScore(overlapsU, overlapsV) + backgroundEdgeOverlapScore(overlapsU, overlapsV);
 
 		LOG_ALL(randlosslog)
-				<< "edge (" << crag.id(crag.u(e))
-				<< ", "     << crag.id(crag.v(e))
+				<< "edge (" << crag.id(e.u())
+				<< ", "     << crag.id(e.v())
 				<< "): "    << edge[e] << std::endl;
 	}
 
@@ -98,181 +80,99 @@ RandLoss::RandLoss(
 		propagateLeafValues(crag);
 }
 
-void
-RandLoss::recurseRandLoss(
-		const Crag&                crag,
-		const CragVolumes&         volumes,
-		const Crag::Node&          n,
-		const ExplicitVolume<int>& groundTruth) {
-
-	bool leafNode = (Crag::SubsetInArcIt(crag.getSubsetGraph(), crag.toSubset(n)) == lemon::INVALID);
-	if (leafNode) {
-
-		LOG_ALL(randlosslog) << "getting leaf overlap for node " << crag.id(n) << std::endl;
-		_overlaps[n] = leafOverlaps(*volumes[n], groundTruth);
-
-	} else {
-
-		// get overlaps with all gt regions
-		for (Crag::SubsetInArcIt a(crag.getSubsetGraph(), crag.toSubset(n)); a != lemon::INVALID; ++a) {
-
-			Crag::Node child = crag.toRag(crag.getSubsetGraph().source(a));
-
-			recurseRandLoss(crag, volumes, child, groundTruth);
-
-			for (auto p : _overlaps[child])
-				if (!_overlaps[n].count(p.first))
-					_overlaps[n][p.first] = p.second;
-				else
-					_overlaps[n][p.first] += p.second;
-		}
-	}
-}
-
-std::map<int, int>
-RandLoss::leafOverlaps(
-		const ExplicitVolume<bool>& region,
-		const ExplicitVolume<int>&  groundTruth) {
-
-	std::map<int, int> overlaps;
-
-	util::point<unsigned int, 3> offset =
-			(region.getOffset() - groundTruth.getOffset())/
-			groundTruth.getResolution();
-
-	LOG_ALL(randlosslog) << "offset into ground-truth image: " << offset << std::endl;
-
-	for (unsigned int z = 0; z < region.getDiscreteBoundingBox().depth();  z++)
-	for (unsigned int y = 0; y < region.getDiscreteBoundingBox().height(); y++)
-	for (unsigned int x = 0; x < region.getDiscreteBoundingBox().width();  x++) {
-
-		if (!region.data()(x, y, z))
-			continue;
-
-		int gtLabel = groundTruth[offset + util::point<unsigned int, 3>(x, y, z)];
-
-		if (!overlaps.count(gtLabel))
-			overlaps[gtLabel] = 1;
-		else
-			overlaps[gtLabel]++;
-	}
-
-	return overlaps;
-}
-
 double
 RandLoss::foregroundNodeOverlapScore(
-		const std::map<int, int>& overlaps) {
-
-	double score = 0;
-
-	// incorrectly merged pairs
-	for (auto p : overlaps) {
-		for (auto l : overlaps) {
+		const GroundTruthOverlaps::Overlaps& overlaps) {
 
-			int label1 = p.first;
-			int label2 = l.first;
+	// with o_l the overlap with foreground label l, the number of incorrectly 
+	// merged pairs is sum_{l<k} o_l*o_k = ((sum_l o_l)^2 - sum_l o_l^2)/2, the 
+	// number of correctly merged pairs is sum_l o_l*(o_l - 1)/2
 
-			if (label1 >= label2)
-				continue;
+	double sum        = 0;
+	double sumSquares = 0;
 
-			if (label1 == 0)
-				continue;
+	for (const GroundTruthOverlaps::Overlap& overlap : overlaps) {
 
-			double overlap1 = p.second;
-			double overlap2 = l.second;
-
-			LOG_ALL(randlosslog)
-					<< "incorrectly merges " << label1
-					<< " (" << overlap1 << " voxels) and " << label2
-					<< " (" << overlap2 << " voxels)" << std::endl;
-			LOG_ALL(randlosslog) << "+= " << overlap1*overlap2 << std::endl;
+		if (overlap.label == 0)
+			continue;
 
-			score += overlap1*overlap2;
-		}
+		sum        += overlap.size;
+		sumSquares += (double)overlap.size*overlap.size;
 	}
 
-	// correctly merged pairs
-	for (auto p : overlaps) {
+	double incorrect = (sum*sum - sumSquares)/2;
+	double correct   = (sumSquares - sum)/2;
 
-		int label = p.first;
-		if (label == 0)
-			continue;
-
-		double overlap = p.second;
-		score -= overlap*(overlap - 1)/2;
-
-		LOG_ALL(randlosslog)
-				<< "correctly merges " << label
-				<< " (" << overlap << " voxels)" << std::endl;
-		LOG_ALL(randlosslog) << "-= " << overlap*(overlap -1)/2 << std::endl;
-	}
+	LOG_ALL(randlosslog)
+			<< "incorrectly merges " << incorrect
+			<< " pairs, correctly merges " << correct
+			<< " pairs" << std::endl;
 
-	return score;
+	return incorrect - correct;
 }
 
 double
 RandLoss::foregroundEdgeOverlapScore(
-		const std::map<int, int>& overlapsU,
-		const std::map<int, int>& overlapsV) {
+		const GroundTruthOverlaps::Overlaps& overlapsU,
+		const GroundTruthOverlaps::Overlaps& overlapsV) {
 
-	double score = 0;
+	// all foreground pairs between u and v are incorrectly merged, except for 
+	// the ones with the same label
 
-	for (auto p : overlapsU) {
-		for (auto l : overlapsV) {
+	double sumU    = 0;
+	double sumV    = 0;
+	double correct = 0;
 
-			int label1 = p.first;
-			int label2 = l.first;
+	for (const GroundTruthOverlaps::Overlap& overlap : overlapsU)
+		if (overlap.label != 0)
+			sumU += overlap.size;
+	for (const GroundTruthOverlaps::Overlap& overlap : overlapsV)
+		if (overlap.label != 0)
+			sumV += overlap.size;
 
-			if (label1 == 0 || label2 == 0)
-				continue;
+	// both are sorted by label
+	const GroundTruthOverlaps::Overlap* u = overlapsU.begin();
+	const GroundTruthOverlaps::Overlap* v = overlapsV.begin();
 
-			double overlap1 = p.second;
-			double overlap2 = l.second;
+	while (u != overlapsU.end() && v != overlapsV.end()) {
 
-			// correctly merged
-			if (label1 == label2) {
+		if (u->label < v->label) {
 
-				score -= overlap1*overlap2;
+			u++;
 
-				LOG_ALL(randlosslog)
-						<< "correctly merges " << label1
-						<< " (" << overlap1 << " voxels) and " << label2
-						<< " (" << overlap2 << " voxels)" << std::endl;
-				LOG_ALL(randlosslog) << "-= " << overlap1*overlap2 << std::endl;
+		} else if (v->label < u->label) {
 
-			// incorrectly merged
-			} else {
+			v++;
 
-				score += overlap1*overlap2;
+		} else {
 
-				LOG_ALL(randlosslog)
-						<< "incorrectly merges " << label1
-						<< " (" << overlap1 << " voxels) and " << label2
-						<< " (" << overlap2 << " voxels)" << std::endl;
-				LOG_ALL(randlosslog) << "+= " << overlap1*overlap2 << std::endl;
-			}
+			if (u->label != 0)
+				correct += (double)u->size*v->size;
+			u++;
+			v++;
 		}
 	}
 
-	return score;
+	double incorrect = sumU*sumV - correct;
+
+	LOG_ALL(randlosslog)
+			<< "incorrectly merges " << incorrect
+			<< " pairs, correctly merges " << correct
+			<< " pairs" << std::endl;
+
+	return incorrect - correct;
 }
 
 double
 RandLoss::backgroundNodeOverlapScore(
-		const std::map<int, int>& overlaps) {
-
-	if (!overlaps.count(0))
-		return 0;
+		const GroundTruthOverlaps::Overlaps& overlaps) {
 
 	// overlap with background
-	double overlap = overlaps.at(0);
+	double overlap = overlaps.get(0);
 
 	LOG_ALL(randlosslog)
 			<< "overlaps with " << overlap
 			<< " background voxels" << std::endl;
-	LOG_ALL(randlosslog)
-			<< "+= " << pow(overlap, 2) << std::endl;
 
 	// reward is -overlap^2 of not selecting this node, i.e., punishment of 
 	// overlap^2
@@ -281,23 +181,17 @@ RandLoss::backgroundNodeOverlapScore(
 
 double
 RandLoss::backgroundEdgeOverlapScore(
-		const std::map<int, int>& overlapsU,
-		const std::map<int, int>& overlapsV) {
-
-	if (!overlapsU.count(0) || !overlapsV.count(0))
-		return 0;
+		const GroundTruthOverlaps::Overlaps& overlapsU,
+		const GroundTruthOverlaps::Overlaps& overlapsV) {
 
 	// overlap with background
-	double overlapU = overlapsU.at(0);
-	double overlapV = overlapsV.at(0);
+	double overlapU = overlapsU.get(0);
+	double overlapV = overlapsV.get(0);
 
 	LOG_ALL(randlosslog)
 			<< "adjacent nodes overlap with " << overlapU
 			<< " and " << overlapV
 			<< " background voxels" << std::endl;
-	LOG_ALL(randlosslog)
-			<< "+= " << 2*overlapU*overlapV << std::endl;
 
 	return 2*overlapU*overlapV;
 }
-
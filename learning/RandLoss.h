@@ -3,6 +3,7 @@
 
 #include <imageprocessing/ExplicitVolume.h>
 #include <learning/Loss.h>
+#include "GroundTruthOverlaps.h"
 
 /**
  * Loss that approximates the RAND index of a solution compared to the ground 
@@ -33,33 +34,28 @@ public:
 			const CragVolumes&         volumes,
 			const ExplicitVolume<int>& groundTruth);
 
-private:
-
-	void recurseRandLoss(
+	/**
+	 * Create a RAND loss from precomputed ground-truth overlaps.
+	 */
+	RandLoss(
 			const Crag&                crag,
-			const CragVolumes&         volumes,
-			const Crag::Node&          n,
-			const ExplicitVolume<int>& groundTruth);
+			const GroundTruthOverlaps& overlaps);
 
-	std::map<int, int> leafOverlaps(
-			const ExplicitVolume<bool>& region,
-			const ExplicitVolume<int>&  groundTruth);
+private:
 
 	double foregroundNodeOverlapScore(
-			const std::map<int, int>& overlaps);
+			const GroundTruthOverlaps::Overlaps& overlaps);
 
 	double foregroundEdgeOverlapScore(
-			const std::map<int, int>& overlapsU,
-			const std::map<int, int>& overlapsV);
+			const GroundTruthOverlaps::Overlaps& overlapsU,
+			const GroundTruthOverlaps::Overlaps& overlapsV);
 
 	double backgroundNodeOverlapScore(
-			const std::map<int, int>& overlaps);
+			const GroundTruthOverlaps::Overlaps& overlaps);
 
 	double backgroundEdgeOverlapScore(
-			const std::map<int, int>& overlapsU,
-			const std::map<int, int>& overlapsV);
-
-	Crag::NodeMap<std::map<int, int>> _overlaps;
+			const GroundTruthOverlaps::Overlaps& overlapsU,
+			const GroundTruthOverlaps::Overlaps& overlapsV);
 };
 
 #endif // CANDIDATE_MC_LEARNING_RAND_LOSS_H__
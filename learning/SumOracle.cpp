@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <numeric>
+#include <crag/ParallelFor.h>
+#include <util/Logger.h>
+#include <util/assert.h>
+#include <util/helpers.hpp>
+#include "SumOracle.h"
+
+logger::LogChannel sumoraclelog("sumoraclelog", "[SumOracle] ");
+
+SumOracle::SumOracle(const Parameters& parameters) :
+	_parameters(parameters),
+	_random(parameters.seed) {}
+
+void
+SumOracle::valueGradientP(
+			const FeatureWeights& weights,
+			double&               value,
+			FeatureWeights&       gradient) {
+
+	std::vector<std::size_t> batch = drawBatch();
+
+	sum(
+			batch,
+			weights,
+			value,
+			gradient,
+			[&](std::size_t i, double& v, FeatureWeights& g) {
+
+				_oracles[i]->valueGradientP(weights, v, g);
+			});
+
+	if (batch.size() == _oracles.size())
+		return;
+
+	// scale the batch to an estimate of the sum over all oracles
+	double scale = (double)_oracles.size()/batch.size();
+
+	std::vector<double> g = gradient.exportToVector();
+	for (double& v : g)
+		v *= scale;
+	gradient.importFromVector(g);
+
+	value *= scale;
+}
+
+void
+SumOracle::valueGradientR(
+			const FeatureWeights& weights,
+			double&               value,
+			FeatureWeights&       gradient) {
+
+	std::vector<std::size_t> all(_oracles.size());
+	std::iota(all.begin(), all.end(), 0);
+
+	sum(
+			all,
+			weights,
+			value,
+			gradient,
+			[&](std::size_t i, double& v, FeatureWeights& g) {
+
+				_oracles[i]->valueGradientR(weights, v, g);
+			});
+}
+
+bool
+SumOracle::haveConcavePart() const {
+
+	for (const Oracle<FeatureWeights>* oracle : _oracles)
+		if (oracle->haveConcavePart())
+			return true;
+
+	return false;
+}
+
+std::vector<std::size_t>
+SumOracle::drawBatch() {
+
+	std::vector<std::size_t> indices(_oracles.size());
+	std::iota(indices.begin(), indices.end(), 0);
+
+	if (_parameters.batchSize == 0 || _parameters.batchSize >= _oracles.size())
+		return indices;
+
+	std::shuffle(indices.begin(), indices.end(), _random);
+	indices.resize(_parameters.batchSize);
+	std::sort(indices.begin(), indices.end());
+
+	LOG_DEBUG(sumoraclelog) << "evaluating oracles " << indices << std::endl;
+
+	return indices;
+}
+
+template <typename F>
+void
+SumOracle::sum(
+		const std::vector<std::size_t>& oracles,
+		const FeatureWeights&           weights,
+		double&                         value,
+		FeatureWeights&                 gradient,
+		F                               evaluate) {
+
+	UTIL_ASSERT(!oracles.empty());
+
+	std::vector<double>         values(oracles.size(), 0);
+	std::vector<FeatureWeights> gradients(oracles.size(), weights);
+
+	parallelFor(
+			oracles.size(),
+			getNumThreads(_parameters.numThreads),
+			[&](std::size_t i) {
+
+				evaluate(oracles[i], values[i], gradients[i]);
+			});
+
+	// add in a fixed order, independent of the number of threads
+	value = 0;
+	std::vector<double> sum(weights.exportToVector().size(), 0);
+
+	for (std::size_t i = 0; i < oracles.size(); i++) {
+
+		value += values[i];
+
+		std::vector<double> g = gradients[i].exportToVector();
+		UTIL_ASSERT_REL(g.size(), ==, sum.size());
+
+		for (std::size_t k = 0; k < sum.size(); k++)
+			sum[k] += g[k];
+	}
+
+	gradient.importFromVector(sum);
+}
@@ -0,0 +1,89 @@
+#ifndef CANDIDATE_MC_LEARNING_SUM_ORACLE_H__
+#define CANDIDATE_MC_LEARNING_SUM_ORACLE_H__
+
+#include <random>
+#include <vector>
+#include <features/FeatureWeights.h>
+#include "Oracle.h"
+
+/**
+ * An oracle for the sum of the objectives of several other oracles, e.g., one 
+ * CragSolverOracle per training dataset. The oracles are evaluated 
+ * concurrently, and their values and gradients are added in the order in 
+ * which the oracles were added, such that the result does not depend on the 
+ * number of threads.
+ *
+ * In the stochastic mode, each call of valueGradientP() evaluates only a 
+ * random subset of batchSize oracles and scales the sum by numOracles/batchSize, 
+ * which is an unbiased estimate of the full sum. Note that the 
+ * BundleOptimizer assumes exact values and gradients, such that the stochastic 
+ * mode is better used with the GradientOptimizer.
+ */
+class SumOracle : public Oracle<FeatureWeights> {
+
+public:
+
+	struct Parameters {
+
+		Parameters() :
+			numThreads(0),
+			batchSize(0),
+			seed(0) {}
+
+		// the number of oracles to evaluate concurrently, values smaller than 
+		// 1 use one thread per hardware thread
+		int numThreads;
+
+		// the number of oracles to evaluate in each call of valueGradientP(), 
+		// 0 evaluates all of them
+		unsigned int batchSize;
+
+		// the seed for drawing the batches
+		unsigned int seed;
+	};
+
+	SumOracle(const Parameters& parameters = Parameters());
+
+	/**
+	 * Add an oracle to the sum. The oracle is not owned by this class and has 
+	 * to stay valid while this oracle is used.
+	 */
+	void add(Oracle<FeatureWeights>& oracle) { _oracles.push_back(&oracle); }
+
+	std::size_t size() const { return _oracles.size(); }
+
+	void valueGradientP(
+			const FeatureWeights& weights,
+			double&               value,
+			FeatureWeights&       gradient) override;
+
+	void valueGradientR(
+			const FeatureWeights& weights,
+			double&               value,
+			FeatureWeights&       gradient) override;
+
+	bool haveConcavePart() const override;
+
+private:
+
+	// the indices of the oracles to evaluate in the next call of 
+	// valueGradientP(), in increasing order
+	std::vector<std::size_t> drawBatch();
+
+	template <typename F>
+	void sum(
+			const std::vector<std::size_t>& oracles,
+			const FeatureWeights&           weights,
+			double&                         value,
+			FeatureWeights&                 gradient,
+			F                               evaluate);
+
+	Parameters _parameters;
+
+	std::vector<Oracle<FeatureWeights>*> _oracles;
+
+	std::mt19937 _random;
+};
+
+#endif // CANDIDATE_MC_LEARNING_SUM_ORACLE_H__
+
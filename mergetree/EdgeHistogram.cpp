@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <util/assert.h>
+#include "EdgeHistogram.h"
+
+EdgeHistogram::EdgeHistogram(std::vector<unsigned int>& bins) :
+	_size(bins.size()) {
+
+	std::sort(bins.begin(), bins.end());
+
+	for (unsigned int bin : bins)
+		if (!_bins.empty() && _bins.back().bin == bin)
+			_bins.back().count++;
+		else
+			_bins.push_back({bin, 1});
+
+	_bins.shrink_to_fit();
+}
+
+void
+EdgeHistogram::merge(const EdgeHistogram& other) {
+
+	if (other._bins.empty())
+		return;
+
+	std::vector<Bin> merged;
+	merged.reserve(_bins.size() + other._bins.size());
+
+	auto i = _bins.begin();
+	auto j = other._bins.begin();
+
+	while (i != _bins.end() || j != other._bins.end()) {
+
+		if (j == other._bins.end() || (i != _bins.end() && i->bin < j->bin)) {
+
+			merged.push_back(*i++);
+
+		} else if (i == _bins.end() || j->bin < i->bin) {
+
+			merged.push_back(*j++);
+
+		} else {
+
+			merged.push_back({i->bin, i->count + j->count});
+			i++;
+			j++;
+		}
+	}
+
+	merged.shrink_to_fit();
+
+	_bins.swap(merged);
+	_size += other._size;
+}
+
+unsigned int
+EdgeHistogram::rankBin(std::size_t rank, float& fraction) const {
+
+	UTIL_ASSERT_REL(rank, <, _size);
+
+	std::size_t before = 0;
+
+	for (const Bin& bin : _bins) {
+
+		if (rank < before + bin.count) {
+
+			fraction = (rank - before + 0.5)/bin.count;
+			return bin.bin;
+		}
+
+		before += bin.count;
+	}
+
+	UTIL_ASSERT(false);
+	return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef MULTI2CUT_MERGETREE_EDGE_HISTOGRAM_H__
+#define MULTI2CUT_MERGETREE_EDGE_HISTOGRAM_H__
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * A sparse histogram over the values of the grid edges of a region adjacency 
+ * edge. Only non-empty bins are stored. When two regions are merged, the 
+ * histograms of their edges to a common neighbor are merged as well, which 
+ * costs linear time in the number of non-empty bins, instead of the number of 
+ * grid edges.
+ */
+class EdgeHistogram {
+
+public:
+
+	/**
+	 * Create an empty histogram.
+	 */
+	EdgeHistogram() : _size(0) {}
+
+	/**
+	 * Create a histogram from the bins of a list of values. The list will be 
+	 * sorted.
+	 */
+	explicit EdgeHistogram(std::vector<unsigned int>& bins);
+
+	/**
+	 * Add the counts of another histogram to this one.
+	 */
+	void merge(const EdgeHistogram& other);
+
+	/**
+	 * The number of values in this histogram.
+	 */
+	std::size_t size() const { return _size; }
+
+	/**
+	 * Find the bin of the value with the given rank, i.e., the value that 
+	 * would be at position rank if all values were sorted.
+	 *
+	 * @param rank
+	 *              The rank of the value, smaller than size().
+	 * @param fraction
+	 *              Set to the relative position of the value within its bin, 
+	 *              in (0,1), assuming the values of a bin are evenly 
+	 *              distributed.
+	 */
+	unsigned int rankBin(std::size_t rank, float& fraction) const;
+
+private:
+
+	struct Bin {
+
+		unsigned int bin;
+		unsigned int count;
+	};
+
+	// the non-empty bins, sorted by bin
+	std::vector<Bin> _bins;
+
+	std::size_t _size;
+};
+
+#endif // MULTI2CUT_MERGETREE_EDGE_HISTOGRAM_H__
+
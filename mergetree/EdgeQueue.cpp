@@ -0,0 +1,99 @@
+#include <util/assert.h>
+#include "EdgeQueue.h"
+
+void
+EdgeQueue::push(int id, float priority) {
+
+	UTIL_ASSERT_REL(id, >=, 0);
+
+	if (id >= (int)_positions.size())
+		_positions.resize(id + 1, -1);
+
+	if (_positions[id] >= 0) {
+
+		std::size_t i = _positions[id];
+		float previous = _heap[i].priority;
+		_heap[i].priority = priority;
+
+		if (priority < previous)
+			up(i);
+		else
+			down(i);
+
+		return;
+	}
+
+	_heap.push_back({priority, id});
+	_positions[id] = _heap.size() - 1;
+	up(_heap.size() - 1);
+}
+
+void
+EdgeQueue::remove(int id) {
+
+	if (!contains(id))
+		return;
+
+	std::size_t i    = _positions[id];
+	std::size_t last = _heap.size() - 1;
+
+	if (i != last)
+		swap(i, last);
+
+	_heap.pop_back();
+	_positions[id] = -1;
+
+	// the former last entry takes the place of the removed one
+	if (i < _heap.size()) {
+
+		if (i > 0 && less(i, (i - 1)/2))
+			up(i);
+		else
+			down(i);
+	}
+}
+
+void
+EdgeQueue::swap(std::size_t i, std::size_t j) {
+
+	std::swap(_heap[i], _heap[j]);
+	_positions[_heap[i].id] = i;
+	_positions[_heap[j].id] = j;
+}
+
+void
+EdgeQueue::up(std::size_t i) {
+
+	while (i > 0) {
+
+		std::size_t parent = (i - 1)/2;
+
+		if (!less(i, parent))
+			break;
+
+		swap(i, parent);
+		i = parent;
+	}
+}
+
+void
+EdgeQueue::down(std::size_t i) {
+
+	while (true) {
+
+		std::size_t left     = 2*i + 1;
+		std::size_t right    = left + 1;
+		std::size_t smallest = i;
+
+		if (left < _heap.size() && less(left, smallest))
+			smallest = left;
+		if (right < _heap.size() && less(right, smallest))
+			smallest = right;
+
+		if (smallest == i)
+			break;
+
+		swap(i, smallest);
+		i = smallest;
+	}
+}
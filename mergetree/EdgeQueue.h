@@ -0,0 +1,85 @@
+#ifndef MULTI2CUT_MERGETREE_EDGE_QUEUE_H__
+#define MULTI2CUT_MERGETREE_EDGE_QUEUE_H__
+
+#include <vector>
+
+/**
+ * A priority queue of edge ids, that returns the edge with the smallest 
+ * priority first. The queue knows the position of each edge in its binary 
+ * heap, such that the priority of an edge can be changed and edges can be 
+ * removed. This keeps the queue as small as the number of edges that can 
+ * still be merged. Edges with equal priority are returned in increasing order 
+ * of their ids.
+ */
+class EdgeQueue {
+
+public:
+
+	/**
+	 * Add an edge with the given priority, or change the priority of the edge 
+	 * if it is already in the queue.
+	 */
+	void push(int id, float priority);
+
+	/**
+	 * Remove an edge from the queue. Does nothing if the edge is not in the 
+	 * queue.
+	 */
+	void remove(int id);
+
+	/**
+	 * Check whether an edge is in the queue.
+	 */
+	bool contains(int id) const {
+
+		return id >= 0 && id < (int)_positions.size() && _positions[id] >= 0;
+	}
+
+	/**
+	 * Get the edge with the smallest priority.
+	 */
+	int top() const { return _heap.front().id; }
+
+	/**
+	 * Get the priority of the edge returned by top().
+	 */
+	float topPriority() const { return _heap.front().priority; }
+
+	/**
+	 * Remove the edge with the smallest priority.
+	 */
+	void pop() { remove(top()); }
+
+	std::size_t size() const { return _heap.size(); }
+
+	bool empty() const { return _heap.empty(); }
+
+private:
+
+	struct Entry {
+
+		float priority;
+		int   id;
+	};
+
+	bool less(std::size_t i, std::size_t j) const {
+
+		return
+				_heap[i].priority < _heap[j].priority ||
+				(_heap[i].priority == _heap[j].priority && _heap[i].id < _heap[j].id);
+	}
+
+	void swap(std::size_t i, std::size_t j);
+
+	void up(std::size_t i);
+
+	void down(std::size_t i);
+
+	std::vector<Entry> _heap;
+
+	// the position of each edge in the heap, -1 if not contained
+	std::vector<int> _positions;
+};
+
+#endif // MULTI2CUT_MERGETREE_EDGE_QUEUE_H__
+
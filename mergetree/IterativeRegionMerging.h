@@ -6,8 +6,10 @@
 #include <util/Logger.h>
 #include <util/cont_map.hpp>
 #include <util/assert.h>
+#include <crag/ParallelFor.h>
 #include "NodeNumConverter.h"
 #include "EdgeNumConverter.h"
+#include "EdgeQueue.h"
 #include <vigra/multi_gridgraph.hxx>
 #include <vigra/multi_watersheds.hxx>
 #include <vigra/adjacency_list_graph.hxx>
@@ -36,6 +38,21 @@ struct GraphMapTypeTraits<MultiArrayView<3, int> > {
 } // namespace vigra
 
 
+/**
+ * Creates a merge tree by iteratively merging the two adjacent regions with 
+ * the smallest edge score.
+ *
+ * Scoring functions summarize the grid edges between two regions in an edge 
+ * statistics object, which is merged when regions are merged. They provide
+ *
+ *   EdgeStatistics edgeStatistics(const std::vector<GridGraphType::Edge>&) const
+ *   void mergeStatistics(EdgeStatistics& statistics, const EdgeStatistics& other) const
+ *   float operator()(const RagType::Edge&, const EdgeStatistics&)
+ *   void onMerge(const RagType::Edge&, const RagType::Node newRegion)
+ *
+ * The grid edges themselves are only kept until the initial statistics are 
+ * computed.
+ */
 template <int D>
 class IterativeRegionMerging {
 
@@ -47,7 +64,15 @@ public:
 	IterativeRegionMerging(vigra::MultiArrayView<D, int> initialRegions);
 
 	/**
-	 * Store the initial (before calling createMergeTree) or final RAG.
+	 * Set the number of threads to compute the initial edge statistics with. 
+	 * Values smaller than 1 use one thread per hardware thread.
+	 */
+	void setNumThreads(int numThreads) { _numThreads = numThreads; }
+
+	/**
+	 * Store the initial (before calling createMergeTree) or final RAG. For the 
+	 * final RAG, the scores of the edges at the time they were created are 
+	 * stored.
 	 */
 	template <typename ScoringFunction>
 	void storeRag(std::string filename, ScoringFunction& scoringFunction);
@@ -64,47 +89,31 @@ public:
 
 private:
 
-	typedef util::cont_map<RagType::Edge, std::vector<typename GridGraphType::Edge>, EdgeNumConverter<RagType> > GridEdgesType;
-	typedef util::cont_map<RagType::Node, RagType::Node, NodeNumConverter<RagType> >                    ParentNodesType;
-	typedef util::cont_map<RagType::Edge, float, EdgeNumConverter<RagType> >                            EdgeScoresType;
-
-	struct EdgeCompare {
-
-		EdgeCompare(const EdgeScoresType& edgeScores_) :
-			edgeScores(edgeScores_) {}
-
-		bool operator()(const RagType::Edge& a, const RagType::Edge& b) {
-
-			UTIL_ASSERT(edgeScores.count(a));
-			UTIL_ASSERT(edgeScores.count(b));
-
-			// sort edges in increasing score value
-			return edgeScores[a] > edgeScores[b];
-		}
-
-		const EdgeScoresType& edgeScores;
-	};
+	typedef RagType::EdgeMap<std::vector<typename GridGraphType::Edge> >              GridEdgesType;
+	typedef util::cont_map<RagType::Node, RagType::Node, NodeNumConverter<RagType> > ParentNodesType;
+	typedef util::cont_map<RagType::Edge, float, EdgeNumConverter<RagType> >         EdgeScoresType;
 
-	typedef std::priority_queue<RagType::Edge, std::vector<RagType::Edge>, EdgeCompare> MergeEdgesType;
+	template <typename ScoringFunction>
+	using EdgeStatisticsType = util::cont_map<RagType::Edge, typename ScoringFunction::EdgeStatistics, EdgeNumConverter<RagType> >;
 
-	// merge two regions and return new region node
+	// compute the statistics of all initial edges and release the grid edges
 	template <typename ScoringFunction>
-	RagType::Node mergeRegions(
-			RagType::Node regionA,
-			RagType::Node regionB,
-			ScoringFunction& scoringFunction);
+	void computeInitialStatistics(
+			ScoringFunction&                     scoringFunction,
+			EdgeStatisticsType<ScoringFunction>& statistics);
 
-	// merge two regions identified by an edge
-	// a and b can optionally be given as u and v of the edge to avoid a lookup
+	// merge two regions identified by an edge and return the new region node
 	template <typename ScoringFunction>
 	RagType::Node mergeRegions(
-			RagType::Edge edge,
-			ScoringFunction& scoringFunction,
-			RagType::Node a = RagType::Node(),
-			RagType::Node b = RagType::Node());
+			RagType::Edge                        edge,
+			ScoringFunction&                     scoringFunction,
+			EdgeStatisticsType<ScoringFunction>& statistics);
 
 	template <typename ScoringFunction>
-	void scoreEdge(const RagType::Edge& edge, ScoringFunction& scoringFunction);
+	void scoreEdge(
+			const RagType::Edge&                       edge,
+			ScoringFunction&                           scoringFunction,
+			const EdgeStatisticsType<ScoringFunction>& statistics);
 
 	inline RagType::Edge nextMergeEdge() { float _; return nextMergeEdge(_); }
 	inline RagType::Edge nextMergeEdge(float& score);
@@ -116,6 +125,8 @@ private:
 
 	RagType _rag;
 
+	// the grid edges of the initial RAG edges, cleared once the initial edge 
+	// statistics are computed
 	GridEdgesType   _ragToGridEdges;
 	ParentNodesType _parentNodes;
 	EdgeScoresType  _edgeScores;
@@ -129,7 +140,14 @@ private:
 	};
 	std::vector<Merge> _mergeHistory;
 
-	MergeEdgesType _mergeEdges;
+	// the edges between regions that have not been merged yet, by id
+	EdgeQueue _mergeEdges;
+
+	// set once createMergeTree() released the grid edges, after which only 
+	// the edge scores are available
+	bool _merged;
+
+	int _numThreads;
 };
 
 template <int D>
@@ -137,31 +155,27 @@ IterativeRegionMerging<D>::IterativeRegionMerging(
 		vigra::MultiArrayView<D, int> initialRegions) :
 	_grid(initialRegions.shape()),
 	_gridEdgeWeights(_grid),
-	_ragToGridEdges(_rag),
 	_parentNodes(_rag),
 	_edgeScores(_rag),
-	_mergeEdges(EdgeCompare(_edgeScores)) {
+	_merged(false),
+	_numThreads(1) {
 
-	// get initial region adjacency graph
+	// get initial region adjacency graph and grid edges for each rag edge
 
-	RagType::EdgeMap<std::vector<typename GridGraphType::Edge> > affiliatedEdges;
 	vigra::makeRegionAdjacencyGraph(
 			_grid,
 			initialRegions,
 			_rag,
-			affiliatedEdges);
-
-	// get grid edges for each rag edge
-
-	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
-		_ragToGridEdges[*edge] = affiliatedEdges[*edge];
+			_ragToGridEdges);
 
 	// logging
 
 	int numRegions = 0;
 	for (RagType::NodeIt node(_rag); node != lemon::INVALID; ++node)
 		numRegions++;
-	int numRegionEdges = _ragToGridEdges.size();
+	int numRegionEdges = 0;
+	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
+		numRegionEdges++;
 
 	LOG_USER(mergetreelog)
 			<< "got region adjacency graph with "
@@ -181,7 +195,13 @@ IterativeRegionMerging<D>::storeRag(std::string filename, ScoringFunction& scori
 		unsigned int u = _rag.id(_rag.u(*edge));
 		unsigned int v = _rag.id(_rag.v(*edge));
 
-		file << u << "\t" << v << "\t" << scoringFunction(*edge, _ragToGridEdges[*edge]) << std::endl;
+		float score;
+		if (_merged)
+			score = _edgeScores[*edge];
+		else
+			score = scoringFunction(*edge, scoringFunction.edgeStatistics(_ragToGridEdges[*edge]));
+
+		file << u << "\t" << v << "\t" << score << std::endl;
 	}
 }
 
@@ -190,11 +210,19 @@ template <typename ScoringFunction>
 void
 IterativeRegionMerging<D>::createMergeTree(ScoringFunction& scoringFunction) {
 
+	UTIL_ASSERT(!_merged);
+
+	EdgeStatisticsType<ScoringFunction> statistics(_rag);
+
+	LOG_USER(mergetreelog) << "computing initial edge statistics..." << std::endl;
+
+	computeInitialStatistics(scoringFunction, statistics);
+	_merged = true;
+
 	LOG_USER(mergetreelog) << "computing initial edge scores..." << std::endl;
 
-	// compute initial edge scores
 	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
-		scoreEdge(*edge, scoringFunction);
+		scoreEdge(*edge, scoringFunction, statistics);
 
 	LOG_USER(mergetreelog) << "merging regions..." << std::endl;
 
@@ -207,7 +235,7 @@ IterativeRegionMerging<D>::createMergeTree(ScoringFunction& scoringFunction) {
 		if (next == lemon::INVALID)
 			break;
 
-		RagType::Node merged = mergeRegions(next, scoringFunction);
+		RagType::Node merged = mergeRegions(next, scoringFunction, statistics);
 
 		_mergeHistory.push_back({_rag.u(next), _rag.v(next), merged, score});
 
@@ -219,9 +247,38 @@ IterativeRegionMerging<D>::createMergeTree(ScoringFunction& scoringFunction) {
 
 	LOG_USER(mergetreelog) << "finished merging" << std::endl;
 	LOG_DEBUG(mergetreelog)
-			<< "_ragToGridEdges contains "
-			<< _ragToGridEdges.size() << " elements, with an overhead of "
-			<< _ragToGridEdges.overhead() << std::endl;
+			<< "edge statistics contain "
+			<< statistics.size() << " elements, with an overhead of "
+			<< statistics.overhead() << std::endl;
+}
+
+template <int D>
+template <typename ScoringFunction>
+void
+IterativeRegionMerging<D>::computeInitialStatistics(
+		ScoringFunction&                     scoringFunction,
+		EdgeStatisticsType<ScoringFunction>& statistics) {
+
+	std::vector<RagType::Edge> edges;
+	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
+		edges.push_back(*edge);
+
+	std::vector<typename ScoringFunction::EdgeStatistics> initialStatistics(edges.size());
+
+	parallelFor(
+			edges.size(),
+			getNumThreads(_numThreads),
+			[&](std::size_t i) {
+
+				initialStatistics[i] = scoringFunction.edgeStatistics(_ragToGridEdges[edges[i]]);
+
+				// the grid edges are not needed anymore
+				std::vector<typename GridGraphType::Edge>().swap(_ragToGridEdges[edges[i]]);
+			},
+			64);
+
+	for (std::size_t i = 0; i < edges.size(); i++)
+		statistics[edges[i]] = std::move(initialStatistics[i]);
 }
 
 template <int D>
@@ -244,36 +301,12 @@ template <int D>
 template <typename ScoringFunction>
 IterativeRegionMerging<D>::RagType::Node
 IterativeRegionMerging<D>::mergeRegions(
-		RagType::Node a,
-		RagType::Node b,
-		ScoringFunction& scoringFunction) {
-
-	// don't merge previously merged nodes
-	UTIL_ASSERT(_parentNodes[a] == lemon::INVALID);
-	UTIL_ASSERT(_parentNodes[b] == lemon::INVALID);
-
-	RagType::Edge edge = _rag.findEdge(a, b);
+		RagType::Edge                        edge,
+		ScoringFunction&                     scoringFunction,
+		EdgeStatisticsType<ScoringFunction>& statistics) {
 
-	if (edge == lemon::INVALID)
-		return RagType::Node();
-
-	return mergeRegions(edge, scoringFunction, a, b);
-}
-
-template <int D>
-template <typename ScoringFunction>
-IterativeRegionMerging<D>::RagType::Node
-IterativeRegionMerging<D>::mergeRegions(
-		RagType::Edge edge,
-		ScoringFunction& scoringFunction,
-		RagType::Node a,
-		RagType::Node b) {
-
-	if (a == lemon::INVALID || b == lemon::INVALID) {
-
-		a = _rag.u(edge);
-		b = _rag.v(edge);
-	}
+	RagType::Node a = _rag.u(edge);
+	RagType::Node b = _rag.v(edge);
 
 	// don't merge previously merged nodes
 	UTIL_ASSERT(_parentNodes[a] == lemon::INVALID);
@@ -285,7 +318,8 @@ IterativeRegionMerging<D>::mergeRegions(
 	_parentNodes[a] = c;
 	_parentNodes[b] = c;
 
-	// connect c to neighbors of a and b and set affiliated edges accordingly
+	// connect c to neighbors of a and b and merge the edge statistics 
+	// accordingly
 
 	std::vector<RagType::Edge> newEdges;
 
@@ -308,6 +342,9 @@ IterativeRegionMerging<D>::mergeRegions(
 			if (neighbor == other || _parentNodes[neighbor] != lemon::INVALID)
 				continue;
 
+			// the edge can not be merged anymore
+			_mergeEdges.remove(_rag.id(*edge));
+
 			neighbors.push_back(neighbor);
 			neighborEdges.push_back(*edge);
 		}
@@ -320,20 +357,27 @@ IterativeRegionMerging<D>::mergeRegions(
 
 			// add the edge from c->neighbor
 			RagType::Edge newEdge = _rag.findEdge(c, neighbor);
-			if (newEdge == lemon::INVALID)
+			bool isNew = (newEdge == lemon::INVALID);
+			if (isNew) {
+
 				newEdge = _rag.addEdge(c, neighbor);
+				newEdges.push_back(newEdge);
+			}
 
-			// add affiliated edges from child->neighbor to new edge c->neighbor
-			std::copy(
-					_ragToGridEdges[neighborEdge].begin(),
-					_ragToGridEdges[neighborEdge].end(),
-					std::back_inserter(_ragToGridEdges[newEdge]));
+			// access the new edge first, which might grow the map
+			typename ScoringFunction::EdgeStatistics& newStatistics = statistics[newEdge];
+			typename ScoringFunction::EdgeStatistics& oldStatistics = statistics[neighborEdge];
 
-			// clear the affiliated edges to save memory -- they are not needed 
-			// anymore
-			_ragToGridEdges[neighborEdge].clear();
+			// move or merge the statistics from child->neighbor to the new 
+			// edge c->neighbor
+			if (isNew)
+				newStatistics = std::move(oldStatistics);
+			else
+				scoringFunction.mergeStatistics(newStatistics, oldStatistics);
 
-			newEdges.push_back(newEdge);
+			// clear the old statistics to save memory -- they are not needed 
+			// anymore
+			oldStatistics = typename ScoringFunction::EdgeStatistics();
 		}
 	}
 
@@ -342,7 +386,7 @@ IterativeRegionMerging<D>::mergeRegions(
 
 	// get edge score for new edges
 	for (std::vector<RagType::Edge>::const_iterator i = newEdges.begin(); i != newEdges.end(); i++)
-		scoreEdge(*i, scoringFunction);
+		scoreEdge(*i, scoringFunction, statistics);
 
 	return c;
 }
@@ -350,34 +394,30 @@ IterativeRegionMerging<D>::mergeRegions(
 template <int D>
 template <typename ScoringFunction>
 void
-IterativeRegionMerging<D>::scoreEdge(const RagType::Edge& edge, ScoringFunction& scoringFunction) {
+IterativeRegionMerging<D>::scoreEdge(
+		const RagType::Edge&                       edge,
+		ScoringFunction&                           scoringFunction,
+		const EdgeStatisticsType<ScoringFunction>& statistics) {
 
-	_edgeScores[edge] = scoringFunction(edge, _ragToGridEdges[edge]);
-	_mergeEdges.push(edge);
+	_edgeScores[edge] = scoringFunction(edge, statistics[edge]);
+	_mergeEdges.push(_rag.id(edge), _edgeScores[edge]);
 }
 
 template <int D>
 IterativeRegionMerging<D>::RagType::Edge
 IterativeRegionMerging<D>::nextMergeEdge(float& score) {
 
-	RagType::Edge next;
-
-	while (true) {
-
-		// no more edges
-		if (_mergeEdges.size() == 0)
-			return RagType::Edge();
+	// no more edges
+	if (_mergeEdges.empty())
+		return RagType::Edge();
 
-		next = _mergeEdges.top(); _mergeEdges.pop();
-
-		// don't accept edges to already merged regions
-		if (_parentNodes[_rag.u(next)] != lemon::INVALID || _parentNodes[_rag.v(next)] != lemon::INVALID)
-			continue;
-
-		break;
-	}
+	RagType::Edge next = _rag.edgeFromId(_mergeEdges.top());
+	score = _mergeEdges.topPriority();
+	_mergeEdges.pop();
 
-	score = _edgeScores[next];
+	// edges to already merged regions have been removed
+	UTIL_ASSERT(_parentNodes[_rag.u(next)] == lemon::INVALID);
+	UTIL_ASSERT(_parentNodes[_rag.v(next)] == lemon::INVALID);
 
 	return next;
 }
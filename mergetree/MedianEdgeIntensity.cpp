@@ -0,0 +1,6 @@
+#include "MedianEdgeIntensity.h"
+
+util::ProgramOption optionMedianHistogramBins(
+		util::_long_name        = "medianHistogramBins",
+		util::_description_text = "The number of histogram bins over the range of edge intensities, used to find the median edge intensity of merged regions. Default is 1024.",
+		util::_default_value    = 1024);
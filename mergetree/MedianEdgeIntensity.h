@@ -1,13 +1,20 @@
 #ifndef MULTI2CUT_MERGETREE_MEDIAN_EDGE_INTENSITY_H__
 #define MULTI2CUT_MERGETREE_MEDIAN_EDGE_INTENSITY_H__
 
-#include <util/cont_map.hpp>
+#include <algorithm>
+#include <util/ProgramOptions.h>
 #include <vigra/graph_algorithms.hxx>
-#include "EdgeNumConverter.h"
+#include "EdgeHistogram.h"
+
+extern util::ProgramOption optionMedianHistogramBins;
 
 /**
  * An edge scoring function that returns the median intensity of the edge 
  * pixels.
+ *
+ * The intensities of the edge pixels are summarized in a histogram with 
+ * optionMedianHistogramBins bins over the range of all edge intensities. The 
+ * median is interpolated within its bin.
  */
 template <int D>
 class MedianEdgeIntensity {
@@ -19,23 +26,14 @@ public:
 	typedef vigra::AdjacencyListGraph                       RagType;
 	typedef typename GridGraphType::template EdgeMap<float> EdgeWeightsType;
 
-	struct EdgeComp {
-
-		EdgeComp(const EdgeWeightsType& weights_)
-			: weights(weights_) {}
-
-		bool operator()(
-				const typename GridGraphType::Edge& a,
-				const typename GridGraphType::Edge& b) const {
-			return weights[a] < weights[b];
-		}
-
-		const EdgeWeightsType& weights;
-	};
+	typedef EdgeHistogram EdgeStatistics;
 
 	MedianEdgeIntensity(const vigra::MultiArrayView<D, float> intensities) :
 		_grid(intensities.shape()),
-		_edgeWeights(_grid) {
+		_edgeWeights(_grid),
+		_numBins(std::max(optionMedianHistogramBins.as<int>(), 1)),
+		_min(0),
+		_binWidth(0) {
 
 		vigra::edgeWeightsFromNodeWeights(
 				_grid,
@@ -44,26 +42,69 @@ public:
 
 		if (_edgeWeights.size() == 0)
 			return;
+
+		auto minmax = std::minmax_element(_edgeWeights.begin(), _edgeWeights.end());
+
+		_min      = *minmax.first;
+		_binWidth = (*minmax.second - _min)/_numBins;
+	}
+
+	/**
+	 * Summarize the intensities of the given grid edges. Can be called 
+	 * concurrently.
+	 */
+	EdgeStatistics edgeStatistics(const std::vector<typename GridGraphType::Edge>& gridEdges) const {
+
+		std::vector<unsigned int> bins;
+		bins.reserve(gridEdges.size());
+
+		for (const typename GridGraphType::Edge& e : gridEdges)
+			bins.push_back(getBin(_edgeWeights[e]));
+
+		return EdgeStatistics(bins);
+	}
+
+	/**
+	 * Add the statistics of one edge to the statistics of another, when two 
+	 * edges are merged.
+	 */
+	void mergeStatistics(EdgeStatistics& statistics, const EdgeStatistics& other) const {
+
+		statistics.merge(other);
 	}
 
 	/**
 	 * Get the score for an edge. An edge will be merged the earlier, the 
 	 * smaller its score is.
 	 */
-	float operator()(const RagType::Edge& edge, std::vector<typename GridGraphType::Edge>& gridEdges) {
+	float operator()(const RagType::Edge&, const EdgeStatistics& statistics) {
 
-		typename std::vector<typename GridGraphType::Edge>::iterator median = gridEdges.begin() + gridEdges.size()/2;
-		std::nth_element(gridEdges.begin(), median, gridEdges.end(), EdgeComp(_edgeWeights));
+		float fraction;
+		unsigned int bin = statistics.rankBin(statistics.size()/2, fraction);
 
-		return _edgeWeights[*median];
+		return _min + (bin + fraction)*_binWidth;
 	}
 
 	void onMerge(const typename RagType::Edge&, const typename RagType::Node) {}
 
 private:
 
+	unsigned int getBin(float value) const {
+
+		if (_binWidth <= 0)
+			return 0;
+
+		return std::min((unsigned int)((value - _min)/_binWidth), _numBins - 1);
+	}
+
 	GridGraphType   _grid;
 	EdgeWeightsType _edgeWeights;
+
+	unsigned int _numBins;
+
+	// the smallest edge intensity and the width of the histogram bins
+	float _min;
+	float _binWidth;
 };
 
 #endif // MULTI2CUT_MERGETREE_MEDIAN_EDGE_INTENSITY_H__
@@ -24,6 +24,8 @@ public:
 	typedef typename ScoringFunctionType::GridGraphType GridGraphType;
 	typedef typename ScoringFunctionType::RagType       RagType;
 
+	typedef typename ScoringFunctionType::EdgeStatistics EdgeStatistics;
+
 	typedef util::cont_map<typename RagType::Node, std::size_t, NodeNumConverter<RagType> > RegionSizesType;
 
 	template <typename T>
@@ -41,12 +43,22 @@ public:
 			_regionSizes[_rag.nodeFromId(id)]++;
 	}
 
-	float operator()(const typename RagType::Edge& edge, std::vector<typename GridGraphType::Edge>& gridEdges) {
+	EdgeStatistics edgeStatistics(const std::vector<typename GridGraphType::Edge>& gridEdges) const {
+
+		return _scoringFunction.edgeStatistics(gridEdges);
+	}
+
+	void mergeStatistics(EdgeStatistics& statistics, const EdgeStatistics& other) const {
+
+		_scoringFunction.mergeStatistics(statistics, other);
+	}
+
+	float operator()(const typename RagType::Edge& edge, const EdgeStatistics& statistics) {
 
 		typename RagType::Node u = _rag.u(edge);
 		typename RagType::Node v = _rag.v(edge);
 
-		float score = _scoringFunction(edge, gridEdges);
+		float score = _scoringFunction(edge, statistics);
 
 		score *= pow(std::abs<std::size_t>(_regionSizes[u] - _regionSizes[v]), _exponent);
 
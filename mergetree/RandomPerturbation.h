@@ -24,6 +24,8 @@ public:
 	typedef typename ScoringFunctionType::GridGraphType GridGraphType;
 	typedef typename ScoringFunctionType::RagType       RagType;
 
+	typedef typename ScoringFunctionType::EdgeStatistics EdgeStatistics;
+
 	RandomPerturbation(ScoringFunctionType& scoringFunction) :
 		_scoringFunction(scoringFunction),
 		_normalDistribution(0, 1),
@@ -37,14 +39,24 @@ public:
 			srand(optionRandomPerturbationSeed.as<int>());
 		}
 
-	float operator()(const typename RagType::Edge& edge, std::vector<typename GridGraphType::Edge>& gridEdges) {
+	EdgeStatistics edgeStatistics(const std::vector<typename GridGraphType::Edge>& gridEdges) const {
+
+		return _scoringFunction.edgeStatistics(gridEdges);
+	}
+
+	void mergeStatistics(EdgeStatistics& statistics, const EdgeStatistics& other) const {
+
+		_scoringFunction.mergeStatistics(statistics, other);
+	}
+
+	float operator()(const typename RagType::Edge& edge, const EdgeStatistics& statistics) {
 
-		float score = _scoringFunction(edge, gridEdges);
+		float score = _scoringFunction(edge, statistics);
 
 		double uniform = (double)rand()/RAND_MAX;
 		double pertubation = boost::math::quantile(_normalDistribution, uniform);
 
-		pertubation = pertubation*_stdDev*1.0/gridEdges.size();
+		pertubation = pertubation*_stdDev*1.0/statistics.size();
 
 		return score + pertubation;
 	}
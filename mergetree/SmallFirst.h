@@ -31,6 +31,8 @@ public:
 	typedef typename ScoringFunctionType::GridGraphType GridGraphType;
 	typedef typename ScoringFunctionType::RagType       RagType;
 
+	typedef typename ScoringFunctionType::EdgeStatistics EdgeStatistics;
+
 	typedef util::cont_map<typename RagType::Node, std::size_t, NodeNumConverter<RagType> > RegionSizesType;
 	typedef util::cont_map<typename RagType::Node, float, NodeNumConverter<RagType> >       AverageIntensitiesType;
 
@@ -74,9 +76,19 @@ public:
 			_averageIntensities[*node] /= _regionSizes[*node];
 	}
 
-	float operator()(const typename RagType::Edge& edge, std::vector<typename GridGraphType::Edge>& gridEdges) {
+	EdgeStatistics edgeStatistics(const std::vector<typename GridGraphType::Edge>& gridEdges) const {
+
+		return _scoringFunction.edgeStatistics(gridEdges);
+	}
+
+	void mergeStatistics(EdgeStatistics& statistics, const EdgeStatistics& other) const {
+
+		_scoringFunction.mergeStatistics(statistics, other);
+	}
+
+	float operator()(const typename RagType::Edge& edge, const EdgeStatistics& statistics) {
 
-		float score = _scoringFunction(edge, gridEdges);
+		float score = _scoringFunction(edge, statistics);
 
 		UTIL_ASSERT_REL(score, >=, 0);
 		UTIL_ASSERT_REL(score, <,  Offset);
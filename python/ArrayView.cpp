@@ -0,0 +1,328 @@
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <util/exceptions.h>
+#include "ArrayView.h"
+
+namespace pycmc {
+
+namespace {
+
+/**
+ * A python object exporting a strided block of memory via the buffer 
+ * protocol, keeping the owner of the memory alive.
+ */
+struct ArrayViewObject {
+
+	PyObject_HEAD
+
+	PyObject*   owner;
+	void*       data;
+	const char* format;
+	Py_ssize_t  itemSize;
+	int         ndim;
+	Py_ssize_t  shape[3];
+	Py_ssize_t  strides[3]; // in bytes
+	bool        readOnly;
+
+	// the guarded object and its generation when this view was created
+	const void* guarded;
+	std::size_t generation;
+};
+
+// the array views and exported buffers of a guarded object
+struct Guard {
+
+	Guard() : numViews(0), numExports(0), generation(0) {}
+
+	std::size_t numViews;
+	std::size_t numExports;
+
+	// increased with each modification of the object
+	std::size_t generation;
+};
+
+// the guards of all objects with array views, only accessed while holding the 
+// GIL
+std::map<const void*, Guard> guards;
+
+bool
+isCContiguous(const ArrayViewObject* view) {
+
+	Py_ssize_t stride = view->itemSize;
+	for (int d = view->ndim - 1; d >= 0; d--) {
+
+		if (view->shape[d] > 1 && view->strides[d] != stride)
+			return false;
+		stride *= view->shape[d];
+	}
+
+	return true;
+}
+
+int
+getBuffer(PyObject* exporter, Py_buffer* buffer, int flags) {
+
+	ArrayViewObject* view = reinterpret_cast<ArrayViewObject*>(exporter);
+
+	if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && view->readOnly) {
+
+		PyErr_SetString(PyExc_BufferError, "array view is read-only");
+		buffer->obj = NULL;
+		return -1;
+	}
+
+	if (view->guarded && guards[view->guarded].generation != view->generation) {
+
+		PyErr_SetString(PyExc_BufferError, "array view is stale, the viewed object was modified after the view was created");
+		buffer->obj = NULL;
+		return -1;
+	}
+
+	if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES && !isCContiguous(view)) {
+
+		PyErr_SetString(PyExc_BufferError, "array view is not contiguous");
+		buffer->obj = NULL;
+		return -1;
+	}
+
+	Py_ssize_t len = view->itemSize;
+	for (int d = 0; d < view->ndim; d++)
+		len *= view->shape[d];
+
+	buffer->buf        = view->data;
+	buffer->obj        = exporter;
+	buffer->len        = len;
+	buffer->readonly   = view->readOnly;
+	buffer->itemsize   = view->itemSize;
+	buffer->format     = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT ? const_cast<char*>(view->format) : NULL);
+	buffer->ndim       = view->ndim;
+	buffer->shape      = ((flags & PyBUF_ND) == PyBUF_ND ? view->shape : NULL);
+	buffer->strides    = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES ? view->strides : NULL);
+	buffer->suboffsets = NULL;
+	buffer->internal   = NULL;
+
+	Py_INCREF(exporter);
+
+	if (view->guarded)
+		guards[view->guarded].numExports++;
+
+	return 0;
+}
+
+void
+releaseBuffer(PyObject* exporter, Py_buffer* /*buffer*/) {
+
+	ArrayViewObject* view = reinterpret_cast<ArrayViewObject*>(exporter);
+
+	if (view->guarded)
+		guards[view->guarded].numExports--;
+}
+
+void
+deallocate(PyObject* self) {
+
+	ArrayViewObject* view = reinterpret_cast<ArrayViewObject*>(self);
+
+	if (view->guarded) {
+
+		auto guard = guards.find(view->guarded);
+		if (--guard->second.numViews == 0)
+			guards.erase(guard);
+	}
+
+	Py_XDECREF(view->owner);
+	Py_TYPE(self)->tp_free(self);
+}
+
+PyBufferProcs arrayViewBufferProcs;
+
+// the remaining fields are set in registerArrayView()
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+PyTypeObject arrayViewType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+};
+#pragma GCC diagnostic pop
+
+// the kind of the elements of a buffer with a given format character
+enum ElementKind { Signed, Unsigned, Floating, Unsupported };
+
+ElementKind
+elementKind(char format) {
+
+	switch (format) {
+
+		case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+			return Signed;
+		case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+			return Unsigned;
+		case 'f': case 'd':
+			return Floating;
+		default:
+			return Unsupported;
+	}
+}
+
+template <typename S, typename T>
+void
+convert(const void* source, std::size_t size, std::vector<T>& target) {
+
+	const S* s = static_cast<const S*>(source);
+	target.resize(size);
+	for (std::size_t i = 0; i < size; i++)
+		target[i] = static_cast<T>(s[i]);
+}
+
+template <typename T>
+bool
+convert(ElementKind kind, std::size_t itemSize, const void* source, std::size_t size, std::vector<T>& target) {
+
+	if (kind == Floating) {
+
+		if (itemSize == sizeof(double)) { convert<double>(source, size, target); return true; }
+		if (itemSize == sizeof(float))  { convert<float> (source, size, target); return true; }
+
+	} else if (kind == Signed) {
+
+		if (itemSize == 1) { convert<int8_t> (source, size, target); return true; }
+		if (itemSize == 2) { convert<int16_t>(source, size, target); return true; }
+		if (itemSize == 4) { convert<int32_t>(source, size, target); return true; }
+		if (itemSize == 8) { convert<int64_t>(source, size, target); return true; }
+
+	} else if (kind == Unsigned) {
+
+		if (itemSize == 1) { convert<uint8_t> (source, size, target); return true; }
+		if (itemSize == 2) { convert<uint16_t>(source, size, target); return true; }
+		if (itemSize == 4) { convert<uint32_t>(source, size, target); return true; }
+		if (itemSize == 8) { convert<uint64_t>(source, size, target); return true; }
+	}
+
+	return false;
+}
+
+} // anonymous namespace
+
+void
+registerArrayView() {
+
+	arrayViewBufferProcs.bf_getbuffer     = &getBuffer;
+	arrayViewBufferProcs.bf_releasebuffer = &releaseBuffer;
+
+	arrayViewType.tp_name      = "pycmc.ArrayView";
+	arrayViewType.tp_doc       = "A view on memory of pycmc objects, to be wrapped with numpy.asarray().";
+	arrayViewType.tp_basicsize = sizeof(ArrayViewObject);
+	arrayViewType.tp_dealloc   = &deallocate;
+	arrayViewType.tp_as_buffer = &arrayViewBufferProcs;
+	arrayViewType.tp_flags     = Py_TPFLAGS_DEFAULT;
+#ifdef Py_TPFLAGS_HAVE_NEWBUFFER
+	arrayViewType.tp_flags    |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+
+	if (PyType_Ready(&arrayViewType) < 0)
+		boost::python::throw_error_already_set();
+
+	Py_INCREF(&arrayViewType);
+	boost::python::scope().attr("ArrayView") =
+			boost::python::object(boost::python::handle<>(reinterpret_cast<PyObject*>(&arrayViewType)));
+}
+
+boost::python::object
+createArrayView(
+		void*                           data,
+		const char*                     format,
+		std::size_t                     itemSize,
+		const std::vector<std::size_t>& shape,
+		const std::vector<std::size_t>& strides,
+		boost::python::object           owner,
+		bool                            readOnly,
+		const void*                     guarded) {
+
+	if (shape.size() > 3 || strides.size() != shape.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"array views support up to three dimensions, got shape of size " << shape.size());
+
+	ArrayViewObject* view = PyObject_New(ArrayViewObject, &arrayViewType);
+	if (!view)
+		boost::python::throw_error_already_set();
+
+	Py_INCREF(owner.ptr());
+	view->owner    = owner.ptr();
+	view->data     = data;
+	view->format   = format;
+	view->itemSize = itemSize;
+	view->ndim     = shape.size();
+	view->readOnly = readOnly;
+	view->guarded  = guarded;
+
+	if (guarded) {
+
+		Guard& guard = guards[guarded];
+		guard.numViews++;
+		view->generation = guard.generation;
+	}
+
+	for (std::size_t d = 0; d < shape.size(); d++) {
+
+		view->shape[d]   = shape[d];
+		view->strides[d] = strides[d]*itemSize;
+	}
+
+	return boost::python::object(boost::python::handle<>(reinterpret_cast<PyObject*>(view)));
+}
+
+void
+beginModification(const void* guarded) {
+
+	auto guard = guards.find(guarded);
+	if (guard == guards.end())
+		return;
+
+	if (guard->second.numExports > 0) {
+
+		PyErr_SetString(PyExc_BufferError, "can not modify an object while its memory is exported by an array view");
+		boost::python::throw_error_already_set();
+	}
+
+	guard->second.generation++;
+}
+
+template <typename T>
+std::vector<T>
+bufferToVector(boost::python::object object) {
+
+	Py_buffer buffer;
+	if (PyObject_GetBuffer(object.ptr(), &buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+		boost::python::throw_error_already_set();
+
+	// skip byte order and alignment markers of native formats
+	const char* format = (buffer.format ? buffer.format : "B");
+	if (*format == '@' || *format == '=')
+		format++;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	else if (*format == '<')
+		format++;
+#endif
+
+	ElementKind kind = (std::strlen(format) == 1 ? elementKind(*format) : Unsupported);
+
+	std::vector<T> values;
+	bool converted = convert(kind, buffer.itemsize, buffer.buf, buffer.len/buffer.itemsize, values);
+
+	std::string formatString(buffer.format ? buffer.format : "B");
+	PyBuffer_Release(&buffer);
+
+	if (!converted)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"unsupported buffer format " << formatString);
+
+	return values;
+}
+
+template std::vector<double> bufferToVector<double>(boost::python::object);
+template std::vector<int>    bufferToVector<int>(boost::python::object);
+
+} // namespace pycmc
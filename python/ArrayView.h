@@ -0,0 +1,108 @@
+#ifndef CANDIDATE_MC_PYTHON_ARRAY_VIEW_H__
+#define CANDIDATE_MC_PYTHON_ARRAY_VIEW_H__
+
+#include <vector>
+#include <boost/python.hpp>
+
+namespace pycmc {
+
+/**
+ * The struct module format character of a type, as used by the python buffer 
+ * protocol.
+ */
+template <typename T> struct BufferFormat {};
+template <> struct BufferFormat<double>        { static const char* get() { return "d"; } };
+template <> struct BufferFormat<float>         { static const char* get() { return "f"; } };
+template <> struct BufferFormat<int>           { static const char* get() { return "i"; } };
+template <> struct BufferFormat<unsigned int>  { static const char* get() { return "I"; } };
+template <> struct BufferFormat<unsigned char> { static const char* get() { return "B"; } };
+
+/**
+ * Register the ArrayView type with the python module that is currently 
+ * initialized. Has to be called before any array view is created.
+ */
+void registerArrayView();
+
+/**
+ * Create a python object that exposes the memory at data through the buffer 
+ * protocol, such that numpy.asarray() (or memoryview()) can use it without 
+ * copying. The object keeps owner alive.
+ *
+ * @param shape
+ *              The size of each dimension (at most 3).
+ * @param strides
+ *              The distance between consecutive elements in each dimension, 
+ *              in elements (not bytes).
+ * @param guarded
+ *              If given, the C++ object whose modifications can invalidate 
+ *              the memory. Such modifications have to call 
+ *              beginModification(guarded) first.
+ */
+boost::python::object createArrayView(
+		void*                           data,
+		const char*                     format,
+		std::size_t                     itemSize,
+		const std::vector<std::size_t>& shape,
+		const std::vector<std::size_t>& strides,
+		boost::python::object           owner,
+		bool                            readOnly,
+		const void*                     guarded = 0);
+
+template <typename T>
+boost::python::object createArrayView(
+		T*                              data,
+		const std::vector<std::size_t>& shape,
+		const std::vector<std::size_t>& strides,
+		boost::python::object           owner,
+		bool                            readOnly = false,
+		const void*                     guarded = 0) {
+
+	return createArrayView(data, BufferFormat<T>::get(), sizeof(T), shape, strides, owner, readOnly, guarded);
+}
+
+/**
+ * Has to be called before modifying an object that was passed as guarded to 
+ * createArrayView() in a way that might move its memory. Raises a python 
+ * BufferError if the memory is currently exported by one of the views (e.g., 
+ * to a numpy array that is still alive). Otherwise, the existing views of 
+ * the object are marked as stale and refuse to export their memory.
+ */
+void beginModification(const void* guarded);
+
+/**
+ * Create a read-only array with a copy of the given values, for data that is 
+ * not stored contiguously (like CRAG node and edge maps).
+ */
+template <typename T>
+boost::python::object createArray(const std::vector<T>& values, const std::vector<std::size_t>& shape) {
+
+	boost::python::object storage(
+			boost::python::handle<>(
+					PyByteArray_FromStringAndSize(
+							reinterpret_cast<const char*>(values.data()),
+							values.size()*sizeof(T))));
+
+	std::vector<std::size_t> strides(shape.size(), 1);
+	for (int d = (int)shape.size() - 2; d >= 0; d--)
+		strides[d] = strides[d + 1]*shape[d + 1];
+
+	return createArrayView(
+			reinterpret_cast<T*>(PyByteArray_AsString(storage.ptr())),
+			shape,
+			strides,
+			storage,
+			true);
+}
+
+/**
+ * Copy the content of any C-contiguous object that supports the buffer 
+ * protocol (like a numpy array) into a vector, converting integer and floating 
+ * point elements to T. Available for double and int.
+ */
+template <typename T>
+std::vector<T> bufferToVector(boost::python::object buffer);
+
+} // namespace pycmc
+
+#endif // CANDIDATE_MC_PYTHON_ARRAY_VIEW_H__
+
@@ -14,6 +14,7 @@
 #include <inference/CragSolution.h>
 #include <learning/BundleOptimizer.h>
 #include <learning/Loss.h>
+#include "ArrayView.h"
 #include "PyOracle.h"
 #include "logging.h"
 
@@ -31,16 +32,238 @@ std::vector<V> list_to_vec(boost::python::list l) {
 	return vec;
 }
 
+template <typename Map, typename K>
+std::vector<double> featuresGetter(const Map& map, const K& k) { return map[k].toVector(); }
+
+// the stored features with squares and pairwise products, as used with the 
+// feature weights
+template <typename Map, typename K>
+std::vector<double> featuresExpand(const Map& map, const K& k) { return map.expand(k); }
+
+// Modifications of features can reallocate the memory of featuresView(), 
+// which is refused while a view is in use.
 template <typename Map, typename K, typename V, typename D>
 void featuresSetter(Map& map, const K& k, const V& value) { 
+	pycmc::beginModification(&map);
 	map.set(k, list_to_vec<D>(value));
 }
 
+template <typename Map, typename K>
+void featuresAppend(Map& map, const K& k, double feature) {
+	pycmc::beginModification(&map);
+	map.append(k, feature);
+}
+
+void retrieveNodeFeatures(Hdf5CragStore& store, const Crag& crag, NodeFeatures& features) {
+	pycmc::beginModification(&features);
+	store.retrieveNodeFeatures(crag, features);
+}
+
+void retrieveEdgeFeatures(Hdf5CragStore& store, const Crag& crag, EdgeFeatures& features) {
+	pycmc::beginModification(&features);
+	store.retrieveEdgeFeatures(crag, features);
+}
+
 template <typename Map, typename K, typename V, typename D>
 void weightSetter(Map& map, const K& k, const V& value) { 
 	map[k] = list_to_vec<D>(value);
 }
 
+// Leaf nodes and edges are copied into lists, since the spans returned by the 
+// CRAG are invalidated by modifications of the CRAG.
+template <typename Range>
+boost::python::list toList(const Range& range) {
+
+	boost::python::list list;
+	for (const auto& element : range)
+		list.append(element);
+
+	return list;
+}
+
+boost::python::list leafNodes(const Crag& crag, Crag::CragNode n) { return toList(crag.leafNodes(n)); }
+boost::python::list nodeLeafEdges(const Crag& crag, Crag::CragNode n) { return toList(crag.leafEdges(n)); }
+boost::python::list edgeLeafEdges(const Crag& crag, Crag::CragEdge e) { return toList(crag.leafEdges(e)); }
+
+// Bulk access for numpy. Feature matrices and volumes are exposed as views 
+// without copying, data that is not stored contiguously (ids and node and edge 
+// maps) is copied in one call. Values are ordered like crag.nodes() and 
+// crag.edges().
+
+template <typename KeyType>
+KeyType keyFromId(const Crag& crag, int id);
+
+template <>
+Crag::CragNode keyFromId<Crag::CragNode>(const Crag& crag, int id) {
+
+	const Crag::RagType& rag = crag.getAdjacencyGraph();
+	if (id < 0 || id > rag.maxNodeId() || !rag.valid(rag.nodeFromId(id)))
+		UTIL_THROW_EXCEPTION(UsageError, "there is no node with id " << id);
+
+	return crag.nodeFromId(id);
+}
+
+template <>
+Crag::CragEdge keyFromId<Crag::CragEdge>(const Crag& crag, int id) {
+
+	const Crag::RagType& rag = crag.getAdjacencyGraph();
+	if (id < 0 || id > rag.maxEdgeId() || !rag.valid(rag.edgeFromId(id)))
+		UTIL_THROW_EXCEPTION(UsageError, "there is no edge with id " << id);
+
+	return Crag::CragEdge(crag, rag.edgeFromId(id));
+}
+
+boost::python::object nodeIds(const Crag& crag) {
+
+	std::vector<int> ids;
+	for (Crag::CragNode n : crag.nodes())
+		ids.push_back(crag.id(n));
+
+	return pycmc::createArray(ids, {ids.size()});
+}
+
+boost::python::object edgeIds(const Crag& crag) {
+
+	std::vector<int> ids;
+	for (Crag::CragEdge e : crag.edges())
+		ids.push_back(crag.id(e));
+
+	return pycmc::createArray(ids, {ids.size()});
+}
+
+boost::python::object edgeNodeIds(const Crag& crag) {
+
+	std::vector<int> ids;
+	for (Crag::CragEdge e : crag.edges()) {
+
+		ids.push_back(crag.id(e.u()));
+		ids.push_back(crag.id(e.v()));
+	}
+
+	return pycmc::createArray(ids, {ids.size()/2, 2});
+}
+
+template <typename Map, typename Range>
+boost::python::object mapToArray(const Map& map, Range range) {
+
+	std::vector<double> values;
+	for (auto k : range)
+		values.push_back(map[k]);
+
+	return pycmc::createArray(values, {values.size()});
+}
+
+template <typename Map, typename Range>
+void mapFromArray(Map& map, Range range, boost::python::object array) {
+
+	std::vector<double> values = pycmc::bufferToVector<double>(array);
+
+	std::size_t i = 0;
+	for (auto k : range) {
+
+		if (i == values.size())
+			UTIL_THROW_EXCEPTION(UsageError, "array has fewer values than the map has keys");
+		map[k] = values[i++];
+	}
+
+	if (i != values.size())
+		UTIL_THROW_EXCEPTION(UsageError, "array has more values than the map has keys");
+}
+
+boost::python::object nodeMapToArray(const Crag::NodeMap<double>& map, const Crag& crag) { return mapToArray(map, crag.nodes()); }
+boost::python::object edgeMapToArray(const Crag::EdgeMap<double>& map, const Crag& crag) { return mapToArray(map, crag.edges()); }
+void nodeMapFromArray(Crag::NodeMap<double>& map, const Crag& crag, boost::python::object array) { mapFromArray(map, crag.nodes(), array); }
+void edgeMapFromArray(Crag::EdgeMap<double>& map, const Crag& crag, boost::python::object array) { mapFromArray(map, crag.edges(), array); }
+
+/**
+ * A writable view on the stored features of the given type, as a matrix with 
+ * one row per element. Modifying the features raises a BufferError while an 
+ * array of the view is alive, and makes the view unusable otherwise.
+ */
+template <typename FeaturesType, typename Type>
+boost::python::object featuresView(boost::python::object self, Type type) {
+
+	FeaturesType& allFeatures = boost::python::extract<FeaturesType&>(self);
+	auto& features = allFeatures.getFeatures(type);
+
+	std::size_t rows = features.size();
+	std::size_t cols = (rows > 0 ? features.storedDims() : 0);
+
+	return pycmc::createArrayView(features.data(), {rows, cols}, {(std::size_t)features.stride(), 1}, self, false, &allFeatures);
+}
+
+/**
+ * The ids of the elements of the rows of featuresView().
+ */
+template <typename FeaturesType, typename Type>
+boost::python::object featuresRowIds(const FeaturesType& features, const Crag& crag, Type type) {
+
+	const auto& f = features.getFeatures(type);
+
+	std::vector<int> ids;
+	for (std::size_t row = 0; row < f.size(); row++)
+		ids.push_back(crag.id(f.rowKey(row)));
+
+	return pycmc::createArray(ids, {ids.size()});
+}
+
+/**
+ * Set the features of the elements with the given ids to the rows of a 
+ * matrix.
+ */
+template <typename FeaturesType, typename KeyType>
+void featuresSetRows(FeaturesType& features, const Crag& crag, boost::python::object ids, boost::python::object matrix) {
+
+	std::vector<int>    i = pycmc::bufferToVector<int>(ids);
+	std::vector<double> m = pycmc::bufferToVector<double>(matrix);
+
+	if (i.empty())
+		return;
+
+	pycmc::beginModification(&features);
+
+	if (m.size() % i.size() != 0)
+		UTIL_THROW_EXCEPTION(UsageError, "matrix of size " << m.size() << " does not have " << i.size() << " rows");
+
+	std::size_t dims = m.size()/i.size();
+
+	for (std::size_t row = 0; row < i.size(); row++)
+		features.set(keyFromId<KeyType>(crag, i[row]), m.begin() + row*dims, m.begin() + (row + 1)*dims);
+}
+
+boost::python::object weightsToArray(const FeatureWeights& weights) {
+
+	std::vector<double> w = weights.exportToVector();
+	return pycmc::createArray(w, {w.size()});
+}
+
+void weightsFromArray(FeatureWeights& weights, boost::python::object array) {
+
+	std::vector<double> w = pycmc::bufferToVector<double>(array);
+
+	if (w.size() != weights.exportToVector().size())
+		UTIL_THROW_EXCEPTION(UsageError, "expected " << weights.exportToVector().size() << " weights, got " << w.size());
+
+	weights.importFromVector(w);
+}
+
+/**
+ * A writable view on the voxels of a volume, with shape (depth, height, 
+ * width).
+ */
+template <typename T>
+boost::python::object volumeView(boost::python::object self) {
+
+	ExplicitVolume<T>& volume = boost::python::extract<ExplicitVolume<T>&>(self);
+	auto& data = volume.data();
+
+	return pycmc::createArrayView(
+			data.data(),
+			{(std::size_t)data.shape(2), (std::size_t)data.shape(1), (std::size_t)data.shape(0)},
+			{(std::size_t)data.stride(2), (std::size_t)data.stride(1), (std::size_t)data.stride(0)},
+			self);
+}
+
 // iterator traits specializations
 //
 // if clang
@@ -145,6 +368,8 @@ BOOST_PYTHON_MODULE(pycmc) {
 
 	boost::python::register_exception_translator<Exception>(&translateException);
 
+	registerArrayView();
+
 	// Logging
 	boost::python::enum_<logger::LogLevel>("LogLevel")
 			.value("Quiet", logger::Quiet)
@@ -242,9 +467,12 @@ BOOST_PYTHON_MODULE(pycmc) {
 			.def("isRootNode", &Crag::isRootNode)
 			.def("isLeafNode", &Crag::isLeafNode)
 			.def("isLeafEdge", &Crag::isLeafEdge)
-			.def("leafNodes", &Crag::leafNodes)
-			.def("leafEdges", static_cast<std::set<Crag::CragEdge>(Crag::*)(Crag::CragNode) const>(&Crag::leafEdges))
-			.def("leafEdges", static_cast<std::set<Crag::CragEdge>(Crag::*)(Crag::CragEdge) const>(&Crag::leafEdges))
+			.def("leafNodes", &leafNodes)
+			.def("leafEdges", &nodeLeafEdges)
+			.def("leafEdges", &edgeLeafEdges)
+			.def("nodeIds", &nodeIds)
+			.def("edgeIds", &edgeIds)
+			.def("edgeNodeIds", &edgeNodeIds)
 			;
 
 	// util::point<float, 3>
@@ -323,6 +551,7 @@ BOOST_PYTHON_MODULE(pycmc) {
 			.def("getResolution", &ExplicitVolume<int>::getResolution, boost::python::return_internal_reference<>())
 			.def("getOffset", &CragVolume::getOffset, boost::python::return_internal_reference<>())
 			.def("cut", &ExplicitVolume<int>::cut)
+			.def("view", &volumeView<int>)
 			.def("__getitem__", &genericGetter<ExplicitVolume<int>,
 					util::point<int,3>, int>, boost::python::return_value_policy<boost::python::copy_const_reference>())
 			;
@@ -334,6 +563,7 @@ BOOST_PYTHON_MODULE(pycmc) {
 			.def("getResolution", &ExplicitVolume<float>::getResolution, boost::python::return_internal_reference<>())
 			.def("getOffset", &CragVolume::getOffset, boost::python::return_internal_reference<>())
 			.def("cut", &ExplicitVolume<float>::cut)
+			.def("view", &volumeView<float>)
 			.def("__getitem__", &genericGetter<ExplicitVolume<float>,
 					util::point<float,3>, float>, boost::python::return_value_policy<boost::python::copy_const_reference>())
 			;
@@ -345,6 +575,7 @@ BOOST_PYTHON_MODULE(pycmc) {
 			.def("getResolution", &CragVolume::getResolution, boost::python::return_internal_reference<>())
 			.def("getOffset", &CragVolume::getOffset, boost::python::return_internal_reference<>())
 			.def("cut", &CragVolume::cut)
+			.def("view", &volumeView<unsigned char>)
 			.def("__getitem__", &genericGetter<ExplicitVolume<unsigned char>, util::point<int,3>, unsigned char>,
 					boost::python::return_value_policy<boost::python::copy_const_reference>())
 			;
@@ -367,10 +598,14 @@ BOOST_PYTHON_MODULE(pycmc) {
 	boost::python::class_<Crag::NodeMap<double>, boost::noncopyable>("CragNodeMap_d", boost::python::init<const Crag&>())
 			.def("__getitem__", &genericGetter<Crag::NodeMap<double>, Crag::CragNode, double>, boost::python::return_value_policy<boost::python::copy_const_reference>())
 			.def("__setitem__", &genericSetter<Crag::NodeMap<double>, Crag::CragNode, double>)
+			.def("toArray", &nodeMapToArray)
+			.def("fromArray", &nodeMapFromArray)
 			;
 	boost::python::class_<Crag::EdgeMap<double>, boost::noncopyable>("CragEdgeMap_d", boost::python::init<const Crag&>())
 			.def("__getitem__", &genericGetter<Crag::EdgeMap<double>, Crag::CragEdge, double>, boost::python::return_value_policy<boost::python::copy_const_reference>())
 			.def("__setitem__", &genericSetter<Crag::EdgeMap<double>, Crag::CragEdge, double>)
+			.def("toArray", &edgeMapToArray)
+			.def("fromArray", &edgeMapFromArray)
 			;
 
 	// Costs
@@ -405,20 +640,26 @@ BOOST_PYTHON_MODULE(pycmc) {
 
 	// NodeFeatures
 	boost::python::class_<NodeFeatures>("NodeFeatures", boost::python::init<const Crag&>())
-			.def("__getitem__", &genericGetter<NodeFeatures, Crag::CragNode, std::vector<double>>,
-					boost::python::return_internal_reference<>())
+			.def("__getitem__", &featuresGetter<NodeFeatures, Crag::CragNode>)
 			.def("__setitem__", &featuresSetter<NodeFeatures, Crag::CragNode, boost::python::list, double>)
+			.def("expand", &featuresExpand<NodeFeatures, Crag::CragNode>)
 			.def("dims", &NodeFeatures::dims)
-			.def("append", &NodeFeatures::append)
+			.def("append", &featuresAppend<NodeFeatures, Crag::CragNode>)
+			.def("view", &featuresView<NodeFeatures, Crag::NodeType>)
+			.def("rowIds", &featuresRowIds<NodeFeatures, Crag::NodeType>)
+			.def("setRows", &featuresSetRows<NodeFeatures, Crag::CragNode>)
 			;
 
 	// EdgeFeatures
 	boost::python::class_<EdgeFeatures>("EdgeFeatures", boost::python::init<const Crag&>())
-			.def("__getitem__", &genericGetter<EdgeFeatures, Crag::CragEdge, std::vector<double>>,
-					boost::python::return_internal_reference<>())
+			.def("__getitem__", &featuresGetter<EdgeFeatures, Crag::CragEdge>)
 			.def("__setitem__", &featuresSetter<EdgeFeatures, Crag::CragEdge, boost::python::list, double>)
+			.def("expand", &featuresExpand<EdgeFeatures, Crag::CragEdge>)
 			.def("dims", &EdgeFeatures::dims)
-			.def("append", &EdgeFeatures::append)
+			.def("append", &featuresAppend<EdgeFeatures, Crag::CragEdge>)
+			.def("view", &featuresView<EdgeFeatures, Crag::EdgeType>)
+			.def("rowIds", &featuresRowIds<EdgeFeatures, Crag::EdgeType>)
+			.def("setRows", &featuresSetRows<EdgeFeatures, Crag::CragEdge>)
 			;
 
 	// FeatureWeights
@@ -431,6 +672,8 @@ BOOST_PYTHON_MODULE(pycmc) {
 			.def("__getitem__", &genericGetter<FeatureWeights, Crag::EdgeType, std::vector<double>>,
 					boost::python::return_internal_reference<>())
 			.def("__setitem__", &weightSetter<FeatureWeights, Crag::EdgeType, boost::python::list, double>)
+			.def("toArray", &weightsToArray)
+			.def("fromArray", &weightsFromArray)
 			;
 
 	// CragSolution
@@ -460,8 +703,8 @@ BOOST_PYTHON_MODULE(pycmc) {
 			.def("saveSolution", &Hdf5CragStore::saveSolution)
 			.def("retrieveCrag", &Hdf5CragStore::retrieveCrag)
 			.def("retrieveVolumes", &Hdf5CragStore::retrieveVolumes)
-			.def("retrieveNodeFeatures", &Hdf5CragStore::retrieveNodeFeatures)
-			.def("retrieveEdgeFeatures", &Hdf5CragStore::retrieveEdgeFeatures)
+			.def("retrieveNodeFeatures", &retrieveNodeFeatures)
+			.def("retrieveEdgeFeatures", &retrieveEdgeFeatures)
 			.def("retrieveFeaturesMin", &Hdf5CragStore::retrieveFeaturesMin)
 			.def("retrieveFeaturesMax", &Hdf5CragStore::retrieveFeaturesMax)
 			//.def("retrieveSkeletons", &Hdf5CragStore::retrieveSkeletons)
@@ -146,7 +146,7 @@ def segment():
     # threshold leaf node edges
     for e in crag.edges():
         if crag.isLeafEdge(e):
-            prob = edge_rf.getProbabilities(edge_features[e])[1]
+            prob = edge_rf.getProbabilities(edge_features.expand(e))[1]
             if prob > 0.5:
                 solution.setSelected(e, True)
             else:
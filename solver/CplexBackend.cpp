@@ -24,7 +24,8 @@ CplexBackend::CplexBackend(const Parameter& parameter) :
     c_(env_),
     obj_(env_),
     sol_(env_),
-    firstRun_(true)
+    firstRun_(true),
+    _quadraticObjective(false)
 {
     LOG_DEBUG(cplexlog) << "constructing cplex solver" << std::endl;
 }
@@ -49,6 +50,13 @@ CplexBackend::initialize(
 
     _numVariables = numVariables;
 
+    // the previous objective refers to the previous variables, the next call
+    // to setObjective() has to create a new one
+    if (!firstRun_)
+        model_.remove(obj_);
+    firstRun_           = true;
+    _quadraticObjective = false;
+
     // delete previous variables
     x_.clear();
 
@@ -87,6 +95,29 @@ void
 CplexBackend::setObjective(const QuadraticObjective& objective) {
     try {
 
+        // a linear objective replacing a linear objective, as in cutting-plane
+        // methods and repeated solves with new costs: change the coefficients
+        // in place, such that the extracted model, the constraints, and the
+        // search information of the previous solve are kept
+        if (!firstRun_ && !_quadraticObjective && objective.getQuadraticCoefficients().empty()) {
+
+            LOG_DEBUG(cplexlog) << "updating linear coefficients" << std::endl;
+
+            obj_.setSense(objective.getSense() == Minimize ? IloObjective::Minimize : IloObjective::Maximize);
+            obj_.setConstant(objective.getConstant());
+
+            IloNumArray coefs(env_, _numVariables);
+            for (size_t i = 0; i < _numVariables; i++)
+                coefs[i] = (
+                        objective.getCoefficients()[i] == std::numeric_limits<double>::infinity() ?
+                        CPX_INFBOUND :
+                        objective.getCoefficients()[i]);
+            obj_.setLinearCoefs(x_, coefs);
+            coefs.end();
+
+            return;
+        }
+
 
        if(!firstRun_){
         model_.remove(obj_);
@@ -130,6 +161,8 @@ CplexBackend::setObjective(const QuadraticObjective& objective) {
             firstRun_ = false;
         }
 
+        _quadraticObjective = !objective.getQuadraticCoefficients().empty();
+
 
     } catch (IloCplex::Exception e) {
 
@@ -145,15 +178,26 @@ CplexBackend::setConstraints(const LinearConstraints& constraints) {
         model_.remove(*constraint);
     _constraints.clear();
 
+    LOG_USER(cplexlog) << "setting " << constraints.size() << " constraints" << std::endl;
+
+    addConstraints(constraints);
+}
+
+void
+CplexBackend::addConstraints(const LinearConstraints& constraints, unsigned int first) {
+
+    if (first >= constraints.size())
+        return;
+
     // allocate memory for new constraints
-    _constraints.reserve(constraints.size());
+    _constraints.reserve(_constraints.size() + constraints.size() - first);
 
     try {
-        LOG_USER(cplexlog) << "setting " << constraints.size() << " constraints" << std::endl;
+        LOG_DEBUG(cplexlog) << "adding " << (constraints.size() - first) << " constraints" << std::endl;
 
         IloExtractableArray cplex_constraints(env_);
-        for (LinearConstraints::const_iterator constraint = constraints.begin(); constraint != constraints.end(); constraint++) {
-            IloRange linearConstraint = createConstraint(*constraint);
+        for (unsigned int i = first; i < constraints.size(); i++) {
+            IloRange linearConstraint = createConstraint(constraints[i]);
             _constraints.push_back(linearConstraint);
             cplex_constraints.add(linearConstraint);
         }
@@ -167,6 +211,17 @@ CplexBackend::setConstraints(const LinearConstraints& constraints) {
     }
 }
 
+void
+CplexBackend::setInitialSolution(const Solution& solution) {
+
+    if (solution.size() != _numVariables)
+        return;
+
+    _initialSolution.resize(_numVariables);
+    for (unsigned int i = 0; i < _numVariables; i++)
+        _initialSolution[i] = solution[i];
+}
+
 void
 CplexBackend::addConstraint(const LinearConstraint& constraint) {
 
@@ -217,7 +272,11 @@ bool
 CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg) {
 
     try {
-        cplex_ = IloCplex(model_);
+        // extract the model only once, later changes to the model are 
+        // passed on to cplex incrementally and the previous solution is 
+        // reused
+        if (!cplex_.getImpl())
+            cplex_ = IloCplex(model_);
         setVerbose(_parameter.verbose);
 
         setMIPGap(_parameter.mipGap);
@@ -229,6 +288,17 @@ CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg) {
 
         setNumThreads(_parameter.numThreads);
 
+        if (!_initialSolution.empty()) {
+
+            IloNumArray start(env_, _numVariables);
+            for (unsigned int i = 0; i < _numVariables; i++)
+                start[i] = _initialSolution[i];
+            cplex_.addMIPStart(x_, start);
+            start.end();
+
+            _initialSolution.clear();
+        }
+
         if(!cplex_.solve()) {
            LOG_USER(cplexlog) << "failed to optimize. " << cplex_.getStatus() << std::endl;
            msg = "Optimal solution *NOT* found";
@@ -246,8 +316,6 @@ CplexBackend::solve(Solution& x,/* double& value, */ std::string& msg) {
         // get current value of the objective
         const double value = cplex_.getObjValue();
         x.setValue(value);
-        model_.remove(obj_);
-        //cplex_.clearModel();
 
     } catch (IloCplex::Exception& e) {
 
@@ -83,6 +83,10 @@ public:
 
     void addConstraint(const LinearConstraint& constraint);
 
+    void addConstraints(const LinearConstraints& constraints, unsigned int first = 0);
+
+    void setInitialSolution(const Solution& solution);
+
     bool solve(Solution& solution,/* double& value, */ std::string& message);
 
 private:
@@ -138,8 +142,15 @@ private:
     typedef std::vector<IloExtractable> ConstraintVector;
     ConstraintVector _constraints;
 
+    // start solution for the next solve, empty if none was given
+    std::vector<double> _initialSolution;
+
     // are we in the first run
     bool firstRun_;
+
+    // whether the current objective has quadratic terms, otherwise a new
+    // objective only updates the coefficients of the current one
+    bool _quadraticObjective;
 };
 
 
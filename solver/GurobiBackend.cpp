@@ -3,6 +3,7 @@
 #ifdef HAVE_GUROBI
 
 #include <sstream>
+#include <vector>
 
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
@@ -83,6 +84,7 @@ GurobiBackend::initialize(
 	if (_model)
 		GRBfreemodel(_model);
 	GRB_CHECK(GRBnewmodel(_env, &_model, NULL, 0, NULL, NULL, NULL, NULL, NULL));
+	_numConstraints = 0;
 
 	// set parameters
 
@@ -205,28 +207,89 @@ GurobiBackend::setConstraints(const LinearConstraints& constraints) {
 		for (int i = 0; i < _numConstraints; i++)
 			constraintIndicies[i] = i;
 		GRB_CHECK(GRBdelconstrs(_model, _numConstraints, constraintIndicies));
+		delete[] constraintIndicies;
 
 		GRB_CHECK(GRBupdatemodel(_model));
 	}
 
+	_numConstraints = 0;
+
 	LOG_DEBUG(gurobilog) << "setting " << constraints.size() << " constraints" << std::endl;
 
-	_numConstraints = constraints.size();
-	unsigned int j = 0;
-	for (const LinearConstraint& constraint : constraints) {
+	addConstraints(constraints);
+}
+
+void
+GurobiBackend::addConstraints(const LinearConstraints& constraints, unsigned int first) {
+
+	if (first >= constraints.size())
+		return;
+
+	unsigned int numConstraints = constraints.size() - first;
+
+	LOG_DEBUG(gurobilog) << "adding " << numConstraints << " constraints" << std::endl;
 
-		if (j > 0)
-			if (j % 1000 == 0)
-				LOG_ALL(gurobilog) << "" << j << " constraints set so far" << std::endl;
+	// add all constraints in a single call, in compressed row format
+	std::vector<int>    beg;
+	std::vector<int>    inds;
+	std::vector<double> vals;
+	std::vector<char>   senses;
+	std::vector<double> rhs;
 
-		addConstraint(constraint);
+	beg.reserve(numConstraints);
+	senses.reserve(numConstraints);
+	rhs.reserve(numConstraints);
+
+	for (unsigned int j = first; j < constraints.size(); j++) {
+
+		const LinearConstraint& constraint = constraints[j];
+
+		beg.push_back(inds.size());
+
+		for (auto& pair : constraint.getCoefficients()) {
+
+			inds.push_back(pair.first);
+			vals.push_back(pair.second);
+		}
 
-		j++;
+		senses.push_back(
+				constraint.getRelation() == LessEqual ? GRB_LESS_EQUAL :
+						(constraint.getRelation() == GreaterEqual ? GRB_GREATER_EQUAL :
+								GRB_EQUAL));
+		rhs.push_back(constraint.getValue());
 	}
 
+	GRB_CHECK(GRBaddconstrs(
+			_model,
+			numConstraints,
+			inds.size(),
+			&beg[0],
+			inds.empty() ? NULL : &inds[0],
+			vals.empty() ? NULL : &vals[0],
+			&senses[0],
+			&rhs[0],
+			NULL /* optional names */));
+
+	_numConstraints += numConstraints;
+
 	GRB_CHECK(GRBupdatemodel(_model));
 }
 
+void
+GurobiBackend::setInitialSolution(const Solution& solution) {
+
+	if (solution.size() != _numVariables)
+		return;
+
+	LOG_DEBUG(gurobilog) << "setting start solution" << std::endl;
+
+	GRB_CHECK(GRBsetdblattrarray(
+			_model,
+			GRB_DBL_ATTR_START,
+			0 /* start */, _numVariables,
+			const_cast<double*>(&solution[0])));
+}
+
 void
 GurobiBackend::addConstraint(const LinearConstraint& constraint) {
 
@@ -255,6 +318,8 @@ GurobiBackend::addConstraint(const LinearConstraint& constraint) {
 			constraint.getValue(),
 			NULL /* optional name */));
 
+	_numConstraints++;
+
 	delete[] inds;
 	delete[] vals;
 }
@@ -60,6 +60,10 @@ public:
 
 	void addConstraint(const LinearConstraint& constraint);
 
+	void addConstraints(const LinearConstraints& constraints, unsigned int first = 0);
+
+	void setInitialSolution(const Solution& solution);
+
 	bool solve(Solution& solution, std::string& message);
 
 private:
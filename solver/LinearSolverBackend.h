@@ -64,6 +64,31 @@ public:
 	 */
 	virtual void addConstraint(const LinearConstraint& constraint) = 0;
 
+	/**
+	 * Add constraints to the ones already present, without replacing them. 
+	 * Only the constraints starting at the given index are added, such that a 
+	 * growing set of constraints can be passed to the solver incrementally, 
+	 * as in cutting-plane methods.
+	 *
+	 * @param constraints A set of linear constraints.
+	 * @param first The index of the first constraint to add.
+	 */
+	virtual void addConstraints(const LinearConstraints& constraints, unsigned int first = 0) {
+
+		for (unsigned int i = first; i < constraints.size(); i++)
+			addConstraint(constraints[i]);
+	}
+
+	/**
+	 * Provide a start solution for the next call to solve(), e.g., the 
+	 * solution of a previous call. The solution is only a hint and does not 
+	 * need to be feasible. Backends that do not support warm starts ignore 
+	 * it.
+	 *
+	 * @param solution A solution with one value per variable.
+	 */
+	virtual void setInitialSolution(const Solution& solution) {}
+
 	/**
 	 * Solve the problem.
 	 *
@@ -27,8 +27,9 @@ ScipBackend::~ScipBackend() {
 
 	LOG_DEBUG(sciplog) << "destructing scip solver..." << std::endl;
 
-	freeVariables();
-	freeConstraints();
+	// SCIPfree frees variables and constraints for us
+	_variables.clear();
+	_constraints.clear();
 
 	if (_scip != 0)
 		SCIP_CALL_ABORT(SCIPfree(&_scip));
@@ -187,6 +188,10 @@ ScipBackend::solve(Solution& x, std::string& msg) {
 	if (SCIPgetNSols(_scip) == 0) {
 
 		msg = "Optimal solution *NOT* found";
+
+		// go back to the problem stage to allow modifications
+		SCIP_CALL_ABORT(SCIPfreeTransform(_scip));
+
 		return false;
 	}
 
@@ -205,6 +210,25 @@ ScipBackend::solve(Solution& x, std::string& msg) {
 	return true;
 }
 
+void
+ScipBackend::setInitialSolution(const Solution& solution) {
+
+	if (solution.size() != _numVariables)
+		return;
+
+	LOG_DEBUG(sciplog) << "adding start solution" << std::endl;
+
+	SCIP_SOL* sol;
+	SCIP_CALL_ABORT(SCIPcreateOrigSol(_scip, &sol, NULL));
+
+	for (unsigned int i = 0; i < _numVariables; i++)
+		SCIP_CALL_ABORT(SCIPsetSolVal(_scip, sol, _variables[i], solution[i]));
+
+	// infeasible solutions are discarded by SCIP
+	SCIP_Bool stored;
+	SCIP_CALL_ABORT(SCIPaddSolFree(_scip, &sol, &stored));
+}
+
 void
 ScipBackend::setVerbose(bool verbose) {
 
@@ -225,7 +249,11 @@ ScipBackend::freeVariables() {
 void
 ScipBackend::freeConstraints() {
 
-	// SCIPfree should free the constraints for us
+	// remove the constraints from the problem, otherwise they accumulate 
+	// over calls to setConstraints()
+	for (SCIP_CONS* c : _constraints)
+		SCIP_CALL_ABORT(SCIPdelCons(_scip, c));
+
 	_constraints.clear();
 }
 
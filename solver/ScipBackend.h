@@ -55,6 +55,8 @@ public:
 
 	void addConstraint(const LinearConstraint& constraint);
 
+	void setInitialSolution(const Solution& solution);
+
 	bool solve(Solution& solution, std::string& message);
 
 private: